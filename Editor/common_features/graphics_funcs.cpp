@@ -25,6 +25,7 @@
 
 #include <common_features/logger.h>
 #include <FileMapper/file_mapper.h>
+#include <Utils/bitmask.h>
 
 #include "graphics_funcs.h"
 
@@ -35,6 +36,18 @@
 
 #include <QtDebug>
 
+/**
+ * @brief Format of QImage which is fits the bit-mask kernels: alpha channel must be the fourth byte of every pixel
+ * @return QImage pixel format
+ */
+static inline QImage::Format bitMaskFormat()
+{
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    return QImage::Format_ARGB32;
+#else
+    return QImage::Format_RGBA8888;
+#endif
+}
 
 FIBITMAP *GraphicsHelps::loadImage(QString file, bool convertTo32bit)
 {
@@ -103,44 +116,12 @@ void GraphicsHelps::mergeWithMask(FIBITMAP *image, QString pathToMask, QPixmap *
     unsigned int img_h = FreeImage_GetHeight(image);
     unsigned int mask_w = FreeImage_GetWidth(mask);
     unsigned int mask_h = FreeImage_GetHeight(mask);
-    BYTE *img_bits  = FreeImage_GetBits(image);
-    BYTE *mask_bits = FreeImage_GetBits(mask);
-    BYTE *FPixP = img_bits;
-    BYTE *SPixP = mask_bits;
-    RGBQUAD Npix = {0x00, 0x00, 0x00, 0xFF};   //Destination pixel color
-    unsigned short newAlpha = 255; //Calculated destination alpha-value
+    unsigned int w = (img_w < mask_w) ? img_w : mask_w;
 
     for(unsigned int y = 0; (y < img_h) && (y < mask_h); y++)
-    {
-        for(unsigned int x = 0; (x < img_w) && (x < mask_w); x++)
-        {
-            Npix.rgbBlue = ((SPixP[FI_RGBA_BLUE] & 0x7F) | FPixP[FI_RGBA_BLUE]);
-            Npix.rgbGreen = ((SPixP[FI_RGBA_GREEN] & 0x7F) | FPixP[FI_RGBA_GREEN]);
-            Npix.rgbRed = ((SPixP[FI_RGBA_RED] & 0x7F) | FPixP[FI_RGBA_RED]);
-            newAlpha = 255 - ((static_cast<unsigned short>(SPixP[FI_RGBA_RED]) +
-                               static_cast<unsigned short>(SPixP[FI_RGBA_GREEN]) +
-                               static_cast<unsigned short>(SPixP[FI_RGBA_BLUE])) / 3);
-
-            if((SPixP[FI_RGBA_RED] > 240u) //is almost White
-               && (SPixP[FI_RGBA_GREEN] > 240u)
-               && (SPixP[FI_RGBA_BLUE] > 240u))
-                newAlpha = 0;
-
-            newAlpha += ((short(FPixP[FI_RGBA_RED]) +
-                          short(FPixP[FI_RGBA_GREEN]) +
-                          short(FPixP[FI_RGBA_BLUE])) / 3);
-
-            if(newAlpha > 255)
-                newAlpha = 255;
-
-            FPixP[FI_RGBA_BLUE]  = Npix.rgbBlue;
-            FPixP[FI_RGBA_GREEN] = Npix.rgbGreen;
-            FPixP[FI_RGBA_RED]   = Npix.rgbRed;
-            FPixP[FI_RGBA_ALPHA] = static_cast<BYTE>(newAlpha);
-            FPixP += 4;
-            SPixP += 4;
-        }
-    }
+        BitMask::mergeWithMask(FreeImage_GetScanLine(image, static_cast<int>(y)),
+                               FreeImage_GetScanLine(mask, static_cast<int>(y)),
+                               w);
 
     FreeImage_Unload(mask);
 }
@@ -191,21 +172,13 @@ void GraphicsHelps::mergeToRGBA(QPixmap &img, QImage &mask, QString path, QStrin
 
 void GraphicsHelps::getMaskFromRGBA(const QPixmap &srcimage, QImage &mask)
 {
-    unsigned int img_w   = srcimage.width();
-    unsigned int img_h   = srcimage.height();
+    int img_w   = srcimage.width();
+    int img_h   = srcimage.height();
 
-    QImage image = srcimage.toImage();
-    mask = QImage(img_w, img_h, QImage::Format_ARGB32);
-    QRgb Fpix;
-    for(unsigned int y = 0; (y < img_h); y++)
-    {
-        for(unsigned int x = 0; (x < img_w); x++)
-        {
-            Fpix = image.pixel(x, y);
-            uint32_t grey = (255 - qAlpha(Fpix));
-            mask.setPixel(x, y, qRgba(grey, grey, grey, 0xFF));
-        }
-    }
+    QImage image = srcimage.toImage().convertToFormat(bitMaskFormat());
+    mask = QImage(img_w, img_h, bitMaskFormat());
+    for(int y = 0; (y < img_h); y++)
+        BitMask::maskFromAlpha(image.constScanLine(y), mask.scanLine(y), static_cast<size_t>(img_w));
 }
 
 void GraphicsHelps::getMaskFromRGBA(const QPixmap &srcimage, FIBITMAP *&mask)
@@ -213,7 +186,7 @@ void GraphicsHelps::getMaskFromRGBA(const QPixmap &srcimage, FIBITMAP *&mask)
     unsigned int img_w   = srcimage.width();
     unsigned int img_h   = srcimage.height();
 
-    QImage image = srcimage.toImage();
+    QImage image = srcimage.toImage().convertToFormat(bitMaskFormat());
 
     mask = FreeImage_AllocateT(FIT_BITMAP,
                                img_w, img_h,
@@ -222,20 +195,11 @@ void GraphicsHelps::getMaskFromRGBA(const QPixmap &srcimage, FIBITMAP *&mask)
                                FI_RGBA_GREEN_MASK,
                                FI_RGBA_BLUE_MASK);
 
-    RGBQUAD Npix = {0x0, 0x0, 0x0, 0xFF};
-
+    // FreeImage keeps rows from bottom to top
     for(unsigned int y = 0; (y < img_h); y++)
-    {
-        for(unsigned int x = 0; (x < img_w); x++)
-        {
-            uint8_t grey = (255 - qAlpha(image.pixel(x, ((img_h - 1) - y))));
-            Npix.rgbRed  = grey;
-            Npix.rgbGreen = grey;
-            Npix.rgbBlue = grey;
-            Npix.rgbReserved = 0xFF;
-            FreeImage_SetPixelColor(mask,  x, y, &Npix);
-        }
-    }
+        BitMask::maskFromAlpha(image.constScanLine(static_cast<int>((img_h - 1) - y)),
+                               FreeImage_GetScanLine(mask, static_cast<int>(y)),
+                               img_w);
 }
 
 //Implementation of Bitwise merging of bit-mask to RGBA image
@@ -247,51 +211,17 @@ void GraphicsHelps::mergeToRGBA_BitWise(QImage &image, QImage mask)
     if(image.isNull())
         return;
 
-    //bool isWhiteMask = true;
-    //QImage target(image.width(), image.height(), QImage::Format_ARGB32);
+    if(image.format() != bitMaskFormat())
+        image = image.convertToFormat(bitMaskFormat());
 
-    //QImage newmask = mask.convertToFormat(QImage::Format_ARGB32);
-    //newmask = newmask.convertToFormat(QImage::Format_ARGB32);
-    //    if(target.size()!= mask.size())
-    //    {
-    //        mask = mask.copy(0, 0, target.width(), target.height());
-    //    }
+    if(mask.format() != bitMaskFormat())
+        mask = mask.convertToFormat(bitMaskFormat());
 
+    int w = qMin(image.width(), mask.width());
+
+    // This path always ANDed the mask with qRgb(128, 128, 128), unlike the FreeImage one
     for(int y = 0; (y < image.height()) && (y < mask.height()); y++)
-        for(int x = 0; (x < image.width()) && (x < mask.width()); x++)
-        {
-            QColor Fpix = QColor(image.pixel(x, y));
-            QColor Dpix = QColor(qRgb(128, 128, 128));
-            QColor Spix = QColor(mask.pixel(x, y));
-            QColor Npix;
-            Npix.setAlpha(255);
-            //AND
-            Npix.setRed(Dpix.red() & Spix.red());
-            Npix.setGreen(Dpix.green() & Spix.green());
-            Npix.setBlue(Dpix.blue() & Spix.blue());
-            //OR
-            Npix.setRed(Fpix.red() | Npix.red());
-            Npix.setGreen(Fpix.green() | Npix.green());
-            Npix.setBlue(Fpix.blue() | Npix.blue());
-            //            isWhiteMask &= ( (Spix.red()>240) //is almost White
-            //                             &&(Spix.green()>240)
-            //                             &&(Spix.blue()>240));
-            //Calculate alpha-channel level
-            int newAlpha = 255 - ((Spix.red() + Spix.green() + Spix.blue()) / 3);
-
-            if((Spix.red() > 240) //is almost White
-               && (Spix.green() > 240)
-               && (Spix.blue() > 240))
-                newAlpha = 0;
-
-            newAlpha = newAlpha + ((Fpix.red() + Fpix.green() + Fpix.blue()) / 3);
-
-            if(newAlpha > 255)
-                newAlpha = 255;
-
-            Npix.setAlpha(newAlpha);
-            image.setPixel(x, y, Npix.rgba());
-        }
+        BitMask::mergeWithMask(image.scanLine(y), mask.constScanLine(y), static_cast<size_t>(w), 0x80);
 }
 
 void GraphicsHelps::loadMaskedImage(QString rootDir, QString in_imgName, QString &out_maskName, QPixmap &out_Img, QImage &, QString &out_errStr)
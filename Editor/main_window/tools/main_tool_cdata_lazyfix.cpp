@@ -27,6 +27,7 @@
 #include <FileMapper/file_mapper.h>
 #include <DirManager/dirman.h>
 #include <Utils/files.h>
+#include <Utils/bitmask.h>
 
 #ifdef _WIN32
 #define FREEIMAGE_LIB 1
@@ -89,52 +90,16 @@ static bool mergeBitBltToRGBA(FIBITMAP *image, const std::string &pathToMask)
     unsigned int mask_w = FreeImage_GetWidth(mask);
     unsigned int mask_h = FreeImage_GetHeight(mask);
 
-    RGBQUAD Fpix;
-    RGBQUAD Bpix;
-    RGBQUAD Npix = {0x0, 0x0, 0x0, 0xFF};
+    unsigned int w = (img_w < mask_w) ? img_w : mask_w;
 
     for(unsigned int y = 0; (y < img_h) && (y < mask_h); y++)
-    {
-        for(unsigned int x = 0; (x < img_w) && (x < mask_w); x++)
-        {
-
-            FreeImage_GetPixelColor(image, x, y, &Fpix);
-            FreeImage_GetPixelColor(mask, x, y, &Bpix);
-
-            Npix.rgbRed     = ((0x7F & Bpix.rgbRed) | Fpix.rgbRed);
-            Npix.rgbGreen   = ((0x7F & Bpix.rgbGreen) | Fpix.rgbGreen);
-            Npix.rgbBlue    = ((0x7F & Bpix.rgbBlue) | Fpix.rgbBlue);
-            int newAlpha = 255 -
-                           ((int(Bpix.rgbRed) +
-                             int(Bpix.rgbGreen) +
-                             int(Bpix.rgbBlue)) / 3);
-            if((Bpix.rgbRed > 240u) //is almost White
-               && (Bpix.rgbGreen > 240u)
-               && (Bpix.rgbBlue > 240u))
-                newAlpha = 0;
-
-            newAlpha = newAlpha + ((int(Fpix.rgbRed) +
-                                    int(Fpix.rgbGreen) +
-                                    int(Fpix.rgbBlue)) / 3);
-            if(newAlpha > 255)
-                newAlpha = 255;
-            Npix.rgbReserved = newAlpha;
-
-            FreeImage_SetPixelColor(image, x, y, &Npix);
-        }
-    }
+        BitMask::mergeWithMask(FreeImage_GetScanLine(image, static_cast<int>(y)),
+                               FreeImage_GetScanLine(mask, static_cast<int>(y)),
+                               w);
     FreeImage_Unload(mask);
     return true;
 }
 
-static inline uint8_t subtractAlpha(const uint8_t channel, const uint8_t alpha)
-{
-    int16_t ch = static_cast<int16_t>(channel) - static_cast<int16_t>(alpha);
-    if(ch < 0)
-        ch = 0;
-    return static_cast<uint8_t>(ch);
-}
-
 static void splitRGBAtoBitBlt(FIBITMAP *&image, FIBITMAP *&mask)
 {
     unsigned int img_w   = FreeImage_GetWidth(image);
@@ -147,30 +112,10 @@ static void splitRGBAtoBitBlt(FIBITMAP *&image, FIBITMAP *&mask)
                                FreeImage_GetGreenMask(image),
                                FreeImage_GetBlueMask(image));
 
-    RGBQUAD Fpix;
-    RGBQUAD Npix = {0x0, 0x0, 0x0, 0xFF};
-
     for(unsigned int y = 0; (y < img_h); y++)
-    {
-        for(unsigned int x = 0; (x < img_w); x++)
-        {
-            FreeImage_GetPixelColor(image, x, y, &Fpix);
-
-            uint8_t grey = (255 - Fpix.rgbReserved);
-            Npix.rgbRed  = grey;
-            Npix.rgbGreen = grey;
-            Npix.rgbBlue = grey;
-            Npix.rgbReserved = 255;
-
-            Fpix.rgbRed  = subtractAlpha(Fpix.rgbRed, grey);
-            Fpix.rgbGreen = subtractAlpha(Fpix.rgbGreen, grey);
-            Fpix.rgbBlue = subtractAlpha(Fpix.rgbBlue, grey);
-            Fpix.rgbReserved = 255;
-
-            FreeImage_SetPixelColor(image, x, y, &Fpix);
-            FreeImage_SetPixelColor(mask,  x, y, &Npix);
-        }
-    }
+        BitMask::splitToFrontAndMask(FreeImage_GetScanLine(image, static_cast<int>(y)),
+                                     FreeImage_GetScanLine(mask, static_cast<int>(y)),
+                                     img_w);
 }
 
 struct LazyFixTool_Setup
@@ -19,20 +19,18 @@
 #ifndef PLAY_SFX_H
 #define PLAY_SFX_H
 
-#include <unordered_map>
 #include <string>
 
 struct Mix_Chunk;
+/*!
+ * \brief Plays sound files by path, decoded sounds are kept by PGE_SfxBank
+ */
 class PGE_SfxPlayer
 {
 public:
     static void playFile(std::string sndFile);
     static void clearSoundBuffer();
     static Mix_Chunk *openSFX(std::string sndFile);
-
-private:
-    typedef std::unordered_map<std::string, Mix_Chunk* > sfxHash;
-    static  sfxHash chunksBuffer;
 };
 
 #endif // PLAY_SFX_H
@@ -0,0 +1,307 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sfx_bank.h"
+#include "pge_audio.h"
+
+#include <common_features/logger.h>
+#include <common_features/worker_pool.h>
+#include <FileMapper/file_mapper.h>
+
+#include <unordered_map>
+#include <list>
+#include <memory>
+
+namespace
+{
+
+enum class SfxState
+{
+    //! Waiting for background thread
+    Queued,
+    //! Decoding right now
+    Loading,
+    Ready,
+    Failed
+};
+
+struct SfxEntry
+{
+    SfxState   state = SfxState::Queued;
+    Mix_Chunk *chunk = nullptr;
+    size_t     bytes = 0;
+    //! Place in the usage list, valid for ready sounds only
+    std::list<std::string>::iterator lru;
+};
+
+}
+
+static struct SfxBankState
+{
+    SDL_mutex  *mutex = nullptr;
+    //! Signals that one of sounds has been decoded
+    SDL_cond   *loaded = nullptr;
+    //! References to elements are kept valid on insertion, so entries are accessed by references while unlocked
+    std::unordered_map<std::string, SfxEntry> entries;
+    //! Ready sounds, most recently used are first
+    std::list<std::string> lru;
+    std::unique_ptr<WorkerPool> loader;
+    PGE_SfxBank::Stats stats;
+    size_t      budget = PGE_SfxBank::defaultBudget;
+} s_bank;
+
+static void ensureInit()
+{
+    if(!s_bank.mutex)
+    {
+        s_bank.mutex = SDL_CreateMutex();
+        s_bank.loaded = SDL_CreateCond();
+    }
+}
+
+static Mix_Chunk *decodeChunk(const std::string &file)
+{
+    Mix_Chunk *chunk = nullptr;
+#if  defined(__unix__) || defined(__APPLE__) || defined(_WIN32) || defined(__HAIKU__)
+    FileMapper fileMap;
+    if(fileMap.open_file(file.c_str()))
+    {
+        chunk = Mix_LoadWAV_RW(SDL_RWFromMem(fileMap.data(), static_cast<int>(fileMap.size())), 1);
+        fileMap.close_file();
+    }
+#else
+    chunk = Mix_LoadWAV(file.c_str());
+#endif
+    if(!chunk)
+        pLogWarning("SfxBank: Fail to load sound %s: %s", file.c_str(), Mix_GetError());
+    return chunk;
+}
+
+/*!
+ * \brief Put decoded sound into the entry, must be called with locked mutex
+ */
+static void storeChunk(const std::string &file, SfxEntry &e, Mix_Chunk *chunk)
+{
+    e.chunk = chunk;
+    if(!chunk)
+    {
+        e.state = SfxState::Failed;
+        return;
+    }
+
+    e.state = SfxState::Ready;
+    e.bytes = sizeof(Mix_Chunk) + chunk->alen;
+    s_bank.lru.push_front(file);
+    e.lru = s_bank.lru.begin();
+    s_bank.stats.bytes += e.bytes;
+    s_bank.stats.loaded++;
+}
+
+static bool isChunkPlaying(Mix_Chunk *chunk)
+{
+    int channels = Mix_AllocateChannels(-1);
+    for(int i = 0; i < channels; i++)
+    {
+        if(Mix_Playing(i) && (Mix_GetChunk(i) == chunk))
+            return true;
+    }
+    return false;
+}
+
+/*!
+ * \brief Free least recently used sounds while memory usage is over budget, must be called with locked mutex
+ * \param keep Sound which must not be freed
+ */
+static void trimToBudget(Mix_Chunk *keep)
+{
+    std::list<std::string>::iterator it = s_bank.lru.end();
+    while((s_bank.stats.bytes > s_bank.budget) && (it != s_bank.lru.begin()))
+    {
+        --it;
+        auto e = s_bank.entries.find(*it);
+        if((e == s_bank.entries.end()) || (e->second.chunk == keep) || isChunkPlaying(e->second.chunk))
+            continue;
+
+        Mix_FreeChunk(e->second.chunk);
+        s_bank.stats.bytes -= e->second.bytes;
+        s_bank.stats.loaded--;
+        s_bank.stats.evictions++;
+        s_bank.entries.erase(e);
+        it = s_bank.lru.erase(it);
+    }
+}
+
+static void loadJob(const std::string &file)
+{
+    SDL_LockMutex(s_bank.mutex);
+    auto it = s_bank.entries.find(file);
+    if((it == s_bank.entries.end()) || (it->second.state != SfxState::Queued))
+    {
+        // Already taken by the game thread or dropped by clear()
+        SDL_UnlockMutex(s_bank.mutex);
+        return;
+    }
+    SfxEntry &e = it->second;
+    e.state = SfxState::Loading;
+    SDL_UnlockMutex(s_bank.mutex);
+
+    Mix_Chunk *chunk = decodeChunk(file);
+
+    SDL_LockMutex(s_bank.mutex);
+    storeChunk(file, e, chunk);
+    SDL_CondBroadcast(s_bank.loaded);
+    SDL_UnlockMutex(s_bank.mutex);
+}
+
+void PGE_SfxBank::preload(const std::vector<std::string> &files)
+{
+    if(!PGE_Audio::isLoaded())
+        return;
+
+    ensureInit();
+
+    std::vector<std::string> queue;
+    SDL_LockMutex(s_bank.mutex);
+    for(const std::string &file : files)
+    {
+        if(file.empty() || (s_bank.entries.find(file) != s_bank.entries.end()))
+            continue;
+        s_bank.entries.insert({file, SfxEntry()});
+        queue.push_back(file);
+    }
+    SDL_UnlockMutex(s_bank.mutex);
+
+    if(queue.empty())
+        return;
+
+    // Single thread is enough to stay ahead of the game, and it don't compete with texture decoders
+    if(!s_bank.loader)
+        s_bank.loader.reset(new WorkerPool(1));
+
+    for(std::string &file : queue)
+        s_bank.loader->push([file]()->void
+        {
+            loadJob(file);
+        });
+}
+
+Mix_Chunk *PGE_SfxBank::get(const std::string &file)
+{
+    if(!PGE_Audio::isLoaded())
+        return nullptr;
+
+    ensureInit();
+
+    SDL_LockMutex(s_bank.mutex);
+    auto it = s_bank.entries.find(file);
+    if(it == s_bank.entries.end())
+        it = s_bank.entries.insert({file, SfxEntry()}).first;
+
+    SfxEntry &e = it->second;
+    switch(e.state)
+    {
+    case SfxState::Queued:
+        // Background thread haven't reached it yet, decode it right here
+        s_bank.stats.misses++;
+        e.state = SfxState::Loading;
+        SDL_UnlockMutex(s_bank.mutex);
+        {
+            Mix_Chunk *chunk = decodeChunk(file);
+            SDL_LockMutex(s_bank.mutex);
+            storeChunk(file, e, chunk);
+        }
+        break;
+
+    case SfxState::Loading:
+        s_bank.stats.waits++;
+        while(e.state == SfxState::Loading)
+            SDL_CondWait(s_bank.loaded, s_bank.mutex);
+        break;
+
+    case SfxState::Ready:
+        s_bank.stats.hits++;
+        s_bank.lru.splice(s_bank.lru.begin(), s_bank.lru, e.lru);
+        break;
+
+    case SfxState::Failed:
+        break;
+    }
+
+    Mix_Chunk *chunk = e.chunk;
+    trimToBudget(chunk);
+    SDL_UnlockMutex(s_bank.mutex);
+
+    return chunk;
+}
+
+void PGE_SfxBank::setBudget(size_t bytes)
+{
+    ensureInit();
+    SDL_LockMutex(s_bank.mutex);
+    s_bank.budget = bytes;
+    trimToBudget(nullptr);
+    SDL_UnlockMutex(s_bank.mutex);
+}
+
+PGE_SfxBank::Stats PGE_SfxBank::stats()
+{
+    ensureInit();
+    SDL_LockMutex(s_bank.mutex);
+    Stats st = s_bank.stats;
+    st.budget = s_bank.budget;
+    SDL_UnlockMutex(s_bank.mutex);
+    return st;
+}
+
+void PGE_SfxBank::clear()
+{
+    ensureInit();
+
+    // Drop not started jobs, and wait for the running one
+    SDL_LockMutex(s_bank.mutex);
+    for(auto it = s_bank.entries.begin(); it != s_bank.entries.end();)
+    {
+        if(it->second.state == SfxState::Queued)
+            it = s_bank.entries.erase(it);
+        else
+            ++it;
+    }
+    SDL_UnlockMutex(s_bank.mutex);
+    s_bank.loader.reset();
+
+    if(PGE_Audio::isLoaded())
+        Mix_HaltChannel(-1);
+
+    SDL_LockMutex(s_bank.mutex);
+    D_pLogDebug("SfxBank: hits %llu, misses %llu, waits %llu, evictions %llu, %u sounds in %u bytes",
+                static_cast<unsigned long long>(s_bank.stats.hits),
+                static_cast<unsigned long long>(s_bank.stats.misses),
+                static_cast<unsigned long long>(s_bank.stats.waits),
+                static_cast<unsigned long long>(s_bank.stats.evictions),
+                static_cast<unsigned>(s_bank.stats.loaded),
+                static_cast<unsigned>(s_bank.stats.bytes));
+    for(auto &it : s_bank.entries)
+    {
+        if(it.second.chunk)
+            Mix_FreeChunk(it.second.chunk);
+    }
+    s_bank.entries.clear();
+    s_bank.lru.clear();
+    s_bank.stats = Stats();
+    SDL_UnlockMutex(s_bank.mutex);
+}
@@ -0,0 +1,94 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SFX_BANK_H
+#define SFX_BANK_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+struct Mix_Chunk;
+
+/*!
+ * \brief Cache of decoded sound effects with bounded memory usage
+ *
+ * Sounds are decoded by a background thread when they are queued by preload(),
+ * so the game thread finds them ready when they will be played first time.
+ * Sounds which are requested by get() but never preloaded are decoded
+ * immediately and counted as misses. When total size of decoded sounds exceeds
+ * the budget, least recently used sounds which are not playing now are freed.
+ */
+class PGE_SfxBank
+{
+public:
+    struct Stats
+    {
+        //! Requested sounds which were already decoded
+        uint64_t hits = 0;
+        //! Requested sounds which were decoded on request
+        uint64_t misses = 0;
+        //! Requested sounds which were still decoding by background thread
+        uint64_t waits = 0;
+        //! Sounds freed to keep memory usage under the budget
+        uint64_t evictions = 0;
+        //! Count of decoded sounds
+        size_t   loaded = 0;
+        //! Memory used by decoded sounds in bytes
+        size_t   bytes = 0;
+        //! Memory budget in bytes
+        size_t   budget = 0;
+    };
+
+    /*!
+     * \brief Queue sounds to be decoded by background thread
+     * \param files Absolute paths to sound files
+     */
+    static void preload(const std::vector<std::string> &files);
+
+    /*!
+     * \brief Take decoded sound, decode it if it wasn't preloaded
+     * \param file Absolute path to sound file
+     * \return Decoded sound or nullptr if it can't be loaded.
+     *         Chunk stays valid while it's playing or until next get() call
+     */
+    static Mix_Chunk *get(const std::string &file);
+
+    /*!
+     * \brief Set maximal memory usage of decoded sounds
+     * \param bytes Memory budget in bytes
+     */
+    static void setBudget(size_t bytes);
+
+    /*!
+     * \brief Usage statistics since recent clear()
+     * \return statistics
+     */
+    static Stats stats();
+
+    /*!
+     * \brief Stop background decoding, halt all channels and free all sounds
+     */
+    static void clear();
+
+    //! Default memory budget in bytes
+    static const size_t defaultBudget = 64 * 1024 * 1024;
+};
+
+#endif // SFX_BANK_H
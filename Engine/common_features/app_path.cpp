@@ -220,6 +220,11 @@ std::string AppPathManager::screenshotsDir()
 #endif
 }
 
+std::string AppPathManager::textureCacheDir()
+{
+    return m_userPath + "/cache/textures";
+}
+
 void AppPathManager::install()
 {
     std::string path = getPgeUserDirectory();
@@ -31,6 +31,7 @@ class AppPathManager
         static std::string userAppDirSTD();
         static std::string languagesDir();
         static std::string screenshotsDir();
+        static std::string textureCacheDir();
         static void install();
         static bool isPortable();
         static bool userDirIsAvailable();
@@ -41,7 +41,7 @@
 // TEMP_MALLOC and TEMP_FREE will only be called in stack fashion - frees in the reverse order of mallocs
 // and any temp memory allocated by a function will be freed before it exits.
 // MALLOC and FREE are used only by GifBegin and GifEnd respectively (to allocate a buffer the size of the image, which
-// is used to find changed pixels for delta-encoding.)
+// is used to find changed pixels for delta-encoding), and by GifWriteFrame to keep a palette for reuse.
 // REALLOC is only used if you mix different frame sizes.
 
 #ifndef GIF_TEMP_MALLOC
@@ -69,6 +69,20 @@
 #define GIF_FREE free
 #endif
 
+// Define this macro to spread heavy per-pixel work over a thread pool.
+// It is called as GIF_PARALLEL_FOR(count, body), where body is a callable taking (size_t begin, size_t end)
+// and every item of the range must be processed exactly once; items are independent from each other.
+// By default the whole range is processed by the calling thread.
+#ifndef GIF_PARALLEL_FOR
+#define GIF_PARALLEL_FOR(count, body) (body)((size_t)0, (size_t)(count))
+#endif
+
+// A frame where fewer than 1/kGifPaletteReuseRatio of pixels were changed reuses a palette built from
+// a whole earlier frame instead of building a new one...
+const int kGifPaletteReuseRatio = 64;
+// ...as long as every changed pixel has a color within kGifPaletteReuseMaxError (sum of RGB differences) in it
+const int kGifPaletteReuseMaxError = 24;
+
 const int kGifTransIndex = 0;
 
 struct GifPalette
@@ -257,6 +271,45 @@ int GifPartitionByMedian(uint8_t* image, int com, int left, int right, int neede
     return neededCenter;
 }
 
+// Splits pixels of a tree node along the axis with the largest range,
+// returns count of pixels going into the left subtree
+int GifSplitNode(uint8_t* image, int numPixels, int firstElt, int lastElt, int splitElt, int treeNode, GifPalette* pal)
+{
+    // Find the axis with the largest range
+    int minR = 255, maxR = 0;
+    int minG = 255, maxG = 0;
+    int minB = 255, maxB = 0;
+    for(int ii=0; ii<numPixels; ++ii)
+    {
+        int r = image[ii*4+0];
+        int g = image[ii*4+1];
+        int b = image[ii*4+2];
+
+        if(r > maxR) maxR = r;
+        if(r < minR) minR = r;
+
+        if(g > maxG) maxG = g;
+        if(g < minG) minG = g;
+
+        if(b > maxB) maxB = b;
+        if(b < minB) minB = b;
+    }
+
+    int rRange = maxR - minR;
+    int gRange = maxG - minG;
+    int bRange = maxB - minB;
+
+    // and split along that axis. (incidentally, this means this isn't a "proper" k-d tree but I don't know what else to call it)
+    int splitCom = 1;
+    if(bRange > gRange) splitCom = 2;
+    if(rRange > bRange && rRange > gRange) splitCom = 0;
+
+    int subPixelsA = numPixels * (splitElt - firstElt) / (lastElt - firstElt);
+    pal->treeSplitElt[treeNode] = (uint8_t)splitCom;
+    pal->treeSplit[treeNode] = image[subPixelsA*4+splitCom];
+    return GifPartitionByMedian(image, splitCom, 0, numPixels, subPixelsA);
+}
+
 // Builds a palette by creating a balanced k-d tree of all pixels in the image
 void GifSplitPalette(uint8_t* image, int numPixels, int firstElt, int lastElt, int splitElt, int splitDist, int treeNode, bool buildForDither, GifPalette* pal)
 {
@@ -332,49 +385,114 @@ void GifSplitPalette(uint8_t* image, int numPixels, int firstElt, int lastElt, i
         return;
     }
 
-    // Find the axis with the largest range
-    int minR = 255, maxR = 0;
-    int minG = 255, maxG = 0;
-    int minB = 255, maxB = 0;
-    for(int ii=0; ii<numPixels; ++ii)
-    {
-        int r = image[ii*4+0];
-        int g = image[ii*4+1];
-        int b = image[ii*4+2];
+    int subPixelsA = GifSplitNode(image, numPixels, firstElt, lastElt, splitElt, treeNode, pal);
+    int subPixelsB = numPixels-subPixelsA;
 
-        if(r > maxR) maxR = r;
-        if(r < minR) minR = r;
+    GifSplitPalette(image,              subPixelsA, firstElt, splitElt, splitElt-splitDist, splitDist/2, treeNode*2,   buildForDither, pal);
+    GifSplitPalette(image+subPixelsA*4, subPixelsB, splitElt, lastElt,  splitElt+splitDist, splitDist/2, treeNode*2+1, buildForDither, pal);
+}
 
-        if(g > maxG) maxG = g;
-        if(g < minG) minG = g;
+// Subtree of the palette k-d tree which is built independently from others
+struct GifSplitTask
+{
+    uint8_t* image;
+    int numPixels;
+    int firstElt;
+    int lastElt;
+    int splitElt;
+    int splitDist;
+    int treeNode;
+};
 
-        if(b > maxB) maxB = b;
-        if(b < minB) minB = b;
-    }
+// Count of subtrees which are built in parallel
+const int kGifParallelSplits = 8;
 
-    int rRange = maxR - minR;
-    int gRange = maxG - minG;
-    int bRange = maxB - minB;
+// Same as GifSplitPalette, but after first splits remaining subtrees are built by GIF_PARALLEL_FOR.
+// Subtrees are covering separate pixels, tree nodes and palette entries, so they don't touch each other
+void GifSplitPaletteParallel(uint8_t* image, int numPixels, int firstElt, int lastElt, int splitElt, int splitDist, bool buildForDither, GifPalette* pal)
+{
+    GifSplitTask tasks[kGifParallelSplits];
+    int numTasks = 1;
+    tasks[0].image = image;
+    tasks[0].numPixels = numPixels;
+    tasks[0].firstElt = firstElt;
+    tasks[0].lastElt = lastElt;
+    tasks[0].splitElt = splitElt;
+    tasks[0].splitDist = splitDist;
+    tasks[0].treeNode = 1;
+
+    while(numTasks*2 <= kGifParallelSplits)
+    {
+        bool split = false;
+        // Walk backwards, so every task is moved into its own place before being replaced
+        for(int ii=numTasks-1; ii>=0; --ii)
+        {
+            GifSplitTask t = tasks[ii];
+            GifSplitTask& a = tasks[ii*2];
+            GifSplitTask& b = tasks[ii*2+1];
 
-    // and split along that axis. (incidentally, this means this isn't a "proper" k-d tree but I don't know what else to call it)
-    int splitCom = 1;
-    if(bRange > gRange) splitCom = 2;
-    if(rRange > bRange && rRange > gRange) splitCom = 0;
+            if(t.lastElt <= t.firstElt+1 || t.numPixels == 0)
+            {
+                // leaf or empty node, keep it for GifSplitPalette to finish
+                a = t;
+                b = t;
+                b.numPixels = 0;
+                continue;
+            }
 
-    int subPixelsA = numPixels * (splitElt - firstElt) / (lastElt - firstElt);
-    pal->treeSplitElt[treeNode] = (uint8_t)splitCom;
-    pal->treeSplit[treeNode] = image[subPixelsA*4+splitCom];
-    subPixelsA = GifPartitionByMedian(image, splitCom, 0, numPixels, subPixelsA);
-    int subPixelsB = numPixels-subPixelsA;
+            int subPixelsA = GifSplitNode(t.image, t.numPixels, t.firstElt, t.lastElt, t.splitElt, t.treeNode, pal);
+            split = true;
+
+            a.image = t.image;
+            a.numPixels = subPixelsA;
+            a.firstElt = t.firstElt;
+            a.lastElt = t.splitElt;
+            a.splitElt = t.splitElt-t.splitDist;
+            a.splitDist = t.splitDist/2;
+            a.treeNode = t.treeNode*2;
+
+            b.image = t.image+subPixelsA*4;
+            b.numPixels = t.numPixels-subPixelsA;
+            b.firstElt = t.splitElt;
+            b.lastElt = t.lastElt;
+            b.splitElt = t.splitElt+t.splitDist;
+            b.splitDist = t.splitDist/2;
+            b.treeNode = t.treeNode*2+1;
+        }
+        numTasks *= 2;
+        if(!split)
+            break;
+    }
 
-    GifSplitPalette(image,              subPixelsA, firstElt, splitElt, splitElt-splitDist, splitDist/2, treeNode*2,   buildForDither, pal);
-    GifSplitPalette(image+subPixelsA*4, subPixelsB, splitElt, lastElt,  splitElt+splitDist, splitDist/2, treeNode*2+1, buildForDither, pal);
+    GIF_PARALLEL_FOR(numTasks, [&](size_t begin, size_t end)
+    {
+        for(size_t ii=begin; ii<end; ++ii)
+        {
+            const GifSplitTask& t = tasks[ii];
+            GifSplitPalette(t.image, t.numPixels, t.firstElt, t.lastElt, t.splitElt, t.splitDist, t.treeNode, buildForDither, pal);
+        }
+    });
 }
 
 // Finds all pixels that have changed from the previous image and
 // moves them to the front of the buffer.
 // This allows us to build a palette optimized for the colors of the
 // changed pixels only.
+int GifCountChangedPixels( const uint8_t* lastFrame, const uint8_t* frame, int numPixels )
+{
+    int numChanged = 0;
+    for (int ii=0; ii<numPixels; ++ii)
+    {
+        if(lastFrame[0] != frame[0] ||
+           lastFrame[1] != frame[1] ||
+           lastFrame[2] != frame[2])
+            ++numChanged;
+        lastFrame += 4;
+        frame += 4;
+    }
+    return numChanged;
+}
+
 int GifPickChangedPixels( const uint8_t* lastFrame, uint8_t* frame, int numPixels )
 {
     int numChanged = 0;
@@ -399,6 +517,27 @@ int GifPickChangedPixels( const uint8_t* lastFrame, uint8_t* frame, int numPixel
     return numChanged;
 }
 
+// Checks that every pixel changed since the previous frame has a close enough color in the palette
+bool GifPaletteFitsChanges( GifPalette* pPal, const uint8_t* lastFrame, const uint8_t* frame, int numPixels )
+{
+    for (int ii=0; ii<numPixels; ++ii)
+    {
+        if(lastFrame[0] != frame[0] ||
+           lastFrame[1] != frame[1] ||
+           lastFrame[2] != frame[2])
+        {
+            int bestDiff = 1000000;
+            int bestInd = kGifTransIndex;
+            GifGetClosestPaletteColor(pPal, frame[0], frame[1], frame[2], bestInd, bestDiff);
+            if(bestDiff > kGifPaletteReuseMaxError)
+                return false;
+        }
+        lastFrame += 4;
+        frame += 4;
+    }
+    return true;
+}
+
 // Creates a palette by placing all the image pixels in a k-d tree and then averaging the blocks at the bottom.
 // This is known as the "modified median split" technique
 void GifMakePalette( const uint8_t* lastFrame, const uint8_t* nextFrame, uint32_t width, uint32_t height, int bitDepth, bool buildForDither, GifPalette* pPal )
@@ -419,7 +558,7 @@ void GifMakePalette( const uint8_t* lastFrame, const uint8_t* nextFrame, uint32_
     const int splitElt = lastElt/2;
     const int splitDist = splitElt/2;
 
-    GifSplitPalette(destroyableImage, numPixels, 1, lastElt, splitElt, splitDist, 1, buildForDither, pPal);
+    GifSplitPaletteParallel(destroyableImage, numPixels, 1, lastElt, splitElt, splitDist, buildForDither, pPal);
 
     GIF_TEMP_FREE(destroyableImage);
 
@@ -539,10 +678,15 @@ void GifDitherImage( const uint8_t* lastFrame, const uint8_t* nextFrame, uint8_t
     GIF_TEMP_FREE(quantPixels);
 }
 
-// Picks palette colors for the image using simple thresholding, no dithering
-void GifThresholdImage( const uint8_t* lastFrame, const uint8_t* nextFrame, uint8_t* outFrame, uint32_t width, uint32_t height, GifPalette* pPal )
+// Picks palette colors for the rows of the image using simple thresholding, no dithering
+void GifThresholdRows( const uint8_t* lastFrame, const uint8_t* nextFrame, uint8_t* outFrame, uint32_t width, uint32_t firstRow, uint32_t endRow, GifPalette* pPal )
 {
-    uint32_t numPixels = width*height;
+    size_t offset = (size_t)firstRow * width * 4;
+    if(lastFrame) lastFrame += offset;
+    nextFrame += offset;
+    outFrame += offset;
+
+    uint32_t numPixels = (endRow - firstRow) * width;
     for( uint32_t ii=0; ii<numPixels; ++ii )
     {
         // if a previous color is available, and it matches the current color,
@@ -577,6 +721,16 @@ void GifThresholdImage( const uint8_t* lastFrame, const uint8_t* nextFrame, uint
     }
 }
 
+// Picks palette colors for the image using simple thresholding, no dithering.
+// Every pixel depends on itself only, so rows are spread by GIF_PARALLEL_FOR
+void GifThresholdImage( const uint8_t* lastFrame, const uint8_t* nextFrame, uint8_t* outFrame, uint32_t width, uint32_t height, GifPalette* pPal )
+{
+    GIF_PARALLEL_FOR(height, [&](size_t begin, size_t end)
+    {
+        GifThresholdRows(lastFrame, nextFrame, outFrame, width, (uint32_t)begin, (uint32_t)end, pPal);
+    });
+}
+
 // Compare an already paletted frame to the previous one.
 // nextFrame8 is 8-bit, lastFrame and outFrame are 32-bit.
 void GifDeltaImage( const uint8_t* lastFrame, const uint8_t* nextFrame8, uint8_t* outFrame, uint32_t width, uint32_t height, bool deltaCoded, const GifPalette* pPal )
@@ -627,52 +781,37 @@ void GifDeltaImage( const uint8_t* lastFrame, const uint8_t* nextFrame8, uint8_t
     }
 }
 
-// Simple structure to write out the LZW-compressed portion of the image
-// one bit at a time
+// Simple structure to write out the LZW-compressed portion of the image.
+// Codes are packed into a word and moved out by whole bytes
 struct GifBitStatus
 {
-    uint8_t bitIndex;  // how many bits in the partial byte written so far
-    uint8_t byte;      // current partial byte
+    uint32_t bits;      // pending bits, the lowest ones go first
+    uint32_t bitCount;  // how many bits are pending
 
     uint32_t chunkIndex;
     uint8_t chunk[256];   // bytes are written in here until we have 256 of them, then written to the file
 };
 
-// insert a single bit
-void GifWriteBit( GifBitStatus& stat, uint32_t bit )
-{
-    bit = bit & 1;
-    bit = bit << stat.bitIndex;
-    stat.byte |= bit;
-
-    ++stat.bitIndex;
-    if( stat.bitIndex > 7 )
-    {
-        // move the newly-finished byte to the chunk buffer
-        stat.chunk[stat.chunkIndex++] = stat.byte;
-        // and start a new byte
-        stat.bitIndex = 0;
-        stat.byte = 0;
-    }
-}
-
 // write all bytes so far to the file
 void GifWriteChunk( FILE* f, GifBitStatus& stat )
 {
     fputc((int)stat.chunkIndex, f);
     fwrite(stat.chunk, 1, stat.chunkIndex, f);
 
-    stat.bitIndex = 0;
-    stat.byte = 0;
     stat.chunkIndex = 0;
 }
 
 void GifWriteCode( FILE* f, GifBitStatus& stat, uint32_t code, uint32_t length )
 {
-    for( uint32_t ii=0; ii<length; ++ii )
+    // codes are 12 bits at most and less than a byte is pending, so everything fits into the word
+    stat.bits |= (code & ((1u << length) - 1)) << stat.bitCount;
+    stat.bitCount += length;
+
+    while( stat.bitCount >= 8 )
     {
-        GifWriteBit(stat, code);
-        code = code >> 1;
+        stat.chunk[stat.chunkIndex++] = (uint8_t)(stat.bits & 0xff);
+        stat.bits >>= 8;
+        stat.bitCount -= 8;
 
         if( stat.chunkIndex == 255 )
         {
@@ -681,6 +820,17 @@ void GifWriteCode( FILE* f, GifBitStatus& stat, uint32_t code, uint32_t length )
     }
 }
 
+// pad the partial byte with zero bits and move it into the chunk
+void GifFlushBits( GifBitStatus& stat )
+{
+    if( stat.bitCount )
+    {
+        stat.chunk[stat.chunkIndex++] = (uint8_t)(stat.bits & 0xff);
+        stat.bits = 0;
+        stat.bitCount = 0;
+    }
+}
+
 // The LZW dictionary is a 256-ary tree constructed as the file is encoded,
 // this is one node
 struct GifLzwNode
@@ -760,8 +910,8 @@ void GifWriteLzwImage(FILE* f, uint8_t* image, uint32_t left, uint32_t top,  uin
     uint32_t maxCode = clearCode+1;
 
     GifBitStatus stat;
-    stat.byte = 0;
-    stat.bitIndex = 0;
+    stat.bits = 0;
+    stat.bitCount = 0;
     stat.chunkIndex = 0;
 
     GifWriteCode(f, stat, clearCode, codeSize);  // start with a fresh LZW dictionary
@@ -821,7 +971,7 @@ void GifWriteLzwImage(FILE* f, uint8_t* image, uint32_t left, uint32_t top,  uin
     GifWriteCode( f, stat, clearCode+1, (uint32_t)minCodeSize + 1 );
 
     // write out the last partial chunk
-    while( stat.bitIndex ) GifWriteBit(stat, 0);
+    GifFlushBits(stat);
     if( stat.chunkIndex ) GifWriteChunk(f, stat);
 
     fputc(0, f); // image block terminator
@@ -841,6 +991,8 @@ struct GifWriter
     int currentWidth;
     int currentHeight;
     bool sizeChanged;
+    GifPalette* lastPal;  // palette built from a whole frame given to GifWriteFrame(), NULL if none yet
+    bool lastPalValid;    // lastPal may be reused, no frames with many changes were written since it was built
 };
 
 // Handle a call to GifWriteFrame[8] with a different image size to the previous
@@ -874,6 +1026,8 @@ bool GifBegin( GifWriter* writer, FILE *file, uint32_t width, uint32_t height, u
 
     // allocate
     writer->oldImage = (uint8_t*)GIF_MALLOC(width*height*4);
+    writer->lastPal = NULL;
+    writer->lastPalValid = false;
 
     fputs("GIF89a", writer->f);
 
@@ -950,10 +1104,41 @@ bool GifWriteFrame( GifWriter* writer, const uint8_t* image, uint32_t width, uin
         oldImage = NULL;
     writer->firstFrame = false;
 
+    // When frame barely changed, a palette of an earlier whole frame still fits it well.
+    // A palette built from changed pixels only can't be reused: colors of other pixels are missing in it
+    bool barelyChanged = false;
+    int numPixels = (int)(width * height);
+    if(!dither && oldImage)
+        barelyChanged = GifCountChangedPixels(oldImage, image, numPixels) < numPixels / kGifPaletteReuseRatio;
+    if(!barelyChanged)
+        writer->lastPalValid = false;
+
+    bool reusePalette = false;
+    if(barelyChanged)
+    {
+        if(!writer->lastPalValid || writer->lastPal->bitDepth != bitDepth)
+        {
+            // Build it once from the whole frame, then following barely changed frames will reuse it
+            if(!writer->lastPal)
+                writer->lastPal = (GifPalette*)GIF_MALLOC(sizeof(GifPalette));
+            // entries of empty tree leaves are never written by GifMakePalette
+            memset(writer->lastPal, 0, sizeof(GifPalette));
+            memset(writer->lastPal->treeSplitElt, 3, 256);
+            GifMakePalette(NULL, image, width, height, bitDepth, false, writer->lastPal);
+            writer->lastPalValid = true;
+        }
+        reusePalette = GifPaletteFitsChanges(writer->lastPal, oldImage, image, numPixels);
+    }
+
     GifPalette pal;
-    // mark all nodes unused
-    memset(pal.treeSplitElt, 3, 256);
-    GifMakePalette((dither? NULL : oldImage), image, width, height, bitDepth, dither, &pal);
+    if(reusePalette)
+        memcpy(&pal, writer->lastPal, sizeof(GifPalette));
+    else
+    {
+        // mark all nodes unused
+        memset(pal.treeSplitElt, 3, 256);
+        GifMakePalette((dither? NULL : oldImage), image, width, height, bitDepth, dither, &pal);
+    }
 
     if(dither)
         GifDitherImage(oldImage, image, writer->oldImage, width, height, &pal);
@@ -1014,10 +1199,13 @@ bool GifEnd( GifWriter* writer )
     fclose(writer->f);
     GIF_FREE(writer->oldImage);
     GIF_FREE(writer->globalPal);
+    GIF_FREE(writer->lastPal);
 
     writer->f = NULL;
     writer->oldImage = NULL;
     writer->globalPal = NULL;
+    writer->lastPal = NULL;
+    writer->lastPalValid = false;
 
     return true;
 }
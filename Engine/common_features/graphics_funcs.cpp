@@ -16,6 +16,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <Utils/files.h>
+#include <Utils/bitmask.h>
 #include <FileMapper/file_mapper.h>
 
 #include "graphics_funcs.h"
@@ -167,23 +168,10 @@ void GraphicsHelps::getMaskFromRGBA(FIBITMAP *&image, FIBITMAP *&mask)
                                FreeImage_GetGreenMask(image),
                                FreeImage_GetBlueMask(image));
 
-    RGBQUAD Fpix;
-    RGBQUAD Npix = {0x0, 0x0, 0x0, 0xFF};
-
     for(unsigned int y = 0; (y < img_h); y++)
-    {
-        for(unsigned int x = 0; (x < img_w); x++)
-        {
-            FreeImage_GetPixelColor(image, x, y, &Fpix);
-
-            uint8_t grey = (255 - Fpix.rgbReserved);
-            Npix.rgbRed  = grey;
-            Npix.rgbGreen = grey;
-            Npix.rgbBlue = grey;
-            Npix.rgbReserved = 0xFF;
-            FreeImage_SetPixelColor(mask,  x, y, &Npix);
-        }
-    }
+        BitMask::maskFromAlpha(FreeImage_GetScanLine(image, static_cast<int>(y)),
+                               FreeImage_GetScanLine(mask, static_cast<int>(y)),
+                               img_w);
 }
 
 SDL_Surface *GraphicsHelps::fi2sdl(FIBITMAP *img)
@@ -219,43 +207,12 @@ void GraphicsHelps::mergeWithMask(FIBITMAP *image, std::string pathToMask, std::
     unsigned int img_h = FreeImage_GetHeight(image);
     unsigned int mask_w = FreeImage_GetWidth(mask);
     unsigned int mask_h = FreeImage_GetHeight(mask);
-    BYTE *img_bits  = FreeImage_GetBits(image);
-    BYTE *mask_bits = FreeImage_GetBits(mask);
-    BYTE *FPixP = img_bits;
-    BYTE *SPixP = mask_bits;
-    RGBQUAD Npix = {0x00, 0x00, 0x00, 0xFF};   //Destination pixel color
-    unsigned short newAlpha = 0xFF; //Calculated destination alpha-value
+    unsigned int w = (img_w < mask_w) ? img_w : mask_w;
 
     for(unsigned int y = 0; (y < img_h) && (y < mask_h); y++)
-    {
-        for(unsigned int x = 0; (x < img_w) && (x < mask_w); x++)
-        {
-            Npix.rgbBlue = ((SPixP[FI_RGBA_BLUE] & 0x7F) | FPixP[FI_RGBA_BLUE]);
-            Npix.rgbGreen = ((SPixP[FI_RGBA_GREEN] & 0x7F) | FPixP[FI_RGBA_GREEN]);
-            Npix.rgbRed = ((SPixP[FI_RGBA_RED] & 0x7F) | FPixP[FI_RGBA_RED]);
-            newAlpha = 255 - ((static_cast<unsigned short>(SPixP[FI_RGBA_RED]) +
-                               static_cast<unsigned short>(SPixP[FI_RGBA_GREEN]) +
-                               static_cast<unsigned short>(SPixP[FI_RGBA_BLUE])) / 3);
-
-            if((SPixP[FI_RGBA_RED] > 240u) //is almost White
-               && (SPixP[FI_RGBA_GREEN] > 240u)
-               && (SPixP[FI_RGBA_BLUE] > 240u))
-                newAlpha = 0;
-
-            newAlpha += ((static_cast<unsigned short>(FPixP[FI_RGBA_RED]) +
-                          static_cast<unsigned short>(FPixP[FI_RGBA_GREEN]) +
-                          static_cast<unsigned short>(FPixP[FI_RGBA_BLUE])) / 3);
-
-            if(newAlpha > 255) newAlpha = 255;
-
-            FPixP[FI_RGBA_BLUE]  = Npix.rgbBlue;
-            FPixP[FI_RGBA_GREEN] = Npix.rgbGreen;
-            FPixP[FI_RGBA_RED]   = Npix.rgbRed;
-            FPixP[FI_RGBA_ALPHA] = static_cast<BYTE>(newAlpha);
-            FPixP += 4;
-            SPixP += 4;
-        }
-    }
+        BitMask::mergeWithMask(FreeImage_GetScanLine(image, static_cast<int>(y)),
+                               FreeImage_GetScanLine(mask, static_cast<int>(y)),
+                               w);
 
     FreeImage_Unload(mask);
 }
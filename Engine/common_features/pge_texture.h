@@ -42,6 +42,18 @@ struct PGE_Texture
 
     PGEColor ColorUpper;
     PGEColor ColorLower;
+
+    /* Texture atlas support: texture handle may be a shared atlas page,
+       in this case, UV-coordinates are pointing to the image on that page */
+    bool atlas_member = false; //Texture handle is owned by atlas and must not be deleted directly
+    GLfloat uv_left = 0.0f;    //Sub-rectangle of the image on the texture (between 0.0f and 1.0f)
+    GLfloat uv_top = 0.0f;
+    GLfloat uv_right = 1.0f;
+    GLfloat uv_bottom = 1.0f;
+    int atlas_x = 0;           //Position of the image on the atlas page in pixels
+    int atlas_y = 0;
+    int atlas_w = 0;           //Size of the atlas page in pixels
+    int atlas_h = 0;
 };
 
 
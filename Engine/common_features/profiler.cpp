@@ -0,0 +1,141 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "profiler.h"
+#include "app_path.h"
+#include "logger.h"
+#include "fmt_format_ne.h"
+
+#include <DirManager/dirman.h>
+#include <Utils/files.h>
+#include <fmt/fmt_time.h>
+
+#include <SDL2/SDL_thread.h>
+
+#include <chrono>
+#include <ctime>
+#include <vector>
+
+struct ProfileZoneEntry
+{
+    const char *name = nullptr;
+    int64_t     begin = 0;
+    int64_t     end = 0;
+    unsigned long thread = 0;
+};
+
+std::atomic<bool> PGE_Profiler::m_enabled(false);
+
+//! Ring buffer of zones, allocated on first start
+static std::vector<ProfileZoneEntry> g_zones;
+//! Count of zones written since start, position in ring is taken by modulo
+static std::atomic<uint64_t> g_zonesWritten(0);
+//! Time of capture start, zones are exported relative to it
+static int64_t g_captureBegin = 0;
+
+void PGE_Profiler::start()
+{
+    if(g_zones.empty())
+        g_zones.resize(bufferSize);
+    g_zonesWritten.store(0);
+    g_captureBegin = now();
+    m_enabled.store(true);
+}
+
+void PGE_Profiler::stop()
+{
+    m_enabled.store(false);
+}
+
+void PGE_Profiler::toggle()
+{
+    if(!isEnabled())
+    {
+        start();
+        pLogInfo("Profiler: capturing of zones has been started");
+        return;
+    }
+
+    stop();
+
+    std::string dir = AppPathManager::screenshotsDir() + "/";
+    if(!DirMan::exists(dir))
+        DirMan::mkAbsDir(dir);
+
+    std::time_t in_time_t = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    std::tm t = fmt::localtime(in_time_t);
+    std::string saveTo = fmt::sprintf_ne("%sTrace_%04d-%02d-%02d_%02d-%02d-%02d.json",
+                                         dir,
+                                         (1900 + t.tm_year), (1 + t.tm_mon), t.tm_mday,
+                                         t.tm_hour, t.tm_min, t.tm_sec);
+    exportTrace(saveTo);
+}
+
+bool PGE_Profiler::exportTrace(const std::string &path)
+{
+    FILE *f = Files::utf8_fopen(path.c_str(), "wb");
+    if(!f)
+    {
+        pLogWarning("Profiler: Can't open %s for writing", path.c_str());
+        return false;
+    }
+
+    uint64_t written = g_zonesWritten.load();
+    uint64_t first = (written > bufferSize) ? written - bufferSize : 0;
+
+    std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool comma = false;
+    for(uint64_t i = first; i < written; i++)
+    {
+        const ProfileZoneEntry &z = g_zones[static_cast<size_t>(i % bufferSize)];
+        if(!z.name)
+            continue;
+        // Chrome trace takes microseconds, fraction keeps nanoseconds
+        std::fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f}",
+                     comma ? ",\n" : "",
+                     z.name,
+                     z.thread,
+                     static_cast<double>(z.begin - g_captureBegin) / 1000.0,
+                     static_cast<double>(z.end - z.begin) / 1000.0);
+        comma = true;
+    }
+    std::fprintf(f, "\n]}\n");
+    std::fclose(f);
+
+    pLogInfo("Profiler: %llu zones are written into %s",
+             static_cast<unsigned long long>(written - first), path.c_str());
+    return true;
+}
+
+int64_t PGE_Profiler::now()
+{
+    using std::chrono::nanoseconds;
+    using std::chrono::duration_cast;
+    return duration_cast<nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void PGE_Profiler::addZone(const char *name, int64_t beginNs, int64_t endNs)
+{
+    uint64_t slot = g_zonesWritten.fetch_add(1, std::memory_order_relaxed);
+    ProfileZoneEntry &z = g_zones[static_cast<size_t>(slot % bufferSize)];
+    z.name = name;
+    z.begin = beginNs;
+    z.end = endNs;
+    z.thread = SDL_ThreadID();
+}
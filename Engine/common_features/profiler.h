@@ -0,0 +1,124 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PGE_PROFILER_H
+#define PGE_PROFILER_H
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+
+/*!
+ * \brief Collects timed zones of the frame into a ring buffer and exports them as Chrome trace
+ *
+ * Export result can be opened by chrome://tracing or by https://ui.perfetto.dev.
+ * When profiler is not capturing, every zone costs a single flag check.
+ * Build with PGE_NO_PROFILER to remove zones completely.
+ */
+class PGE_Profiler
+{
+public:
+    //! Count of zones kept in the ring buffer, older zones are overwritten
+    static const size_t bufferSize = 1 << 16;
+
+    /*!
+     * \brief Is zones are captured right now
+     * \return true if profiler is capturing
+     */
+    static inline bool isEnabled()
+    {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Clear buffer and start capturing of zones
+     */
+    static void start();
+    /*!
+     * \brief Stop capturing of zones, captured zones are kept until next start
+     */
+    static void stop();
+    /*!
+     * \brief Start capturing, or stop it and export captured zones into screenshots directory
+     *
+     * Used by hot key.
+     */
+    static void toggle();
+
+    /*!
+     * \brief Write captured zones as Chrome trace JSON
+     * \param path Path to the target file
+     * \return true on success
+     *
+     * Must not be called while worker threads are running zones.
+     */
+    static bool exportTrace(const std::string &path);
+
+    /*!
+     * \brief Current time in nanoseconds
+     * \return Monotonic time in nanoseconds
+     */
+    static int64_t now();
+    /*!
+     * \brief Put finished zone into the ring buffer
+     * \param name Name of the zone, must be a string literal
+     * \param beginNs Time of zone begin
+     * \param endNs Time of zone end
+     */
+    static void addZone(const char *name, int64_t beginNs, int64_t endNs);
+
+private:
+    static std::atomic<bool> m_enabled;
+};
+
+/*!
+ * \brief Measures time of the scope and puts it into the profiler
+ */
+class PGE_ProfileZone
+{
+    //! Name of the zone, or null when profiler wasn't capturing on begin
+    const char *m_name;
+    int64_t     m_begin;
+public:
+    explicit PGE_ProfileZone(const char *name) :
+        m_name(PGE_Profiler::isEnabled() ? name : nullptr),
+        m_begin(m_name ? PGE_Profiler::now() : 0)
+    {}
+
+    ~PGE_ProfileZone()
+    {
+        if(m_name)
+            PGE_Profiler::addZone(m_name, m_begin, PGE_Profiler::now());
+    }
+
+    PGE_ProfileZone(const PGE_ProfileZone &) = delete;
+    PGE_ProfileZone &operator=(const PGE_ProfileZone &) = delete;
+};
+
+#define PGE_PROFILE_JOIN_(a, b) a##b
+#define PGE_PROFILE_JOIN(a, b) PGE_PROFILE_JOIN_(a, b)
+
+#ifndef PGE_NO_PROFILER
+//! Measure time from this line until end of the scope
+#define PGE_PROFILE_ZONE(name) PGE_ProfileZone PGE_PROFILE_JOIN(pge_profile_zone_, __LINE__)(name)
+#else
+#define PGE_PROFILE_ZONE(name)
+#endif
+
+#endif // PGE_PROFILER_H
@@ -0,0 +1,164 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "worker_pool.h"
+#include "logger.h"
+
+#include <SDL2/SDL_thread.h>
+#include <SDL2/SDL_mutex.h>
+#include <SDL2/SDL_cpuinfo.h>
+
+#include <algorithm>
+
+WorkerPool::WorkerPool(int threads)
+{
+    #ifndef PGE_NO_THREADING
+    if(threads <= 0)
+        threads = SDL_GetCPUCount();
+    if(threads <= 0)
+        threads = 1;
+
+    m_mutex = SDL_CreateMutex();
+    m_wakeUp = SDL_CreateCond();
+    m_done = SDL_CreateCond();
+
+    for(int i = 0; i < threads; i++)
+    {
+        SDL_Thread *t = SDL_CreateThread(&WorkerPool::worker, "WorkerPool", this);
+        if(!t)
+        {
+            pLogWarning("WorkerPool: Failed to start worker thread: %s", SDL_GetError());
+            break;
+        }
+        m_threads.push_back(t);
+    }
+    #else
+    (void)threads;
+    #endif
+}
+
+WorkerPool::~WorkerPool()
+{
+    #ifndef PGE_NO_THREADING
+    wait();
+
+    SDL_LockMutex(m_mutex);
+    m_quit = true;
+    SDL_CondBroadcast(m_wakeUp);
+    SDL_UnlockMutex(m_mutex);
+
+    for(SDL_Thread *t : m_threads)
+        SDL_WaitThread(t, NULL);
+    m_threads.clear();
+
+    SDL_DestroyCond(m_done);
+    SDL_DestroyCond(m_wakeUp);
+    SDL_DestroyMutex(m_mutex);
+    #endif
+}
+
+void WorkerPool::push(Job job)
+{
+    if(m_threads.empty())
+    {
+        // No workers are available, do the job here
+        job();
+        return;
+    }
+
+    SDL_LockMutex(m_mutex);
+    m_jobs.push_back(std::move(job));
+    m_pending++;
+    SDL_CondSignal(m_wakeUp);
+    SDL_UnlockMutex(m_mutex);
+}
+
+bool WorkerPool::wait(int timeoutMs)
+{
+    if(m_threads.empty())
+        return true;
+
+    bool finished = true;
+    SDL_LockMutex(m_mutex);
+    while(m_pending > 0)
+    {
+        if(timeoutMs < 0)
+            SDL_CondWait(m_done, m_mutex);
+        else if(SDL_CondWaitTimeout(m_done, m_mutex, static_cast<Uint32>(timeoutMs)) == SDL_MUTEX_TIMEDOUT)
+        {
+            finished = (m_pending == 0);
+            break;
+        }
+    }
+    SDL_UnlockMutex(m_mutex);
+    return finished;
+}
+
+void WorkerPool::parallelFor(size_t count, size_t minChunk, const std::function<void (size_t, size_t)> &body)
+{
+    if(minChunk == 0)
+        minChunk = 1;
+
+    if(m_threads.empty() || (count <= minChunk))
+    {
+        if(count > 0)
+            body(0, count);
+        return;
+    }
+
+    size_t workers = m_threads.size();
+    size_t chunk = std::max(minChunk, (count + workers - 1) / workers);
+    for(size_t begin = 0; begin < count; begin += chunk)
+    {
+        size_t end = std::min(count, begin + chunk);
+        push([&body, begin, end]()->void
+        {
+            body(begin, end);
+        });
+    }
+    wait();
+}
+
+int WorkerPool::worker(void *self)
+{
+    WorkerPool *pool = reinterpret_cast<WorkerPool *>(self);
+
+    SDL_LockMutex(pool->m_mutex);
+    while(true)
+    {
+        while(pool->m_jobs.empty() && !pool->m_quit)
+            SDL_CondWait(pool->m_wakeUp, pool->m_mutex);
+
+        if(pool->m_jobs.empty() && pool->m_quit)
+            break;
+
+        Job job = std::move(pool->m_jobs.front());
+        pool->m_jobs.pop_front();
+        SDL_UnlockMutex(pool->m_mutex);
+
+        job();
+
+        SDL_LockMutex(pool->m_mutex);
+        pool->m_pending--;
+        if(pool->m_pending == 0)
+            SDL_CondBroadcast(pool->m_done);
+    }
+    SDL_UnlockMutex(pool->m_mutex);
+
+    return 0;
+}
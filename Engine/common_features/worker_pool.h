@@ -0,0 +1,102 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <functional>
+#include <deque>
+#include <vector>
+#include <cstddef>
+
+struct SDL_Thread;
+struct SDL_mutex;
+struct SDL_cond;
+
+/*!
+ * \brief Fixed set of worker threads which are processing queued jobs
+ *
+ * Jobs must not touch rendering context, it belongs to the main thread.
+ * When engine is built with PGE_NO_THREADING, jobs are executed immediately
+ * in the calling thread.
+ */
+class WorkerPool
+{
+public:
+    typedef std::function<void()> Job;
+
+    /*!
+     * \brief Starts worker threads
+     * \param threads Count of threads. When 0, count of CPU cores will be used
+     */
+    explicit WorkerPool(int threads = 0);
+    /*!
+     * \brief Waits until all queued jobs are done and stops worker threads
+     */
+    ~WorkerPool();
+
+    /*!
+     * \brief Add job into the queue
+     * \param job Function to execute by one of workers
+     */
+    void push(Job job);
+
+    /*!
+     * \brief Wait until all queued jobs are done
+     * \param timeoutMs Time to wait in milliseconds. When negative, wait forever
+     * \return true if all jobs are done, false on timeout
+     */
+    bool wait(int timeoutMs = -1);
+
+    /*!
+     * \brief Split range into chunks, process them by workers and wait until all of them are done
+     * \param count Count of items in the range
+     * \param minChunk Minimal count of items per job, smaller ranges are processed in the calling thread
+     * \param body Function which processes items from begin to end (excluding)
+     *
+     * Waits for all queued jobs, don't use it with pool shared with other long tasks.
+     */
+    void parallelFor(size_t count, size_t minChunk, const std::function<void(size_t, size_t)> &body);
+
+    /*!
+     * \brief Count of worker threads
+     * \return count of threads
+     */
+    int threadsCount() const
+    {
+        return static_cast<int>(m_threads.size());
+    }
+
+private:
+    static int worker(void *self);
+
+    //! Queued jobs
+    std::deque<Job> m_jobs;
+    //! Count of queued and running jobs
+    int         m_pending = 0;
+    //! Workers are must quit
+    bool        m_quit = false;
+    SDL_mutex  *m_mutex = nullptr;
+    //! Signals workers about new job or quit
+    SDL_cond   *m_wakeUp = nullptr;
+    //! Signals waiters that all jobs are done
+    SDL_cond   *m_done = nullptr;
+    std::vector<SDL_Thread *> m_threads;
+};
+
+#endif // WORKER_POOL_H
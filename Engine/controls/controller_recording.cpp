@@ -0,0 +1,47 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "controller_recording.h"
+#include <common_features/logger.h>
+
+RecordingController::RecordingController(Controller *source, std::shared_ptr<InputTrack> track, int player, std::string savePath) :
+    Controller(),
+    m_source(source),
+    m_track(track),
+    m_player(player),
+    m_frame(0),
+    m_savePath(savePath)
+{}
+
+RecordingController::~RecordingController()
+{
+    if(m_track.use_count() == 1)
+    {
+        if(m_track->save(m_savePath))
+            pLogDebug("Input of %u steps is recorded into %s",
+                      static_cast<unsigned>(m_track->frames()), m_savePath.c_str());
+    }
+}
+
+void RecordingController::update()
+{
+    m_source->update();
+    keys = m_source->keys;
+    m_track->setKeys(m_frame, m_player, keys);
+    m_frame++;
+}
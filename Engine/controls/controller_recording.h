@@ -0,0 +1,63 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONTROLLER_RECORDING_H
+#define CONTROLLER_RECORDING_H
+
+#include "controller.h"
+#include "input_track.h"
+#include <memory>
+#include <string>
+
+/*!
+ * \brief A controller which passes key states of another controller and records them
+ *        into the input track, one step of the track per loop step.
+ *
+ * Controllers of all players are sharing one track, the last destroyed controller saves it.
+ */
+class RecordingController : public Controller
+{
+public:
+    /*!
+     * \brief Constructor
+     * \param source Controller of physical device, will be owned by this controller
+     * \param track Input track to record into
+     * \param player Number of player in the track from zero
+     * \param savePath Path to the file where track will be saved
+     */
+    RecordingController(Controller *source, std::shared_ptr<InputTrack> track, int player, std::string savePath);
+
+    /*!
+     * \brief Destructor
+     */
+    ~RecordingController();
+
+    /*!
+     * \brief Read key states of the source controller and record them
+     */
+    void update();
+
+private:
+    std::unique_ptr<Controller> m_source;
+    std::shared_ptr<InputTrack> m_track;
+    int         m_player;
+    size_t      m_frame;
+    std::string m_savePath;
+};
+
+#endif // CONTROLLER_RECORDING_H
@@ -0,0 +1,35 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "controller_replay.h"
+
+ReplayController::ReplayController(std::shared_ptr<InputTrack> track, int player) :
+    Controller(),
+    m_track(track),
+    m_player(player),
+    m_frame(0)
+{}
+
+ReplayController::~ReplayController()
+{}
+
+void ReplayController::update()
+{
+    keys = m_track->keys(m_frame, m_player);
+    m_frame++;
+}
@@ -0,0 +1,68 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONTROLLER_REPLAY_H
+#define CONTROLLER_REPLAY_H
+
+#include "controller.h"
+#include "input_track.h"
+#include <memory>
+
+/*!
+ * \brief A controller which takes key states of the player from a recorded input track
+ *        instead of a physical device, one step of the track per loop step
+ */
+class ReplayController : public Controller
+{
+public:
+    /*!
+     * \brief Constructor
+     * \param track Recorded input track
+     * \param player Number of player in the track from zero
+     */
+    ReplayController(std::shared_ptr<InputTrack> track, int player);
+
+    /*!
+     * \brief Destructor
+     */
+    ~ReplayController();
+
+    /*!
+     * \brief Take key states of the next loop step
+     */
+    void update();
+
+    //! Count of taken loop steps
+    inline size_t frame() const
+    {
+        return m_frame;
+    }
+
+    //! Is the whole track played
+    inline bool finished() const
+    {
+        return m_frame >= m_track->frames();
+    }
+
+private:
+    std::shared_ptr<InputTrack> m_track;
+    int     m_player;
+    size_t  m_frame;
+};
+
+#endif // CONTROLLER_REPLAY_H
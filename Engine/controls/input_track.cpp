@@ -0,0 +1,233 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "input_track.h"
+#include "controller.h"
+
+#include <Utils/files.h>
+#include <common_features/logger.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+static const char *g_inputTrackMagic = "PGE-INPUT 1";
+
+InputTrack::InputTrack() :
+    seed(0),
+    hasSeed(false),
+    m_players(1)
+{}
+
+bool InputTrack::load(const std::string &path)
+{
+    FILE *f = Files::utf8_fopen(path.c_str(), "rb");
+    if(!f)
+    {
+        pLogWarning("InputTrack: Can't open file %s", path.c_str());
+        return false;
+    }
+
+    reset(1);
+    char line[1024];
+    bool magicFound = false;
+    size_t lineNum = 0;
+    bool ok = true;
+
+    while(std::fgets(line, sizeof(line), f))
+    {
+        lineNum++;
+        size_t len = std::strlen(line);
+        while(len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+            line[--len] = '\0';
+
+        if(!magicFound)
+        {
+            if(std::strcmp(line, g_inputTrackMagic) != 0)
+            {
+                pLogWarning("InputTrack: %s is not an input track file", path.c_str());
+                ok = false;
+                break;
+            }
+            magicFound = true;
+            continue;
+        }
+
+        if((len == 0) || (line[0] == '#'))
+            continue;
+
+        char *eq = std::strchr(line, '=');
+        if(eq)
+        {
+            *eq = '\0';
+            if(std::strcmp(line, "players") == 0)
+            {
+                int players = std::atoi(eq + 1);
+                if((players < 1) || (players > 4) || !m_keys.empty())
+                {
+                    pLogWarning("InputTrack: Invalid count of players at line %u", static_cast<unsigned>(lineNum));
+                    ok = false;
+                    break;
+                }
+                m_players = players;
+            }
+            else if(std::strcmp(line, "seed") == 0)
+            {
+                seed = std::strtoull(eq + 1, nullptr, 10);
+                hasSeed = true;
+            }
+            continue;
+        }
+
+        char *cur = line;
+        char *end = nullptr;
+        unsigned long count = std::strtoul(cur, &end, 10);
+        if(end == cur)
+        {
+            pLogWarning("InputTrack: Invalid line %u", static_cast<unsigned>(lineNum));
+            ok = false;
+            break;
+        }
+
+        uint16_t masks[4] = {0, 0, 0, 0};
+        for(int p = 0; p < m_players; p++)
+        {
+            cur = end;
+            masks[p] = static_cast<uint16_t>(std::strtoul(cur, &end, 16));
+            if(end == cur)
+                break;
+        }
+
+        for(unsigned long i = 0; i < count; i++)
+            m_keys.insert(m_keys.end(), masks, masks + m_players);
+    }
+
+    std::fclose(f);
+
+    if(ok && !magicFound)
+    {
+        pLogWarning("InputTrack: %s is empty", path.c_str());
+        ok = false;
+    }
+
+    if(!ok)
+        reset(1);
+    else
+        pLogDebug("InputTrack: Loaded %u steps of %d players from %s",
+                  static_cast<unsigned>(frames()), m_players, path.c_str());
+
+    return ok;
+}
+
+bool InputTrack::save(const std::string &path) const
+{
+    FILE *f = Files::utf8_fopen(path.c_str(), "wb");
+    if(!f)
+    {
+        pLogWarning("InputTrack: Can't write file %s", path.c_str());
+        return false;
+    }
+
+    std::fprintf(f, "%s\n", g_inputTrackMagic);
+    std::fprintf(f, "players=%d\n", m_players);
+    if(hasSeed)
+        std::fprintf(f, "seed=%llu\n", static_cast<unsigned long long>(seed));
+
+    size_t players = static_cast<size_t>(m_players);
+    size_t total = frames();
+    size_t frame = 0;
+    while(frame < total)
+    {
+        //Count of next steps with same keys
+        const uint16_t *row = &m_keys[frame * players];
+        size_t count = 1;
+        while((frame + count < total) &&
+              std::equal(row, row + players, &m_keys[(frame + count) * players]))
+            count++;
+
+        std::fprintf(f, "%lu", static_cast<unsigned long>(count));
+        for(size_t p = 0; p < players; p++)
+            std::fprintf(f, " %x", static_cast<unsigned>(row[p]));
+        std::fprintf(f, "\n");
+        frame += count;
+    }
+
+    bool ok = (std::ferror(f) == 0);
+    std::fclose(f);
+    if(!ok)
+        pLogWarning("InputTrack: Failed to write file %s", path.c_str());
+    return ok;
+}
+
+void InputTrack::reset(int players)
+{
+    m_keys.clear();
+    m_players = players;
+    seed = 0;
+    hasSeed = false;
+}
+
+controller_keys InputTrack::keys(size_t frame, int player) const
+{
+    if((player < 0) || (player >= m_players) || (frame >= frames()))
+        return ResetControlKeys();
+    return unpackKeys(m_keys[frame * static_cast<size_t>(m_players) + static_cast<size_t>(player)]);
+}
+
+void InputTrack::setKeys(size_t frame, int player, const controller_keys &keys)
+{
+    if((player < 0) || (player >= m_players))
+        return;
+    size_t players = static_cast<size_t>(m_players);
+    if(frame >= frames())
+        m_keys.resize((frame + 1) * players, 0);
+    m_keys[frame * players + static_cast<size_t>(player)] = packKeys(keys);
+}
+
+uint16_t InputTrack::packKeys(const controller_keys &keys)
+{
+    uint16_t mask = 0;
+    mask |= keys.start      ? (1u << Controller::key_start) : 0;
+    mask |= keys.left       ? (1u << Controller::key_left) : 0;
+    mask |= keys.right      ? (1u << Controller::key_right) : 0;
+    mask |= keys.up         ? (1u << Controller::key_up) : 0;
+    mask |= keys.down       ? (1u << Controller::key_down) : 0;
+    mask |= keys.run        ? (1u << Controller::key_run) : 0;
+    mask |= keys.jump       ? (1u << Controller::key_jump) : 0;
+    mask |= keys.alt_run    ? (1u << Controller::key_altrun) : 0;
+    mask |= keys.alt_jump   ? (1u << Controller::key_altjump) : 0;
+    mask |= keys.drop       ? (1u << Controller::key_drop) : 0;
+    return mask;
+}
+
+controller_keys InputTrack::unpackKeys(uint16_t mask)
+{
+    controller_keys keys = ResetControlKeys();
+    keys.start      = (mask & (1u << Controller::key_start)) != 0;
+    keys.left       = (mask & (1u << Controller::key_left)) != 0;
+    keys.right      = (mask & (1u << Controller::key_right)) != 0;
+    keys.up         = (mask & (1u << Controller::key_up)) != 0;
+    keys.down       = (mask & (1u << Controller::key_down)) != 0;
+    keys.run        = (mask & (1u << Controller::key_run)) != 0;
+    keys.jump       = (mask & (1u << Controller::key_jump)) != 0;
+    keys.alt_run    = (mask & (1u << Controller::key_altrun)) != 0;
+    keys.alt_jump   = (mask & (1u << Controller::key_altjump)) != 0;
+    keys.drop       = (mask & (1u << Controller::key_drop)) != 0;
+    return keys;
+}
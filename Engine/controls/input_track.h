@@ -0,0 +1,104 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INPUT_TRACK_H
+#define INPUT_TRACK_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "control_keys.h"
+
+/*!
+ * \brief States of control keys of every player per each loop step
+ *
+ * Stored as a text file:
+ * \code
+ * PGE-INPUT 1
+ * players=2
+ * seed=1234567
+ * # count of loop steps, then key masks of every player in hex
+ * 120 0 0
+ * 35 44 0
+ * \endcode
+ * Bits of the key mask are following order of Controller::commands.
+ * Lines of "name=value" form are properties, unknown ones are ignored.
+ * Seed is the seed of random numbers generator used at start of the level.
+ */
+class InputTrack
+{
+public:
+    InputTrack();
+
+    /*!
+     * \brief Load the track from a file
+     * \param path Path to the file
+     * \return true on success
+     */
+    bool load(const std::string &path);
+    /*!
+     * \brief Save the track into a file
+     * \param path Path to the file
+     * \return true on success
+     */
+    bool save(const std::string &path) const;
+
+    //! Clear the track and set count of players
+    void reset(int players);
+
+    //! Count of loop steps in the track
+    inline size_t frames() const
+    {
+        return m_players > 0 ? (m_keys.size() / static_cast<size_t>(m_players)) : 0;
+    }
+
+    inline int players() const
+    {
+        return m_players;
+    }
+
+    /*!
+     * \brief Key states of the player at the loop step
+     * \param frame Number of loop step from zero
+     * \param player Number of player from zero
+     * \return key states, all keys are released past the end of the track
+     */
+    controller_keys keys(size_t frame, int player) const;
+    /*!
+     * \brief Store key states of the player at the loop step, track grows when needed
+     * \param frame Number of loop step from zero
+     * \param player Number of player from zero
+     * \param keys Key states
+     */
+    void setKeys(size_t frame, int player, const controller_keys &keys);
+
+    //! Seed of random numbers generator used when track was recorded
+    uint64_t seed;
+    //! Is seed stored in the track
+    bool     hasSeed;
+
+    static uint16_t packKeys(const controller_keys &keys);
+    static controller_keys unpackKeys(uint16_t mask);
+
+private:
+    //! Key masks of all players of every loop step in a row
+    std::vector<uint16_t> m_keys;
+    int m_players;
+};
+
+#endif // INPUT_TRACK_H
@@ -68,6 +68,7 @@ ConfigManager::TexturesBank ConfigManager::common_textures;
 /* *** Texture banks *** */
 ConfigManager::TexturesBank ConfigManager::level_textures;
 ConfigManager::TexturesBank ConfigManager::world_textures;
+TextureAtlas ConfigManager::level_atlas;
 
 std::string ConfigManager::imgFile, ConfigManager::imgFileM;
 std::string ConfigManager::tmpstr;
@@ -260,6 +261,7 @@ bool ConfigManager::unloadLevelConfigs()
     for(size_t i = 0; i < level_textures.size(); i++)
         GlRenderer::deleteTexture(level_textures[i]);
     level_textures.clear();
+    level_atlas.clear();
     resetPlayableTexuresState();
     /***************Clear animators*************/
     Animator_Blocks.clear();
@@ -25,7 +25,10 @@
 #include "../common_features/npc_animator.h"
 #include "../common_features/matrix_animator.h"
 #include "../common_features/data_array.h"
+#include "../graphics/texture_atlas.h"
 #include <Utils/vptrlist.h>
+#include <set>
+#include <functional>
 
 #include "setup_load_screen.h"
 #include "setup_wld_scene.h"
@@ -348,6 +351,20 @@ namespace ConfigManager
     extern VPtrList<AdvNpcAnimator > Animator_NPC;//!< Global NPC Animators (just for a coins, vines, not for activing NPC's!)
     /*****Level NPC************/
 
+    /*****Level sprites atlas************/
+    /*!
+     * \brief Decode textures of given blocks, BGO and NPCs in parallel and pack them into atlas pages before they are requested
+     * \param blocks IDs of blocks are used on the level
+     * \param bgos IDs of BGO are used on the level
+     * \param npcs IDs of NPCs are used on the level
+     * \param idle Function to call periodically from the main thread while images are decoding
+     */
+    void buildLevelAtlas(const std::set<unsigned long> &blocks,
+                         const std::set<unsigned long> &bgos,
+                         const std::set<unsigned long> &npcs,
+                         const std::function<void()> &idle = nullptr);
+    /*****Level sprites atlas************/
+
 
 
 
@@ -440,6 +457,8 @@ namespace ConfigManager
     /***********Texture banks*************/
     extern TexturesBank level_textures;
     extern TexturesBank world_textures;
+    //! Shared pages of block, BGO and NPC sprites of the level
+    extern TextureAtlas level_atlas;
     /***********Texture banks*************/
 
     void addError(std::string bug);
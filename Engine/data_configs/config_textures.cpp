@@ -20,6 +20,56 @@
 #include "config_manager_private.h"
 #include <graphics/gl_renderer.h>
 
+/*!
+ * \brief Takes texture from level atlas if image was pre-decoded, otherwise loads texture from the disk
+ */
+static void loadLevelSpriteTexture(PGE_Texture &target,
+                                   const std::string &imgFile,
+                                   const std::string &maskFile,
+                                   const std::string &maskFallback)
+{
+    if(!ConfigManager::level_atlas.take(target, imgFile, maskFile))
+        GlRenderer::loadTextureP(target, imgFile, maskFile, maskFallback);
+}
+
+void ConfigManager::buildLevelAtlas(const std::set<unsigned long> &blocks,
+                                    const std::set<unsigned long> &bgos,
+                                    const std::set<unsigned long> &npcs,
+                                    const std::function<void()> &idle)
+{
+    for(unsigned long id : blocks)
+    {
+        if(!lvl_block_indexes.contains(id) || lvl_block_indexes[id].isInit)
+            continue;
+        obj_block &b = lvl_block_indexes[id];
+        level_atlas.addImage(Dir_Blocks.getCustomFile(b.setup.image_n),
+                             Dir_Blocks.getCustomFile(b.setup.mask_n),
+                             Dir_Blocks.getMaskFallbackFile(b.setup.image_n));
+    }
+
+    for(unsigned long id : bgos)
+    {
+        if(!lvl_bgo_indexes.contains(id) || lvl_bgo_indexes[id].isInit)
+            continue;
+        obj_bgo &b = lvl_bgo_indexes[id];
+        level_atlas.addImage(Dir_BGO.getCustomFile(b.setup.image_n),
+                             Dir_BGO.getCustomFile(b.setup.mask_n),
+                             Dir_BGO.getMaskFallbackFile(b.setup.image_n));
+    }
+
+    for(unsigned long id : npcs)
+    {
+        if(!lvl_npc_indexes.contains(id) || lvl_npc_indexes[id].isInit)
+            continue;
+        obj_npc &n = lvl_npc_indexes[id];
+        level_atlas.addImage(Dir_NPC.getCustomFile(n.setup.image_n),
+                             Dir_NPC.getCustomFile(n.setup.mask_n),
+                             Dir_NPC.getMaskFallbackFile(n.setup.image_n));
+    }
+
+    level_atlas.build(GlRenderer::atlasPageSize(), idle);
+}
+
 int  ConfigManager::getBlockTexture(unsigned long blockID)
 {
     if(!lvl_block_indexes.contains(blockID))
@@ -43,11 +93,11 @@ int  ConfigManager::getBlockTexture(unsigned long blockID)
         blkSetup->textureArrayId = id;
         PGE_Texture texture;
         level_textures.push_back(texture);
-        GlRenderer::loadTextureP(level_textures[id],
-                                 imgFile,
-                                 maskFile,
-                                 maskFallback
-                                );
+        loadLevelSpriteTexture(level_textures[id],
+                               imgFile,
+                               maskFile,
+                               maskFallback
+                              );
         blkSetup->image = &(level_textures[id]);
         blkSetup->textureID = level_textures[id].texture;
         blkSetup->isInit = true;
@@ -129,11 +179,11 @@ int  ConfigManager::getBgoTexture(unsigned long bgoID)
         PGE_Texture texture;
         bgoSetup->textureArrayId = id;
         level_textures.push_back(texture);
-        GlRenderer::loadTextureP(level_textures[id],
-                                 imgFile,
-                                 maskFile,
-                                 maskFallback
-                                );
+        loadLevelSpriteTexture(level_textures[id],
+                               imgFile,
+                               maskFile,
+                               maskFallback
+                              );
         bgoSetup->image = &(level_textures[id]);
         bgoSetup->textureID = level_textures[id].texture;
         bgoSetup->isInit = true;
@@ -194,11 +244,11 @@ int  ConfigManager::getNpcTexture(unsigned long npcID)
         npcSetup->textureArrayId = id;
         PGE_Texture texture;
         level_textures.push_back(texture);
-        GlRenderer::loadTextureP(level_textures[id],
-                                 imgFile,
-                                 maskFile,
-                                 maskFallback
-                                );
+        loadLevelSpriteTexture(level_textures[id],
+                               imgFile,
+                               maskFile,
+                               maskFallback
+                              );
         npcSetup->image = &(level_textures[id]);
         npcSetup->textureID = level_textures[id].texture;
         npcSetup->isInit = true;
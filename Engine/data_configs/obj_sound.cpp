@@ -6,7 +6,7 @@
 #include <SDL2/SDL_mixer_ext.h>
 #include <vector>
 #include <common_features/logger.h>
-#include <FileMapper/file_mapper.h>
+#include <audio/sfx_bank.h>
 
 #include <common_features/fmt_format_ne.h>
 #include <IniProcessor/ini_processing.h>
@@ -50,6 +50,7 @@ void obj_sound_index::setPath(std::string _path)
 
 void obj_sound_index::play()
 {
+    Mix_Chunk *chunk = path.empty() ? nullptr : PGE_SfxBank::get(path);
     if(chunk)
         Mix_PlayChannel(channel, chunk, 0);
     else
@@ -66,82 +67,28 @@ void ConfigManager::buildSoundIndex()
     loadingTime.start();
 #endif
 
-    if(newBuild)
-    {
-        //build array table
+    if(newBuild) //build array table
         main_sfx_index.resize(static_cast<size_t>(main_sound.size()) - 1);
 
-        for(unsigned long i = 1; i < main_sound.size(); i++)
-        {
-            obj_sound_index sound;
-
-            if(main_sound.contains(i))
-            {
-                obj_sound &snd = main_sound[i];
-#if  defined(__unix__) || defined(__APPLE__) || defined(_WIN32) || defined(__HAIKU__)
-                FileMapper fileMap;
-
-                if(fileMap.open_file(snd.absPath.c_str()))
-                {
-                    sound.chunk = Mix_LoadWAV_RW(SDL_RWFromMem(fileMap.data(),
-                                                 static_cast<int>(fileMap.size())), 1);
-                    fileMap.close_file();
-                }
-
-#else
-                sound.chunk = Mix_LoadWAV(snd.absPath.c_str());
-#endif
-                sound.path = snd.absPath;
-
-                if(!sound.chunk)
-                    pLogWarning("Fail to load sound-%d: %s", i, Mix_GetError());
-                else
-                    need_to_reserve += (snd.channel >= 0 ? 1 : 0);
+    std::vector<std::string> preload;
+    preload.reserve(main_sfx_index.size());
 
-                sound.channel = snd.channel;
-            }
-
-            main_sfx_index[static_cast<size_t>(i) - 1] = sound;
-        }
-    }
-    else
+    for(unsigned long i = 1; (i < main_sound.size()) && (i <= static_cast<unsigned long>(main_sfx_index.size())); i++)
     {
-        for(unsigned long i = 1; (i < main_sound.size()) && (i <= static_cast<unsigned long>(main_sfx_index.size())); i++)
+        if(main_sound.contains(i))
         {
-            if(main_sound.contains(i))
-            {
-                obj_sound_index &sound = main_sfx_index[static_cast<size_t>(i) - 1];
-                obj_sound &snd = main_sound[i];
-                sound.setPath(snd.absPath);
-
-                if(sound.need_reload)
-                {
-#if  defined(__unix__) || defined(__APPLE__) || defined(_WIN32) || defined(__HAIKU__)
-                    FileMapper fileMap;
-
-                    if(fileMap.open_file(snd.absPath.c_str()))
-                    {
-                        sound.chunk = Mix_LoadWAV_RW(SDL_RWFromMem(fileMap.data(),
-                                                     static_cast<int>(fileMap.size())),
-                                                     static_cast<int>(fileMap.size()));
-                        fileMap.close_file();
-                    }
-
-#else
-                    sound.chunk = Mix_LoadWAV(snd.absPath.c_str());
-#endif
-                }
-
-                if(!sound.chunk)
-                    pLogWarning("Fail to load sound-%d: %s", i, Mix_GetError());
-                else
-                    need_to_reserve += (snd.channel >= 0 ? 1 : 0);
-
-                sound.channel = snd.channel;
-            }
+            obj_sound_index &sound = main_sfx_index[static_cast<size_t>(i) - 1];
+            obj_sound &snd = main_sound[i];
+            sound.setPath(snd.absPath);
+            preload.push_back(snd.absPath);
+            need_to_reserve += (snd.channel >= 0 ? 1 : 0);
+            sound.channel = snd.channel;
         }
     }
 
+    //Sounds are decoded by background thread while rest of the scene is loading
+    PGE_SfxBank::preload(preload);
+
     if(need_to_reserve > 0)
     {
         total_channels = (total_channels + need_to_reserve + 32);
@@ -182,15 +129,7 @@ void ConfigManager::clearSoundIndex()
     if(main_sfx_index.empty())
         return;
 
-    size_t size = main_sfx_index.size();
-    obj_sound_index *d = main_sfx_index.data();
-
-    for(size_t i = 0; i < size; i++)
-    {
-        if(d[i].chunk)
-            Mix_FreeChunk(d[i].chunk);
-    }
-
+    PGE_SfxBank::clear();
     main_sfx_index.clear();
 }
 
@@ -4,16 +4,14 @@
 #include <string>
 
 #include "obj_sound_roles.h"
-struct Mix_Chunk;
 
 struct obj_sound_index
 {
     std::string path;
     bool need_reload = false;
-    Mix_Chunk *chunk = nullptr;
     int channel = -1;
     void setPath(std::string _path);
-    void play(); //!< play sound
+    void play(); //!< play sound, decoded sound is taken from PGE_SfxBank
 };
 
 
@@ -38,6 +38,7 @@
 #include <common_features/logger.h>
 #include <common_features/translator.h>
 #include <common_features/number_limiter.h>
+#include <common_features/profiler.h>
 
 #include <data_configs/config_manager.h>
 
@@ -47,6 +48,7 @@
 #include <settings/debugger.h>
 
 #include <networking/intproc.h>
+#include <scenes/level/lvl_netsync.h>
 
 PGEEngineCmdArgs    g_flags;
 
@@ -232,13 +234,17 @@ bool PGEEngineApp::initSDL()
     int sdlMixerInitFlags = 0;
     // Prepare flags for SDL initialization
     sdlInitFlags |= SDL_INIT_TIMER;
-    sdlInitFlags |= SDL_INIT_AUDIO;
-    sdlInitFlags |= SDL_INIT_VIDEO;
     sdlInitFlags |= SDL_INIT_EVENTS;
-    sdlInitFlags |= SDL_INIT_JOYSTICK;
-    //(Cool thing, but is not needed yet)
-    //sdlInitFlags |= SDL_INIT_HAPTIC;
-    sdlInitFlags |= SDL_INIT_GAMECONTROLLER;
+    //Headless mode must work on machines without display and sound devices
+    if(!PGE_Window::headless)
+    {
+        sdlInitFlags |= SDL_INIT_AUDIO;
+        sdlInitFlags |= SDL_INIT_VIDEO;
+        sdlInitFlags |= SDL_INIT_JOYSTICK;
+        //(Cool thing, but is not needed yet)
+        //sdlInitFlags |= SDL_INIT_HAPTIC;
+        sdlInitFlags |= SDL_INIT_GAMECONTROLLER;
+    }
 
     sdlMixerInitFlags |= MIX_INIT_FLAC;
     sdlMixerInitFlags |= MIX_INIT_MOD;
@@ -416,6 +422,20 @@ static void printUsage(const char *arg0)
         "  --debug-superman           - Enable unlimited flying up\n"
         "  --debug-chucknorris        - Allow to playable character destroy any objects\n"
         "  --debug-worldfreedom       - Allow to walk everywhere on the world map\n"
+        "  --headless                 - Run without window, rendering and audio as fast as possible\n"
+        "            (requires --config and a level file, message boxes are printed into log)\n"
+        "  --play-input=\"{path}\"     - Take controls of players from a recorded input track\n"
+        "  --record-input=\"{path}\"   - Record controls of players into an input track\n"
+        "  --frame-timings=\"{path}\"  - Write times of update, collisions and rendering\n"
+        "            of every loop step of the level into CSV file\n"
+        "  --frames=N                 - Close the level after N loop steps\n"
+        "  --profile[=\"{path}\"]      - Capture profiler zones since start and write them\n"
+        "            as Chrome trace on exit (F10 key starts and writes capture at any time)\n"
+        "  --netsync-server[=PORT]    - Send state of the level to other engines by UDP\n"
+        "  --netsync-client=HOST[:PORT] - Show state of the level from the server engine\n"
+        "            (both engines must open the same level file)\n"
+        "  --netsync-log=\"{path}\"    - Write checksums of every sent or received snapshot\n"
+        "            into CSV file, logs of the server and the client must have same ones\n"
         "\n"
         "More detailed information can be found here:\n"
         "http://wohlsoft.ru/pgewiki/PGE_Engine#Command_line_arguments\n"
@@ -675,6 +695,98 @@ void PGEEngineApp::parseHighArgs(const std::vector<std::string> &args)
             g_AppSettings.vsync = true;
             PGE_Window::vsync = true;
         }
+        else if(param_s.compare("--headless") == 0)
+        {
+            PGE_Window::headless = true;
+            g_flags.audioEnabled = false;
+        }
+        else if(param_s.compare("--profile") == 0)
+            PGE_Profiler::start();
+        else if(param_s.compare(0, 10, "--profile=") == 0)
+        {
+            std::string tmp;
+            bool ok = false;
+            tmp = takeStrFromArg(param_s, ok);
+            if(ok)
+            {
+                g_AppSettings.profileTraceFile = tmp;
+                PGE_Profiler::start();
+            }
+        }
+        else if(param_s.compare(0, 13, "--play-input=") == 0)
+        {
+            std::string tmp;
+            bool ok = false;
+            tmp = takeStrFromArg(param_s, ok);
+            if(ok)
+                g_AppSettings.inputReplayFile = tmp;
+        }
+        else if(param_s.compare(0, 15, "--record-input=") == 0)
+        {
+            std::string tmp;
+            bool ok = false;
+            tmp = takeStrFromArg(param_s, ok);
+            if(ok)
+                g_AppSettings.inputRecordFile = tmp;
+        }
+        else if(param_s.compare(0, 16, "--frame-timings=") == 0)
+        {
+            std::string tmp;
+            bool ok = false;
+            tmp = takeStrFromArg(param_s, ok);
+            if(ok)
+                g_AppSettings.frameTimingsFile = tmp;
+        }
+        else if(param_s.compare(0, 9, "--frames=") == 0)
+        {
+            int tmp;
+            bool ok = false;
+            tmp = takeIntFromArg(param_s, ok);
+            if(ok && (tmp > 0))
+                g_AppSettings.frameLimit = static_cast<unsigned long>(tmp);
+        }
+        else if(param_s.compare("--netsync-server") == 0)
+            LVL_NetSync::setup.role = LVL_NetSync::ROLE_SERVER;
+        else if(param_s.compare(0, 17, "--netsync-server=") == 0)
+        {
+            int tmp;
+            bool ok = false;
+            tmp = takeIntFromArg(param_s, ok);
+            if(ok && (tmp > 0) && (tmp < 65536))
+            {
+                LVL_NetSync::setup.role = LVL_NetSync::ROLE_SERVER;
+                LVL_NetSync::setup.port = static_cast<uint16_t>(tmp);
+            }
+            else
+                pLogWarning("Invalid port of network synchronization: [%s]", param_s.c_str());
+        }
+        else if(param_s.compare(0, 17, "--netsync-client=") == 0)
+        {
+            std::string tmp;
+            bool ok = false;
+            tmp = takeStrFromArg(param_s, ok);
+            if(ok)
+            {
+                size_t colon = tmp.rfind(':');
+                if(colon != std::string::npos)
+                {
+                    int port = atoi(tmp.c_str() + colon + 1);
+                    if((port > 0) && (port < 65536))
+                        LVL_NetSync::setup.port = static_cast<uint16_t>(port);
+                    tmp.resize(colon);
+                }
+                LVL_NetSync::setup.role = LVL_NetSync::ROLE_CLIENT;
+                LVL_NetSync::setup.host = tmp;
+            }
+        }
+        else if(param_s.compare(0, 14, "--netsync-log=") == 0)
+        {
+            std::string tmp;
+            bool ok = false;
+            tmp = takeStrFromArg(param_s, ok);
+            if(ok)
+                LVL_NetSync::setup.logFile = tmp;
+        }
         else
         {
             char *str = &param_s[0];
@@ -23,12 +23,20 @@
 #include <data_configs/config_manager.h>
 #include <unordered_set>
 #include <mutex>
+#include <cstring>
+#include <algorithm>
+#include <vector>
 
 #include "font_manager_private.h"
 
 //! FreeType library descriptor
 FT_Library  g_ft = nullptr;
 
+//! Width and height of glyph texture page, limited by renderer's atlas page size
+static const int g_glyphPageSize = 512;
+//! Gap between glyphs on the page to avoid bleeding of neighbours while scaling
+static const int g_glyphPadding = 1;
+
 //! Loaded TTF fonts set used as fallback for missing glyphs
 static std::unordered_set<TtfFont*> g_loadedFaces;
 static std::mutex                   g_loadedFaces_mutex;
@@ -65,6 +73,11 @@ TtfFont::~TtfFont()
         GlRenderer::deleteTexture(t);
     m_texturesBank.clear();
 
+    for(GlyphPage &p : m_glyphPages)
+        GlRenderer::deleteTexture(p.tx);
+    m_glyphPages.clear();
+    m_recentPage.clear();
+
     g_loadedFaces_mutex.lock();
     if(m_face)
     {
@@ -136,6 +149,18 @@ PGE_Size TtfFont::textSize(std::string &text,
     if(text.empty())
         return PGE_Size(0, 0);
 
+    makeLayoutKey(m_layoutKey, fontSize, (max_line_lenght << 1) | (cut ? 1 : 0), text);
+    auto cached = m_metricsCache.find(m_layoutKey);
+    if(cached != m_metricsCache.end())
+    {
+        text = cached->second.text;
+        return cached->second.size;
+    }
+
+    if(m_metricsCache.size() >= layoutCacheLimit)
+        m_metricsCache.clear();
+    TextMetrics &metrics = m_metricsCache[m_layoutKey];
+
     //! index of last found space character
     size_t lastspace = 0;
     //! Count of lines
@@ -222,7 +247,9 @@ PGE_Size TtfFont::textSize(std::string &text,
         maxWidth = static_cast<uint32_t>(text.length());
 
     /****************Word wrap*end*****************/
-    return PGE_Size(static_cast<int32_t>(widthSummMax), static_cast<int32_t>((fontSize * 1.5) * count));
+    metrics.text = text;
+    metrics.size = PGE_Size(static_cast<int32_t>(widthSummMax), static_cast<int32_t>((fontSize * 1.5) * count));
+    return metrics.size;
 }
 
 void TtfFont::printText(const std::string &text,
@@ -234,50 +261,61 @@ void TtfFont::printText(const std::string &text,
     if(text.empty())
         return;
 
-    uint32_t offsetX = 0;
-    uint32_t offsetY = 0;
     bool    doublePixel = ConfigManager::setup_fonts.double_pixled;
 
-    const char *strIt  = text.c_str();
-    const char *strEnd = strIt + text.size();
-    for(; strIt < strEnd; strIt++)
+    makeLayoutKey(m_layoutKey, fontSize, doublePixel ? 1 : 0, text);
+    auto cached = m_layoutCache.find(m_layoutKey);
+    if(cached == m_layoutCache.end())
     {
-        const char &cx = *strIt;
-        UTF8 ucx = static_cast<unsigned char>(cx);
+        if(m_layoutCache.size() >= layoutCacheLimit)
+            m_layoutCache.clear();
+        cached = m_layoutCache.insert({m_layoutKey, std::vector<TextQuad>()}).first;
+        std::vector<TextQuad> &quads = cached->second;
 
-        switch(cx)
+        uint32_t offsetX = 0;
+        uint32_t offsetY = 0;
+
+        const char *strIt  = text.c_str();
+        const char *strEnd = strIt + text.size();
+        for(; strIt < strEnd; strIt++)
         {
-        case '\n':
-            offsetX = 0;
-            offsetY += (fontSize * 1.5);
-            continue;
+            const char &cx = *strIt;
+            UTF8 ucx = static_cast<unsigned char>(cx);
 
-        case '\t':
-            //Fake tabulation
-            offsetX += offsetX + offsetX % uint32_t(fontSize * 1.5);
-            continue;
-//        case ' ':
-//            offsetX += m_spaceWidth + m_interLetterSpace / 2;
-//            continue;
-        }
+            switch(cx)
+            {
+            case '\n':
+                offsetX = 0;
+                offsetY += (fontSize * 1.5);
+                continue;
+
+            case '\t':
+                //Fake tabulation
+                offsetX += offsetX + offsetX % uint32_t(fontSize * 1.5);
+                continue;
+            }
 
-        const TheGlyph &glyph = getGlyph(doublePixel ? (fontSize / 2) : fontSize, get_utf8_char(&cx));
-        if(glyph.tx)
-        {
-            GlRenderer::setTextureColor(Red, Green, Blue, Alpha);
-            int32_t glyph_x = x + static_cast<int32_t>(offsetX);
-            int32_t glyph_y = y + static_cast<int32_t>(offsetY + fontSize);
-            GlRenderer::renderTexture(glyph.tx,
-                                      static_cast<float>(glyph_x + glyph.left),
-                                      static_cast<float>(glyph_y - glyph.top),
-                                      (doublePixel ? (glyph.width * 2) : glyph.width),
-                                      (doublePixel ? (glyph.height * 2) : glyph.height)
-                                      );
-        }
-        offsetX += glyph.tx ? uint32_t(glyph.advance >> 6) : (fontSize >> 2);
+            const TheGlyph &glyph = getGlyph(doublePixel ? (fontSize / 2) : fontSize, get_utf8_char(&cx));
+            if(glyph.tx)
+            {
+                TextQuad q;
+                q.tx = glyph.tx;
+                q.x = static_cast<float>(static_cast<int32_t>(offsetX) + glyph.left);
+                q.y = static_cast<float>(static_cast<int32_t>(offsetY + fontSize) - glyph.top);
+                q.w = static_cast<float>(doublePixel ? (glyph.width * 2) : glyph.width);
+                q.h = static_cast<float>(doublePixel ? (glyph.height * 2) : glyph.height);
+                quads.push_back(q);
+            }
+            offsetX += glyph.tx ? uint32_t(glyph.advance >> 6) : (fontSize >> 2);
 
-        strIt += static_cast<size_t>(trailingBytesForUTF8[ucx]);
+            strIt += static_cast<size_t>(trailingBytesForUTF8[ucx]);
+        }
     }
+
+    // Glyphs of the same size are sharing the texture page, so the whole text goes into one batch
+    GlRenderer::setTextureColor(Red, Green, Blue, Alpha);
+    for(const TextQuad &q : cached->second)
+        GlRenderer::renderTexture(q.tx, static_cast<float>(x) + q.x, static_cast<float>(y) + q.y, q.w, q.h);
 }
 
 bool TtfFont::isLoaded()
@@ -424,7 +462,8 @@ const TtfFont::TheGlyph &TtfFont::loadGlyph(uint32_t fontSize, char32_t characte
     texture.nOfColors   = GL_RGBA;
     texture.format      = GL_BGRA;
 
-    GlRenderer::loadRawTextureP(texture, image, width, height);
+    if(!packGlyph(texture, image, width, height, fontSize))
+        GlRenderer::loadRawTextureP(texture, image, width, height);
     t_glyph.tx      = &texture;
     t_glyph.width   = width;
     t_glyph.height  = height;
@@ -450,4 +489,76 @@ const TtfFont::TheGlyph &TtfFont::loadGlyph(uint32_t fontSize, char32_t characte
     return rc->second;
 }
 
+bool TtfFont::packGlyph(PGE_Texture &texture, uint8_t *image, uint32_t width, uint32_t height, uint32_t fontSize)
+{
+    int pageSize = std::min(GlRenderer::atlasPageSize(), g_glyphPageSize);
+    int w = static_cast<int>(width);
+    int h = static_cast<int>(height);
+
+    // Renderer has no atlases support, or glyph is too big
+    if((pageSize <= 0) || (w > pageSize / 2) || (h > pageSize / 2))
+        return false;
+
+    GlyphPage *page = nullptr;
+    auto recent = m_recentPage.find(fontSize);
+    if(recent != m_recentPage.end())
+        page = recent->second;
+
+    if(page)
+    {
+        // Start next shelf
+        if(page->shelfX + w > pageSize)
+        {
+            page->shelfX = 0;
+            page->shelfY += page->shelfH + g_glyphPadding;
+            page->shelfH = 0;
+        }
+        // Page is full
+        if(page->shelfY + h > pageSize)
+            page = nullptr;
+    }
+
+    if(!page)
+    {
+        m_glyphPages.emplace_back();
+        page = &m_glyphPages.back();
+        page->tx.nOfColors = texture.nOfColors;
+        page->tx.format    = texture.format;
+        std::vector<uint8_t> blank(static_cast<size_t>(pageSize * pageSize * 4), 0);
+        GlRenderer::loadRawTextureP(page->tx, blank.data(),
+                                    static_cast<uint32_t>(pageSize),
+                                    static_cast<uint32_t>(pageSize));
+        m_recentPage[fontSize] = page;
+    }
 
+    int x = page->shelfX;
+    int y = page->shelfY;
+    GlRenderer::updateRawTextureP(page->tx, x, y, image, width, height);
+    page->shelfX += w + g_glyphPadding;
+    page->shelfH = std::max(page->shelfH, h);
+
+    texture.texture = page->tx.texture;
+    texture.inited = true;
+    texture.w = w;
+    texture.h = h;
+    texture.frame_w = w;
+    texture.frame_h = h;
+    texture.atlas_member = true;
+    texture.atlas_x = x;
+    texture.atlas_y = y;
+    texture.atlas_w = pageSize;
+    texture.atlas_h = pageSize;
+    texture.uv_left   = static_cast<GLfloat>(x) / static_cast<GLfloat>(pageSize);
+    texture.uv_top    = static_cast<GLfloat>(y) / static_cast<GLfloat>(pageSize);
+    texture.uv_right  = static_cast<GLfloat>(x + w) / static_cast<GLfloat>(pageSize);
+    texture.uv_bottom = static_cast<GLfloat>(y + h) / static_cast<GLfloat>(pageSize);
+    return true;
+}
+
+void TtfFont::makeLayoutKey(std::string &key, uint32_t fontSize, uint32_t flags, const std::string &text)
+{
+    key.resize(sizeof(fontSize) + sizeof(flags));
+    std::memcpy(&key[0], &fontSize, sizeof(fontSize));
+    std::memcpy(&key[sizeof(fontSize)], &flags, sizeof(flags));
+    key.append(text);
+}
@@ -21,6 +21,8 @@
 
 
 #include <unordered_map>
+#include <vector>
+#include <string>
 #include <Utils/vptrlist.h>
 #include <common_features/pge_texture.h>
 
@@ -126,11 +128,65 @@ private:
     const TheGlyph &getGlyph(uint32_t fontSize, char32_t character);
     const TheGlyph &loadGlyph(uint32_t fontSize, char32_t character);
 
+    /**
+     * @brief Put glyph image onto the texture page of given pixel size
+     * @param texture Destination texture context
+     * @param image Raw pixels of the glyph
+     * @param width Width of glyph image
+     * @param height Height of glyph image
+     * @param fontSize Pixel size of the font
+     * @return true if glyph was packed, false if it must be loaded as standalone texture
+     */
+    bool packGlyph(PGE_Texture &texture, uint8_t *image, uint32_t width, uint32_t height, uint32_t fontSize);
+
     typedef std::unordered_map<char32_t, TheGlyph> CharMap;
     typedef std::unordered_map<uint32_t, CharMap>  SizeCharMap;
 
     SizeCharMap m_charMap;
     VPtrList<PGE_Texture > m_texturesBank;
+
+    //! Shared texture of glyphs of one pixel size, filled by shelves from top to bottom
+    struct GlyphPage
+    {
+        PGE_Texture tx;
+        //! Left side of free space on current shelf
+        int shelfX = 0;
+        //! Top side of current shelf
+        int shelfY = 0;
+        //! Height of tallest glyph on current shelf
+        int shelfH = 0;
+    };
+    //! All glyph pages of the font
+    VPtrList<GlyphPage> m_glyphPages;
+    //! Page which is filling now for every pixel size
+    std::unordered_map<uint32_t, GlyphPage*> m_recentPage;
+
+    //! Glyph of the laid out text with position relative to the text origin
+    struct TextQuad
+    {
+        PGE_Texture *tx = nullptr;
+        float x = 0.0f;
+        float y = 0.0f;
+        float w = 0.0f;
+        float h = 0.0f;
+    };
+    //! Result of textSize() call
+    struct TextMetrics
+    {
+        std::string text;
+        PGE_Size    size;
+    };
+
+    static void makeLayoutKey(std::string &key, uint32_t fontSize, uint32_t flags, const std::string &text);
+
+    //! Recently printed texts, keyed by font size and string
+    std::unordered_map<std::string, std::vector<TextQuad>> m_layoutCache;
+    //! Recently measured texts, keyed by font size, word wrap settings and string
+    std::unordered_map<std::string, TextMetrics> m_metricsCache;
+    //! Reusable key buffer
+    std::string m_layoutKey;
+    //! Caches are dropped when they are growing to this count of entries
+    static const size_t layoutCacheLimit = 256;
 };
 
 #endif // TTF_FONT_H
@@ -23,11 +23,18 @@
 */
 
 #include "gl_renderer.h"
+#include "texture_cache.h"
 #include "window.h"
 #include "../common_features/app_path.h"
 
 #include <common_features/graphics_funcs.h>
 #include <common_features/logger.h>
+#include <common_features/worker_pool.h>
+
+#include <functional>
+//! Spreads per-pixel work of the GIF encoder over worker threads
+static void gifParallelFor(size_t count, const std::function<void(size_t, size_t)> &body);
+#define GIF_PARALLEL_FOR(count, body) gifParallelFor(count, body)
 #include <common_features/gif-h/gif.h>
 #include <gui/pge_msgbox.h>
 
@@ -47,6 +54,7 @@
 #include "render/render_opengl21.h"
 #include "render/render_opengl31.h"
 #include "render/render_swsdl.h"
+#include "render/render_null.h"
 
 #include <DirManager/dirman.h>
 #include <Utils/files.h>
@@ -55,6 +63,9 @@
 
 #include <ctime>
 #include <chrono>
+#include <vector>
+#include <memory>
+#include <cstring>
 
 #ifdef DEBUG_BUILD
 #include <Utils/elapsed_timer.h>
@@ -64,6 +75,7 @@ static Render_dummy     g_dummy;//Empty renderer
 static Render_OpenGL31  g_opengl31;
 static Render_OpenGL21  g_opengl21;
 static Render_SW_SDL    g_swsdl;
+static Render_Null      g_null;
 
 static Render_Base      *g_renderer = &g_dummy;
 
@@ -750,6 +762,8 @@ GlRenderer::RenderEngineType GlRenderer::setRenderer(GlRenderer::RenderEngineTyp
     #endif
     else if(rtype == RENDER_SW_SDL)
         pLogDebug("SDL Software renderer selected!");
+    else if(rtype == RENDER_NULL)
+        pLogDebug("Null renderer selected!");
 
     return rtype;
 }
@@ -777,6 +791,12 @@ void GlRenderer::setup_SW_SDL()
     g_renderer->set_SDL_settings();
 }
 
+void GlRenderer::setup_Null()
+{
+    g_renderer = &g_null;
+    g_renderer->set_SDL_settings();
+}
+
 std::string GlRenderer::engineName()
 {
     return g_renderer->name();
@@ -788,6 +808,7 @@ bool GlRenderer::init()
         return false;
 
     g_ScreenshotPath = AppPathManager::screenshotsDir() + "/";
+    TextureCache::init(AppPathManager::textureCacheDir());
     m_isReady = g_renderer->init();
 
     if(m_isReady)
@@ -815,12 +836,64 @@ void GlRenderer::loadTextureP(PGE_Texture& target,
                               std::string path,
                               std::string maskPath,
                               std::string maskFallbackPath)
+{
+    if(path.empty())
+        return;
+
+    #ifdef DEBUG_BUILD
+    ElapsedTimer totalTime;
+    totalTime.start();
+    #endif
+
+    if(TextureCache::loadTexture(target, path, maskPath, maskFallbackPath))
+    {
+        #ifdef DEBUG_BUILD
+        pLogDebug("Total Loading of texture %s from cache passed in %d nanoseconds",
+                  path.c_str(), static_cast<int>(totalTime.nanoelapsed()));
+        #endif
+        return;
+    }
+
+    FIBITMAP *sourceImage = loadTextureImage(path, maskPath, maskFallbackPath);
+    if(!sourceImage)
+    {
+        target = g_renderer->getDummyTexture();
+        return;
+    }
+
+    #ifdef DEBUG_BUILD
+    uint32_t w = static_cast<uint32_t>(FreeImage_GetWidth(sourceImage));
+    uint32_t h = static_cast<uint32_t>(FreeImage_GetHeight(sourceImage));
+    #endif
+
+    loadTextureImageP(target, sourceImage);
+
+    #ifdef DEBUG_BUILD
+    pLogDebug("Total Loading of texture %s passed in %d nanoseconds (%dx%d)",
+              path.c_str(),
+              static_cast<int>(totalTime.nanoelapsed()),
+              static_cast<int>(w),
+              static_cast<int>(h));
+    #endif
+}
+
+FIBITMAP *GlRenderer::loadTextureImage(std::string path,
+                                       std::string maskPath,
+                                       std::string maskFallbackPath)
 {
     //SDL_Surface * sourceImage;
     FIBITMAP *sourceImage;
 
     if(path.empty())
-        return;
+        return NULL;
+
+    sourceImage = TextureCache::loadImage(path, maskPath, maskFallbackPath);
+    if(sourceImage)
+        return sourceImage;
+
+    const std::string cachePath = path;
+    const std::string cacheMaskPath = maskPath;
+    const std::string cacheMaskFallbackPath = maskFallbackPath;
 
     // Load the OpenGL texture
     //sourceImage = GraphicsHelps::loadQImage(path); // Gives us the information to make the texture
@@ -846,19 +919,12 @@ void GlRenderer::loadTextureP(PGE_Texture& target,
                     "Reason: %s.",
                     path.c_str(),
                     (Files::fileExists(path) ? "wrong image format" : "file not exist"));
-        target = g_renderer->getDummyTexture();
-        return;
+        return NULL;
     }
 
     #ifdef DEBUG_BUILD
-    ElapsedTimer totalTime;
     ElapsedTimer maskMergingTime;
-    ElapsedTimer bindingTime;
-    ElapsedTimer unloadTime;
-    totalTime.start();
     int64_t maskElapsed = 0;
-    int64_t bindElapsed = 0;
-    int64_t unloadElapsed = 0;
     #endif
 
     //Apply Alpha mask
@@ -894,65 +960,71 @@ void GlRenderer::loadTextureP(PGE_Texture& target,
                     "Reason: %s.",
                     path.c_str(),
                     "Zero image size!");
-        target = g_renderer->getDummyTexture();
-        return;
+        return NULL;
     }
 
     #ifdef DEBUG_BUILD
+    pLogDebug("Mask merging of %s passed in %d nanoseconds", path.c_str(), static_cast<int>(maskElapsed));
+    #endif
+
+    TextureCache::store(cachePath, cacheMaskPath, cacheMaskFallbackPath, sourceImage);
+
+    return sourceImage;
+}
+
+void GlRenderer::loadTextureImageP(PGE_Texture &target, FIBITMAP *image)
+{
+    #ifdef DEBUG_BUILD
+    ElapsedTimer bindingTime;
+    ElapsedTimer unloadTime;
     bindingTime.start();
+    int64_t bindElapsed = 0;
+    int64_t unloadElapsed = 0;
     #endif
-    RGBQUAD upperColor;
-    FreeImage_GetPixelColor(sourceImage, 0, 0, &upperColor);
-    target.ColorUpper.r = float(upperColor.rgbRed) / 255.0f;
-    target.ColorUpper.b = float(upperColor.rgbBlue) / 255.0f;
-    target.ColorUpper.g = float(upperColor.rgbGreen) / 255.0f;
-    RGBQUAD lowerColor;
-    FreeImage_GetPixelColor(sourceImage, 0, static_cast<unsigned int>(h - 1), &lowerColor);
-    target.ColorLower.r = float(lowerColor.rgbRed) / 255.0f;
-    target.ColorLower.b = float(lowerColor.rgbBlue) / 255.0f;
-    target.ColorLower.g = float(lowerColor.rgbGreen) / 255.0f;
-    FreeImage_FlipVertical(sourceImage);
+
+    uint32_t w = static_cast<uint32_t>(FreeImage_GetWidth(image));
+    uint32_t h = static_cast<uint32_t>(FreeImage_GetHeight(image));
+    getTextureEdgeColors(target, image);
+    FreeImage_FlipVertical(image);
     target.nOfColors = GL_RGBA;
     target.format = GL_BGRA;
     target.w = static_cast<int>(w);
     target.h = static_cast<int>(h);
     target.frame_w = static_cast<int>(w);
     target.frame_h = static_cast<int>(h);
-    //    #ifdef PGE_USE_OpenGL_2_1
-    //    glEnable(GL_TEXTURE_2D);
-    //    #endif
-    //    // Have OpenGL generate a texture object handle for us
-    //    glGenTextures( 1, &(target.texture) ); GLERRORCHECK();
-    //    // Bind the texture object
-    //    glBindTexture( GL_TEXTURE_2D, target.texture ); GLERRORCHECK();
-    GLubyte *textura = reinterpret_cast<GLubyte *>(FreeImage_GetBits(sourceImage));
+    GLubyte *textura = reinterpret_cast<GLubyte *>(FreeImage_GetBits(image));
     g_renderer->loadTexture(target, w, h, textura);
-    // //    glTexImage2D(GL_TEXTURE_2D, 0, target.nOfColors, sourceImage.width(), sourceImage.height(),
-    // //         0, target.format, GL_UNSIGNED_BYTE, sourceImage.bits() );
-    //    glTexImage2D(GL_TEXTURE_2D, 0, target.nOfColors, w, h,
-    //           0, target.format, GL_UNSIGNED_BYTE, textura ); GLERRORCHECK();
-    //    glBindTexture( GL_TEXTURE_2D, 0); GLERRORCHECK();
-    //    target.inited = true;
     #ifdef DEBUG_BUILD
     bindElapsed = bindingTime.nanoelapsed();
     unloadTime.start();
     #endif
     //SDL_FreeSurface(sourceImage);
-    GraphicsHelps::closeImage(sourceImage);
+    GraphicsHelps::closeImage(image);
     #ifdef DEBUG_BUILD
     unloadElapsed = unloadTime.nanoelapsed();
+    pLogDebug("Binding time of texture passed in %d nanoseconds", static_cast<int>(bindElapsed));
+    pLogDebug("Unload time of texture passed in %d nanoseconds", static_cast<int>(unloadElapsed));
     #endif
-    #ifdef DEBUG_BUILD
-    pLogDebug("Mask merging of %s passed in %d nanoseconds", path.c_str(), static_cast<int>(maskElapsed));
-    pLogDebug("Binding time of %s passed in %d nanoseconds", path.c_str(), static_cast<int>(bindElapsed));
-    pLogDebug("Unload time of %s passed in %d nanoseconds", path.c_str(), static_cast<int>(unloadElapsed));
-    pLogDebug("Total Loading of texture %s passed in %d nanoseconds (%dx%d)",
-              path.c_str(),
-              static_cast<int>(totalTime.nanoelapsed()),
-              static_cast<int>(w),
-              static_cast<int>(h));
-    #endif
-    return;
+}
+
+void GlRenderer::getTextureEdgeColors(PGE_Texture &target, FIBITMAP *image)
+{
+    uint32_t h = static_cast<uint32_t>(FreeImage_GetHeight(image));
+    RGBQUAD upperColor;
+    FreeImage_GetPixelColor(image, 0, 0, &upperColor);
+    target.ColorUpper.r = float(upperColor.rgbRed) / 255.0f;
+    target.ColorUpper.b = float(upperColor.rgbBlue) / 255.0f;
+    target.ColorUpper.g = float(upperColor.rgbGreen) / 255.0f;
+    RGBQUAD lowerColor;
+    FreeImage_GetPixelColor(image, 0, static_cast<unsigned int>(h - 1), &lowerColor);
+    target.ColorLower.r = float(lowerColor.rgbRed) / 255.0f;
+    target.ColorLower.b = float(lowerColor.rgbBlue) / 255.0f;
+    target.ColorLower.g = float(lowerColor.rgbGreen) / 255.0f;
+}
+
+int GlRenderer::atlasPageSize()
+{
+    return g_renderer->atlasPageSize();
 }
 
 void GlRenderer::loadRawTextureP(PGE_Texture &target, uint8_t *pixels, uint32_t width, uint32_t height)
@@ -964,9 +1036,15 @@ void GlRenderer::loadRawTextureP(PGE_Texture &target, uint8_t *pixels, uint32_t
     g_renderer->loadTexture(target, width, height, pixels);
 }
 
+void GlRenderer::updateRawTextureP(PGE_Texture &target, int x, int y, uint8_t *pixels, uint32_t width, uint32_t height)
+{
+    g_renderer->updateTexture(target, x, y, width, height, pixels);
+}
+
 void GlRenderer::deleteTexture(PGE_Texture &tx)
 {
-    if((tx.inited) && (tx.texture != g_renderer->getDummyTexture().texture))
+    // Atlas pages are shared between multiple textures and are owned by the atlas
+    if((tx.inited) && !tx.atlas_member && (tx.texture != g_renderer->getDummyTexture().texture))
         g_renderer->deleteTexture(tx);
 
     tx.inited = false;
@@ -984,6 +1062,15 @@ void GlRenderer::deleteTexture(PGE_Texture &tx)
     tx.ColorLower.r = 0;
     tx.ColorLower.g = 0;
     tx.ColorLower.b = 0;
+    tx.atlas_member = false;
+    tx.uv_left = 0.0f;
+    tx.uv_top = 0.0f;
+    tx.uv_right = 1.0f;
+    tx.uv_bottom = 1.0f;
+    tx.atlas_x = 0;
+    tx.atlas_y = 0;
+    tx.atlas_w = 0;
+    tx.atlas_h = 0;
 }
 
 bool GlRenderer::isTopDown()
@@ -1001,6 +1088,22 @@ int GlRenderer::getPixelDataSize(const PGE_Texture *tx)
 
 void GlRenderer::getPixelData(const PGE_Texture *tx, unsigned char *pixelData)
 {
+    if(tx && tx->atlas_member)
+    {
+        // Read whole atlas page and take the image from it
+        size_t pageLine = static_cast<size_t>(tx->atlas_w) * 4;
+        size_t line = static_cast<size_t>(tx->w) * 4;
+        std::vector<unsigned char> page(pageLine * static_cast<size_t>(tx->atlas_h));
+        g_renderer->getPixelData(tx, page.data());
+        for(int y = 0; y < tx->h; y++)
+        {
+            const unsigned char *src = page.data() + pageLine * static_cast<size_t>(tx->atlas_y + y)
+                                       + static_cast<size_t>(tx->atlas_x) * 4;
+            memcpy(pixelData + line * static_cast<size_t>(y), src, line);
+        }
+        return;
+    }
+
     g_renderer->getPixelData(tx, pixelData);
 }
 
@@ -1140,17 +1243,68 @@ int GlRenderer::makeShot_action(void *_pixels)
 }
 
 
+//! Count of frame buffers shared by capture and encoder, when all of them are busy new frames are dropped
+static const size_t g_gifFramesPool = 4;
+
+struct GifFrame
+{
+    std::vector<unsigned char> pixels;
+    int w = 0;
+    int h = 0;
+};
+
 static struct gifRecord
 {
-    GifWriter   writer      = {NULL, NULL, true, false, NULL, 0, 0, 0, 0, false};
-    SDL_Thread *worker      = nullptr;
+    GifWriter   writer      = {NULL, NULL, true, false, NULL, 0, 0, 0, 0, false, NULL};
+    //! Persistent encoder thread, frames are encoded in order of their capture
+    std::unique_ptr<WorkerPool> encoder;
+    //! Threads which are helping encoder to quantize pixels of the frame
+    std::unique_ptr<WorkerPool> quantizers;
+    //! Protects the list of free frames
     SDL_mutex  *mutex       = nullptr;
+    GifFrame    frames[g_gifFramesPool];
+    //! Frame buffers which are not queued to the encoder
+    std::vector<GifFrame *> freeFrames;
+    //! Size of GIF frames
+    int         width       = 0;
+    int         height      = 0;
+    //! Captured pixels are going from top to bottom
+    bool        topDown     = false;
+    //! Count of frames skipped because encoder was behind
+    unsigned long dropped   = 0;
     uint32_t    delay       = 3;
     double      delayTimer  = 0.0;
     bool        enabled     = false;
-    unsigned char padding[7]= {0, 0, 0, 0, 0, 0, 0};
 } g_gif;
 
+static void gifParallelFor(size_t count, const std::function<void(size_t, size_t)> &body)
+{
+    if(g_gif.quantizers)
+        g_gif.quantizers->parallelFor(count, 1, body);
+    else
+        body(0, count);
+}
+
+static GifFrame *gifTakeFreeFrame()
+{
+    GifFrame *frame = nullptr;
+    SDL_LockMutex(g_gif.mutex);
+    if(!g_gif.freeFrames.empty())
+    {
+        frame = g_gif.freeFrames.back();
+        g_gif.freeFrames.pop_back();
+    }
+    SDL_UnlockMutex(g_gif.mutex);
+    return frame;
+}
+
+static void gifReleaseFrame(GifFrame *frame)
+{
+    SDL_LockMutex(g_gif.mutex);
+    g_gif.freeFrames.push_back(frame);
+    SDL_UnlockMutex(g_gif.mutex);
+}
+
 bool GlRenderer::recordInProcess()
 {
     return g_gif.enabled;
@@ -1171,22 +1325,52 @@ void GlRenderer::toggleRecorder()
                     static_cast<uint32_t>(m_viewport_w),
                     static_cast<uint32_t>(m_viewport_h), g_gif.delay, false))
         {
+            g_gif.width = m_viewport_w;
+            g_gif.height = m_viewport_h;
+            g_gif.topDown = g_renderer->isTopDown();
+            g_gif.dropped = 0;
+            g_gif.delayTimer = 0.0;
+            g_gif.mutex = SDL_CreateMutex();
+            g_gif.freeFrames.clear();
+            for(GifFrame &f : g_gif.frames)
+                g_gif.freeFrames.push_back(&f);
+            g_gif.encoder.reset(new WorkerPool(1));
+            g_gif.quantizers.reset(new WorkerPool());
             g_gif.enabled = true;
             PGE_Audio::playSoundByRole(obj_sound_role::PlayerGrow);
         }
     }
     else
     {
-        #ifndef PGE_NO_THREADING
-        if(g_gif.worker)
-            SDL_WaitThread(g_gif.worker, NULL);
-        g_gif.worker = nullptr;
-        #endif
-        //if(g_gif.mutex)
-        //    SDL_DestroyMutex(g_gif.mutex);
-        //g_gif.mutex = nullptr;
+        // Encode captures which are still in flight
+        if(g_renderer->isAsyncCaptureSupported())
+        {
+            while(true)
+            {
+                GifFrame *frame = gifTakeFreeFrame();
+                if(!frame)
+                {
+                    g_gif.encoder->wait();
+                    frame = gifTakeFreeFrame();
+                }
+                if(!g_renderer->takeScreenPixelsRGBA(frame->pixels, frame->w, frame->h, true))
+                {
+                    gifReleaseFrame(frame);
+                    break;
+                }
+                processRecorder_push(frame);
+            }
+        }
+
+        // Waits until all queued frames are encoded
+        g_gif.encoder.reset();
+        g_gif.quantizers.reset();
         GifEnd(&g_gif.writer);
+        SDL_DestroyMutex(g_gif.mutex);
+        g_gif.mutex = nullptr;
         g_gif.enabled = false;
+        if(g_gif.dropped > 0)
+            pLogDebug("GIF recorder: %lu frames were dropped because encoder was behind", g_gif.dropped);
         PGE_Audio::playSoundByRole(obj_sound_role::PlayerShrink);
     }
 }
@@ -1201,7 +1385,6 @@ void GlRenderer::processRecorder(double ticktime)
         if(g_gif.delayTimer != 0.0)
             return;
 
-        // Make the BYTE array, factor of 3 because it's RBG.
         int w, h;
         SDL_GetWindowSize(PGE_Window::window, &w, &h);
 
@@ -1213,45 +1396,62 @@ void GlRenderer::processRecorder(double ticktime)
 
         w = w - static_cast<int>(m_offset_x) * 2;
         h = h - static_cast<int>(m_offset_y) * 2;
-        uint8_t *pixels = new uint8_t[size_t(4 * w * h)];
-        g_renderer->getScreenPixelsRGBA(static_cast<int>(m_offset_x), static_cast<int>(m_offset_y), w, h, pixels);
-
-        PGE_GL_shoot *shoot = new PGE_GL_shoot();
-        shoot->pixels = pixels;
-        shoot->w = w;
-        shoot->h = h;
-        #ifndef PGE_NO_THREADING
-        if(g_gif.worker)
-            SDL_WaitThread(g_gif.worker, NULL);
-        g_gif.worker = SDL_CreateThread(processRecorder_action, "gif_recorder", reinterpret_cast<void *>(shoot));
-        #else
-        processRecorder_action(reinterpret_cast<void *>(shoot));
-        #endif
+
+        // Encoder is behind, skip the frame instead of waiting for it
+        GifFrame *frame = gifTakeFreeFrame();
+        if(!frame)
+        {
+            g_gif.dropped++;
+            return;
+        }
+
+        if(g_renderer->isAsyncCaptureSupported())
+        {
+            // Capture started by previous frame is already copied, take it and start a new one
+            if(g_renderer->takeScreenPixelsRGBA(frame->pixels, frame->w, frame->h))
+                processRecorder_push(frame);
+            else
+                gifReleaseFrame(frame);
+
+            if(!g_renderer->beginScreenPixelsRGBA(static_cast<int>(m_offset_x), static_cast<int>(m_offset_y), w, h))
+                g_gif.dropped++;
+        }
+        else
+        {
+            frame->pixels.resize(size_t(4 * w * h));
+            frame->w = w;
+            frame->h = h;
+            g_renderer->getScreenPixelsRGBA(static_cast<int>(m_offset_x), static_cast<int>(m_offset_y), w, h, frame->pixels.data());
+            processRecorder_push(frame);
+        }
     }
 }
 
-int GlRenderer::processRecorder_action(void *_pixels)
+void GlRenderer::processRecorder_push(void *_frame)
 {
-    //SDL_LockMutex(g_gif.mutex);
-    PGE_GL_shoot *shoot = reinterpret_cast<PGE_GL_shoot *>(_pixels);
-    FIBITMAP *shotImg = FreeImage_ConvertFromRawBitsEx(false, reinterpret_cast<BYTE *>(shoot->pixels), FIT_BITMAP,
-                                                       shoot->w, shoot->h,
-                                                        4 * shoot->w, 32,
-                                                       0xFF000000, 0x00FF0000, 0x0000FF00, g_renderer->isTopDown());
-    if((shoot->w != m_viewport_w) || (shoot->h != m_viewport_h))
+    GifFrame *frame = reinterpret_cast<GifFrame *>(_frame);
+    g_gif.encoder->push([frame]()->void
+    {
+        processRecorder_action(frame);
+        gifReleaseFrame(frame);
+    });
+}
+
+int GlRenderer::processRecorder_action(void *_frame)
+{
+    GifFrame *frame = reinterpret_cast<GifFrame *>(_frame);
+    // Frame buffer is reused, so bitmap only refers it without copying
+    FIBITMAP *shotImg = FreeImage_ConvertFromRawBitsEx(false, reinterpret_cast<BYTE *>(frame->pixels.data()), FIT_BITMAP,
+                                                       frame->w, frame->h,
+                                                       4 * frame->w, 32,
+                                                       0xFF000000, 0x00FF0000, 0x0000FF00, g_gif.topDown);
+    if((frame->w != g_gif.width) || (frame->h != g_gif.height))
     {
         FIBITMAP *temp;
-        temp = FreeImage_Rescale(shotImg, m_viewport_w, m_viewport_h, FILTER_BOX);
+        temp = FreeImage_Rescale(shotImg, g_gif.width, g_gif.height, FILTER_BOX);
+        FreeImage_Unload(shotImg);
         if(!temp)
-        {
-            FreeImage_Unload(shotImg);
-            delete []shoot->pixels;
-            shoot->pixels = nullptr;
-            delete []shoot;
-            SDL_UnlockMutex(g_gif.mutex);
             return 0;
-        }
-        FreeImage_Unload(shotImg);
         shotImg = temp;
     }
 
@@ -1260,14 +1460,10 @@ int GlRenderer::processRecorder_action(void *_pixels)
 
     uint8_t *img = FreeImage_GetBits(shotImg);
     GifWriteFrame(&g_gif.writer, img,
-                  static_cast<uint32_t>(m_viewport_w),
-                  static_cast<uint32_t>(m_viewport_h),
+                  static_cast<uint32_t>(g_gif.width),
+                  static_cast<uint32_t>(g_gif.height),
                   g_gif.delay/*uint32_t((ticktime)/10.0)*/, 8, false);
     FreeImage_Unload(shotImg);
-    delete[] shoot->pixels;
-    shoot->pixels = nullptr;
-    delete []shoot;
-    //SDL_UnlockMutex(g_gif.mutex);
     return 0;
 }
 
@@ -25,6 +25,7 @@
 #include <common_features/pge_texture.h>
 
 struct SDL_Thread;
+struct FIBITMAP;
 
 class GlRenderer
 {
@@ -43,7 +44,9 @@ public:
         //! OpenGL 3.1 renderer engine
         RENDER_OPENGL_3_1,
         //! Software renderer with using of SDL2 API
-        RENDER_SW_SDL
+        RENDER_SW_SDL,
+        //! Renderer which draws nothing, no window is created (headless mode)
+        RENDER_NULL
     };
 
     /**
@@ -68,6 +71,11 @@ public:
      */
     static void setup_SW_SDL();
 
+    /**
+     * @brief Initialize renderer which draws nothing
+     */
+    static void setup_Null();
+
     /**
      * @brief Get renderer engine name
      * @return string with engine name
@@ -124,7 +132,17 @@ public:
     static void processRecorder(double ticktime);
 
 private:
-    static int  processRecorder_action(void *_pixels);
+    /**
+     * @brief Queue captured frame to the encoder thread
+     * @param _frame Captured frame, returned into the pool when encoded
+     */
+    static void processRecorder_push(void *_frame);
+    /**
+     * @brief Encode captured frame into GIF (GIF/Video recorder)
+     * @param _frame Captured frame
+     * @return Always 0
+     */
+    static int  processRecorder_action(void *_frame);
 
 public:
     /**
@@ -331,6 +349,38 @@ public:
                              std::string maskPath = std::string(),
                              std::string maskFallbackPath = std::string());
 
+    /**
+     * @brief Decode image file and merge it with a mask. Doesn't touch the rendering context,
+     *        so it's safe to call from any thread
+     * @param path Path to image file
+     * @param maskPath Path to bitwise transparency mask (or keep empty)
+     * @param maskFallbackPath Path to fallback (transparent PNG) to extract bitwise mask for given front (or keep empty)
+     * @return 32-bit image ready to be passed into loadTextureImageP(), or null on error
+     */
+    static FIBITMAP *loadTextureImage(std::string path,
+                                      std::string maskPath = std::string(),
+                                      std::string maskFallbackPath = std::string());
+
+    /**
+     * @brief Make texture from an image which was decoded by loadTextureImage()
+     * @param target Destination texture context
+     * @param image Decoded image. Will be closed by this call
+     */
+    static void loadTextureImageP(PGE_Texture &target, FIBITMAP *image);
+
+    /**
+     * @brief Read colors of top and bottom edges of the image into texture context
+     * @param target Destination texture context
+     * @param image Decoded image
+     */
+    static void getTextureEdgeColors(PGE_Texture &target, FIBITMAP *image);
+
+    /**
+     * @brief Size of texture atlas page supported by current renderer
+     * @return Width and height of square atlas page in pixels, or 0 if atlases are not supported
+     */
+    static int  atlasPageSize();
+
     /**
      * @brief Load texture from raw pixels array
      * @param target Destination texture context
@@ -340,6 +390,17 @@ public:
      */
     static void loadRawTextureP(PGE_Texture &target, uint8_t *pixels, uint32_t width, uint32_t height);
 
+    /**
+     * @brief Replace part of already loaded texture by raw pixels
+     * @param target Texture to modify
+     * @param x Left side of the area to replace
+     * @param y Top side of the area to replace
+     * @param pixels Raw RGBA pixels array of the area
+     * @param width Width of the area
+     * @param height Height of the area
+     */
+    static void updateRawTextureP(PGE_Texture &target, int x, int y, uint8_t *pixels, uint32_t width, uint32_t height);
+
     /**
      * @brief Unload the texture
      * @param tx Texture context with texture
@@ -28,6 +28,21 @@ Render_Base::Render_Base(std::string renderer_name) :
 
 Render_Base::~Render_Base() {}
 
+bool Render_Base::isAsyncCaptureSupported()
+{
+    return false;
+}
+
+bool Render_Base::beginScreenPixelsRGBA(int, int, int, int)
+{
+    return false;
+}
+
+bool Render_Base::takeScreenPixelsRGBA(std::vector<unsigned char> &, int &, int &, bool)
+{
+    return false;
+}
+
 const std::string &Render_Base::name()
 {
     return m_renderer_name;
@@ -20,6 +20,7 @@
 #define RENDER_BASE_H
 
 #include <string>
+#include <vector>
 #include <common_features/pge_texture.h>
 #include <common_features/point.h>
 #include <common_features/pointf.h>
@@ -69,6 +70,16 @@ public:
      * \param maskPath mask image file path
      */
     virtual void loadTexture(PGE_Texture &target, uint32_t width, uint32_t height, uint8_t *RGBApixels) = 0;
+    /*!
+     * \brief Replaces part of already loaded texture
+     * \param target texture to modify
+     * \param x Left side of the area to replace
+     * \param y Top side of the area to replace
+     * \param width Width of the area
+     * \param height Height of the area
+     * \param RGBApixels new pixels of the area
+     */
+    virtual void updateTexture(PGE_Texture &target, int x, int y, uint32_t width, uint32_t height, uint8_t *RGBApixels) = 0;
     /*!
      * \brief Deletes target texture
      * \param tx texture to delete
@@ -79,6 +90,11 @@ public:
      * @return true if texture is top-down directed
      */
     virtual bool isTopDown() = 0;
+    /**
+     * @brief Size of texture atlas page which can be used with this renderer
+     * @return Width and height of square atlas page in pixels, or 0 if atlases are not supported
+     */
+    virtual int atlasPageSize() = 0;
     /*!
      * \brief Captures screen surface into 24-bit pixel array
      * \param [__in] x Capture at position x of left side
@@ -97,6 +113,29 @@ public:
      * \param [__out] pixels
      */
     virtual void getScreenPixelsRGBA(int x, int y, int w, int h, unsigned char *pixels) = 0;
+    /*!
+     * \brief Is renderer able to capture screen surface without stalling of the pipeline
+     * \return true if beginScreenPixelsRGBA() and takeScreenPixelsRGBA() are supported
+     */
+    virtual bool isAsyncCaptureSupported();
+    /*!
+     * \brief Starts capture of screen surface into 32-bit pixel array without waiting for it
+     * \param [__in] x Capture at position x of left side
+     * \param [__in] y Capture at position y of top side
+     * \param [__in] w Width from left to right of surface to capture
+     * \param [__in] h Height from top to bottom of surface to capture
+     * \return true if capture was started, false if all capture buffers are busy
+     */
+    virtual bool beginScreenPixelsRGBA(int x, int y, int w, int h);
+    /*!
+     * \brief Takes the oldest capture started by beginScreenPixelsRGBA()
+     * \param [__out] pixels Output pixel array, resized to 4 * w * h bytes of the capture
+     * \param [__out] w Width of the capture
+     * \param [__out] h Height of the capture
+     * \param [__in] wait Take capture even it was started recently, this may stall the pipeline
+     * \return true if pixels were written, false if no capture is ready
+     */
+    virtual bool takeScreenPixelsRGBA(std::vector<unsigned char> &pixels, int &w, int &h, bool wait = false);
     /*!
      * \brief [__in] Returns pixel data from texture into target array
      * \param [__in] tx Pointer to texture
@@ -184,11 +223,16 @@ public:
         return PGE_Texture();
     }
     virtual void loadTexture(PGE_Texture &, uint32_t, uint32_t, uint8_t *) {}
+    virtual void updateTexture(PGE_Texture &, int, int, uint32_t, uint32_t, uint8_t *) {}
     virtual void deleteTexture(PGE_Texture &) {}
     virtual bool isTopDown()
     {
         return false;
     }
+    virtual int atlasPageSize()
+    {
+        return 0;
+    }
     virtual void getScreenPixels(int, int, int, int, unsigned char *) {}
     virtual void getScreenPixelsRGBA(int, int, int, int, unsigned char *) {}
     virtual void getPixelData(const PGE_Texture *, unsigned char *) {}
@@ -0,0 +1,227 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "render_gl_batch.h"
+
+#if defined(RENDER_SUPORT_OPENGL2) || defined(RENDER_SUPORT_OPENGL3)
+
+#include <common_features/logger.h>
+#include <common_features/pge_texture.h>
+
+#include <SDL2/SDL.h> // SDL 2 Library
+#include <SDL2/SDL_opengl.h>
+
+#include "../gl_debug.h"
+
+#define BATCH_VERTEX_OFFSET(field) reinterpret_cast<const GLvoid *>(offsetof(Vertex, field))
+
+Render_GlBatch::Render_GlBatch()
+{
+    m_vertices.reserve(maxQuads * 4);
+    m_indices.resize(maxQuads * 6);
+
+    for(size_t q = 0; q < maxQuads; q++)
+    {
+        GLushort base = static_cast<GLushort>(q * 4);
+        GLushort *idx = m_indices.data() + (q * 6);
+        idx[0] = base + 0;
+        idx[1] = base + 1;
+        idx[2] = base + 2;
+        idx[3] = base + 0;
+        idx[4] = base + 2;
+        idx[5] = base + 3;
+    }
+}
+
+Render_GlBatch::~Render_GlBatch()
+{}
+
+void Render_GlBatch::init()
+{
+    m_vertices.clear();
+    m_texture = 0;
+    m_drawCalls = 0;
+    m_useVBO = false;
+
+    m_glGenBuffers    = reinterpret_cast<PFNGLGENBUFFERSPROC>(SDL_GL_GetProcAddress("glGenBuffers"));
+    m_glDeleteBuffers = reinterpret_cast<PFNGLDELETEBUFFERSPROC>(SDL_GL_GetProcAddress("glDeleteBuffers"));
+    m_glBindBuffer    = reinterpret_cast<PFNGLBINDBUFFERPROC>(SDL_GL_GetProcAddress("glBindBuffer"));
+    m_glBufferData    = reinterpret_cast<PFNGLBUFFERDATAPROC>(SDL_GL_GetProcAddress("glBufferData"));
+    m_glBufferSubData = reinterpret_cast<PFNGLBUFFERSUBDATAPROC>(SDL_GL_GetProcAddress("glBufferSubData"));
+
+    if(m_glGenBuffers && m_glDeleteBuffers && m_glBindBuffer && m_glBufferData && m_glBufferSubData)
+    {
+        m_glGenBuffers(1, &m_vbo);
+        m_glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        m_glBufferData(GL_ARRAY_BUFFER,
+                       static_cast<GLsizeiptr>(maxQuads * 4 * sizeof(Vertex)),
+                       NULL, GL_STREAM_DRAW);
+        m_useVBO = (glGetError() == GL_NO_ERROR);
+        m_glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    if(!m_useVBO && m_vbo)
+    {
+        m_glDeleteBuffers(1, &m_vbo);
+        m_vbo = 0;
+    }
+
+    pLogDebug("GL Sprite batch: %s", m_useVBO ? "streaming VBO" : "client-side arrays");
+}
+
+void Render_GlBatch::uninit()
+{
+    m_vertices.clear();
+    m_texture = 0;
+
+    if(m_vbo && m_glDeleteBuffers)
+        m_glDeleteBuffers(1, &m_vbo);
+
+    m_vbo = 0;
+    m_useVBO = false;
+}
+
+void Render_GlBatch::setTexture(GLuint texture)
+{
+    m_uvLeft = 0.0f;
+    m_uvTop = 0.0f;
+    m_uvWidth = 1.0f;
+    m_uvHeight = 1.0f;
+
+    if(m_texture == texture)
+        return;
+
+    flush();
+    m_texture = texture;
+}
+
+void Render_GlBatch::setTexture(const PGE_Texture &texture)
+{
+    setTexture(texture.texture);
+    m_uvLeft = texture.uv_left;
+    m_uvTop = texture.uv_top;
+    m_uvWidth = texture.uv_right - texture.uv_left;
+    m_uvHeight = texture.uv_bottom - texture.uv_top;
+}
+
+void Render_GlBatch::pushQuad(GLfloat left, GLfloat top, GLfloat right, GLfloat bottom,
+                              GLfloat tx_left, GLfloat tx_top, GLfloat tx_right, GLfloat tx_bottom,
+                              const GLfloat *color)
+{
+    if(m_vertices.size() >= maxQuads * 4)
+        flush();
+
+    tx_left   = m_uvLeft + tx_left * m_uvWidth;
+    tx_right  = m_uvLeft + tx_right * m_uvWidth;
+    tx_top    = m_uvTop + tx_top * m_uvHeight;
+    tx_bottom = m_uvTop + tx_bottom * m_uvHeight;
+
+    const GLfloat r = color[0], g = color[1], b = color[2], a = color[3];
+    m_vertices.push_back({left,  top,    tx_left,  tx_top,    r, g, b, a});
+    m_vertices.push_back({right, top,    tx_right, tx_top,    r, g, b, a});
+    m_vertices.push_back({right, bottom, tx_right, tx_bottom, r, g, b, a});
+    m_vertices.push_back({left,  bottom, tx_left,  tx_bottom, r, g, b, a});
+}
+
+void Render_GlBatch::flush()
+{
+    if(m_vertices.empty())
+        return;
+
+    const GLsizei stride = static_cast<GLsizei>(sizeof(Vertex));
+    const GLsizei quads = static_cast<GLsizei>(m_vertices.size() / 4);
+    const bool textured = (m_texture != 0);
+
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    GLERRORCHECK();
+
+    if(textured)
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        GLERRORCHECK();
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        GLERRORCHECK();
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        GLERRORCHECK();
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        GLERRORCHECK();
+    }
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLERRORCHECK();
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    GLERRORCHECK();
+    glEnableClientState(GL_COLOR_ARRAY);
+    GLERRORCHECK();
+
+    if(textured)
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    else
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    GLERRORCHECK();
+
+    if(m_useVBO)
+    {
+        const GLsizeiptr dataSize = static_cast<GLsizeiptr>(m_vertices.size() * sizeof(Vertex));
+        m_glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        // Orphan previous storage to don't wait while GPU finishes drawing of previous batch
+        m_glBufferData(GL_ARRAY_BUFFER,
+                       static_cast<GLsizeiptr>(maxQuads * 4 * sizeof(Vertex)),
+                       NULL, GL_STREAM_DRAW);
+        m_glBufferSubData(GL_ARRAY_BUFFER, 0, dataSize, m_vertices.data());
+        GLERRORCHECK();
+        glVertexPointer(2, GL_FLOAT, stride, BATCH_VERTEX_OFFSET(x));
+        glColorPointer(4, GL_FLOAT, stride, BATCH_VERTEX_OFFSET(r));
+        if(textured)
+            glTexCoordPointer(2, GL_FLOAT, stride, BATCH_VERTEX_OFFSET(u));
+    }
+    else
+    {
+        const Vertex *v = m_vertices.data();
+        glVertexPointer(2, GL_FLOAT, stride, &v->x);
+        glColorPointer(4, GL_FLOAT, stride, &v->r);
+        if(textured)
+            glTexCoordPointer(2, GL_FLOAT, stride, &v->u);
+    }
+    GLERRORCHECK();
+
+    glDrawElements(GL_TRIANGLES, quads * 6, GL_UNSIGNED_SHORT, m_indices.data());
+    GLERRORCHECK();
+
+    if(m_useVBO)
+        m_glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    GLERRORCHECK();
+
+    m_vertices.clear();
+    m_drawCalls++;
+}
+
+size_t Render_GlBatch::takeDrawCallsCount()
+{
+    size_t calls = m_drawCalls;
+    m_drawCalls = 0;
+    return calls;
+}
+
+#endif //RENDER_SUPORT_OPENGL2 || RENDER_SUPORT_OPENGL3
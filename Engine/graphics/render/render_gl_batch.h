@@ -0,0 +1,154 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RENDER_GL_BATCH_H
+#define RENDER_GL_BATCH_H
+
+#include "render_platform_support.h"
+
+#if defined(RENDER_SUPORT_OPENGL2) || defined(RENDER_SUPORT_OPENGL3)
+
+#include <vector>
+#include <cstddef>
+#include <SDL2/SDL_opengl.h>
+
+struct PGE_Texture;
+
+/*!
+ * \brief Sprite batching stage shared by OpenGL renderers.
+ *
+ * Quads are accumulated into a float vertex array and submitted by one draw call
+ * when the bound texture changes, the capacity is reached, or the renderer
+ * explicitly flushes (viewport change, screen clear, buffer swap, etc.).
+ * When vertex buffer objects are available, vertices are streamed into
+ * a persistent VBO, otherwise client-side arrays are used.
+ */
+class Render_GlBatch
+{
+public:
+    //! Maximal number of quads in one draw call
+    static const size_t maxQuads = 4096;
+
+    Render_GlBatch();
+    ~Render_GlBatch();
+
+    /*!
+     * \brief Initializes the batch. Must be called after GL context was created
+     */
+    void init();
+    /*!
+     * \brief Releases GL resources of the batch. Pending quads are discarded
+     */
+    void uninit();
+
+    /*!
+     * \brief Changes texture for next quads, flushes pending quads when texture changes
+     * \param texture texture handle, or 0 to draw flat-color quads
+     */
+    void setTexture(GLuint texture);
+
+    /*!
+     * \brief Changes texture for next quads, flushes pending quads when texture handle changes
+     *
+     * Texture coordinates of next quads are mapped into sub-rectangle of the texture,
+     * so images packed into same atlas page are drawn by one draw call.
+     * \param texture texture context
+     */
+    void setTexture(const PGE_Texture &texture);
+
+    /*!
+     * \brief Returns texture which is used by pending quads
+     * \return texture handle, or 0 for flat-color quads
+     */
+    GLuint texture() const
+    {
+        return m_texture;
+    }
+
+    /*!
+     * \brief Appends quad into the batch
+     * \param left Left side in GL coordinates
+     * \param top Top side in GL coordinates
+     * \param right Right side in GL coordinates
+     * \param bottom Bottom side in GL coordinates
+     * \param tx_left Left texture side position (between 0.0f and 1.0f)
+     * \param tx_top Top texture side position (between 0.0f and 1.0f)
+     * \param tx_right Right texture side position (between 0.0f and 1.0f)
+     * \param tx_bottom Bottom texture side position (between 0.0f and 1.0f)
+     * \param color Array of four color levels (red, green, blue, alpha)
+     */
+    void pushQuad(GLfloat left, GLfloat top, GLfloat right, GLfloat bottom,
+                  GLfloat tx_left, GLfloat tx_top, GLfloat tx_right, GLfloat tx_bottom,
+                  const GLfloat *color);
+
+    /*!
+     * \brief Submits all pending quads
+     */
+    void flush();
+
+    /*!
+     * \brief Is any quad waiting for submission?
+     * \return true if batch is not empty
+     */
+    bool hasPending() const
+    {
+        return !m_vertices.empty();
+    }
+
+    /*!
+     * \brief Number of draw calls were issued since last call of this function
+     * \return count of draw calls
+     */
+    size_t takeDrawCallsCount();
+
+private:
+    struct Vertex
+    {
+        GLfloat x, y;
+        GLfloat u, v;
+        GLfloat r, g, b, a;
+    };
+
+    //! Pending vertices, four per quad
+    std::vector<Vertex>   m_vertices;
+    //! Pre-built indices to draw quads as triangle pairs
+    std::vector<GLushort> m_indices;
+    //! Texture of pending quads
+    GLuint  m_texture = 0;
+    //! Sub-rectangle of current texture
+    GLfloat m_uvLeft = 0.0f;
+    GLfloat m_uvTop = 0.0f;
+    GLfloat m_uvWidth = 1.0f;
+    GLfloat m_uvHeight = 1.0f;
+    //! Persistent vertex buffer object
+    GLuint  m_vbo = 0;
+    //! Is VBO streaming available?
+    bool    m_useVBO = false;
+    //! Count of issued draw calls
+    size_t  m_drawCalls = 0;
+
+    PFNGLGENBUFFERSPROC     m_glGenBuffers = nullptr;
+    PFNGLDELETEBUFFERSPROC  m_glDeleteBuffers = nullptr;
+    PFNGLBINDBUFFERPROC     m_glBindBuffer = nullptr;
+    PFNGLBUFFERDATAPROC     m_glBufferData = nullptr;
+    PFNGLBUFFERSUBDATAPROC  m_glBufferSubData = nullptr;
+};
+
+#endif //RENDER_SUPORT_OPENGL2 || RENDER_SUPORT_OPENGL3
+
+#endif // RENDER_GL_BATCH_H
@@ -0,0 +1,137 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "render_gl_readback.h"
+
+#if defined(RENDER_SUPORT_OPENGL2) || defined(RENDER_SUPORT_OPENGL3)
+
+#include <common_features/logger.h>
+
+#include <SDL2/SDL.h> // SDL 2 Library
+#include <SDL2/SDL_opengl.h>
+
+#include <cstring>
+
+#include "../gl_debug.h"
+
+Render_GlReadback::Render_GlReadback()
+{}
+
+Render_GlReadback::~Render_GlReadback()
+{}
+
+void Render_GlReadback::init()
+{
+    m_tail = 0;
+    m_pending = 0;
+    m_usePBO = false;
+
+    m_glGenBuffers    = reinterpret_cast<PFNGLGENBUFFERSPROC>(SDL_GL_GetProcAddress("glGenBuffers"));
+    m_glDeleteBuffers = reinterpret_cast<PFNGLDELETEBUFFERSPROC>(SDL_GL_GetProcAddress("glDeleteBuffers"));
+    m_glBindBuffer    = reinterpret_cast<PFNGLBINDBUFFERPROC>(SDL_GL_GetProcAddress("glBindBuffer"));
+    m_glBufferData    = reinterpret_cast<PFNGLBUFFERDATAPROC>(SDL_GL_GetProcAddress("glBufferData"));
+    m_glMapBuffer     = reinterpret_cast<PFNGLMAPBUFFERPROC>(SDL_GL_GetProcAddress("glMapBuffer"));
+    m_glUnmapBuffer   = reinterpret_cast<PFNGLUNMAPBUFFERPROC>(SDL_GL_GetProcAddress("glUnmapBuffer"));
+
+    if(m_glGenBuffers && m_glDeleteBuffers && m_glBindBuffer &&
+       m_glBufferData && m_glMapBuffer && m_glUnmapBuffer)
+    {
+        for(Slot &s : m_slots)
+        {
+            m_glGenBuffers(1, &s.pbo);
+            s.capacity = 0;
+        }
+        m_usePBO = (glGetError() == GL_NO_ERROR);
+    }
+
+    if(!m_usePBO)
+        uninit();
+
+    pLogDebug("GL Screen capture: %s", m_usePBO ? "pixel buffer objects" : "synchronous");
+}
+
+void Render_GlReadback::uninit()
+{
+    for(Slot &s : m_slots)
+    {
+        if(s.pbo && m_glDeleteBuffers)
+            m_glDeleteBuffers(1, &s.pbo);
+        s.pbo = 0;
+        s.capacity = 0;
+    }
+
+    m_tail = 0;
+    m_pending = 0;
+    m_usePBO = false;
+}
+
+bool Render_GlReadback::begin(int x, int y, int w, int h)
+{
+    if(!m_usePBO || (m_pending >= ringSize) || (w <= 0) || (h <= 0))
+        return false;
+
+    Slot &s = m_slots[(m_tail + m_pending) % ringSize];
+    size_t size = static_cast<size_t>(w) * static_cast<size_t>(h) * 4;
+
+    m_glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+    if(s.capacity < size)
+    {
+        m_glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size), NULL, GL_STREAM_READ);
+        s.capacity = size;
+    }
+    // With bound pack buffer the pointer is an offset in the buffer, the call doesn't wait for pixels
+    glReadPixels(x, y, w, h, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    GLERRORCHECK();
+    m_glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    s.w = w;
+    s.h = h;
+    m_pending++;
+    return true;
+}
+
+bool Render_GlReadback::take(std::vector<unsigned char> &pixels, int &w, int &h, bool wait)
+{
+    // Capture of the current frame is still being copied, mapping it now would stall
+    if(!m_usePBO || (m_pending == 0) || (!wait && (m_pending < 2)))
+        return false;
+
+    Slot &s = m_slots[m_tail];
+    size_t size = static_cast<size_t>(s.w) * static_cast<size_t>(s.h) * 4;
+    bool ok = false;
+
+    m_glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+    const unsigned char *mapped = reinterpret_cast<const unsigned char *>(m_glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY));
+    if(mapped)
+    {
+        pixels.resize(size);
+        std::memcpy(pixels.data(), mapped, size);
+        m_glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        w = s.w;
+        h = s.h;
+        ok = true;
+    }
+    m_glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_tail = (m_tail + 1) % ringSize;
+    m_pending--;
+    return ok;
+}
+
+#endif //RENDER_SUPORT_OPENGL2 || RENDER_SUPORT_OPENGL3
@@ -0,0 +1,113 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef RENDER_GL_READBACK_H
+#define RENDER_GL_READBACK_H
+
+#include "render_platform_support.h"
+
+#if defined(RENDER_SUPORT_OPENGL2) || defined(RENDER_SUPORT_OPENGL3)
+
+#include <vector>
+#include <cstddef>
+#include <SDL2/SDL_opengl.h>
+
+/*!
+ * \brief Asynchronous screen capture stage shared by OpenGL renderers.
+ *
+ * Pixels are read into a small ring of pixel buffer objects, so glReadPixels()
+ * returns right away and the driver copies pixels while next frames are drawn.
+ * Capture is mapped into memory one frame after it was started, when copy is finished.
+ */
+class Render_GlReadback
+{
+public:
+    //! Count of pixel buffer objects in the ring
+    static const size_t ringSize = 3;
+
+    Render_GlReadback();
+    ~Render_GlReadback();
+
+    /*!
+     * \brief Initializes the ring. Must be called after GL context was created
+     */
+    void init();
+    /*!
+     * \brief Releases GL resources of the ring. Pending captures are discarded
+     */
+    void uninit();
+
+    /*!
+     * \brief Are pixel buffer objects available?
+     * \return true if captures can be done asynchronously
+     */
+    bool isSupported() const
+    {
+        return m_usePBO;
+    }
+
+    /*!
+     * \brief Starts capture of the current read buffer
+     * \param x Left side in window pixels
+     * \param y Bottom side in window pixels
+     * \param w Width of the capture
+     * \param h Height of the capture
+     * \return true if capture was started, false if every buffer of the ring is busy
+     */
+    bool begin(int x, int y, int w, int h);
+
+    /*!
+     * \brief Copies the oldest capture into the memory and frees its buffer
+     * \param pixels Output RGBA pixel array, resized to fit the capture
+     * \param w Width of the capture
+     * \param h Height of the capture
+     * \param wait Take capture which was started by the latest begin() call too
+     * \return true if pixels were written
+     */
+    bool take(std::vector<unsigned char> &pixels, int &w, int &h, bool wait);
+
+private:
+    struct Slot
+    {
+        GLuint pbo = 0;
+        //! Allocated size of the buffer in bytes
+        size_t capacity = 0;
+        int w = 0;
+        int h = 0;
+    };
+
+    Slot    m_slots[ringSize];
+    //! Index of the oldest pending capture
+    size_t  m_tail = 0;
+    //! Count of pending captures
+    size_t  m_pending = 0;
+    //! Are pixel buffer objects available?
+    bool    m_usePBO = false;
+
+    PFNGLGENBUFFERSPROC     m_glGenBuffers = nullptr;
+    PFNGLDELETEBUFFERSPROC  m_glDeleteBuffers = nullptr;
+    PFNGLBINDBUFFERPROC     m_glBindBuffer = nullptr;
+    PFNGLBUFFERDATAPROC     m_glBufferData = nullptr;
+    PFNGLMAPBUFFERPROC      m_glMapBuffer = nullptr;
+    PFNGLUNMAPBUFFERPROC    m_glUnmapBuffer = nullptr;
+};
+
+#endif //RENDER_SUPORT_OPENGL2 || RENDER_SUPORT_OPENGL3
+
+#endif // RENDER_GL_READBACK_H
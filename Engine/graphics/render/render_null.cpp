@@ -0,0 +1,109 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "render_null.h"
+
+#include <cstring>
+
+Render_Null::Render_Null() : Render_Base("Null"),
+    m_nextTexture(1),
+    m_viewport_w(800),
+    m_viewport_h(600)
+{}
+
+Render_Null::~Render_Null()
+{}
+
+bool Render_Null::init()
+{
+    return true;
+}
+
+bool Render_Null::uninit()
+{
+    return true;
+}
+
+void Render_Null::initDummyTexture()
+{
+    m_dummyTexture.nOfColors = GL_RGBA;
+    m_dummyTexture.format = GL_BGRA;
+    m_dummyTexture.w = 32;
+    m_dummyTexture.h = 32;
+    loadTexture(m_dummyTexture, 32, 32, nullptr);
+}
+
+PGE_Texture Render_Null::getDummyTexture()
+{
+    return m_dummyTexture;
+}
+
+void Render_Null::loadTexture(PGE_Texture &target, uint32_t, uint32_t, uint8_t *)
+{
+    target.texture = m_nextTexture++;
+    target.inited = true;
+}
+
+void Render_Null::deleteTexture(PGE_Texture &tx)
+{
+    tx.inited = false;
+    tx.texture = 0;
+}
+
+void Render_Null::getScreenPixels(int, int, int w, int h, unsigned char *pixels)
+{
+    std::memset(pixels, 0, static_cast<size_t>(w) * static_cast<size_t>(h) * 3);
+}
+
+void Render_Null::getScreenPixelsRGBA(int, int, int w, int h, unsigned char *pixels)
+{
+    std::memset(pixels, 0, static_cast<size_t>(w) * static_cast<size_t>(h) * 4);
+}
+
+void Render_Null::getPixelData(const PGE_Texture *tx, unsigned char *pixelData)
+{
+    if(!tx)
+        return;
+    std::memset(pixelData, 0, static_cast<size_t>(tx->w) * static_cast<size_t>(tx->h) * 4);
+}
+
+void Render_Null::setViewportSize(int w, int h)
+{
+    m_viewport_w = w;
+    m_viewport_h = h;
+}
+
+PGE_Point Render_Null::MapToScr(PGE_Point point)
+{
+    return point;
+}
+
+PGE_Point Render_Null::MapToScr(int x, int y)
+{
+    return PGE_Point(x, y);
+}
+
+int Render_Null::alignToCenterW(int x, int w)
+{
+    return x + (m_viewport_w / 2) - (w / 2);
+}
+
+int Render_Null::alignToCenterH(int y, int h)
+{
+    return y + (m_viewport_h / 2) - (h / 2);
+}
@@ -0,0 +1,93 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RENDER_NULL_H
+#define RENDER_NULL_H
+
+#include "render_base.h"
+
+/*!
+ * \brief Renderer which draws nothing, used by the headless mode.
+ *
+ * Unlike Render_dummy it initializes successfully and keeps sizes and states
+ * of textures, so the game logic which depends on them works the same way
+ * as with a real renderer.
+ */
+class Render_Null : public Render_Base
+{
+public:
+    Render_Null();
+    ~Render_Null();
+
+    virtual void set_SDL_settings() {}
+    virtual unsigned int SDL_InitFlags()
+    {
+        return 0;
+    }
+    virtual bool init();
+    virtual bool uninit();
+    virtual void initDummyTexture();
+    virtual PGE_Texture getDummyTexture();
+    virtual void loadTexture(PGE_Texture &target, uint32_t width, uint32_t height, uint8_t *RGBApixels);
+    virtual void updateTexture(PGE_Texture &, int, int, uint32_t, uint32_t, uint8_t *) {}
+    virtual void deleteTexture(PGE_Texture &tx);
+    virtual bool isTopDown()
+    {
+        return false;
+    }
+    virtual int atlasPageSize()
+    {
+        return 0;
+    }
+    virtual void getScreenPixels(int x, int y, int w, int h, unsigned char *pixels);
+    virtual void getScreenPixelsRGBA(int x, int y, int w, int h, unsigned char *pixels);
+    virtual void getPixelData(const PGE_Texture *tx, unsigned char *pixelData);
+    virtual void setViewport(int, int, int, int) {}
+    virtual void resetViewport() {}
+    virtual void setViewportSize(int w, int h);
+    virtual void setVirtualSurfaceSize(int, int) {}
+    virtual void flush() {}
+    virtual void repaint() {}
+    virtual void setClearColor(float, float, float, float) {}
+    virtual void clearScreen() {}
+
+    virtual void renderRect(float, float, float, float, GLfloat, GLfloat, GLfloat, GLfloat, bool) {}
+    virtual void renderRectBR(float, float, float, float, GLfloat, GLfloat, GLfloat, GLfloat) {}
+    virtual void renderTexture(PGE_Texture *, float, float) {}
+    virtual void renderTexture(PGE_Texture *, float, float, float, float, float, float, float, float) {}
+    virtual void renderTextureCur(float, float, float, float, float, float, float, float) {}
+
+    virtual void BindTexture(PGE_Texture *) {}
+    virtual void setTextureColor(float, float, float, float) {}
+    virtual void UnBindTexture() {}
+
+    virtual PGE_Point MapToScr(PGE_Point point);
+    virtual PGE_Point MapToScr(int x, int y);
+    virtual int  alignToCenterW(int x, int w);
+    virtual int  alignToCenterH(int y, int h);
+
+private:
+    PGE_Texture m_dummyTexture;
+    //! Next number given to the loaded texture, numbers are never reused
+    GLuint      m_nextTexture;
+    //! Resolution of viewport
+    int         m_viewport_w;
+    int         m_viewport_h;
+};
+
+#endif // RENDER_NULL_H
@@ -36,6 +36,7 @@
 #define FREEIMAGE_LIB
 #endif
 #include <FreeImageLite.h>
+#include <algorithm>
 
 static bool g_OpenGL2_convertToPowof2 = false;
 
@@ -167,11 +168,15 @@ bool Render_OpenGL21::init()
     GLERRORCHECK();
     g_OpenGL2_convertToPowof2 = isNonPowOf2Supported();
     pLogDebug("OpenGL 2.1: Non-Pow-of-two textures supported: %d", g_OpenGL2_convertToPowof2);
+    m_batch.init();
+    m_readback.init();
     return true;
 }
 
 bool Render_OpenGL21::uninit()
 {
+    m_batch.uninit();
+    m_readback.uninit();
     glDeleteTextures(1, &(_dummyTexture.texture));
     SDL_GL_DeleteContext(PGE_Window::glcontext);
     return true;
@@ -252,8 +257,28 @@ void Render_OpenGL21::loadTexture(PGE_Texture &target, uint32_t width, uint32_t
         FreeImage_Unload(tempImage);
 }
 
+void Render_OpenGL21::updateTexture(PGE_Texture &target, int x, int y, uint32_t width, uint32_t height, uint8_t *RGBApixels)
+{
+    // Pending quads must be drawn with old content
+    if(m_batch.texture() == target.texture)
+        m_batch.flush();
+    glBindTexture(GL_TEXTURE_2D, target.texture);
+    GLERRORCHECK();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    GLERRORCHECK();
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y,
+                    static_cast<GLsizei>(width),
+                    static_cast<GLsizei>(height),
+                    target.format, GL_UNSIGNED_BYTE, reinterpret_cast<GLubyte *>(RGBApixels));
+    GLERRORCHECK();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    GLERRORCHECK();
+}
+
 void Render_OpenGL21::deleteTexture(PGE_Texture &tx)
 {
+    if(m_batch.texture() == tx.texture)
+        m_batch.setTexture(0);
     glDeleteTextures(1, &(tx.texture));
 }
 
@@ -262,18 +287,46 @@ bool Render_OpenGL21::isTopDown()
     return true;
 }
 
+int Render_OpenGL21::atlasPageSize()
+{
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    GLERRORCHECK();
+    // Keep pages power-of-two and not too big to don't waste video memory
+    return static_cast<int>(std::min<GLint>(maxSize, 2048));
+}
+
 void Render_OpenGL21::getScreenPixels(int x, int y, int w, int h, unsigned char *pixels)
 {
+    m_batch.flush();
     glReadPixels(x, y, w, h, GL_BGR, GL_UNSIGNED_BYTE, pixels);
 }
 
 void Render_OpenGL21::getScreenPixelsRGBA(int x, int y, int w, int h, unsigned char *pixels)
 {
+    m_batch.flush();
     glReadPixels(x, y, w, h, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
 }
 
+bool Render_OpenGL21::isAsyncCaptureSupported()
+{
+    return m_readback.isSupported();
+}
+
+bool Render_OpenGL21::beginScreenPixelsRGBA(int x, int y, int w, int h)
+{
+    m_batch.flush();
+    return m_readback.begin(x, y, w, h);
+}
+
+bool Render_OpenGL21::takeScreenPixelsRGBA(std::vector<unsigned char> &pixels, int &w, int &h, bool wait)
+{
+    return m_readback.take(pixels, w, h, wait);
+}
+
 void Render_OpenGL21::setViewport(int x, int y, int w, int h)
 {
+    m_batch.flush();
     glViewport(static_cast<GLint>(offset_x_draw + x * viewport_scale_x_draw),
                static_cast<GLint>(offset_y_draw + (window_h - (y + h)) * viewport_scale_y_draw),
                static_cast<GLsizei>(w * viewport_scale_x_draw),
@@ -288,6 +341,7 @@ void Render_OpenGL21::resetViewport()
 {
     float w, w1, wd1, h, h1, hd1, wd, hd;
     int   wi, hi, wid, hid;
+    m_batch.flush();
     SDL_GetWindowSize(PGE_Window::window, &wi, &hi);
     SDL_GL_GetDrawableSize(PGE_Window::window, &wid, &hid);
     //Real size of window
@@ -359,11 +413,13 @@ void Render_OpenGL21::setVirtualSurfaceSize(int w, int h)
 
 void Render_OpenGL21::flush()
 {
+    m_batch.flush();
     glFlush();
 }
 
 void Render_OpenGL21::repaint()
 {
+    m_batch.flush();
     SDL_GL_SwapWindow(PGE_Window::window);
 }
 
@@ -375,6 +431,7 @@ void Render_OpenGL21::setClearColor(float r, float g, float b, float a)
 
 void Render_OpenGL21::clearScreen()
 {
+    m_batch.flush();
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     GLERRORCHECK();
 }
@@ -420,6 +477,7 @@ void Render_OpenGL21::getPixelData(const PGE_Texture *tx, unsigned char *pixelDa
     if(!tx)
         return;
 
+    m_batch.flush();
     setRenderTexture((const_cast<PGE_Texture *>(tx))->texture);
     glGetTexImage(GL_TEXTURE_2D, 0, GL_BGRA, GL_UNSIGNED_BYTE, pixelData);
     setUnbindTexture();
@@ -428,15 +486,22 @@ void Render_OpenGL21::getPixelData(const PGE_Texture *tx, unsigned char *pixelDa
 void Render_OpenGL21::renderRect(float x, float y, float w, float h, GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha, bool filled)
 {
     PGE_RectF rect = MapToGl(x, y, w, h);
-    setRenderColors();
-    setAlphaBlending();
-    glColor4f(red, green, blue, alpha);
 
     if(filled)
-        glBegin(GL_QUADS);
-    else
-        glBegin(GL_LINE_LOOP);
+    {
+        GLfloat Colors[] = { red, green, blue, alpha };
+        m_batch.setTexture(0);
+        m_batch.pushQuad(static_cast<GLfloat>(rect.left()),  static_cast<GLfloat>(rect.top()),
+                         static_cast<GLfloat>(rect.right()), static_cast<GLfloat>(rect.bottom()),
+                         0.0f, 0.0f, 0.0f, 0.0f, Colors);
+        return;
+    }
 
+    m_batch.flush();
+    setRenderColors();
+    setAlphaBlending();
+    glColor4f(red, green, blue, alpha);
+    glBegin(GL_LINE_LOOP);
     glVertex2d(rect.left(),  rect.top());
     glVertex2d(rect.right(), rect.top());
     glVertex2d(rect.right(), rect.bottom());
@@ -448,16 +513,11 @@ void Render_OpenGL21::renderRect(float x, float y, float w, float h, GLfloat red
 void Render_OpenGL21::renderRectBR(float _left, float _top, float _right, float _bottom, GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
 {
     PGE_RectF rect = MapToGlSI(_left, _top, _right, _bottom);
-    setRenderColors();
-    setAlphaBlending();
-    glColor4f(red, green, blue, alpha);
-    glBegin(GL_QUADS);
-    glVertex2d(rect.left(),  rect.top());
-    glVertex2d(rect.right(), rect.top());
-    glVertex2d(rect.right(), rect.bottom());
-    glVertex2d(rect.left(),  rect.bottom());
-    glEnd();
-    GLERRORCHECK();
+    GLfloat Colors[] = { red, green, blue, alpha };
+    m_batch.setTexture(0);
+    m_batch.pushQuad(static_cast<GLfloat>(rect.left()),  static_cast<GLfloat>(rect.top()),
+                     static_cast<GLfloat>(rect.right()), static_cast<GLfloat>(rect.bottom()),
+                     0.0f, 0.0f, 0.0f, 0.0f, Colors);
 }
 
 void Render_OpenGL21::renderTexture(PGE_Texture *texture, float x, float y)
@@ -465,21 +525,10 @@ void Render_OpenGL21::renderTexture(PGE_Texture *texture, float x, float y)
     if(!texture) return;
 
     PGE_RectF rect = MapToGl(x, y, static_cast<float>(texture->w), static_cast<float>(texture->h));
-    setRenderTexture(texture->texture);
-    setAlphaBlending();
-    glColor4f(color_binded_texture[0], color_binded_texture[1], color_binded_texture[2], color_binded_texture[3]);
-    glBegin(GL_QUADS);
-    glTexCoord2f(0.0f, 0.0f);
-    glVertex2d(rect.left(),  rect.top());
-    glTexCoord2f(1.0f, 0.0f);
-    glVertex2d(rect.right(), rect.top());
-    glTexCoord2f(1.0f, 1.0f);
-    glVertex2d(rect.right(), rect.bottom());
-    glTexCoord2f(0.0f, 1.0f);
-    glVertex2d(rect.left(),  rect.bottom());
-    glEnd();
-    GLERRORCHECK();
-    setUnbindTexture();
+    m_batch.setTexture(*texture);
+    m_batch.pushQuad(static_cast<GLfloat>(rect.left()),  static_cast<GLfloat>(rect.top()),
+                     static_cast<GLfloat>(rect.right()), static_cast<GLfloat>(rect.bottom()),
+                     0.0f, 0.0f, 1.0f, 1.0f, color_binded_texture);
 }
 
 void Render_OpenGL21::renderTexture(PGE_Texture *texture, float x, float y, float w, float h, float ani_top, float ani_bottom, float ani_left, float ani_right)
@@ -487,44 +536,23 @@ void Render_OpenGL21::renderTexture(PGE_Texture *texture, float x, float y, floa
     if(!texture) return;
 
     PGE_RectF rect = MapToGl(x, y, w, h);
-    setRenderTexture(texture->texture);
-    setAlphaBlending();
-    glColor4f(color_binded_texture[0], color_binded_texture[1], color_binded_texture[2], color_binded_texture[3]);
-    glBegin(GL_QUADS);
-    glTexCoord2f(ani_left, ani_top);
-    glVertex2d(rect.left(),  rect.top());
-    glTexCoord2f(ani_right, ani_top);
-    glVertex2d(rect.right(), rect.top());
-    glTexCoord2f(ani_right, ani_bottom);
-    glVertex2d(rect.right(), rect.bottom());
-    glTexCoord2f(ani_left, ani_bottom);
-    glVertex2d(rect.left(),  rect.bottom());
-    glEnd();
-    GLERRORCHECK();
-    setUnbindTexture();
+    m_batch.setTexture(*texture);
+    m_batch.pushQuad(static_cast<GLfloat>(rect.left()),  static_cast<GLfloat>(rect.top()),
+                     static_cast<GLfloat>(rect.right()), static_cast<GLfloat>(rect.bottom()),
+                     ani_left, ani_top, ani_right, ani_bottom, color_binded_texture);
 }
 
 void Render_OpenGL21::renderTextureCur(float x, float y, float w, float h, float ani_top, float ani_bottom, float ani_left, float ani_right)
 {
     PGE_RectF rect = MapToGl(x, y, w, h);
-    glColor4f(color_binded_texture[0], color_binded_texture[1], color_binded_texture[2], color_binded_texture[3]);
-    glBegin(GL_QUADS);
-    glTexCoord2f(ani_left, ani_top);
-    glVertex2d(rect.left(), rect.top());
-    glTexCoord2f(ani_right, ani_top);
-    glVertex2d(rect.right(), rect.top());
-    glTexCoord2f(ani_right, ani_bottom);
-    glVertex2d(rect.right(), rect.bottom());
-    glTexCoord2f(ani_left, ani_bottom);
-    glVertex2d(rect.left(), rect.bottom());
-    glEnd();
-    GLERRORCHECK();
+    m_batch.pushQuad(static_cast<GLfloat>(rect.left()),  static_cast<GLfloat>(rect.top()),
+                     static_cast<GLfloat>(rect.right()), static_cast<GLfloat>(rect.bottom()),
+                     ani_left, ani_top, ani_right, ani_bottom, color_binded_texture);
 }
 
 void Render_OpenGL21::BindTexture(PGE_Texture *texture)
 {
-    setRenderTexture(texture->texture);
-    setAlphaBlending();
+    m_batch.setTexture(*texture);
 }
 
 void Render_OpenGL21::setTextureColor(float Red, float Green, float Blue, float Alpha)
@@ -537,7 +565,7 @@ void Render_OpenGL21::setTextureColor(float Red, float Green, float Blue, float
 
 void Render_OpenGL21::UnBindTexture()
 {
-    setUnbindTexture();
+    // Texture stays bound to the batch until the next texture change or flush
 }
 
 PGE_RectF Render_OpenGL21::MapToGl(float x, float y, float w, float h)
@@ -21,6 +21,8 @@
 
 #include "render_base.h"
 #include "render_platform_support.h"
+#include "render_gl_batch.h"
+#include "render_gl_readback.h"
 #include <common_features/rectf.h>
 
 #ifdef RENDER_SUPORT_OPENGL2
@@ -36,10 +38,15 @@ class Render_OpenGL21 : public Render_Base
         virtual void initDummyTexture();
         virtual PGE_Texture getDummyTexture();
         virtual void loadTexture(PGE_Texture &target, uint32_t width, uint32_t height, uint8_t *RGBApixels);
+        virtual void updateTexture(PGE_Texture &target, int x, int y, uint32_t width, uint32_t height, uint8_t *RGBApixels);
         virtual void deleteTexture(PGE_Texture &tx);
         virtual bool isTopDown();
+        virtual int  atlasPageSize();
         virtual void getScreenPixels(int x, int y, int w, int h, unsigned char *pixels);
         virtual void getScreenPixelsRGBA(int x, int y, int w, int h, unsigned char *pixels);
+        virtual bool isAsyncCaptureSupported();
+        virtual bool beginScreenPixelsRGBA(int x, int y, int w, int h);
+        virtual bool takeScreenPixelsRGBA(std::vector<unsigned char> &pixels, int &w, int &h, bool wait = false);
         virtual void getPixelData(const PGE_Texture *tx, unsigned char *pixelData);
         virtual void setViewport(int x, int y, int w, int h);
 
@@ -83,6 +90,10 @@ class Render_OpenGL21 : public Render_Base
         int  alignToCenterH(int y, int h);
     private:
         PGE_Texture _dummyTexture;
+        //! Sprite batching stage
+        Render_GlBatch m_batch;
+        //! Asynchronous screen capture stage
+        Render_GlReadback m_readback;
 
         //Virtual resolution of renderable zone
         float window_w = 800.0f;
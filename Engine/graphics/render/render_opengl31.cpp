@@ -36,13 +36,11 @@
 #define FREEIMAGE_LIB
 #endif
 #include <FreeImageLite.h>
+#include <algorithm>
 
 Render_OpenGL31::Render_OpenGL31() : Render_Base("OpenGL 3.1"),
     //Texture render color levels
-    color_binded_texture{1.0f, 1.0f, 1.0f, 1.0f,
-                         1.0f, 1.0f, 1.0f, 1.0f,
-                         1.0f, 1.0f, 1.0f, 1.0f,
-                         1.0f, 1.0f, 1.0f, 1.0f}
+    color_binded_texture{1.0f, 1.0f, 1.0f, 1.0f}
 {}
 
 Render_OpenGL31::~Render_OpenGL31()
@@ -119,11 +117,15 @@ bool Render_OpenGL31::init()
     GLERRORCHECK();
     glEnable(GL_TEXTURE_2D);
     GLERRORCHECK();
+    m_batch.init();
+    m_readback.init();
     return true;
 }
 
 bool Render_OpenGL31::uninit()
 {
+    m_batch.uninit();
+    m_readback.uninit();
     glDeleteTextures(1, &(_dummyTexture.texture));
     SDL_GL_DeleteContext(PGE_Window::glcontext);
     return true;
@@ -176,8 +178,28 @@ void Render_OpenGL31::loadTexture(PGE_Texture &target, uint32_t width, uint32_t
     target.inited = true;
 }
 
+void Render_OpenGL31::updateTexture(PGE_Texture &target, int x, int y, uint32_t width, uint32_t height, uint8_t *RGBApixels)
+{
+    // Pending quads must be drawn with old content
+    if(m_batch.texture() == target.texture)
+        m_batch.flush();
+    glBindTexture(GL_TEXTURE_2D, target.texture);
+    GLERRORCHECK();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    GLERRORCHECK();
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y,
+                    static_cast<GLsizei>(width),
+                    static_cast<GLsizei>(height),
+                    target.format, GL_UNSIGNED_BYTE, reinterpret_cast<GLubyte *>(RGBApixels));
+    GLERRORCHECK();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    GLERRORCHECK();
+}
+
 void Render_OpenGL31::deleteTexture(PGE_Texture &tx)
 {
+    if(m_batch.texture() == tx.texture)
+        m_batch.setTexture(0);
     glDeleteTextures(1, &(tx.texture));
 }
 
@@ -186,18 +208,46 @@ bool Render_OpenGL31::isTopDown()
     return true;
 }
 
+int Render_OpenGL31::atlasPageSize()
+{
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    GLERRORCHECK();
+    // Keep pages power-of-two and not too big to don't waste video memory
+    return static_cast<int>(std::min<GLint>(maxSize, 2048));
+}
+
 void Render_OpenGL31::getScreenPixels(int x, int y, int w, int h, unsigned char *pixels)
 {
+    m_batch.flush();
     glReadPixels(x, y, w, h, GL_BGR, GL_UNSIGNED_BYTE, pixels);
 }
 
 void Render_OpenGL31::getScreenPixelsRGBA(int x, int y, int w, int h, unsigned char *pixels)
 {
+    m_batch.flush();
     glReadPixels(x, y, w, h, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
 }
 
+bool Render_OpenGL31::isAsyncCaptureSupported()
+{
+    return m_readback.isSupported();
+}
+
+bool Render_OpenGL31::beginScreenPixelsRGBA(int x, int y, int w, int h)
+{
+    m_batch.flush();
+    return m_readback.begin(x, y, w, h);
+}
+
+bool Render_OpenGL31::takeScreenPixelsRGBA(std::vector<unsigned char> &pixels, int &w, int &h, bool wait)
+{
+    return m_readback.take(pixels, w, h, wait);
+}
+
 void Render_OpenGL31::setViewport(int x, int y, int w, int h)
 {
+    m_batch.flush();
     glViewport(static_cast<GLint>(offset_x_draw + x * viewport_scale_x_draw),
                static_cast<GLint>(offset_y_draw + (window_h - (y + h)) * viewport_scale_y_draw),
                static_cast<GLsizei>(w * viewport_scale_x_draw),
@@ -212,6 +262,7 @@ void Render_OpenGL31::resetViewport()
 {
     float w, w1, wd1, h, h1, hd1, wd, hd;
     int   wi, hi, wid, hid;
+    m_batch.flush();
     SDL_GetWindowSize(PGE_Window::window, &wi, &hi);
     SDL_GL_GetDrawableSize(PGE_Window::window, &wid, &hid);
     //Real size of window
@@ -283,11 +334,13 @@ void Render_OpenGL31::setVirtualSurfaceSize(int w, int h)
 
 void Render_OpenGL31::flush()
 {
+    m_batch.flush();
     glFlush();
 }
 
 void Render_OpenGL31::repaint()
 {
+    m_batch.flush();
     SDL_GL_SwapWindow(PGE_Window::window);
 }
 
@@ -299,6 +352,7 @@ void Render_OpenGL31::setClearColor(float r, float g, float b, float a)
 
 void Render_OpenGL31::clearScreen()
 {
+    m_batch.flush();
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     GLERRORCHECK();
 }
@@ -358,6 +412,7 @@ void Render_OpenGL31::getPixelData(const PGE_Texture *tx, unsigned char *pixelDa
     if(!tx)
         return;
 
+    m_batch.flush();
     setRenderTexture(const_cast<PGE_Texture *>(tx)->texture);
     glGetTexImage(GL_TEXTURE_2D, 0, GL_BGRA, GL_UNSIGNED_BYTE, pixelData);
     setUnbindTexture();
@@ -366,45 +421,18 @@ void Render_OpenGL31::getPixelData(const PGE_Texture *tx, unsigned char *pixelDa
 void Render_OpenGL31::renderRect(float x, float y, float w, float h, GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha, bool filled)
 {
     PGE_RectF rect = MapToGl(x, y, w, h);
-    setRenderColors();
-    setAlphaBlending();
-    GLdouble Vertices[] =
-    {
-        rect.left(),  rect.top(), 0,
-        rect.right(), rect.top(), 0,
-        rect.right(), rect.bottom(), 0,
-        rect.left(),  rect.bottom(), 0
-    };
-    GLfloat Colors[] = { red, green, blue, alpha,
-                         red, green, blue, alpha,
-                         red, green, blue, alpha,
-                         red, green, blue, alpha
-                       };
-    glVertexPointer(3, GL_DOUBLE, 0, Vertices);
-    GLERRORCHECK();
-    glColorPointer(4, GL_FLOAT, 0, Colors);
-    GLERRORCHECK();
+    GLfloat Colors[] = { red, green, blue, alpha };
 
     if(filled)
     {
-        GLubyte indices[] =
-        {
-            0, 1, 2,
-            0, 2, 3
-        };
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_BYTE, indices);
-        GLERRORCHECK();
-    }
-    else
-    {
-        glDrawArrays(GL_LINE_LOOP, 0, 4);
-        GLERRORCHECK();
+        m_batch.setTexture(0);
+        m_batch.pushQuad(static_cast<GLfloat>(rect.left()),  static_cast<GLfloat>(rect.top()),
+                         static_cast<GLfloat>(rect.right()), static_cast<GLfloat>(rect.bottom()),
+                         0.0f, 0.0f, 0.0f, 0.0f, Colors);
+        return;
     }
-}
 
-void Render_OpenGL31::renderRectBR(float _left, float _top, float _right, float _bottom, GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
-{
-    PGE_RectF rect = MapToGlSI(_left, _top, _right, _bottom);
+    m_batch.flush();
     setRenderColors();
     setAlphaBlending();
     GLdouble Vertices[] =
@@ -414,58 +442,41 @@ void Render_OpenGL31::renderRectBR(float _left, float _top, float _right, float
         rect.right(), rect.bottom(), 0,
         rect.left(),  rect.bottom(), 0
     };
-    GLfloat Colors[] = { red, green, blue, alpha,
-                         red, green, blue, alpha,
-                         red, green, blue, alpha,
-                         red, green, blue, alpha
-                       };
-    GLubyte indices[] =
-    {
-        0, 1, 2,
-        0, 2, 3
-    };
+    GLfloat LineColors[] = { red, green, blue, alpha,
+                             red, green, blue, alpha,
+                             red, green, blue, alpha,
+                             red, green, blue, alpha
+                           };
     glVertexPointer(3, GL_DOUBLE, 0, Vertices);
     GLERRORCHECK();
-    glColorPointer(4, GL_FLOAT, 0, Colors);
+    glColorPointer(4, GL_FLOAT, 0, LineColors);
     GLERRORCHECK();
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_BYTE, indices);
+    glDrawArrays(GL_LINE_LOOP, 0, 4);
+    GLERRORCHECK();
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
     GLERRORCHECK();
 }
 
+void Render_OpenGL31::renderRectBR(float _left, float _top, float _right, float _bottom, GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+    PGE_RectF rect = MapToGlSI(_left, _top, _right, _bottom);
+    GLfloat Colors[] = { red, green, blue, alpha };
+    m_batch.setTexture(0);
+    m_batch.pushQuad(static_cast<GLfloat>(rect.left()),  static_cast<GLfloat>(rect.top()),
+                     static_cast<GLfloat>(rect.right()), static_cast<GLfloat>(rect.bottom()),
+                     0.0f, 0.0f, 0.0f, 0.0f, Colors);
+}
+
 void Render_OpenGL31::renderTexture(PGE_Texture *texture, float x, float y)
 {
     if(!texture) return;
 
     PGE_RectF rect = MapToGl(x, y, static_cast<float>(texture->w), static_cast<float>(texture->h));
-    setRenderTexture(texture->texture);
-    setAlphaBlending();
-    GLdouble Vertices[] =
-    {
-        rect.left(),  rect.top(), 0,
-        rect.right(), rect.top(), 0,
-        rect.right(), rect.bottom(), 0,
-        rect.left(),  rect.bottom(), 0
-    };
-    GLfloat TexCoord[] =
-    {
-        0.0f, 0.0f,
-        1.0f, 0.0f,
-        1.0f, 1.0f,
-        0.0f, 1.0f
-    };
-    GLubyte indices[] =
-    {
-        0, 1, 3, 2
-    };
-    glColorPointer(4, GL_FLOAT, 0, color_binded_texture);
-    GLERRORCHECK();
-    glVertexPointer(3, GL_DOUBLE, 0, Vertices);
-    GLERRORCHECK();
-    glTexCoordPointer(2, GL_FLOAT, 0, TexCoord);
-    GLERRORCHECK();
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_BYTE, indices);
-    GLERRORCHECK();
-    setUnbindTexture();
+    m_batch.setTexture(*texture);
+    m_batch.pushQuad(static_cast<GLfloat>(rect.left()),  static_cast<GLfloat>(rect.top()),
+                     static_cast<GLfloat>(rect.right()), static_cast<GLfloat>(rect.bottom()),
+                     0.0f, 0.0f, 1.0f, 1.0f, color_binded_texture);
 }
 
 void Render_OpenGL31::renderTexture(PGE_Texture *texture, float x, float y, float w, float h, float ani_top, float ani_bottom, float ani_left, float ani_right)
@@ -473,85 +484,36 @@ void Render_OpenGL31::renderTexture(PGE_Texture *texture, float x, float y, floa
     if(!texture) return;
 
     PGE_RectF rect = MapToGl(x, y, w, h);
-    setRenderTexture(texture->texture);
-    setAlphaBlending();
-    GLdouble Vertices[] =
-    {
-        rect.left(),  rect.top(), 0,
-        rect.right(), rect.top(), 0,
-        rect.right(), rect.bottom(), 0,
-        rect.left(),  rect.bottom(), 0
-    };
-    GLfloat TexCoord[] =
-    {
-        ani_left, ani_top,
-        ani_right, ani_top,
-        ani_right, ani_bottom,
-        ani_left, ani_bottom
-    };
-    GLubyte indices[] =
-    {
-        0, 1, 3, 2
-    };
-    glColorPointer(4, GL_FLOAT, 0, color_binded_texture);
-    GLERRORCHECK();
-    glVertexPointer(3, GL_DOUBLE, 0, Vertices);
-    GLERRORCHECK();
-    glTexCoordPointer(2, GL_FLOAT, 0, TexCoord);
-    GLERRORCHECK();
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_BYTE, indices);
-    GLERRORCHECK();
-    setUnbindTexture();
+    m_batch.setTexture(*texture);
+    m_batch.pushQuad(static_cast<GLfloat>(rect.left()),  static_cast<GLfloat>(rect.top()),
+                     static_cast<GLfloat>(rect.right()), static_cast<GLfloat>(rect.bottom()),
+                     ani_left, ani_top, ani_right, ani_bottom, color_binded_texture);
 }
 
 void Render_OpenGL31::renderTextureCur(float x, float y, float w, float h, float ani_top, float ani_bottom, float ani_left, float ani_right)
 {
     PGE_RectF rect = MapToGl(x, y, w, h);
-    GLdouble Vertices[] =
-    {
-        rect.left(),  rect.top(), 0,
-        rect.right(), rect.top(), 0,
-        rect.right(), rect.bottom(), 0,
-        rect.left(),  rect.bottom(), 0
-    };
-    GLfloat TexCoord[] =
-    {
-        ani_left, ani_top,
-        ani_right, ani_top,
-        ani_right, ani_bottom,
-        ani_left, ani_bottom
-    };
-    GLubyte indices[] = { 0, 1, 3, 2 };
-    glColorPointer(4, GL_FLOAT, 0, color_binded_texture);
-    GLERRORCHECK();
-    glVertexPointer(3, GL_DOUBLE, 0, Vertices);
-    GLERRORCHECK();
-    glTexCoordPointer(2, GL_FLOAT, 0, TexCoord);
-    GLERRORCHECK();
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_BYTE, indices);
-    GLERRORCHECK();
+    m_batch.pushQuad(static_cast<GLfloat>(rect.left()),  static_cast<GLfloat>(rect.top()),
+                     static_cast<GLfloat>(rect.right()), static_cast<GLfloat>(rect.bottom()),
+                     ani_left, ani_top, ani_right, ani_bottom, color_binded_texture);
 }
 
 void Render_OpenGL31::BindTexture(PGE_Texture *texture)
 {
-    setRenderTexture(texture->texture);
-    setAlphaBlending();
+    m_batch.setTexture(*texture);
 }
 
 void Render_OpenGL31::setTextureColor(float Red, float Green, float Blue, float Alpha)
 {
-    for(int i = 0; i < 4; i++)
-    {
-        color_binded_texture[i * 4 + 0] = Red;
-        color_binded_texture[i * 4 + 1] = Green;
-        color_binded_texture[i * 4 + 2] = Blue;
-        color_binded_texture[i * 4 + 3] = Alpha;
-    }
+    color_binded_texture[0] = Red;
+    color_binded_texture[1] = Green;
+    color_binded_texture[2] = Blue;
+    color_binded_texture[3] = Alpha;
 }
 
 void Render_OpenGL31::UnBindTexture()
 {
-    setUnbindTexture();
+    // Texture stays bound to the batch until the next texture change or flush
 }
 
 PGE_RectF Render_OpenGL31::MapToGl(float x, float y, float w, float h)
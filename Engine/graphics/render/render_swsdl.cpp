@@ -183,6 +183,41 @@ checkStackAgain:
     target.inited = true;
 }
 
+void Render_SW_SDL::updateTexture(PGE_Texture &target, int x, int y, uint32_t width, uint32_t height, uint8_t *RGBApixels)
+{
+    if(target.texture >= m_textureBank.size())
+        return;
+
+    SDL_Texture *texture = m_textureBank[target.texture];
+    if(!texture)
+        return;
+
+    Uint32 format = 0;
+    SDL_QueryTexture(texture, &format, NULL, NULL, NULL);
+
+    SDL_Surface *surface = SDL_CreateRGBSurfaceFrom(RGBApixels,
+                                                    static_cast<int>(width),
+                                                    static_cast<int>(height),
+                                                    32,
+                                                    static_cast<int>(width * 4),
+                                                    FI_RGBA_RED_MASK,
+                                                    FI_RGBA_GREEN_MASK,
+                                                    FI_RGBA_BLUE_MASK,
+                                                    FI_RGBA_ALPHA_MASK);
+    //Texture is taking pixels in its own format only
+    SDL_Surface *converted = SDL_ConvertSurfaceFormat(surface, format, 0);
+    SDL_FreeSurface(surface);
+    if(!converted)
+    {
+        pLogWarning("Render SW-SDL: Failed to update texture!");
+        return;
+    }
+
+    SDL_Rect rect = {x, y, static_cast<int>(width), static_cast<int>(height)};
+    SDL_UpdateTexture(texture, &rect, converted->pixels, converted->pitch);
+    SDL_FreeSurface(converted);
+}
+
 void Render_SW_SDL::deleteTexture(PGE_Texture &tx)
 {
     if(tx.texture >= m_textureBank.size())
@@ -220,6 +255,12 @@ bool Render_SW_SDL::isTopDown()
     return false;
 }
 
+int Render_SW_SDL::atlasPageSize()
+{
+    // Source rectangles are calculated from whole texture, atlas pages are not supported
+    return 0;
+}
+
 void Render_SW_SDL::getScreenPixels(int x, int y, int w, int h, unsigned char *pixels)
 {
     SDL_Rect rect;
@@ -45,8 +45,10 @@ class Render_SW_SDL : public Render_Base
         virtual void initDummyTexture();
         virtual PGE_Texture getDummyTexture();
         virtual void loadTexture(PGE_Texture &target, uint32_t width, uint32_t height, uint8_t *RGBApixels);
+        virtual void updateTexture(PGE_Texture &target, int x, int y, uint32_t width, uint32_t height, uint8_t *RGBApixels);
         virtual void deleteTexture(PGE_Texture &tx);
         virtual bool isTopDown();
+        virtual int  atlasPageSize();
         virtual void getScreenPixels(int x, int y, int w, int h, unsigned char *pixels);
         virtual void getScreenPixelsRGBA(int x, int y, int w, int h, unsigned char *pixels);
         virtual void getPixelData(const PGE_Texture *tx, unsigned char *pixelData);
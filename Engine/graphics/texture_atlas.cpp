@@ -0,0 +1,318 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "texture_atlas.h"
+#include "gl_renderer.h"
+#include <common_features/graphics_funcs.h>
+#include <common_features/worker_pool.h>
+#include <common_features/logger.h>
+
+#ifdef _WIN32
+#define FREEIMAGE_LIB
+#endif
+#include <FreeImageLite.h>
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef DEBUG_BUILD
+#include <Utils/elapsed_timer.h>
+#endif
+
+//! Transparent gap between packed images to avoid bleeding of neighbours
+static const int g_atlasPadding = 1;
+
+static int pow2roundup(int x)
+{
+    int p = 1;
+    while(p < x)
+        p <<= 1;
+    return p;
+}
+
+/*!
+ * \brief Layout of the page which is filled by shelves of images
+ */
+struct AtlasPageLayout
+{
+    int shelfX = 0;
+    int shelfY = 0;
+    int shelfH = 0;
+    std::vector<size_t> items;
+
+    bool tryPlace(int pageSize, int w, int h, int &x, int &y)
+    {
+        if((shelfX + w <= pageSize) && (h <= shelfH))
+        {
+            x = shelfX;
+            y = shelfY;
+            shelfX += w;
+            return true;
+        }
+
+        // Start a new shelf under the current one
+        int newShelfY = shelfY + shelfH;
+        if((w <= pageSize) && (newShelfY + h <= pageSize))
+        {
+            shelfY = newShelfY;
+            shelfH = h;
+            x = 0;
+            y = shelfY;
+            shelfX = w;
+            return true;
+        }
+
+        return false;
+    }
+
+    int usedHeight() const
+    {
+        return shelfY + shelfH;
+    }
+};
+
+TextureAtlas::TextureAtlas()
+{}
+
+TextureAtlas::~TextureAtlas()
+{
+    // Pages are owned by rendering context, they are deleted by clear() call
+    for(Entry &e : m_entries)
+    {
+        if(e.image)
+            GraphicsHelps::closeImage(e.image);
+    }
+}
+
+std::string TextureAtlas::makeKey(const std::string &path, const std::string &maskPath)
+{
+    return path + '|' + maskPath;
+}
+
+void TextureAtlas::addImage(const std::string &path,
+                            const std::string &maskPath,
+                            const std::string &maskFallbackPath)
+{
+    if(path.empty())
+        return;
+
+    std::string key = makeKey(path, maskPath);
+    if(m_entriesMap.find(key) != m_entriesMap.end())
+        return;
+
+    Entry e;
+    e.path = path;
+    e.maskPath = maskPath;
+    e.maskFallbackPath = maskFallbackPath;
+    m_entriesMap.insert({key, m_entries.size()});
+    m_entries.push_back(e);
+}
+
+void TextureAtlas::build(int pageSize, const std::function<void()> &idle)
+{
+    #ifdef DEBUG_BUILD
+    ElapsedTimer totalTime;
+    totalTime.start();
+    #endif
+
+    const int maxSide = pageSize / maxImageDivider;
+    std::vector<size_t> queue;
+
+    // Decode images which are was not processed yet
+    {
+        WorkerPool pool;
+        for(size_t i = 0; i < m_entries.size(); i++)
+        {
+            Entry &e = m_entries[i];
+            if(e.processed)
+                continue;
+
+            e.processed = true;
+            // Every job writes into it's own entry only
+            pool.push([&e, maxSide]()->void
+            {
+                e.image = GlRenderer::loadTextureImage(e.path, e.maskPath, e.maskFallbackPath);
+                if(!e.image)
+                    return;
+
+                e.w = static_cast<int>(FreeImage_GetWidth(e.image));
+                e.h = static_cast<int>(FreeImage_GetHeight(e.image));
+                if((e.w > maxSide) || (e.h > maxSide))
+                    return; // Too big image, it will be uploaded as standalone texture
+
+                PGE_Texture colors;
+                GlRenderer::getTextureEdgeColors(colors, e.image);
+                e.colorUpper = colors.ColorUpper;
+                e.colorLower = colors.ColorLower;
+                FreeImage_FlipVertical(e.image);
+                e.packable = true;
+            });
+        }
+
+        // Keep main thread alive (loading animation, window events) while decoding
+        while(!pool.wait(idle ? 15 : -1))
+            idle();
+    }
+
+    for(size_t i = 0; i < m_entries.size(); i++)
+    {
+        Entry &e = m_entries[i];
+        if(e.packable && e.image && (e.page < 0))
+            queue.push_back(i);
+    }
+
+    if(queue.empty())
+        return;
+
+    // Tallest images first to keep shelves dense
+    std::sort(queue.begin(), queue.end(), [this](size_t a, size_t b)->bool
+    {
+        const Entry &ea = m_entries[a];
+        const Entry &eb = m_entries[b];
+        if(ea.h != eb.h)
+            return ea.h > eb.h;
+        return ea.w > eb.w;
+    });
+
+    std::vector<AtlasPageLayout> layouts;
+
+    for(size_t idx : queue)
+    {
+        Entry &e = m_entries[idx];
+        int w = e.w + g_atlasPadding;
+        int h = e.h + g_atlasPadding;
+        bool placed = false;
+
+        for(size_t p = 0; p < layouts.size(); p++)
+        {
+            if(layouts[p].tryPlace(pageSize, w, h, e.x, e.y))
+            {
+                layouts[p].items.push_back(idx);
+                e.page = static_cast<int>(m_pages.size() + p);
+                placed = true;
+                break;
+            }
+        }
+
+        if(!placed)
+        {
+            layouts.emplace_back();
+            layouts.back().tryPlace(pageSize, w, h, e.x, e.y);
+            layouts.back().items.push_back(idx);
+            e.page = static_cast<int>(m_pages.size() + layouts.size() - 1);
+        }
+    }
+
+    // Compose and upload pages
+    for(AtlasPageLayout &layout : layouts)
+    {
+        int pageW = pageSize;
+        int pageH = std::min(pow2roundup(layout.usedHeight()), pageSize);
+        size_t pitch = static_cast<size_t>(pageW) * 4;
+        std::vector<uint8_t> pixels(pitch * static_cast<size_t>(pageH), 0);
+
+        for(size_t idx : layout.items)
+        {
+            Entry &e = m_entries[idx];
+            size_t line = static_cast<size_t>(e.w) * 4;
+            for(int y = 0; y < e.h; y++)
+            {
+                uint8_t *dst = pixels.data() + pitch * static_cast<size_t>(e.y + y)
+                               + static_cast<size_t>(e.x) * 4;
+                memcpy(dst, FreeImage_GetScanLine(e.image, y), line);
+            }
+            GraphicsHelps::closeImage(e.image);
+            e.image = nullptr;
+        }
+
+        PGE_Texture page;
+        page.nOfColors = GL_RGBA;
+        page.format = GL_BGRA;
+        GlRenderer::loadRawTextureP(page, pixels.data(),
+                                    static_cast<uint32_t>(pageW),
+                                    static_cast<uint32_t>(pageH));
+        m_pages.push_back(page);
+    }
+
+    if(idle)
+        idle();
+
+    pLogDebug("Texture atlas: %d images packed into %d pages of %dx%d",
+              static_cast<int>(queue.size()),
+              static_cast<int>(layouts.size()),
+              pageSize, pageSize);
+    #ifdef DEBUG_BUILD
+    pLogDebug("Texture atlas: built in %d milliseconds", static_cast<int>(totalTime.elapsed()));
+    #endif
+}
+
+bool TextureAtlas::take(PGE_Texture &target, const std::string &path, const std::string &maskPath)
+{
+    auto it = m_entriesMap.find(makeKey(path, maskPath));
+    if(it == m_entriesMap.end())
+        return false;
+
+    Entry &e = m_entries[it->second];
+    if(e.page < 0)
+    {
+        if(!e.image)
+            return false;
+        // Upload pre-decoded image as standalone texture
+        GlRenderer::loadTextureImageP(target, e.image);
+        e.image = nullptr;
+        return true;
+    }
+
+    const PGE_Texture &page = m_pages[static_cast<size_t>(e.page)];
+    target = PGE_Texture();
+    target.texture = page.texture;
+    target.inited = true;
+    target.nOfColors = page.nOfColors;
+    target.format = page.format;
+    target.w = e.w;
+    target.h = e.h;
+    target.frame_w = e.w;
+    target.frame_h = e.h;
+    target.ColorUpper = e.colorUpper;
+    target.ColorLower = e.colorLower;
+    target.atlas_member = true;
+    target.atlas_x = e.x;
+    target.atlas_y = e.y;
+    target.atlas_w = page.w;
+    target.atlas_h = page.h;
+    target.uv_left   = static_cast<GLfloat>(e.x) / static_cast<GLfloat>(page.w);
+    target.uv_top    = static_cast<GLfloat>(e.y) / static_cast<GLfloat>(page.h);
+    target.uv_right  = static_cast<GLfloat>(e.x + e.w) / static_cast<GLfloat>(page.w);
+    target.uv_bottom = static_cast<GLfloat>(e.y + e.h) / static_cast<GLfloat>(page.h);
+    return true;
+}
+
+void TextureAtlas::clear()
+{
+    for(PGE_Texture &page : m_pages)
+        GlRenderer::deleteTexture(page);
+    m_pages.clear();
+
+    for(Entry &e : m_entries)
+    {
+        if(e.image)
+            GraphicsHelps::closeImage(e.image);
+    }
+    m_entries.clear();
+    m_entriesMap.clear();
+}
@@ -0,0 +1,123 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <common_features/pge_texture.h>
+
+struct FIBITMAP;
+
+/*!
+ * \brief Packs many small images into few shared texture pages
+ *
+ * Images are queued by addImage(), then build() decodes them on worker threads,
+ * packs them into pages with a shelf algorithm and uploads every page as a single
+ * texture. Textures taken from the atlas via take() are referring the shared page
+ * with UV sub-rectangle, so sprites of the same page are drawn by one draw call.
+ * Images which are too big for the page (or all images when renderer doesn't
+ * support atlases) are kept decoded and uploaded as standalone textures by take().
+ */
+class TextureAtlas
+{
+public:
+    TextureAtlas();
+    ~TextureAtlas();
+
+    /*!
+     * \brief Queue image to be packed by next build() call
+     * \param path Path to image file
+     * \param maskPath Path to bitwise transparency mask (or keep empty)
+     * \param maskFallbackPath Path to fallback (transparent PNG) to extract bitwise mask for given front (or keep empty)
+     */
+    void addImage(const std::string &path,
+                  const std::string &maskPath = std::string(),
+                  const std::string &maskFallbackPath = std::string());
+
+    /*!
+     * \brief Decode all queued images, pack them and upload atlas pages
+     * \param pageSize Width and height of atlas page. When 0, images are only decoded
+     * \param idle Function to call from the main thread periodically while images are decoding
+     */
+    void build(int pageSize, const std::function<void()> &idle = nullptr);
+
+    /*!
+     * \brief Take texture of decoded image
+     * \param target Destination texture context
+     * \param path Path to image file
+     * \param maskPath Path to bitwise transparency mask
+     * \return true if target was initialized, false if image must be loaded by regular way
+     */
+    bool take(PGE_Texture &target, const std::string &path, const std::string &maskPath = std::string());
+
+    /*!
+     * \brief Delete all atlas pages and forget all images
+     */
+    void clear();
+
+    /*!
+     * \brief Count of uploaded atlas pages
+     * \return count of pages
+     */
+    size_t pagesCount() const
+    {
+        return m_pages.size();
+    }
+
+    /*!
+     * \brief Maximal size of image side which is allowed to be packed, relative to the page size
+     */
+    static const int maxImageDivider = 2;
+
+private:
+    struct Entry
+    {
+        std::string path;
+        std::string maskPath;
+        std::string maskFallbackPath;
+        //! Decoded image, kept until it will be packed or taken as standalone texture
+        FIBITMAP *image = nullptr;
+        //! Was image already processed by build()?
+        bool processed = false;
+        //! Image is fit into atlas page
+        bool packable = false;
+        //! Index of the page, or -1 if image is not packed
+        int page = -1;
+        int x = 0;
+        int y = 0;
+        int w = 0;
+        int h = 0;
+        PGEColor colorUpper;
+        PGEColor colorLower;
+    };
+
+    static std::string makeKey(const std::string &path, const std::string &maskPath);
+
+    //! Packed and queued images
+    std::vector<Entry> m_entries;
+    //! Index of entries by image and mask paths
+    std::unordered_map<std::string, size_t> m_entriesMap;
+    //! Uploaded pages
+    std::vector<PGE_Texture> m_pages;
+};
+
+#endif // TEXTURE_ATLAS_H
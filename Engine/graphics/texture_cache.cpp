@@ -0,0 +1,262 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "texture_cache.h"
+#include "gl_renderer.h"
+#include <common_features/md5.h>
+#include <common_features/logger.h>
+#include <FileMapper/file_mapper.h>
+#include <DirManager/dirman.h>
+#include <Utils/files.h>
+
+#include <SDL2/SDL_thread.h>
+
+#ifdef _WIN32
+#define FREEIMAGE_LIB
+#endif
+#include <FreeImageLite.h>
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+std::string TextureCache::m_cacheDir;
+bool        TextureCache::m_enabled = false;
+
+static const char g_cacheMagic[8] = {'P', 'G', 'E', 'T', 'X', 'C', '1', '\0'};
+
+/*!
+ * \brief Header of the cache file. Followed by the key string and raw pixels data
+ */
+struct TextureCacheHeader
+{
+    char     magic[8];
+    uint32_t width;
+    uint32_t height;
+    float    colorUpper[3];
+    float    colorLower[3];
+    uint32_t keySize;
+    //! Offset of pixels data from begin of the file
+    uint32_t dataOffset;
+};
+
+/*!
+ * \brief Map cache file and validate it
+ * \param map File mapper
+ * \param file Path to cache file
+ * \param key Expected key of the entry
+ * \return Pointer to the header of mapped entry, or null if entry is missing or invalid
+ */
+static const TextureCacheHeader *mapEntry(FileMapper &map, const std::string &file, const std::string &key)
+{
+    if(!Files::fileExists(file))
+        return nullptr;
+
+    if(!map.open_file(file))
+        return nullptr;
+
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(map.data());
+    uint64_t size = map.size();
+
+    if(size < sizeof(TextureCacheHeader))
+        return nullptr;
+
+    const TextureCacheHeader *h = reinterpret_cast<const TextureCacheHeader *>(data);
+    uint64_t pixelsSize = uint64_t(h->width) * uint64_t(h->height) * 4;
+
+    if((memcmp(h->magic, g_cacheMagic, sizeof(g_cacheMagic)) != 0) ||
+       (h->width == 0) || (h->height == 0) ||
+       (h->keySize != key.size()) ||
+       (uint64_t(sizeof(TextureCacheHeader)) + h->keySize > h->dataOffset) ||
+       (uint64_t(h->dataOffset) + pixelsSize > size))
+        return nullptr;
+
+    if(memcmp(data + sizeof(TextureCacheHeader), key.data(), key.size()) != 0)
+        return nullptr; // Hash collision
+
+    return h;
+}
+
+void TextureCache::init(const std::string &cacheDir)
+{
+    m_cacheDir = cacheDir;
+    m_enabled = false;
+
+    if(m_cacheDir.empty())
+        return;
+
+    if(!DirMan::exists(m_cacheDir) && !DirMan::mkAbsPath(m_cacheDir))
+    {
+        pLogWarning("TextureCache: Can't create cache directory %s, cache is disabled", m_cacheDir.c_str());
+        return;
+    }
+
+    m_enabled = true;
+    pLogDebug("TextureCache: Using %s", m_cacheDir.c_str());
+}
+
+bool TextureCache::isEnabled()
+{
+    return m_enabled;
+}
+
+std::string TextureCache::makeKey(const std::string &path,
+                                  const std::string &maskPath,
+                                  const std::string &maskFallbackPath)
+{
+    if(!m_enabled || path.empty() || (path[0] == ':') || Files::hasSuffix(path, ".png"))
+        return std::string();
+
+    int64_t mtime = Files::fileModifiedTime(path);
+    if(mtime < 0)
+        return std::string();
+
+    std::string key = path + "|" + std::to_string(mtime);
+    key += "|" + maskPath + "|" + std::to_string(maskPath.empty() ? -1 : Files::fileModifiedTime(maskPath));
+    key += "|" + maskFallbackPath + "|" + std::to_string(maskFallbackPath.empty() ? -1 : Files::fileModifiedTime(maskFallbackPath));
+    return key;
+}
+
+std::string TextureCache::entryPath(const std::string &key)
+{
+    return m_cacheDir + "/" + md5(key) + ".rgba";
+}
+
+bool TextureCache::loadTexture(PGE_Texture &target,
+                               const std::string &path,
+                               const std::string &maskPath,
+                               const std::string &maskFallbackPath)
+{
+    std::string key = makeKey(path, maskPath, maskFallbackPath);
+    if(key.empty())
+        return false;
+
+    FileMapper map;
+    const TextureCacheHeader *h = mapEntry(map, entryPath(key), key);
+    if(!h)
+        return false;
+
+    target.ColorUpper.r = h->colorUpper[0];
+    target.ColorUpper.g = h->colorUpper[1];
+    target.ColorUpper.b = h->colorUpper[2];
+    target.ColorLower.r = h->colorLower[0];
+    target.ColorLower.g = h->colorLower[1];
+    target.ColorLower.b = h->colorLower[2];
+    target.nOfColors = GL_RGBA;
+    target.format = GL_BGRA;
+
+    // Pixels are stored in order the renderer expects, upload them directly from the mapped file
+    uint8_t *pixels = reinterpret_cast<uint8_t *>(map.data()) + h->dataOffset;
+    GlRenderer::loadRawTextureP(target, pixels, h->width, h->height);
+    return true;
+}
+
+FIBITMAP *TextureCache::loadImage(const std::string &path,
+                                  const std::string &maskPath,
+                                  const std::string &maskFallbackPath)
+{
+    std::string key = makeKey(path, maskPath, maskFallbackPath);
+    if(key.empty())
+        return nullptr;
+
+    FileMapper map;
+    const TextureCacheHeader *h = mapEntry(map, entryPath(key), key);
+    if(!h)
+        return nullptr;
+
+    FIBITMAP *image = FreeImage_Allocate(static_cast<int>(h->width),
+                                         static_cast<int>(h->height),
+                                         32,
+                                         FI_RGBA_RED_MASK,
+                                         FI_RGBA_GREEN_MASK,
+                                         FI_RGBA_BLUE_MASK);
+    if(!image)
+        return nullptr;
+
+    // Cached rows are ordered from top to bottom, FreeImage keeps them from bottom to top
+    const uint8_t *pixels = reinterpret_cast<const uint8_t *>(map.data()) + h->dataOffset;
+    size_t line = size_t(h->width) * 4;
+    for(uint32_t y = 0; y < h->height; y++)
+    {
+        BYTE *dst = FreeImage_GetScanLine(image, static_cast<int>(h->height - 1 - y));
+        memcpy(dst, pixels + line * y, line);
+    }
+
+    return image;
+}
+
+void TextureCache::store(const std::string &path,
+                         const std::string &maskPath,
+                         const std::string &maskFallbackPath,
+                         FIBITMAP *image)
+{
+    std::string key = makeKey(path, maskPath, maskFallbackPath);
+    if(key.empty() || !image || (FreeImage_GetBPP(image) != 32))
+        return;
+
+    uint32_t w = FreeImage_GetWidth(image);
+    uint32_t h = FreeImage_GetHeight(image);
+    if((w == 0) || (h == 0))
+        return;
+
+    PGE_Texture colors;
+    GlRenderer::getTextureEdgeColors(colors, image);
+
+    TextureCacheHeader hdr;
+    memcpy(hdr.magic, g_cacheMagic, sizeof(g_cacheMagic));
+    hdr.width = w;
+    hdr.height = h;
+    hdr.colorUpper[0] = colors.ColorUpper.r;
+    hdr.colorUpper[1] = colors.ColorUpper.g;
+    hdr.colorUpper[2] = colors.ColorUpper.b;
+    hdr.colorLower[0] = colors.ColorLower.r;
+    hdr.colorLower[1] = colors.ColorLower.g;
+    hdr.colorLower[2] = colors.ColorLower.b;
+    hdr.keySize = static_cast<uint32_t>(key.size());
+    // Keep pixels data aligned
+    hdr.dataOffset = static_cast<uint32_t>((sizeof(TextureCacheHeader) + key.size() + 15) & ~size_t(15));
+
+    std::string file = entryPath(key);
+    // Write into temporary file first to don't let other readers see incomplete entry
+    std::string tempFile = file + "." + std::to_string(SDL_ThreadID()) + ".tmp";
+    FILE *f = Files::utf8_fopen(tempFile.c_str(), "wb");
+    if(!f)
+        return;
+
+    bool ok = true;
+    std::vector<uint8_t> gap(hdr.dataOffset - sizeof(TextureCacheHeader) - key.size(), 0);
+    ok &= (fwrite(&hdr, sizeof(TextureCacheHeader), 1, f) == 1);
+    ok &= (fwrite(key.data(), 1, key.size(), f) == key.size());
+    if(!gap.empty())
+        ok &= (fwrite(gap.data(), 1, gap.size(), f) == gap.size());
+
+    size_t line = size_t(w) * 4;
+    for(uint32_t y = 0; ok && (y < h); y++)
+        ok &= (fwrite(FreeImage_GetScanLine(image, static_cast<int>(h - 1 - y)), 1, line, f) == line);
+
+    fclose(f);
+
+    if(ok && (std::rename(tempFile.c_str(), file.c_str()) != 0))
+        ok = Files::moveFile(file, tempFile, true);
+
+    if(!ok)
+    {
+        Files::deleteFile(tempFile);
+        pLogWarning("TextureCache: Failed to store %s", path.c_str());
+    }
+}
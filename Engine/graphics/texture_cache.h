@@ -0,0 +1,102 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <string>
+#include <common_features/pge_texture.h>
+
+struct FIBITMAP;
+
+/*!
+ * \brief On-disk cache of decoded and mask-merged images
+ *
+ * Every cached image is stored as raw 32-bit pixels in the same order as they are
+ * uploaded into the renderer, so the cache file is memory-mapped and uploaded as-is.
+ * Entries are keyed by paths and modification times of the image, mask and
+ * mask fallback files, so any change of the source files makes a new entry.
+ * PNG images and embedded resources are not cached: they are not needing
+ * mask merging and are decoded quickly.
+ */
+class TextureCache
+{
+public:
+    /*!
+     * \brief Enable the cache
+     * \param cacheDir Directory to keep cache files
+     */
+    static void init(const std::string &cacheDir);
+
+    /*!
+     * \brief Is cache enabled?
+     * \return true if cache is enabled
+     */
+    static bool isEnabled();
+
+    /*!
+     * \brief Make texture from cached image. Must be called from the main thread
+     * \param target Destination texture context
+     * \param path Path to image file
+     * \param maskPath Path to bitwise transparency mask
+     * \param maskFallbackPath Path to fallback (transparent PNG) to extract bitwise mask for given front
+     * \return true if cached image was found and texture was made
+     */
+    static bool loadTexture(PGE_Texture &target,
+                            const std::string &path,
+                            const std::string &maskPath,
+                            const std::string &maskFallbackPath);
+
+    /*!
+     * \brief Load cached image. Safe to call from any thread
+     * \param path Path to image file
+     * \param maskPath Path to bitwise transparency mask
+     * \param maskFallbackPath Path to fallback (transparent PNG) to extract bitwise mask for given front
+     * \return 32-bit image in the same state as GlRenderer::loadTextureImage() gives, or null if not cached
+     */
+    static FIBITMAP *loadImage(const std::string &path,
+                               const std::string &maskPath,
+                               const std::string &maskFallbackPath);
+
+    /*!
+     * \brief Store decoded and mask-merged image into the cache. Safe to call from any thread
+     * \param path Path to image file
+     * \param maskPath Path to bitwise transparency mask
+     * \param maskFallbackPath Path to fallback (transparent PNG) to extract bitwise mask for given front
+     * \param image 32-bit image
+     */
+    static void store(const std::string &path,
+                      const std::string &maskPath,
+                      const std::string &maskFallbackPath,
+                      FIBITMAP *image);
+
+private:
+    /*!
+     * \brief Build the key of cache entry
+     * \return key string, or empty string if this image must not be cached
+     */
+    static std::string makeKey(const std::string &path,
+                               const std::string &maskPath,
+                               const std::string &maskFallbackPath);
+    static std::string entryPath(const std::string &key);
+
+    static std::string m_cacheDir;
+    static bool        m_enabled;
+};
+
+#endif // TEXTURE_CACHE_H
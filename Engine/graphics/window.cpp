@@ -23,6 +23,7 @@
 #include <common_features/logger.h>
 #include <common_features/tr.h>
 #include <common_features/fmt_format_ne.h>
+#include <common_features/profiler.h>
 
 #include <settings/global_settings.h>
 #include <settings/debugger.h>
@@ -42,6 +43,7 @@ bool    PGE_Window::vsyncIsSupported    = true;
 
 bool    PGE_Window::showDebugInfo       = false;
 bool    PGE_Window::showPhysicsDebug    = false;
+bool    PGE_Window::headless            = false;
 
 SDL_Window      *PGE_Window::window     = NULL;
 SDL_GLContext    PGE_Window::glcontext  = NULL;
@@ -98,6 +100,11 @@ void PGE_Window::printSDLError(std::string info)
 
 int PGE_Window::msgBoxInfo(std::string title, std::string text)
 {
+    if(headless)
+    {
+        pLogDebug("MESSAGEBOX: %s: %s", title.c_str(), text.c_str());
+        return 0;
+    }
 #ifdef PGE_ENGINE_DEBUG
     if(PGE_Debugger::isDebuggerPresent())
     {
@@ -111,6 +118,11 @@ int PGE_Window::msgBoxInfo(std::string title, std::string text)
 
 int PGE_Window::msgBoxWarning(std::string title, std::string text)
 {
+    if(headless)
+    {
+        pLogWarning("MESSAGEBOX: %s: %s", title.c_str(), text.c_str());
+        return 0;
+    }
 #ifdef PGE_ENGINE_DEBUG
     if(PGE_Debugger::isDebuggerPresent())
     {
@@ -124,6 +136,11 @@ int PGE_Window::msgBoxWarning(std::string title, std::string text)
 
 int PGE_Window::msgBoxCritical(std::string title, std::string text)
 {
+    if(headless)
+    {
+        pLogCritical("MESSAGEBOX: %s: %s", title.c_str(), text.c_str());
+        return 0;
+    }
 #ifdef PGE_ENGINE_DEBUG
     if(PGE_Debugger::isDebuggerPresent())
     {
@@ -167,6 +184,10 @@ bool PGE_Window::init(std::string WindowTitle, int renderType)
         GlRenderer::setup_SW_SDL();
         break;
 
+    case GlRenderer::RENDER_NULL:
+        GlRenderer::setup_Null();
+        break;
+
     case GlRenderer::RENDER_AUTO:
     case GlRenderer::RENDER_INVALID:
         //% "Renderer is not selected!"
@@ -177,6 +198,22 @@ bool PGE_Window::init(std::string WindowTitle, int renderType)
 
     GlRenderer::setVirtualSurfaceSize(Width, Height);
     GlRenderer::setViewportSize(Width, Height);
+
+    if(rtype == GlRenderer::RENDER_NULL)
+    {
+        //Nothing to show, images are still needed to know sizes of textures
+        GraphicsHelps::initFreeImage();
+        g_isRenderInit = true;
+        if(!GlRenderer::init())
+        {
+            g_isRenderInit = false;
+            return false;
+        }
+        vsync = false;
+        vsyncIsSupported = false;
+        return true;
+    }
+
     window = SDL_CreateWindow(WindowTitle.c_str(),
                               SDL_WINDOWPOS_CENTERED,
                               SDL_WINDOWPOS_CENTERED,
@@ -283,6 +320,8 @@ bool PGE_Window::init(std::string WindowTitle, int renderType)
 
 void PGE_Window::setWindowTitle(std::string title)
 {
+    if(window == NULL)
+        return;
     SDL_SetWindowTitle(window, title.c_str());
 }
 
@@ -342,6 +381,14 @@ bool PGE_Window::uninit()
     if(!g_isRenderInit)
         return false;
 
+    if(window == NULL)
+    {
+        GlRenderer::uninit();
+        GraphicsHelps::closeFreeImage();
+        g_isRenderInit = false;
+        return true;
+    }
+
     // Swith to WINDOWED mode
     if(SDL_SetWindowFullscreen(window, SDL_FALSE) < 0)
     {
@@ -515,6 +562,12 @@ int PGE_Window::processEvents(SDL_Event &event)
             return 2;
         }
 
+        case SDLK_F10:
+        {
+            PGE_Profiler::toggle();
+            return 2;
+        }
+
         case SDLK_F11:
         {
             GlRenderer::toggleRecorder();
@@ -50,6 +50,8 @@ extern int      frameDelay;
 extern bool     showDebugInfo;
 //! Enable rendering of physical engine debug shapes
 extern bool     showPhysicsDebug;
+//! Run without window, rendering and audio as fast as possible
+extern bool     headless;
 //! Descriptor of the game window
 extern SDL_Window       *window;
 //! Descriptor of the OpenGL context
@@ -26,6 +26,7 @@
 
 #include <common_features/app_path.h>
 #include <common_features/tr.h>
+#include <common_features/logger.h>
 #include <audio/pge_audio.h>
 #include <settings/global_settings.h>
 
@@ -213,6 +214,13 @@ bool PGE_MsgBox::isRunning()
 
 void PGE_MsgBox::exec()
 {
+    //Nobody can close the box without a scene which passes controls into it
+    if(PGE_Window::headless && !m_parentScene)
+    {
+        pLogWarning("MESSAGEBOX: %s", m_message.c_str());
+        return;
+    }
+
     updateControllers();
     restart();
     while(m_running)
@@ -226,7 +234,7 @@ void PGE_MsgBox::exec()
         GlRenderer::repaint();
 
         #ifndef __EMSCRIPTEN__
-        if((!PGE_Window::vsync) && (m_uTick > static_cast<Sint32>(SDL_GetTicks() - start_render)))
+        if((!PGE_Window::vsync) && (!PGE_Window::headless) && (m_uTick > static_cast<Sint32>(SDL_GetTicks() - start_render)))
             SDL_Delay(static_cast<Uint32>(m_uTick) - (SDL_GetTicks() - start_render));
         #else
         emscripten_sleep(1);
@@ -24,6 +24,7 @@
 
 #include <audio/play_music.h>
 #include <common_features/logger.h>
+#include <common_features/profiler.h>
 #include <common_features/tr.h>
 
 #include <PGE_File_Formats/pge_x.h>
@@ -109,6 +110,10 @@ int main(int argc, char *argv[])
     // Parse high arguments
     app.parseHighArgs(args);
 
+    //Headless mode has nothing to show, renderer choice doesn't matter
+    if(PGE_Window::headless)
+        g_flags.rendererType = GlRenderer::RENDER_NULL;
+
     // Initalizing SDL
     if(app.initSDL())
     {
@@ -137,7 +142,8 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    app.loadJoysticks();
+    if(!PGE_Window::headless)
+        app.loadJoysticks();
     SDL_PumpEvents();
 
     if(g_AppSettings.fullScreen)
@@ -152,7 +158,8 @@ int main(int argc, char *argv[])
     //Init font manager
     app.initFontBasics();
     pLogDebug("Showing window...");
-    SDL_ShowWindow(PGE_Window::window);
+    if(PGE_Window::window)
+        SDL_ShowWindow(PGE_Window::window);
     pLogDebug("Clear screen...");
     GlRenderer::clearScreen();
     GlRenderer::flush();
@@ -193,6 +200,12 @@ int main(int argc, char *argv[])
         //If application runned first time or target configuration is not exist
         if(configPath_manager.empty() && g_configPackPath.empty())
         {
+            if(PGE_Window::headless)
+            {
+                pLogCritical("Config pack is not specified, can't ask for it in headless mode");
+                return 2;
+            }
+
             //Ask for configuration
             if(GOScene.exec() == 1)
                 g_configPackPath = GOScene.currentConfigPath;
@@ -231,6 +244,13 @@ int main(int argc, char *argv[])
         app.initFontFull();
     }
 
+    //Menus and world map are waiting for the player, headless mode plays levels only
+    if(PGE_Window::headless && !Files::hasSuffix(g_fileToOpen, ".lvl") && !Files::hasSuffix(g_fileToOpen, ".lvlx"))
+    {
+        pLogCritical("Headless mode requires a level file to play");
+        return 2;
+    }
+
     if(!g_fileToOpen.empty())
     {
         g_GameState.reset();
@@ -697,6 +717,13 @@ PlayLevel:
             if(g_flags.testLevel || g_AppSettings.debugMode)
                 g_jumpOnLevelEndTo = RETURN_TO_EXIT;
 
+            //Every headless run plays the level once
+            if(PGE_Window::headless)
+            {
+                g_jumpOnLevelEndTo = RETURN_TO_EXIT;
+                playAgain = false;
+            }
+
             ConfigManager::unloadLevelConfigs();
             lScene.reset();
         }
@@ -723,5 +750,15 @@ PlayLevel:
         }
     }
 ExitFromApplication:
+    if(PGE_Profiler::isEnabled())
+    {
+        if(g_AppSettings.profileTraceFile.empty())
+            PGE_Profiler::toggle();
+        else
+        {
+            PGE_Profiler::stop();
+            PGE_Profiler::exportTrace(g_AppSettings.profileTraceFile);
+        }
+    }
     return 0;
 }
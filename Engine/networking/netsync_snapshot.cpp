@@ -0,0 +1,430 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "netsync_snapshot.h"
+
+#include <algorithm>
+
+static inline void writeVarInt(std::string &out, uint64_t value)
+{
+    while(value >= 0x80)
+    {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+static inline bool readVarInt(const char *&p, const char *end, uint64_t &value)
+{
+    value = 0;
+    for(int shift = 0; shift < 64; shift += 7)
+    {
+        if(p >= end)
+            return false;
+        uint8_t byte = static_cast<uint8_t>(*p++);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if((byte & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+static inline bool readVarInt32(const char *&p, const char *end, uint32_t &value)
+{
+    uint64_t v;
+    if(!readVarInt(p, end, v) || (v > 0xFFFFFFFFu))
+        return false;
+    value = static_cast<uint32_t>(v);
+    return true;
+}
+
+static inline void writeZigZag(std::string &out, int64_t value)
+{
+    writeVarInt(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+static inline bool readZigZag(const char *&p, const char *end, int64_t &value)
+{
+    uint64_t v;
+    if(!readVarInt(p, end, v))
+        return false;
+    value = static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+    return true;
+}
+
+static bool keyLess(const NetSync_Entity &e, uint32_t key)
+{
+    return e.key < key;
+}
+
+const NetSync_Entity *NetSync_Snapshot::find(uint32_t key) const
+{
+    auto it = std::lower_bound(entities.begin(), entities.end(), key, keyLess);
+    if((it == entities.end()) || (it->key != key))
+        return nullptr;
+    return &(*it);
+}
+
+void NetSync_Snapshot::sort()
+{
+    std::sort(entities.begin(), entities.end(), [](const NetSync_Entity &a, const NetSync_Entity &b)
+    {
+        return a.key < b.key;
+    });
+}
+
+uint32_t NetSync_Snapshot::checksum() const
+{
+    //FNV-1a over keys and fields of objects
+    uint32_t hash = 2166136261u;
+    auto mix = [&hash](uint32_t value)
+    {
+        for(int i = 0; i < 4; i++)
+        {
+            hash ^= (value >> (i * 8)) & 0xFF;
+            hash *= 16777619u;
+        }
+    };
+
+    for(const NetSync_Entity &e : entities)
+    {
+        mix(e.key);
+        for(int f = 0; f < NetSync_Entity::F_COUNT; f++)
+            mix(static_cast<uint32_t>(e.field[f]));
+    }
+    return hash;
+}
+
+/*
+ * Frame:
+ *  byte    FrameMarker
+ *  varint  sequence
+ *  varint  baseline sequence, 0 for full snapshot
+ *  varint  time
+ *  varint  count of removed objects, then their keys as differences with previous key
+ *  varint  count of changed objects, then for each of them:
+ *      varint  key as difference with previous key
+ *      varint  mask of changed fields
+ *      zigzag  difference with baseline value for every changed field
+ */
+void NetSync_Codec::encodeFrame(const NetSync_Snapshot &snapshot, const NetSync_Snapshot *baseline, std::string &out)
+{
+    static const NetSync_Entity zero;
+    static const std::vector<NetSync_Entity> empty;
+    const std::vector<NetSync_Entity> &base = baseline ? baseline->entities : empty;
+    const std::vector<NetSync_Entity> &cur = snapshot.entities;
+
+    out.push_back(static_cast<char>(FrameMarker));
+    writeVarInt(out, snapshot.sequence);
+    writeVarInt(out, baseline ? baseline->sequence : 0);
+    writeVarInt(out, snapshot.time);
+
+    // Removed objects
+    std::vector<uint32_t> removed;
+    size_t j = 0;
+    for(const NetSync_Entity &b : base)
+    {
+        while((j < cur.size()) && (cur[j].key < b.key))
+            j++;
+        if((j >= cur.size()) || (cur[j].key != b.key))
+            removed.push_back(b.key);
+    }
+    writeVarInt(out, removed.size());
+    uint32_t prevKey = 0;
+    for(uint32_t key : removed)
+    {
+        writeVarInt(out, key - prevKey);
+        prevKey = key;
+    }
+
+    // Changed and new objects, count is written after them
+    std::string changed;
+    size_t changedCount = 0;
+    prevKey = 0;
+    j = 0;
+    for(const NetSync_Entity &e : cur)
+    {
+        while((j < base.size()) && (base[j].key < e.key))
+            j++;
+        bool isNew = (j >= base.size()) || (base[j].key != e.key);
+        const NetSync_Entity &b = isNew ? zero : base[j];
+
+        uint32_t mask = 0;
+        for(int f = 0; f < NetSync_Entity::F_COUNT; f++)
+        {
+            if(e.field[f] != b.field[f])
+                mask |= (1u << f);
+        }
+        if(!isNew && (mask == 0))
+            continue;
+
+        writeVarInt(changed, e.key - prevKey);
+        prevKey = e.key;
+        writeVarInt(changed, mask);
+        for(int f = 0; f < NetSync_Entity::F_COUNT; f++)
+        {
+            if(mask & (1u << f))
+                writeZigZag(changed, static_cast<int64_t>(e.field[f]) - b.field[f]);
+        }
+        changedCount++;
+    }
+    writeVarInt(out, changedCount);
+    out.append(changed);
+}
+
+bool NetSync_Codec::frameBaseline(const std::string &in, uint32_t &baseline)
+{
+    const char *p = in.data();
+    const char *end = p + in.size();
+    uint32_t sequence;
+    if((p >= end) || (static_cast<unsigned char>(*p++) != FrameMarker))
+        return false;
+    return readVarInt32(p, end, sequence) && readVarInt32(p, end, baseline);
+}
+
+bool NetSync_Codec::decodeFrame(const std::string &in, const NetSync_Snapshot *baseline, NetSync_Snapshot &out)
+{
+    static const NetSync_Entity zero;
+    static const std::vector<NetSync_Entity> empty;
+    const char *p = in.data();
+    const char *end = p + in.size();
+    uint32_t baseSequence;
+    uint64_t count;
+
+    if((p >= end) || (static_cast<unsigned char>(*p++) != FrameMarker))
+        return false;
+    if(!readVarInt32(p, end, out.sequence) || !readVarInt32(p, end, baseSequence) || !readVarInt32(p, end, out.time))
+        return false;
+    if((baseSequence != 0) && (!baseline || (baseline->sequence != baseSequence)))
+        return false;
+    const std::vector<NetSync_Entity> &base = (baseSequence != 0) ? baseline->entities : empty;
+
+    // Every object takes at least one byte, so counts are limited by the data size
+    std::vector<uint32_t> removed;
+    if(!readVarInt(p, end, count) || (count > static_cast<uint64_t>(end - p)))
+        return false;
+    uint32_t key = 0;
+    for(uint64_t i = 0; i < count; i++)
+    {
+        uint32_t diff;
+        if(!readVarInt32(p, end, diff))
+            return false;
+        key += diff;
+        removed.push_back(key);
+    }
+
+    out.entities.clear();
+    out.entities.reserve(base.size());
+    size_t bi = 0, ri = 0;
+    // Copy unchanged objects of the baseline which are going before the key
+    auto copyBaseUntil = [&](uint32_t untilKey, bool all)
+    {
+        for(; (bi < base.size()) && (all || (base[bi].key < untilKey)); bi++)
+        {
+            while((ri < removed.size()) && (removed[ri] < base[bi].key))
+                ri++;
+            if((ri < removed.size()) && (removed[ri] == base[bi].key))
+                continue;
+            out.entities.push_back(base[bi]);
+        }
+    };
+
+    if(!readVarInt(p, end, count) || (count > static_cast<uint64_t>(end - p)))
+        return false;
+    key = 0;
+    for(uint64_t i = 0; i < count; i++)
+    {
+        uint32_t diff, mask;
+        if(!readVarInt32(p, end, diff) || !readVarInt32(p, end, mask))
+            return false;
+        if((i > 0) && (diff == 0))
+            return false; // Keys must be increasing
+        key += diff;
+
+        copyBaseUntil(key, false);
+        const NetSync_Entity *b = &zero;
+        if((bi < base.size()) && (base[bi].key == key))
+            b = &base[bi++];
+
+        NetSync_Entity e = *b;
+        e.key = key;
+        for(int f = 0; f < NetSync_Entity::F_COUNT; f++)
+        {
+            if((mask & (1u << f)) == 0)
+                continue;
+            int64_t delta;
+            if(!readZigZag(p, end, delta))
+                return false;
+            e.field[f] = static_cast<int32_t>(static_cast<int64_t>(b->field[f]) + delta);
+        }
+        out.entities.push_back(e);
+    }
+    copyBaseUntil(0, true);
+
+    return p == end;
+}
+
+void NetSync_Codec::encodeAck(uint32_t sequence, std::string &out)
+{
+    out.push_back(static_cast<char>(AckMarker));
+    writeVarInt(out, sequence);
+}
+
+bool NetSync_Codec::decodeAck(const std::string &in, uint32_t &sequence)
+{
+    const char *p = in.data();
+    const char *end = p + in.size();
+    if((p >= end) || (static_cast<unsigned char>(*p++) != AckMarker))
+        return false;
+    return readVarInt32(p, end, sequence) && (p == end);
+}
+
+
+void NetSync_ReplicationServer::push(NetSync_Snapshot &snapshot)
+{
+    snapshot.sequence = m_nextSequence++;
+    if(m_nextSequence == 0)
+        m_nextSequence = 1;
+    m_history.push_back(snapshot);
+    while(m_history.size() > historySize)
+        m_history.pop_front();
+}
+
+bool NetSync_ReplicationServer::encodeFor(uint32_t acked, std::string &out) const
+{
+    const NetSync_Snapshot *snapshot = latest();
+    if(!snapshot)
+        return false;
+    // Too old or unknown baseline: client gets the full snapshot
+    const NetSync_Snapshot *baseline = (acked != 0) ? findSnapshot(acked) : nullptr;
+    NetSync_Codec::encodeFrame(*snapshot, baseline, out);
+    return true;
+}
+
+const NetSync_Snapshot *NetSync_ReplicationServer::latest() const
+{
+    return m_history.empty() ? nullptr : &m_history.back();
+}
+
+const NetSync_Snapshot *NetSync_ReplicationServer::findSnapshot(uint32_t sequence) const
+{
+    for(auto it = m_history.rbegin(); it != m_history.rend(); it++)
+    {
+        if(it->sequence == sequence)
+            return &(*it);
+    }
+    return nullptr;
+}
+
+
+bool NetSync_ReplicationClient::receive(const std::string &frame, uint32_t localTime, uint32_t &ack)
+{
+    uint32_t baseSequence;
+    if(!NetSync_Codec::frameBaseline(frame, baseSequence))
+        return false;
+
+    const NetSync_Snapshot *baseline = nullptr;
+    if(baseSequence != 0)
+    {
+        baseline = findSnapshot(baseSequence);
+        if(!baseline)
+            return false; // Baseline is gone, server will send full snapshot after next ack
+    }
+
+    NetSync_Snapshot snapshot;
+    if(!NetSync_Codec::decodeFrame(frame, baseline, snapshot))
+        return false;
+
+    // Frames are going by UDP, so late ones are dropped
+    if(!m_history.empty() && (static_cast<int32_t>(snapshot.sequence - m_history.back().sequence) <= 0))
+        return false;
+
+    double offset = static_cast<double>(snapshot.time) - static_cast<double>(localTime);
+    if(!m_hasTimeOffset || (offset > m_timeOffset))
+        m_timeOffset = offset; // Frame with the smallest delay
+    else
+        m_timeOffset += (offset - m_timeOffset) * 0.05; // Follow the drift of clocks
+    m_hasTimeOffset = true;
+
+    m_history.push_back(std::move(snapshot));
+    while(m_history.size() > historySize)
+        m_history.pop_front();
+
+    ack = m_history.back().sequence;
+    return true;
+}
+
+bool NetSync_ReplicationClient::interpolate(uint32_t localTime, NetSync_Snapshot &out) const
+{
+    if(m_history.empty())
+        return false;
+
+    double showTime = static_cast<double>(localTime) + m_timeOffset - interpolationDelay;
+
+    // Find pair of snapshots around the moment
+    const NetSync_Snapshot *to = &m_history.back();
+    const NetSync_Snapshot *from = to;
+    for(size_t i = m_history.size(); i-- > 0;)
+    {
+        from = &m_history[i];
+        if(static_cast<double>(from->time) <= showTime)
+            break;
+        to = from;
+    }
+
+    out = *to;
+    if((from == to) || (to->time <= from->time))
+        return true;
+
+    double t = (showTime - static_cast<double>(from->time)) / static_cast<double>(to->time - from->time);
+    t = std::min(std::max(t, 0.0), 1.0);
+
+    for(NetSync_Entity &e : out.entities)
+    {
+        // Blocks are teleporting, smooth only moving objects
+        if(e.kind() == NetSync_Entity::KIND_BLOCK)
+            continue;
+        const NetSync_Entity *prev = from->find(e.key);
+        if(!prev)
+            continue;
+        for(int f : {NetSync_Entity::F_X, NetSync_Entity::F_Y})
+            e.field[f] = prev->field[f] + static_cast<int32_t>(std::lround((e.field[f] - prev->field[f]) * t));
+    }
+    return true;
+}
+
+uint32_t NetSync_ReplicationClient::latestSequence() const
+{
+    return m_history.empty() ? 0 : m_history.back().sequence;
+}
+
+const NetSync_Snapshot *NetSync_ReplicationClient::latest() const
+{
+    return m_history.empty() ? nullptr : &m_history.back();
+}
+
+const NetSync_Snapshot *NetSync_ReplicationClient::findSnapshot(uint32_t sequence) const
+{
+    for(auto it = m_history.rbegin(); it != m_history.rend(); it++)
+    {
+        if(it->sequence == sequence)
+            return &(*it);
+    }
+    return nullptr;
+}
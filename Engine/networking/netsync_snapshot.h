@@ -0,0 +1,233 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NETSYNC_SNAPSHOT_H
+#define NETSYNC_SNAPSHOT_H
+
+#include <cstdint>
+#include <cmath>
+#include <deque>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Replicated state of one object. All values are quantized to integers,
+ *        so the state reconstructed by the client from deltas is exactly the same as on the server.
+ */
+struct NetSync_Entity
+{
+    enum Kind
+    {
+        KIND_PLAYER = 1,
+        KIND_NPC,
+        KIND_BLOCK
+    };
+
+    enum Flags
+    {
+        FLAG_VISIBLE    = 0x01,
+        FLAG_KILLED     = 0x02,
+        FLAG_DESTROYED  = 0x04,
+        FLAG_ACTIVE     = 0x08,
+        FLAG_HIDDEN     = 0x10
+    };
+
+    enum Field
+    {
+        F_TYPE = 0,
+        F_X,
+        F_Y,
+        F_W,
+        F_H,
+        F_VELX,
+        F_VELY,
+        F_DIRECTION,
+        F_STATE,
+        F_FLAGS,
+        F_COUNT
+    };
+
+    //! Units per pixel of position and size
+    static const int positionScale = 16;
+    //! Units per pixel per tick of velocity
+    static const int velocityScale = 256;
+
+    //! Kind of object in top 4 bits and its ID in the level in others
+    uint32_t key = 0;
+    int32_t  field[F_COUNT] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+    static inline uint32_t makeKey(Kind kind, uint32_t id)
+    {
+        return (static_cast<uint32_t>(kind) << 28) | (id & 0x0FFFFFFF);
+    }
+    inline Kind kind() const
+    {
+        return static_cast<Kind>(key >> 28);
+    }
+    inline uint32_t id() const
+    {
+        return key & 0x0FFFFFFF;
+    }
+
+    static inline int32_t quantize(double value, int scale)
+    {
+        return static_cast<int32_t>(std::lround(value * scale));
+    }
+    static inline double dequantize(int32_t value, int scale)
+    {
+        return static_cast<double>(value) / scale;
+    }
+};
+
+/*!
+ * \brief State of all replicated objects at the moment of time
+ */
+struct NetSync_Snapshot
+{
+    //! Number of snapshot, starts from 1, zero means no snapshot
+    uint32_t sequence = 0;
+    //! Server time when snapshot was taken, in milliseconds
+    uint32_t time = 0;
+    //! Objects sorted by key
+    std::vector<NetSync_Entity> entities;
+
+    /*!
+     * \brief Find object by key
+     * \param key Key of the object
+     * \return pointer to the object or nullptr if it is not in the snapshot
+     */
+    const NetSync_Entity *find(uint32_t key) const;
+    //! Sort entities by key, must be called after filling of the snapshot
+    void sort();
+    //! Hash of all objects, same on the server and the client when snapshot was replicated exactly
+    uint32_t checksum() const;
+};
+
+/*!
+ * \brief Compact encoding of snapshots
+ *
+ * Frame holds the difference between the snapshot and the baseline (the snapshot
+ * which client has acknowledged): keys of removed objects and changed fields of
+ * changed or new objects. Field values are written as zigzag varints of the
+ * difference with the baseline value, so small movements are taking one byte.
+ * Frame without baseline contains the full snapshot.
+ */
+class NetSync_Codec
+{
+public:
+    static const unsigned char FrameMarker = 0x5E;
+    static const unsigned char AckMarker   = 0x5A;
+
+    /*!
+     * \brief Encode snapshot
+     * \param snapshot Snapshot to send
+     * \param baseline Snapshot which client has, or nullptr to send full snapshot
+     * \param out Output buffer, data is appended
+     */
+    static void encodeFrame(const NetSync_Snapshot &snapshot, const NetSync_Snapshot *baseline, std::string &out);
+    /*!
+     * \brief Sequence number of the baseline required to decode the frame
+     * \param in Frame data
+     * \param baseline [out] Sequence number of baseline, zero if frame has full snapshot
+     * \return false if data is not a frame
+     */
+    static bool frameBaseline(const std::string &in, uint32_t &baseline);
+    /*!
+     * \brief Decode frame
+     * \param in Frame data
+     * \param baseline Baseline snapshot, must match the frameBaseline()
+     * \param out [out] Decoded snapshot
+     * \return false if data is broken
+     */
+    static bool decodeFrame(const std::string &in, const NetSync_Snapshot *baseline, NetSync_Snapshot &out);
+
+    static void encodeAck(uint32_t sequence, std::string &out);
+    static bool decodeAck(const std::string &in, uint32_t &sequence);
+};
+
+/*!
+ * \brief Server side of replication: keeps recent snapshots to make deltas against them
+ */
+class NetSync_ReplicationServer
+{
+public:
+    //! Count of recent snapshots kept as baselines
+    static const size_t historySize = 64;
+
+    /*!
+     * \brief Store the new snapshot
+     * \param snapshot Snapshot, its sequence number is assigned here
+     */
+    void push(NetSync_Snapshot &snapshot);
+    /*!
+     * \brief Encode the latest snapshot for the client
+     * \param acked Sequence number of snapshot acknowledged by client, zero if none
+     * \param out Output buffer
+     * \return false if there are no snapshots yet
+     */
+    bool encodeFor(uint32_t acked, std::string &out) const;
+    const NetSync_Snapshot *latest() const;
+
+private:
+    const NetSync_Snapshot *findSnapshot(uint32_t sequence) const;
+    std::deque<NetSync_Snapshot> m_history;
+    uint32_t m_nextSequence = 1;
+};
+
+/*!
+ * \brief Client side of replication: rebuilds snapshots from frames and interpolates between them
+ *
+ * Client shows the state with a small delay behind the server, so there are two
+ * snapshots around the shown moment most of the time and movement stays smooth
+ * when frames are coming unevenly.
+ */
+class NetSync_ReplicationClient
+{
+public:
+    //! Count of recent snapshots kept as baselines
+    static const size_t historySize = 64;
+    //! Delay of the shown state behind the server, milliseconds
+    uint32_t interpolationDelay = 100;
+
+    /*!
+     * \brief Take the received frame
+     * \param frame Frame data
+     * \param localTime Time of receiving, milliseconds
+     * \param ack [out] Sequence number to acknowledge
+     * \return true if frame was accepted
+     */
+    bool receive(const std::string &frame, uint32_t localTime, uint32_t &ack);
+    /*!
+     * \brief Get state of objects for the moment
+     * \param localTime Current time, milliseconds
+     * \param out [out] Interpolated state
+     * \return false if nothing was received yet
+     */
+    bool interpolate(uint32_t localTime, NetSync_Snapshot &out) const;
+    uint32_t latestSequence() const;
+    const NetSync_Snapshot *latest() const;
+
+private:
+    const NetSync_Snapshot *findSnapshot(uint32_t sequence) const;
+    std::deque<NetSync_Snapshot> m_history;
+    //! Difference of the server time and the local time
+    double m_timeOffset = 0.0;
+    bool   m_hasTimeOffset = false;
+};
+
+#endif // NETSYNC_SNAPSHOT_H
@@ -0,0 +1,176 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "netsync_udp.h"
+
+#include <common_features/logger.h>
+
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef int socklen_t;
+#define NETSYNC_INVALID_SOCKET  static_cast<intptr_t>(INVALID_SOCKET)
+#define netsync_closesocket     closesocket
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define NETSYNC_INVALID_SOCKET  static_cast<intptr_t>(-1)
+#define netsync_closesocket     ::close
+#endif
+
+#ifdef _WIN32
+static bool initWinSock()
+{
+    static bool initialized = false;
+    if(!initialized)
+    {
+        WSADATA wsaData;
+        initialized = (WSAStartup(MAKEWORD(2, 2), &wsaData) == 0);
+    }
+    return initialized;
+}
+#endif
+
+std::string NetSync_Address::toString() const
+{
+    uint32_t h = ntohl(host);
+    return std::to_string((h >> 24) & 0xFF) + "." + std::to_string((h >> 16) & 0xFF) + "." +
+           std::to_string((h >> 8) & 0xFF) + "." + std::to_string(h & 0xFF) + ":" +
+           std::to_string(ntohs(port));
+}
+
+NetSync_UdpSocket::NetSync_UdpSocket() :
+    m_socket(NETSYNC_INVALID_SOCKET)
+{}
+
+NetSync_UdpSocket::~NetSync_UdpSocket()
+{
+    close();
+}
+
+bool NetSync_UdpSocket::open(uint16_t port)
+{
+    close();
+#ifdef _WIN32
+    if(!initWinSock())
+    {
+        pLogWarning("NetSync: Failed to initialize WinSock");
+        return false;
+    }
+#endif
+
+    m_socket = static_cast<intptr_t>(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+    if(m_socket == NETSYNC_INVALID_SOCKET)
+    {
+        pLogWarning("NetSync: Failed to create the socket");
+        return false;
+    }
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if(bind(m_socket, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+    {
+        pLogWarning("NetSync: Failed to bind the socket to port %u", static_cast<unsigned>(port));
+        close();
+        return false;
+    }
+
+#ifdef _WIN32
+    u_long nonBlocking = 1;
+    ioctlsocket(m_socket, FIONBIO, &nonBlocking);
+#else
+    fcntl(static_cast<int>(m_socket), F_SETFL, fcntl(static_cast<int>(m_socket), F_GETFL, 0) | O_NONBLOCK);
+#endif
+    return true;
+}
+
+void NetSync_UdpSocket::close()
+{
+    if(m_socket != NETSYNC_INVALID_SOCKET)
+    {
+        netsync_closesocket(m_socket);
+        m_socket = NETSYNC_INVALID_SOCKET;
+    }
+}
+
+bool NetSync_UdpSocket::isOpen() const
+{
+    return m_socket != NETSYNC_INVALID_SOCKET;
+}
+
+bool NetSync_UdpSocket::resolve(const std::string &host, uint16_t port, NetSync_Address &out)
+{
+#ifdef _WIN32
+    if(!initWinSock())
+        return false;
+#endif
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    addrinfo *result = nullptr;
+    if((getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0) || !result)
+    {
+        pLogWarning("NetSync: Failed to resolve the host %s", host.c_str());
+        return false;
+    }
+    out.host = reinterpret_cast<sockaddr_in *>(result->ai_addr)->sin_addr.s_addr;
+    out.port = htons(port);
+    freeaddrinfo(result);
+    return true;
+}
+
+bool NetSync_UdpSocket::send(const NetSync_Address &to, const std::string &data)
+{
+    if(!isOpen() || (data.size() > maxDatagramSize))
+        return false;
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = to.host;
+    addr.sin_port = to.port;
+    return sendto(m_socket, data.data(), static_cast<int>(data.size()), 0,
+                  reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == static_cast<int>(data.size());
+}
+
+bool NetSync_UdpSocket::receive(NetSync_Address &from, std::string &data)
+{
+    if(!isOpen())
+        return false;
+    sockaddr_in addr;
+    socklen_t addrLen = sizeof(addr);
+    int got = static_cast<int>(recvfrom(m_socket, m_buffer, sizeof(m_buffer), 0,
+                                        reinterpret_cast<sockaddr *>(&addr), &addrLen));
+    if(got < 0)
+        return false; // Nothing more or an error (like ICMP unreachable from closed peer)
+    from.host = addr.sin_addr.s_addr;
+    from.port = addr.sin_port;
+    data.assign(m_buffer, static_cast<size_t>(got));
+    return true;
+}
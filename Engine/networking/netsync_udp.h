@@ -0,0 +1,85 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NETSYNC_UDP_H
+#define NETSYNC_UDP_H
+
+#include <cstdint>
+#include <string>
+
+/*!
+ * \brief IPv4 address and port of the remote side
+ */
+struct NetSync_Address
+{
+    uint32_t host = 0; //!< In network byte order
+    uint16_t port = 0; //!< In network byte order
+    inline bool operator==(const NetSync_Address &o) const
+    {
+        return (host == o.host) && (port == o.port);
+    }
+    std::string toString() const;
+};
+
+/*!
+ * \brief Non-blocking UDP socket to transfer replication frames
+ */
+class NetSync_UdpSocket
+{
+public:
+    //! Maximal size of the datagram
+    static const size_t maxDatagramSize = 65000;
+
+    NetSync_UdpSocket();
+    ~NetSync_UdpSocket();
+    NetSync_UdpSocket(const NetSync_UdpSocket &) = delete;
+    NetSync_UdpSocket &operator=(const NetSync_UdpSocket &) = delete;
+
+    /*!
+     * \brief Open the socket
+     * \param port Local port, zero to take any free
+     * \return true on success
+     */
+    bool open(uint16_t port = 0);
+    void close();
+    bool isOpen() const;
+
+    /*!
+     * \brief Resolve the address
+     * \param host Host name or IPv4 address
+     * \param port Port
+     * \param out [out] Resolved address
+     * \return true on success
+     */
+    static bool resolve(const std::string &host, uint16_t port, NetSync_Address &out);
+
+    bool send(const NetSync_Address &to, const std::string &data);
+    /*!
+     * \brief Take next received datagram if available, never waits
+     * \param from [out] Sender address
+     * \param data [out] Datagram
+     * \return false if there are no more datagrams
+     */
+    bool receive(NetSync_Address &from, std::string &data);
+
+private:
+    intptr_t m_socket;
+    char     m_buffer[maxDatagramSize];
+};
+
+#endif // NETSYNC_UDP_H
@@ -86,7 +86,7 @@ win32: {
     RC_FILE = _resources/engine.rc
     LIBS += -lfreeimagelite  -lfreetype -lsqlite3
     LIBS += -lSDL2 $$SDL_MIXER_X_LIBS_DYNAMIC -lSDL2main
-    LIBS += -lversion -lopengl32 -ldbghelp -ladvapi32 -lkernel32
+    LIBS += -lversion -lopengl32 -ldbghelp -ladvapi32 -lkernel32 -lws2_32
 }
 macx: {
     ICON = _resources/cat.icns
@@ -152,6 +152,7 @@ SOURCES += \
     audio/pge_audio.cpp \
     audio/play_music.cpp \
     audio/play_sfx.cpp \
+    audio/sfx_bank.cpp \
     common_features/app_path.cpp \
     common_features/crash_handler.cpp \
     common_features/episode_state.cpp \
@@ -167,6 +168,7 @@ SOURCES += \
     common_features/point.cpp \
     common_features/pointf.cpp \
     common_features/point_mover.cpp \
+    common_features/profiler.cpp \
     common_features/QTranslatorX/ConvertUTF.c \
     common_features/QTranslatorX/qm_translator.cpp \
     common_features/rect.cpp \
@@ -177,11 +179,15 @@ SOURCES += \
     common_features/translator.cpp \
     common_features/util.cpp \
     common_features/version_cmp.cpp \
+    common_features/worker_pool.cpp \
     controls/control_keys.cpp \
     controls/controllable_object.cpp \
     controls/controller.cpp \
     controls/controller_joystick.cpp \
     controls/controller_keyboard.cpp \
+    controls/controller_recording.cpp \
+    controls/controller_replay.cpp \
+    controls/input_track.cpp \
     data_configs/config_engine.cpp \
     data_configs/config_manager.cpp \
     data_configs/config_paths.cpp \
@@ -213,9 +219,14 @@ SOURCES += \
     graphics/gl_renderer.cpp \
     graphics/graphics.cpp \
     graphics/render/render_base.cpp \
+    graphics/render/render_gl_batch.cpp \
+    graphics/render/render_gl_readback.cpp \
     graphics/render/render_opengl21.cpp \
     graphics/render/render_opengl31.cpp \
+    graphics/render/render_null.cpp \
     graphics/render/render_swsdl.cpp \
+    graphics/texture_atlas.cpp \
+    graphics/texture_cache.cpp \
     graphics/window.cpp \
     gui/menu/pge_bool_menuitem.cpp \
     gui/menu/pge_int_menuitem.cpp \
@@ -232,6 +243,8 @@ SOURCES += \
     main.cpp \
     networking/editor_pipe.cpp \
     networking/intproc.cpp \
+    networking/netsync_snapshot.cpp \
+    networking/netsync_udp.cpp \
     _resources/resource.cpp \
     scenes/_base/gfx_effect.cpp \
     scenes/_base/msgbox_queue.cpp \
@@ -242,9 +255,14 @@ SOURCES += \
     scenes/level/lvl_base_object.cpp \
     scenes/level/lvl_bgo.cpp \
     scenes/level/lvl_block.cpp \
+    scenes/level/lvl_broad_phase.cpp \
+    scenes/level/lvl_npc_active_list.cpp \
     scenes/level/lvl_camera.cpp \
     scenes/level/lvl_event_engine.cpp \
+    scenes/level/lvl_frame_timings.cpp \
     scenes/level/lvl_layer_engine.cpp \
+    scenes/level/lvl_name_table.cpp \
+    scenes/level/lvl_netsync.cpp \
     scenes/level/lvl_npc.cpp \
     scenes/level/lvl_physenv.cpp \
     scenes/level/lvl_player.cpp \
@@ -261,6 +279,7 @@ SOURCES += \
     scenes/level/lvl_scene_timers.cpp \
     scenes/level/lvl_scene_trees.cpp \
     scenes/level/lvl_section.cpp \
+    scenes/level/lvl_static_geometry.cpp \
     scenes/level/lvl_subtree.cpp \
     scenes/level/lvl_warp.cpp \
     scenes/level/lvl_z_constants.cpp \
@@ -337,6 +356,7 @@ HEADERS  += \
     audio/pge_audio.h \
     audio/play_music.h \
     audio/play_sfx.h \
+    audio/sfx_bank.h \
     common_features/app_path.h \
     common_features/crash_handler.h \
     common_features/data_array.h \
@@ -357,6 +377,7 @@ HEADERS  += \
     common_features/pointf.h \
     common_features/point.h \
     common_features/point_mover.h \
+    common_features/profiler.h \
     common_features/QTranslatorX/ConvertUTF.h \
     common_features/QTranslatorX/qm_translator.h \
     common_features/QuadTree/LooseQuadtree.h \
@@ -371,12 +392,16 @@ HEADERS  += \
     common_features/tr.h \
     common_features/util.h \
     common_features/version_cmp.h \
+    common_features/worker_pool.h \
     controls/control_keys.h \
     controls/controllable_object.h \
     controls/controller.h \
     controls/controller_joystick.h \
     controls/controller_keyboard.h \
     controls/controller_key_map.h \
+    controls/controller_recording.h \
+    controls/controller_replay.h \
+    controls/input_track.h \
     data_configs/config_manager.h \
     data_configs/config_manager_private.h \
     data_configs/config_select_scene/scene_config_select.h \
@@ -408,9 +433,14 @@ HEADERS  += \
     graphics/gl_renderer.h \
     graphics/graphics.h \
     graphics/render/render_base.h \
+    graphics/render/render_gl_batch.h \
+    graphics/render/render_gl_readback.h \
     graphics/render/render_opengl21.h \
     graphics/render/render_opengl31.h \
+    graphics/render/render_null.h \
     graphics/render/render_swsdl.h \
+    graphics/texture_atlas.h \
+    graphics/texture_cache.h \
     graphics/window.h \
     gui/menu/pge_bool_menuitem.h \
     gui/menu/pge_int_menuitem.h \
@@ -426,6 +456,8 @@ HEADERS  += \
     gui/pge_textinputbox.h \
     networking/editor_pipe.h \
     networking/intproc.h \
+    networking/netsync_snapshot.h \
+    networking/netsync_udp.h \
     _resources/resource_data.h \
     _resources/resource.h \
     scenes/_base/gfx_effect.h \
@@ -438,9 +470,14 @@ HEADERS  += \
     scenes/level/lvl_base_object.h \
     scenes/level/lvl_bgo.h \
     scenes/level/lvl_block.h \
+    scenes/level/lvl_broad_phase.h \
+    scenes/level/lvl_npc_active_list.h \
     scenes/level/lvl_camera.h \
     scenes/level/lvl_event_engine.h \
+    scenes/level/lvl_frame_timings.h \
     scenes/level/lvl_layer_engine.h \
+    scenes/level/lvl_name_table.h \
+    scenes/level/lvl_netsync.h \
     scenes/level/lvl_npc.h \
     scenes/level/lvl_physenv.h \
     scenes/level/lvl_player_def.h \
@@ -448,6 +485,7 @@ HEADERS  += \
     scenes/level/lvl_player_switch.h \
     scenes/level/lvl_quad_tree.h \
     scenes/level/lvl_section.h \
+    scenes/level/lvl_static_geometry.h \
     scenes/level/lvl_subtree.h \
     scenes/level/lvl_warp.h \
     scenes/level/lvl_z_constants.h \
@@ -115,9 +115,15 @@ static inline void processCharacterSwitchBlock(LVL_Player *player, LVL_Block *ne
 }
 
 void PGE_Phys_Object::iterateStep(double ticks, bool force)
+{
+    if(iterateMotion(ticks, force))
+        m_treemap.updatePos();
+}
+
+bool PGE_Phys_Object::iterateMotion(double ticks, bool force)
 {
     if(m_paused && !force)
-        return;
+        return false;
 //FIXME: Fix the missing in-area detector's trap position
     if(m_parent && (m_bodytype == Body_DYNAMIC))
     {
@@ -252,7 +258,7 @@ void PGE_Phys_Object::iterateStep(double ticks, bool force)
         m_momentum_relative.y += iterateY;
     }
 
-    m_treemap.updatePos();
+    return true;
 }
 
 void PGE_Phys_Object::iterateStepPostCollide(float ticks)
@@ -668,13 +674,8 @@ inline bool findMinimalHeight(int idF, PhysObject::objRect sF, double vF,
     return false;
 }
 
-void PGE_Phys_Object::updateCollisions()
+PGE_RectF PGE_Phys_Object::collisionZone()
 {
-    if(m_paused)
-        return;
-
-    std::vector<PGE_Phys_Object *> objs;
-    objs.reserve(25);
     PGE_RectF posRectC = m_momentum.rectF().withMargin(m_momentum.w / 2.0);
 
     if(m_slopeFloor.has || m_slopeFloor.hasOld)
@@ -684,15 +685,37 @@ void PGE_Phys_Object::updateCollisions()
         posRectC.setBottom(posRectC.bottom() + m_slopeFloor.rect.h * 1.5);
     }
 
+    return posRectC;
+}
+
+void PGE_Phys_Object::updateCollisions()
+{
+    if(m_paused)
+        return;
+
+    CollisionBuffers buffers;
+    buffers.objs.reserve(25);
+    PGE_RectF posRectC = collisionZone();
+
     std::function<bool(PGE_Phys_Object*)> itemValidator = [this](PGE_Phys_Object *CUR)->bool
     {
-        return (CUR) &&
-               (dynamic_cast<PGE_Phys_Object*>(CUR) != dynamic_cast<PGE_Phys_Object*>(this)) &&
-               (!CUR->m_paused) &&
-               (CUR->m_is_visible);
+        return isCollisionCandidate(CUR);
     };
 
-    m_scene->queryItems(posRectC, &objs, &itemValidator);
+    m_scene->queryItems(posRectC, &buffers.objs, &itemValidator);
+    updateCollisions(buffers);
+}
+
+void PGE_Phys_Object::updateCollisions(CollisionBuffers &buffers)
+{
+    if(m_paused)
+        return;
+
+    std::vector<PGE_Phys_Object *> &objs = buffers.objs;
+    std::vector<PGE_Phys_Object *> &l_clifCheck = buffers.clifCheck;
+    std::vector<PGE_Phys_Object *> &l_toBump = buffers.toBump;
+    l_clifCheck.clear();
+    l_toBump.clear();
     double k = 0;
     int tm = -1, td = 0;
     PhysObject::ContactAt contactAt = PhysObject::Contact_None;
@@ -700,8 +723,6 @@ void PGE_Phys_Object::updateCollisions()
     bool doHit = false;
     bool doCliffCheck = false;
     bool xSpeedWasReversed = false;
-    std::vector<PGE_Phys_Object *> l_clifCheck;
-    std::vector<PGE_Phys_Object *> l_toBump;
     PhysObject *collideAtTop  = nullptr;
     PhysObject *collideAtBottom = nullptr;
     PhysObject *collideAtLeft  = nullptr;
@@ -70,6 +70,8 @@ PGE_Phys_Object::~PGE_Phys_Object()
     {
         m_treemap.delFromScene();
     }
+    if(m_treemap.m_geometrySlot != LVL_StaticGeometry::noSlot)
+        m_scene->m_staticGeometry.release(m_treemap.m_geometrySlot);
 }
 
 void PGE_Phys_Object::registerInTree()
@@ -853,20 +855,45 @@ bool operator>(const PGE_Phys_Object &lhs, const PGE_Phys_Object &rhs)
 
 void PGE_Phys_Object::show()
 {
-    m_is_visible = true;
+    applyVisibility(true);
 }
 
 void PGE_Phys_Object::hide()
 {
-    m_is_visible = false;
+    applyVisibility(false);
 }
 
 void PGE_Phys_Object::setVisible(bool vizible)
 {
-    m_is_visible = vizible;
+    applyVisibility(vizible);
+}
+
+void PGE_Phys_Object::applyVisibility(bool visible)
+{
+    // Own flag of static layer member is combined with the layer's flag,
+    // so layer engine moves it to the members toggled one by one when they disagree
+    if(m_scene && (m_layerMember.m_static || (visible && m_parent && !m_parent->m_is_visible)))
+        m_scene->m_layers.setMemberVisible(this, visible);
+    else
+        m_is_visible = visible;
+}
+
+void PGE_Phys_Object::setCollidePlayer(int cp)
+{
+    PGE_physBody::setCollidePlayer(cp);
+    if(m_scene)
+        m_scene->m_staticGeometry.updateBlocked(this);
+}
+
+void PGE_Phys_Object::setCollideNpc(int cn)
+{
+    PGE_physBody::setCollideNpc(cn);
+    if(m_scene)
+        m_scene->m_staticGeometry.updateBlocked(this);
 }
 
 bool PGE_Phys_Object::isVisible()
 {
-    return m_is_visible;
+    // Visibility of layer's sub-tree is applied to all its static members
+    return m_is_visible && (!m_parent || m_parent->m_is_visible);
 }
@@ -24,6 +24,7 @@
 #include <common_features/pge_texture.h>
 
 #include "base/lvl_base_physics.h"
+#include "lvl_name_table.h"
 
 #include <vector>
 #ifdef __APPLE__
@@ -47,6 +48,8 @@ class PGE_Phys_Object: public PGE_physBody
             bool         isVizibleOnScreen = false;
             //! Tells, does this object stored into the render list
             bool         isInIenderList = false;
+            //! Z-index taken when object was added into the render list, defines its place in the list
+            long double  zIndex = 0.0L;
         } m_camera_meta;
 
         //! Tells, does this object was catched by camera since recent render action
@@ -232,6 +235,14 @@ class PGE_Phys_Object: public PGE_physBody
         void renderDebug(double _camX, double _camY);
 
         virtual void iterateStep(double ticks, bool force = false);
+        /**
+         * @brief Integrate velocity and position of the body without updating of its place in the tree.
+         *        Touches only the body itself, so bodies can be iterated from several threads
+         * @param ticks Time step in milliseconds
+         * @param force Iterate even paused body
+         * @return true if body was moved and its place in the tree needs to be updated
+         */
+        virtual bool iterateMotion(double ticks, bool force = false);
         void iterateStepPostCollide(float ticks);
         virtual void processContacts() {}
         virtual void preCollision() {}
@@ -251,7 +262,44 @@ class PGE_Phys_Object: public PGE_physBody
             return false;
         }
 
+        /**
+         * @brief Working lists of the collision check, kept between checks to don't allocate them every frame
+         */
+        struct CollisionBuffers
+        {
+            //! Collision candidates, must be filled before check
+            std::vector<PGE_Phys_Object *> objs;
+            //! Candidates for a cliff detection
+            std::vector<PGE_Phys_Object *> clifCheck;
+            //! Blocks to hit
+            std::vector<PGE_Phys_Object *> toBump;
+        };
+
+        /**
+         * @brief Area where collision candidates of this body must be searched
+         * @return Search area rectangle
+         */
+        PGE_RectF collisionZone();
+        /**
+         * @brief Is given object needs to be checked for collisions with this body
+         * @param body Physical body
+         * @return true if collision check is needed
+         */
+        inline bool isCollisionCandidate(PGE_Phys_Object *body) const
+        {
+            return body && (body != this) && (!body->m_paused) && (body->m_is_visible) &&
+                   (!body->m_parent || body->m_parent->m_is_visible);
+        }
+
+        /**
+         * @brief Find collision candidates and resolve collisions
+         */
         void updateCollisions();
+        /**
+         * @brief Resolve collisions with given candidates
+         * @param buffers Working lists, the candidates list must be filled
+         */
+        void updateCollisions(CollisionBuffers &buffers);
         virtual bool onGround()
         {
             return m_stand;
@@ -283,6 +331,11 @@ class PGE_Phys_Object: public PGE_physBody
         virtual void hide();
         virtual void setVisible(bool vizible);
         virtual bool isVisible();
+        /*!
+         * \brief Set own visibility flag, for layer members keeps it in agreement with the layer's flag
+         * \param visible Object is visible
+         */
+        void applyVisibility(bool visible);
         bool                m_is_visible;
         struct TreeMapMember
         {
@@ -298,9 +351,20 @@ class PGE_Phys_Object: public PGE_physBody
             double m_posY_registered = 0.0; //!< Synchronized with R-Tree position
             double m_width_registered = 1.0;  //!< Synchronized with R-Tree Width
             double m_height_registered = 1.0; //!< Synchronized with R-Tree Height
+            //! Slot in the static geometry store of the scene, LVL_StaticGeometry::noSlot if body is not fixed
+            uint32_t m_geometrySlot = 0xFFFFFFFF;
         } m_treemap;
         Momentum            m_momentum_relative;//Momentum, relative to parent layer's position
         PGE_Phys_Object     *m_parent = nullptr;
+        struct LayerMember
+        {
+            //! Handle of layer where object is registered
+            LVL_NameTable::Id m_id = LVL_NameTable::invalid;
+            //! Index in the members list of layer
+            size_t  m_slot = 0;
+            //! Object is in list of static members, visibility of layer's sub-tree is applied to it
+            bool    m_static = false;
+        } m_layerMember;
         /******************************************************************/
 
     public:
@@ -349,6 +413,16 @@ class PGE_Phys_Object: public PGE_physBody
         {
             m_paused = p;
         }
+        /*!
+         * \brief Set blocked sides for playable characters, keeps the static geometry store in sync
+         * \param cp Blocked sides
+         */
+        void setCollidePlayer(int cp);
+        /*!
+         * \brief Set blocked sides for NPCs, keeps the static geometry store in sync
+         * \param cn Blocked sides
+         */
+        void setCollideNpc(int cn);
     private:
         bool m_paused;
 
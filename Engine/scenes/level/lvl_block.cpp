@@ -159,7 +159,7 @@ void LVL_Block::transformTo(unsigned long id, int type)
         {
             // Don't store block as destroyed
             m_scene->m_blocksDestroyed.erase(this);
-            m_scene->m_layers.removeRegItem(data.layer, this);
+            m_scene->m_layers.removeRegItem(this);
             unregisterFromTree();
             m_scene->m_blocksToDelete.push_back(this);
         }
@@ -703,6 +703,7 @@ void LVL_Block::lua_setInvisible(bool iv)
 
     data.invisible = iv;
     m_isHidden = iv;
+    m_scene->m_staticGeometry.updateBlocked(this);
 }
 
 bool LVL_Block::lua_slippery()
@@ -918,6 +919,7 @@ void LVL_Block::destroy(bool playEffect)
 
     m_blocked[1] = Block_NONE;
     m_blocked[2] = Block_NONE;
+    m_scene->m_staticGeometry.updateBlocked(this);
     if(!m_destroyed)
     {
         LVL_LayerEngine::Layer &lyr = m_scene->m_layers.getLayer(data.layer);
@@ -963,6 +965,7 @@ void LVL_Block::setDestroyed(bool dstr)
     }
 
     m_destroyed = dstr;
+    m_scene->m_staticGeometry.updateBlocked(this);
 }
 
 long double LVL_Block::zIndex()
@@ -0,0 +1,180 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lvl_broad_phase.h"
+#include "../scene_level.h"
+
+#include <algorithm>
+
+const double LVL_BroadPhase::clusterMargin = 32.0;
+const double LVL_BroadPhase::clusterMaxSize = 1024.0;
+
+/*!
+ * \brief Same intersection test as the tree query does
+ */
+static inline bool zoneIntersects(const PGE_RectF &zone, const PGE_physBody::Momentum &m)
+{
+    return !((zone.right() <= m.x) || (m.x + m.w <= zone.left()) ||
+             (zone.bottom() <= m.y) || (m.y + m.h <= zone.top()));
+}
+
+void LVL_BroadPhase::build(LevelScene *scene, const std::vector<PGE_Phys_Object *> &bodies)
+{
+    m_bodies = &bodies;
+    m_order.clear();
+    m_zones.resize(bodies.size());
+
+    for(size_t i = 0; i < bodies.size(); i++)
+    {
+        PGE_Phys_Object *body = bodies[i];
+        if(body->isPaused())
+            continue;
+        m_zones[i] = body->collisionZone().withMargin(clusterMargin);
+        m_order.push_back(i);
+    }
+
+    buildClusters(scene);
+}
+
+void LVL_BroadPhase::buildZones(LevelScene *scene, const std::vector<PGE_RectF> &zones)
+{
+    m_bodies = nullptr;
+    m_order.clear();
+    m_zones = zones;
+
+    for(size_t i = 0; i < zones.size(); i++)
+        m_order.push_back(i);
+
+    buildClusters(scene);
+}
+
+void LVL_BroadPhase::buildClusters(LevelScene *scene)
+{
+    m_scene = scene;
+    m_bodyCluster.assign(m_zones.size(), noCluster);
+    m_clusters.clear();
+    m_candidates.clear();
+
+    std::sort(m_order.begin(), m_order.end(), [this](size_t a, size_t b)->bool
+    {
+        return m_zones[a].left() < m_zones[b].left();
+    });
+
+    // Sweep along X axis and join overlapping areas into clusters
+    Cluster cur;
+    bool hasCluster = false;
+    for(size_t i : m_order)
+    {
+        const PGE_RectF &z = m_zones[i];
+        if(hasCluster)
+        {
+            double l = std::min(cur.zone.left(), z.left());
+            double t = std::min(cur.zone.top(), z.top());
+            double r = std::max(cur.zone.right(), z.right());
+            double b = std::max(cur.zone.bottom(), z.bottom());
+            bool overlaps = (z.left() <= cur.zone.right()) &&
+                            (z.top() <= cur.zone.bottom()) &&
+                            (z.bottom() >= cur.zone.top());
+            if(overlaps && ((r - l) <= clusterMaxSize) && ((b - t) <= clusterMaxSize))
+            {
+                cur.zone.setRect(l, t, r - l, b - t);
+                m_bodyCluster[i] = m_clusters.size();
+                continue;
+            }
+            m_clusters.push_back(cur);
+        }
+        cur.zone = z;
+        hasCluster = true;
+        m_bodyCluster[i] = m_clusters.size();
+    }
+
+    if(hasCluster)
+        m_clusters.push_back(cur);
+
+    for(Cluster &c : m_clusters)
+    {
+        c.begin = m_candidates.size();
+        m_scene->queryItems(c.zone, &m_candidates);
+        c.end = m_candidates.size();
+    }
+
+    m_candSlot.resize(m_candidates.size());
+    for(size_t i = 0; i < m_candidates.size(); i++)
+        m_candSlot[i] = m_candidates[i]->m_treemap.m_geometrySlot;
+}
+
+void LVL_BroadPhase::query(size_t index, const PGE_RectF &zone, std::vector<PGE_Phys_Object *> &out) const
+{
+    const size_t scanBlock = 64;
+    const Cluster &c = m_clusters[m_bodyCluster[index]];
+    const LVL_StaticGeometry &geometry = m_scene->m_staticGeometry;
+    const double zLeft = zone.left(), zTop = zone.top();
+    const double zRight = zone.right(), zBottom = zone.bottom();
+    const uint32_t *slots = m_candSlot.data();
+    unsigned char hit[scanBlock];
+
+    for(size_t begin = c.begin; begin < c.end; begin += scanBlock)
+    {
+        size_t count = std::min(scanBlock, c.end - begin);
+
+        for(size_t i = 0; i < count; i++)
+        {
+            uint32_t slot = slots[begin + i];
+            hit[i] = static_cast<unsigned char>((slot == LVL_StaticGeometry::noSlot) ||
+                                                geometry.intersects(slot, zLeft, zTop, zRight, zBottom));
+        }
+
+        for(size_t i = 0; i < count; i++)
+        {
+            if(!hit[i])
+                continue;
+            PGE_Phys_Object *CUR = m_candidates[begin + i];
+            if(!zoneIntersects(zone, CUR->m_momentum))
+                continue;
+            out.push_back(CUR);
+        }
+    }
+}
+
+void LVL_BroadPhase::collide(size_t index)
+{
+    PGE_Phys_Object *body = (*m_bodies)[index];
+
+    if(m_bodyCluster[index] == noCluster)
+    {
+        // Body was paused while broad phase has been built, look for candidates by regular way
+        body->updateCollisions();
+        return;
+    }
+
+    PGE_RectF zone = body->collisionZone();
+    std::vector<PGE_Phys_Object *> &objs = m_buffers.objs;
+    objs.clear();
+    query(index, zone, objs);
+
+    // Remove self, paused and hidden objects
+    size_t j = 0;
+    for(size_t i = 0; i < objs.size(); i++)
+    {
+        if(body->isCollisionCandidate(objs[i]))
+            objs[j++] = objs[i];
+    }
+    objs.resize(j);
+
+    body->updateCollisions(m_buffers);
+}
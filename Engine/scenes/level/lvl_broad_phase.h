@@ -0,0 +1,138 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LVL_BROAD_PHASE_H
+#define LVL_BROAD_PHASE_H
+
+#include "lvl_base_object.h"
+#include <vector>
+
+class LevelScene;
+
+/*!
+ * \brief Broad phase of the collision check for all dynamic bodies of the frame
+ *
+ * Search areas of bodies are sorted along X axis and swept into clusters of
+ * neighbouring bodies. Tree of the scene is queried once per cluster, and every
+ * body picks own candidates from the cluster result. Candidates are filtered at
+ * the moment of the body check by actual positions, so bodies which were moved
+ * by collisions resolved earlier in the same frame are still handled correctly.
+ * All lists are kept between frames to don't allocate them every frame.
+ *
+ * Built by buildZones(), it serves as a read-only snapshot of the tree for the
+ * given areas: query() is safe to call from several threads at once while the
+ * tree itself is not modified.
+ *
+ * Fixed bodies (terrain) are scanned by their slots in the static geometry store
+ * of the scene, which is kept in sync by tree operations, so most of candidates
+ * are rejected without touching of objects themselves. Candidates which passed
+ * the scan and all other bodies are checked by their actual positions.
+ */
+class LVL_BroadPhase
+{
+public:
+    /*!
+     * \brief Find candidates for all given bodies
+     * \param scene Level scene which tree will be queried
+     * \param bodies Bodies to check, must be kept unchanged until next build
+     */
+    void build(LevelScene *scene, const std::vector<PGE_Phys_Object *> &bodies);
+
+    /*!
+     * \brief Query the tree for given search areas
+     * \param scene Level scene which tree will be queried
+     * \param zones Search areas
+     */
+    void buildZones(LevelScene *scene, const std::vector<PGE_RectF> &zones);
+
+    /*!
+     * \brief Find objects intersecting with the search area. Thread-safe
+     * \param index Index of search area given to buildZones() or of the body given to build()
+     * \param zone Actual search area, must be inside of the area given on build
+     * \param out [out] Found objects
+     */
+    void query(size_t index, const PGE_RectF &zone, std::vector<PGE_Phys_Object *> &out) const;
+
+    /*!
+     * \brief Resolve collisions of the body with its candidates (narrow phase)
+     * \param index Index of body in the list given to build()
+     */
+    void collide(size_t index);
+
+    /*!
+     * \brief Count of tree queries made by recent build()
+     * \return count of clusters
+     */
+    size_t clustersCount() const
+    {
+        return m_clusters.size();
+    }
+
+    /*!
+     * \brief Is body can't be moved by collisions, so its geometry can be cached while frame is processed
+     * \param body Physical body
+     * \return true if body is a static non-NPC object
+     */
+    static inline bool isFixedBody(const PGE_Phys_Object *body)
+    {
+        return (body->m_bodytype == PGE_physBody::Body_STATIC) &&
+               (body->type != PGE_Phys_Object::LVLNPC) &&
+               (body->type != PGE_Phys_Object::LVLPlayer);
+    }
+
+    /*!
+     * \brief Extra margin of cluster search area to catch bodies which will be moved while resolving collisions
+     */
+    static const double clusterMargin;
+    /*!
+     * \brief Maximal width and height of cluster search area, bigger groups are split into several clusters
+     */
+    static const double clusterMaxSize;
+
+private:
+    void buildClusters(LevelScene *scene);
+
+    static const size_t noCluster = static_cast<size_t>(-1);
+
+    struct Cluster
+    {
+        PGE_RectF zone;
+        //! First candidate in the m_candidates
+        size_t    begin = 0;
+        //! End of candidates in the m_candidates
+        size_t    end = 0;
+    };
+
+    LevelScene *m_scene = nullptr;
+    //! Bodies of the current frame
+    const std::vector<PGE_Phys_Object *> *m_bodies = nullptr;
+    //! Indices of search areas sorted by left edge
+    std::vector<size_t> m_order;
+    //! Search areas of bodies
+    std::vector<PGE_RectF> m_zones;
+    //! Cluster of every search area
+    std::vector<size_t> m_bodyCluster;
+    std::vector<Cluster> m_clusters;
+    //! Candidates of all clusters
+    std::vector<PGE_Phys_Object *> m_candidates;
+    //! Slots of candidates in the static geometry store, non-fixed bodies have no slot and always pass the scan
+    std::vector<uint32_t> m_candSlot;
+    PGE_Phys_Object::CollisionBuffers m_buffers;
+};
+
+#endif // LVL_BROAD_PHASE_H
@@ -26,6 +26,9 @@
 #include <audio/play_music.h>
 #include <graphics/gl_renderer.h>
 #include <Utils/maths.h>
+#include <common_features/profiler.h>
+
+#include <algorithm>
 
 #include "../scene_level.h"
 
@@ -46,11 +49,7 @@ PGE_LevelCamera::PGE_LevelCamera(LevelScene *_parent) : _scene(_parent)
     cur_section = nullptr;
     fader.setNull();
     m_autoScrool.camera = this;
-    _objects_to_render_max = 1000;
-    _objects_to_render = reinterpret_cast<PGE_Phys_Object **>(malloc(sizeof(PGE_Phys_Object *) * static_cast<size_t>(_objects_to_render_max)));
-    SDL_assert(_objects_to_render);//Out of memory?
-    _objects_to_render_stored = 0;
-    _objects_to_render_recent = 0;
+    _objects_to_render.reserve(1000);
     _disable_cache_mode = false;
     shake_enabled_x = false;
     shake_enabled_y = false;
@@ -75,11 +74,8 @@ PGE_LevelCamera::PGE_LevelCamera(const PGE_LevelCamera &cam) : _scene(cam._scene
     fader = cam.fader;
     m_autoScrool = cam.m_autoScrool;
     m_autoScrool.camera = this;
-    _objects_to_render_max = cam._objects_to_render_max;
-    _objects_to_render_stored = cam._objects_to_render_stored;
-    _objects_to_render_recent = cam._objects_to_render_recent;
-    _objects_to_render = static_cast<PGE_Phys_Object **>(malloc(sizeof(PGE_Phys_Object *) * static_cast<size_t>(_objects_to_render_max)));
-    memcpy(_objects_to_render, cam._objects_to_render, static_cast<size_t>(_objects_to_render_max));
+    _objects_to_render = cam._objects_to_render;
+    _objects_to_render_new = cam._objects_to_render_new;
     _disable_cache_mode = cam._disable_cache_mode;
     shake_enabled_x = cam.shake_enabled_x;
     shake_enabled_y = cam.shake_enabled_y;
@@ -90,9 +86,7 @@ PGE_LevelCamera::PGE_LevelCamera(const PGE_LevelCamera &cam) : _scene(cam._scene
 }
 
 PGE_LevelCamera::~PGE_LevelCamera()
-{
-    free(_objects_to_render);
-}
+{}
 
 void PGE_LevelCamera::init(double x, double y, double w, double h)
 {
@@ -190,40 +184,45 @@ void PGE_LevelCamera::updatePre(double frameDelay)
 
 void PGE_LevelCamera::updatePost(double frameDelay)
 {
+    PGE_PROFILE_ZONE("PGE_LevelCamera::updatePost");
     if(!cur_section)
         return;
 
+    _objects_to_render_new.clear();
+
     if(_disable_cache_mode)
-    {
-        _objects_to_render_stored = 0;
-        _objects_to_render_recent = 0;
-    }
+        _objects_to_render.clear();
     else
     {
-        //Check exists items and remove invizible
-        int offset = 0;
+        //Check exists items and remove invizible, order of remaining items is kept
+        size_t stored = 0;
 
-        for(int i = 0; i < _objects_to_render_stored; i++)
+        for(size_t i = 0; i < _objects_to_render.size(); i++)
         {
-            if(offset > 0)
-                _objects_to_render[i] = _objects_to_render[i + offset];
             PGE_Phys_Object *obj = _objects_to_render[i];
             PGE_Phys_Object::metaCamera *meta = &obj->m_camera_meta;
 
             if(meta->isVizibleOnScreen && obj->isVisible())
+            {
                 meta->isVizibleOnScreen = false;
+                long double z = obj->zIndex();
+                if(z != meta->zIndex)
+                {
+                    //Z-index was changed, find a new place for this item
+                    meta->zIndex = z;
+                    _objects_to_render_new.push_back(obj);
+                }
+                else
+                    _objects_to_render[stored++] = obj;
+            }
             else
             {
                 meta->isInIenderList = false;
                 meta->isVizibleOnScreen = false;
-                offset++;
-                _objects_to_render_stored--;
-                i--;
             }
         }
 
-        if(offset > 0)
-            _objects_to_render_recent = _objects_to_render_stored;
+        _objects_to_render.resize(stored);
     }
 
     queryItems(posRect);
@@ -256,12 +255,9 @@ void PGE_LevelCamera::updatePost(double frameDelay)
         npcs_to_activate.pop();
     }
 
-    //Sort array if modified
-    if(_objects_to_render_recent != _objects_to_render_stored)
-    {
+    //Put new items into their places
+    if(!_objects_to_render_new.empty())
         sortElements();
-        _objects_to_render_recent = _objects_to_render_stored;
-    }
 
     // Draw in-scene backgrounds
     cur_section->m_background.drawInScene(posRect.x() + offset_x, posRect.y() + offset_y, posRect.width(), posRect.height());
@@ -348,68 +344,21 @@ void PGE_LevelCamera::shakeScreenY(double forceY, double dec_step_y)
     }
 }
 
-void PGE_LevelCamera::sortElements()
+static bool compareRenderZ(const PGE_Phys_Object *a, const PGE_Phys_Object *b)
 {
-    if(_objects_to_render_stored <= 1) return;   //Nothing to sort!
-
-    std::vector<int> beg;
-    std::vector<int> end;
-    beg.reserve(static_cast<size_t>(_objects_to_render_stored));
-    end.reserve(static_cast<size_t>(_objects_to_render_stored));
-
-    PGE_Phys_Object *piv;
-    int i = 0, L, R, swapv;
-    beg.push_back(0);
-    end.push_back(_objects_to_render_stored);
-
-//Macros to fix "int to size_t" warning conversion
-#define Beg(x) beg[static_cast<size_t>(x)]
-#define End(y) end[static_cast<size_t>(y)]
-
-    while(i >= 0)
-    {
-        L = Beg(i);
-        R = End(i) - 1;
-
-        if(L < R)
-        {
-            piv = _objects_to_render[L];
-
-            while(L < R)
-            {
-                while((_objects_to_render[R]->zIndex() >= piv->zIndex())  && (L < R)) R--;
-                if(L < R) _objects_to_render[L++] = _objects_to_render[R];
-
-                while((_objects_to_render[L]->zIndex() <= piv->zIndex()) && (L < R)) L++;
-                if(L < R) _objects_to_render[R--] = _objects_to_render[L];
-            }
-
-            _objects_to_render[L] = piv;
-            beg.push_back(L + 1);
-            end.push_back(End(i));
-            End(i++) = (L);
+    return a->m_camera_meta.zIndex < b->m_camera_meta.zIndex;
+}
 
-            if((End(i) - Beg(i)) > (End(i - 1) - Beg(i - 1)))
-            {
-                swapv = Beg(i);
-                Beg(i) = Beg(i - 1);
-                Beg(i - 1) = swapv;
-                swapv = End(i);
-                End(i) = End(i - 1);
-                End(i - 1) = swapv;
-            }
-        }
-        else
-        {
-            i--;
-            beg.pop_back();
-            end.pop_back();
-        }
-    }
+void PGE_LevelCamera::sortElements()
+{
+    // Only new items are sorted, then they are merged with already sorted list.
+    // Both steps are stable: objects with equal Z-index are kept in order they were found
+    std::stable_sort(_objects_to_render_new.begin(), _objects_to_render_new.end(), compareRenderZ);
 
-//Remove those macros
-#undef Beg
-#undef End
+    PGE_RenderList::difference_type middle = static_cast<PGE_RenderList::difference_type>(_objects_to_render.size());
+    _objects_to_render.insert(_objects_to_render.end(), _objects_to_render_new.begin(), _objects_to_render_new.end());
+    std::inplace_merge(_objects_to_render.begin(), _objects_to_render.begin() + middle, _objects_to_render.end(), compareRenderZ);
+    _objects_to_render_new.clear();
 }
 
 void PGE_LevelCamera::changeSectionBorders(long left, long top, long right, long bottom)
@@ -426,23 +375,23 @@ void PGE_LevelCamera::resetLimits()
 
 PGE_Phys_Object **PGE_LevelCamera::renderObjects_arr()
 {
-    return _objects_to_render;
+    return _objects_to_render.data();
 }
 
 int PGE_LevelCamera::renderObjects_max()
 {
-    return _objects_to_render_max;
+    return static_cast<int>(_objects_to_render.capacity());
 }
 
 int PGE_LevelCamera::renderObjects_count()
 {
-    return _objects_to_render_stored;
+    return static_cast<int>(_objects_to_render.size());
 }
 
 void PGE_LevelCamera::setRenderObjects_count(int count)
 {
-    _objects_to_render_stored = count;
-    _objects_to_render_recent = count;
+    if(count >= 0 && static_cast<size_t>(count) < _objects_to_render.size())
+        _objects_to_render.resize(static_cast<size_t>(count));
 }
 
 void PGE_LevelCamera::setRenderObjectsCacheEnabled(bool enabled)
@@ -520,19 +469,8 @@ checkRenderability:
 
             if(renderable && (!item->m_camera_meta.isInIenderList || list->_disable_cache_mode))
             {
-                if(list->_objects_to_render_stored >= list->_objects_to_render_max - 2)
-                {
-                    list->_objects_to_render_max += 1000;
-                    list->_objects_to_render = static_cast<PGE_Phys_Object **>(realloc(list->_objects_to_render, sizeof(PGE_Phys_Object *) * static_cast<size_t>(list->_objects_to_render_max)));
-
-                    if(!list->_objects_to_render)
-                    {
-                        pLogFatal("PGE_LevelCamera: Memory overflow!");
-                        abort();
-                    }
-                }
-                list->_objects_to_render[list->_objects_to_render_stored] = item;
-                list->_objects_to_render_stored++;
+                item->m_camera_meta.zIndex = item->zIndex();
+                list->_objects_to_render_new.push_back(item);
                 if(!list->_disable_cache_mode)
                     item->m_camera_meta.isInIenderList = true;
             }
@@ -198,11 +198,10 @@ class PGE_LevelCamera
     private:
         void _applyLimits();
         void sortElements();
-        //PGE_RenderList     objects_to_render;
-        PGE_Phys_Object **_objects_to_render;
-        int               _objects_to_render_max;
-        int               _objects_to_render_stored;
-        int               _objects_to_render_recent;
+        //! Objects catched by camera, sorted by cached Z-index
+        PGE_RenderList    _objects_to_render;
+        //! Objects catched by camera since recent update, are waiting to be merged into the render list
+        PGE_RenderList    _objects_to_render_new;
         bool              _disable_cache_mode;
 };
 
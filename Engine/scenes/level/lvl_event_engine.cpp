@@ -23,218 +23,116 @@
 #include <data_configs/config_manager.h>
 #include <audio/pge_audio.h>
 
-#include <unordered_set>
-
-LVL_EventAction::LVL_EventAction():
-    m_timeDelayLeft(0.0)
-{}
-
-LVL_EventAction::~LVL_EventAction()
-{}
-
-
-
 LVL_EventEngine::LVL_EventEngine() :
     m_scene(nullptr)
 {}
 
 LVL_EventEngine::~LVL_EventEngine()
 {
-    events.clear();
+    clear();
 }
 
 void LVL_EventEngine::addSMBX64Event(LevelSMBX64Event &evt)
 {
-    LVL_EventAction evntAct;
-    evntAct.m_eventName = evt.name;
-    evntAct.m_timeDelayLeft = 0.0;
+    LVL_NameTable &names = m_scene->m_names;
+    EventId id = names.intern(evt.name);
+    bool smoke = !evt.nosmoke;
+
+    Step main;
+    main.opsBegin = static_cast<uint32_t>(m_ops.size());
 
     if(!evt.layers_hide.empty())
     {
-        EventQueueEntry<LVL_EventAction> hideLayers;
-        PGEStringList layers = evt.layers_hide;
-        bool          smoke  = !evt.nosmoke;
-        hideLayers.makeCaller([this, layers, smoke]()->void
-        {
-            for(const std::string &ly : layers)
-                m_scene->m_layers.hide(ly, smoke);
-        }, 0);
-        evntAct.m_action.events.push_back(hideLayers);
+        Op op;
+        op.type = Op::OP_HIDE_LAYERS;
+        op.smoke = smoke;
+        op.namesBegin = static_cast<uint32_t>(m_opNames.size());
+        for(const std::string &ly : evt.layers_hide)
+            m_opNames.push_back(names.intern(ly));
+        op.namesEnd = static_cast<uint32_t>(m_opNames.size());
+        m_ops.push_back(op);
     }
 
     if(!evt.layers_show.empty())
     {
-        EventQueueEntry<LVL_EventAction> showLayers;
-        PGEStringList   layers  = evt.layers_show;
-        bool            smoke   = !evt.nosmoke;
-        // Detect "Destroyed blocks" layer and replace it with special command
-        for(PGEStringList::iterator it = layers.begin(); it != layers.end(); )
+        Op op;
+        op.type = Op::OP_SHOW_LAYERS;
+        op.smoke = smoke;
+        op.namesBegin = static_cast<uint32_t>(m_opNames.size());
+        for(const std::string &ly : evt.layers_show)
         {
-            std::string *lyr = &(*it);
-            // Undestroy destroyed blocks
-            if(lyr->compare(DESTROYED_LAYER_NAME) == 0)
+            // Detect "Destroyed blocks" layer and replace it with special command
+            if(ly.compare(DESTROYED_LAYER_NAME) == 0)
             {
-                EventQueueEntry<LVL_EventAction> undestroyBlocks;
-                undestroyBlocks.makeCaller([this, smoke]()->void
-                {
-                    m_scene->restoreDestroyedBlocks(smoke);
-                }, 0);
-                evntAct.m_action.events.push_back(undestroyBlocks);
-                it = layers.erase(it);
+                Op undestroy;
+                undestroy.type = Op::OP_RESTORE_DESTROYED_BLOCKS;
+                undestroy.smoke = smoke;
+                m_ops.push_back(undestroy);
             }
             else
-                it++;
+                m_opNames.push_back(names.intern(ly));
         }
-        showLayers.makeCaller([this, layers, smoke]()->void
-        {
-            for(const std::string &ly : layers)
-                m_scene->m_layers.show(ly, smoke);
-        }, 0);
-        evntAct.m_action.events.push_back(showLayers);
+        op.namesEnd = static_cast<uint32_t>(m_opNames.size());
+        m_ops.push_back(op);
     }
 
     if(!evt.layers_toggle.empty())
     {
-        EventQueueEntry<LVL_EventAction> toggleLayers;
-        PGESTRINGList   layers = evt.layers_toggle;
-        bool            smoke  = !evt.nosmoke;
-        toggleLayers.makeCaller([this, layers, smoke]()->void
-        {
-            for(const std::string &ly : layers)
-                m_scene->m_layers.toggle(ly, smoke);
-        }, 0);
-        evntAct.m_action.events.push_back(toggleLayers);
+        Op op;
+        op.type = Op::OP_TOGGLE_LAYERS;
+        op.smoke = smoke;
+        op.namesBegin = static_cast<uint32_t>(m_opNames.size());
+        for(const std::string &ly : evt.layers_toggle)
+            m_opNames.push_back(names.intern(ly));
+        op.namesEnd = static_cast<uint32_t>(m_opNames.size());
+        m_ops.push_back(op);
     }
 
     if(evt.sound_id > 0)
     {
-        EventQueueEntry<LVL_EventAction> playsnd;
-        long soundID = evt.sound_id;
-        playsnd.makeCaller([this, soundID]()->void
-        {
-            PGE_Audio::playSound(soundID);
-        }, 0);
-        evntAct.m_action.events.push_back(playsnd);
+        Op op;
+        op.type = Op::OP_PLAY_SOUND;
+        op.value = evt.sound_id;
+        m_ops.push_back(op);
     }
 
     for(size_t i = 0; i < evt.sets.size(); i++)
     {
-        if(evt.sets[i].background_id != -1)
-        {
-            EventQueueEntry<LVL_EventAction> bgToggle;
+        const LevelEvent_Sets &set = evt.sets[i];
 
-            if(evt.sets[i].background_id < 0)
-            {
-                bgToggle.makeCaller([this, i]()->void
-                {
-                    if(i < m_scene->m_sections.size())
-                    {
-                        m_scene->m_sections[i].resetBG();
-
-                        for(size_t j = 0; j < m_scene->m_cameras.size(); j++)
-                        {
-                            if(m_scene->m_cameras[j].cur_section == &m_scene->m_sections[i])
-                                m_scene->m_sections[i].initBG();
-                        }
-                    }
-
-                }, 0);
-            }
-            else
-            {
-                unsigned long bgID = static_cast<unsigned long>(evt.sets[i].background_id);
-                bgToggle.makeCaller([this, bgID, i]()->void
-                {
-                    if(i < m_scene->m_sections.size())
-                    {
-                        m_scene->m_sections[i].setBG(bgID);
-
-                        for(size_t j = 0; j < m_scene->m_cameras.size(); j++)
-                        {
-                            if(m_scene->m_cameras[j].cur_section == &m_scene->m_sections[i])
-                                m_scene->m_sections[i].initBG();
-                        }
-                    }
-                }, 0);
-            }
-
-            evntAct.m_action.events.push_back(bgToggle);
+        if(set.background_id != -1)
+        {
+            Op op;
+            op.type = (set.background_id < 0) ? Op::OP_RESET_BACKGROUND : Op::OP_SET_BACKGROUND;
+            op.section = i;
+            op.value = set.background_id;
+            m_ops.push_back(op);
         }
 
-        if(evt.sets[i].music_id != -1)
+        if(set.music_id != -1)
         {
-            EventQueueEntry<LVL_EventAction> musToggle;
-
-            if(evt.sets[i].music_id < 0)
-            {
-                musToggle.makeCaller([this, i]()->void
-                {
-                    if(i < m_scene->m_sections.size())
-                    {
-                        m_scene->m_sections[i].resetMusic();
-
-                        for(size_t j = 0; j < m_scene->m_cameras.size(); j++)
-                        {
-                            if(m_scene->m_cameras[j].cur_section == &m_scene->m_sections[i])
-                                m_scene->m_sections[i].playMusic();
-                        }
-                    }
-                }, 0);
-            }
-            else
-            {
-                int musID = static_cast<int>(evt.sets[i].music_id);
-                musToggle.makeCaller([this, musID, i]()->void
-                {
-                    if(i < m_scene->m_sections.size())
-                    {
-                        m_scene->m_sections[i].setMusic(static_cast<unsigned int>(musID));
-
-                        for(size_t j = 0; j < m_scene->m_cameras.size(); j++)
-                        {
-                            if(m_scene->m_cameras[j].cur_section == &m_scene->m_sections[i])
-                                m_scene->m_sections[i].playMusic();
-                        }
-                    }
-                }, 0);
-            }
-
-            evntAct.m_action.events.push_back(musToggle);
+            Op op;
+            op.type = (set.music_id < 0) ? Op::OP_RESET_MUSIC : Op::OP_SET_MUSIC;
+            op.section = i;
+            op.value = set.music_id;
+            m_ops.push_back(op);
         }
 
-        if(evt.sets[i].position_left != -1)
+        if(set.position_left != -1)
         {
-            EventQueueEntry<LVL_EventAction> bordersToggle;
-
-            if(evt.sets[i].position_left == -2)
-            {
-                bordersToggle.makeCaller([this, i]()->void
-                {
-                    if(i < m_scene->m_sections.size())
-                    {
-                        m_scene->m_sections[i].resetLimits();
-                    }
-                }, 0);
-            }
+            Op op;
+            op.section = i;
+            if(set.position_left == -2)
+                op.type = Op::OP_RESET_BORDERS;
             else
             {
-                long box[4] =
-                {
-                    evt.sets[i].position_left,
-                    evt.sets[i].position_top,
-                    evt.sets[i].position_right,
-                    evt.sets[i].position_bottom
-                };
-                bordersToggle.makeCaller([this, box, i]()->void
-                {
-                    if(i < m_scene->m_sections.size())
-                    {
-                        m_scene->m_sections[i].changeLimitBorders(box[0], box[1], box[2], box[3]);
-                    }
-                }, 0);
+                op.type = Op::OP_SET_BORDERS;
+                op.box[0] = set.position_left;
+                op.box[1] = set.position_top;
+                op.box[2] = set.position_right;
+                op.box[3] = set.position_bottom;
             }
-
-            evntAct.m_action.events.push_back(bordersToggle);
+            m_ops.push_back(op);
         }
     }
 
@@ -243,128 +141,272 @@ void LVL_EventEngine::addSMBX64Event(LevelSMBX64Event &evt)
         && ((evt.move_camera_x != 0.0) || (evt.move_camera_y != 0.0))
     )
     {
-        EventQueueEntry<LVL_EventAction> installAutoscroll;
-        installAutoscroll.makeCaller([this, evt]()->void
-        {
-            LVL_Section &section = m_scene->m_sections[static_cast<size_t>(evt.scroll_section)];
-            section.m_isAutoscroll = true;
-            section.m_autoscrollVelocityX = evt.move_camera_x;
-            section.m_autoscrollVelocityY = evt.move_camera_y;
-
-            for(size_t j = 0; j < m_scene->m_cameras.size(); j++)
-            {
-                if(m_scene->m_cameras[j].cur_section == &section)
-                {
-                    m_scene->m_cameras[j].m_autoScrool.enabled = true;
-                    m_scene->m_cameras[j].m_autoScrool.resetAutoscroll();
-                }
-            }
-        }, 0);
-        evntAct.m_action.events.push_back(installAutoscroll);
+        Op op;
+        op.type = Op::OP_AUTOSCROLL;
+        op.section = static_cast<size_t>(evt.scroll_section);
+        op.speedX = evt.move_camera_x;
+        op.speedY = evt.move_camera_y;
+        m_ops.push_back(op);
     }
 
     if(!evt.msg.empty())
     {
-        EventQueueEntry<LVL_EventAction> message;
-        message.makeCaller([this, evt]()->void
-        {
-            EventQueueEntry<LevelScene > msgBox;
-            std::string message = evt.msg;
-            msgBox.makeCaller(
-            [this, message]()->void{
-                m_scene->m_messages.showMsg(message);
-                //                                   PGE_MsgBox box(_scene, evt.msg,
-                //                                   PGE_MsgBox::msg_info, PGE_Point(-1,-1), -1,
-                //                                   ConfigManager::setup_message_box.sprite);
-                //                                   box.exec();
-            }, 0.0);
-            m_scene->m_systemEvents.events.push_back(msgBox);
-        }, 0);
-        evntAct.m_action.events.push_back(message);
+        Op op;
+        op.type = Op::OP_MESSAGE;
+        op.value = static_cast<long>(m_messages.size());
+        m_messages.push_back(evt.msg);
+        m_ops.push_back(op);
     }
 
     if(!evt.movelayer.empty())
     {
-        EventQueueEntry<LVL_EventAction> movelayer;
-        movelayer.makeCaller([this, evt]()->void
-        {
-            m_scene->m_layers.installLayerMotion(evt.movelayer, evt.layer_speed_x, evt.layer_speed_y);
-        }, 0);
-        evntAct.m_action.events.push_back(movelayer);
-        evntAct.m_timeDelayLeft = 0.0;
+        Op op;
+        op.type = Op::OP_MOVE_LAYER;
+        op.namesBegin = static_cast<uint32_t>(m_opNames.size());
+        m_opNames.push_back(names.intern(evt.movelayer));
+        op.namesEnd = static_cast<uint32_t>(m_opNames.size());
+        op.speedX = evt.layer_speed_x;
+        op.speedY = evt.layer_speed_y;
+        m_ops.push_back(op);
     }
 
-    events[evt.name].push_back(evntAct);
+    main.opsEnd = static_cast<uint32_t>(m_ops.size());
+
+    if(m_program.size() < names.size())
+        m_program.resize(names.size());
+    m_program[id].push_back(main);
 
     if(!evt.trigger.empty())
     {
-        LVL_EventAction trigger;
-        trigger.m_eventName = evt.name;
-        EventQueueEntry<LVL_EventAction> triggerEvent;
-        std::string trgr = evt.trigger;
-        triggerEvent.makeCaller([this, trgr]()->void
-        {
-            m_scene->m_events.triggerEvent(trgr);
-        },
-        static_cast<double>(evt.trigger_timer) * 100.0
-        //                ((double(evt.trigger_timer) / 10.0) * 65.0)
-                               );
-        trigger.m_action.events.push_back(triggerEvent);
-        events[evt.name].push_back(trigger);
+        Step trigger;
+        trigger.isTrigger = true;
+        trigger.trigger = names.intern(evt.trigger);
+        trigger.delay = static_cast<double>(evt.trigger_timer) * 100.0;
+        m_program[id].push_back(trigger);
     }
 
     //Automatically trigger events
     if((evt.name == "Level - Start") || evt.autostart == LevelSMBX64Event::AUTO_LevelStart)
-        workingEvents.push_back(events[evt.name]);
+        triggerEvent(id);
 }
 
 void LVL_EventEngine::processTimers(double tickTime)
 {
-    std::unordered_set<std::string> triggered;
+    m_stepNumber++;
+    if(m_completedAt.size() < m_program.size())
+        m_completedAt.resize(m_program.size(), 0);
 
-    //static double smbxTimeUnit = 65.0 / 1000.0;
-    for(size_t i = 0; i < workingEvents.size(); i++)
+    // When the same event completes twice during one step, the rest of its steps are postponed
+    bool     hasSkip = false;
+    uint32_t skipSerial = 0;
+
+    // Triggered events are appended to the end and are processed in the same step
+    for(size_t i = 0; i < m_working.size(); i++)
     {
-        EventActList *ea = &workingEvents[i];
-        if(ea->empty())
-        {
-            workingEvents.erase(workingEvents.begin() + int(i--));
+        Cursor c = m_working[i];
+        if(c.done || (hasSkip && c.serial == skipSerial))
             continue;
+        hasSkip = false;
+
+        const Step &step = m_program[c.event][c.step];
+        if(step.isTrigger)
+        {
+            c.delayLeft -= tickTime;
+            if(c.delayLeft > 0.0)
+            {
+                m_working[i].delayLeft = c.delayLeft;
+                continue;
+            }
+            triggerEvent(step.trigger);
         }
+        else
+            runOps(step);
+
+        m_working[i].done = true;
+        if(m_completedAt.size() < m_program.size())
+            m_completedAt.resize(m_program.size(), 0);
 
-        for(size_t j = 0; j < ea->size(); j++)
+        if(m_completedAt[c.event] == m_stepNumber)
         {
-            LVL_EventAction *ee = &(*ea)[j];
-            if(ee->m_timeDelayLeft <= 0.0)
+            hasSkip = true;
+            skipSerial = c.serial;
+        }
+        else
+            m_completedAt[c.event] = m_stepNumber;
+    }
+
+    size_t kept = 0;
+    for(size_t i = 0; i < m_working.size(); i++)
+    {
+        if(!m_working[i].done)
+            m_working[kept++] = m_working[i];
+    }
+    m_working.resize(kept);
+}
+
+void LVL_EventEngine::triggerEvent(const std::string &event)
+{
+    if(event.empty())
+        return;
+    triggerEvent(eventId(event));
+}
+
+void LVL_EventEngine::triggerEvent(EventId event)
+{
+    if(event >= m_program.size())
+        return;
+
+    const std::vector<Step> &steps = m_program[event];
+    if(steps.empty())
+        return;
+
+    uint32_t serial = ++m_triggerSerial;
+    for(size_t i = 0; i < steps.size(); i++)
+    {
+        Cursor c;
+        c.event = event;
+        c.step = static_cast<uint32_t>(i);
+        c.serial = serial;
+        c.done = false;
+        c.delayLeft = steps[i].delay;
+        m_working.push_back(c);
+    }
+}
+
+LVL_EventEngine::EventId LVL_EventEngine::eventId(const std::string &event) const
+{
+    if(!m_scene)
+        return LVL_NameTable::invalid;
+    return m_scene->m_names.find(event);
+}
+
+void LVL_EventEngine::clear()
+{
+    m_program.clear();
+    m_ops.clear();
+    m_opNames.clear();
+    m_messages.clear();
+    m_working.clear();
+    m_completedAt.clear();
+    m_triggerSerial = 0;
+    m_stepNumber = 0;
+}
+
+void LVL_EventEngine::runOps(const Step &step)
+{
+    LevelScene *scene = m_scene;
+
+    for(uint32_t o = step.opsBegin; o < step.opsEnd; o++)
+    {
+        const Op &op = m_ops[o];
+
+        switch(op.type)
+        {
+        case Op::OP_HIDE_LAYERS:
+            for(uint32_t n = op.namesBegin; n < op.namesEnd; n++)
+                scene->m_layers.hide(m_opNames[n], op.smoke);
+            break;
+
+        case Op::OP_SHOW_LAYERS:
+            for(uint32_t n = op.namesBegin; n < op.namesEnd; n++)
+                scene->m_layers.show(m_opNames[n], op.smoke);
+            break;
+
+        case Op::OP_TOGGLE_LAYERS:
+            for(uint32_t n = op.namesBegin; n < op.namesEnd; n++)
+                scene->m_layers.toggle(m_opNames[n], op.smoke);
+            break;
+
+        case Op::OP_RESTORE_DESTROYED_BLOCKS:
+            scene->restoreDestroyedBlocks(op.smoke);
+            break;
+
+        case Op::OP_PLAY_SOUND:
+            PGE_Audio::playSound(op.value);
+            break;
+
+        case Op::OP_RESET_BACKGROUND:
+        case Op::OP_SET_BACKGROUND:
+            if(op.section < scene->m_sections.size())
             {
-                ee->m_action.processEvents(tickTime /* *smbxTimeUnit*/);
+                LVL_Section &section = scene->m_sections[op.section];
+                if(op.type == Op::OP_RESET_BACKGROUND)
+                    section.resetBG();
+                else
+                    section.setBG(static_cast<unsigned long>(op.value));
 
-                if(ee->m_action.events.empty())
+                for(size_t j = 0; j < scene->m_cameras.size(); j++)
                 {
-                    if(triggered.find(ee->m_eventName) != triggered.end())
-                    {
-                        ea->erase(ea->begin() + j);
-                        j--;
-                        break;
-                    }
-                    triggered.insert(ee->m_eventName);
-                    ea->erase(ea->begin() + j);
-                    j--;
-                    continue;
+                    if(scene->m_cameras[j].cur_section == &section)
+                        section.initBG();
                 }
             }
-            else
-                ee->m_timeDelayLeft -= tickTime;
+            break;
+
+        case Op::OP_RESET_MUSIC:
+        case Op::OP_SET_MUSIC:
+            if(op.section < scene->m_sections.size())
+            {
+                LVL_Section &section = scene->m_sections[op.section];
+                if(op.type == Op::OP_RESET_MUSIC)
+                    section.resetMusic();
+                else
+                    section.setMusic(static_cast<unsigned int>(op.value));
+
+                for(size_t j = 0; j < scene->m_cameras.size(); j++)
+                {
+                    if(scene->m_cameras[j].cur_section == &section)
+                        section.playMusic();
+                }
+            }
+            break;
+
+        case Op::OP_RESET_BORDERS:
+            if(op.section < scene->m_sections.size())
+                scene->m_sections[op.section].resetLimits();
+            break;
+
+        case Op::OP_SET_BORDERS:
+            if(op.section < scene->m_sections.size())
+                scene->m_sections[op.section].changeLimitBorders(op.box[0], op.box[1], op.box[2], op.box[3]);
+            break;
+
+        case Op::OP_AUTOSCROLL:
+        {
+            LVL_Section &section = scene->m_sections[op.section];
+            section.m_isAutoscroll = true;
+            section.m_autoscrollVelocityX = op.speedX;
+            section.m_autoscrollVelocityY = op.speedY;
+
+            for(size_t j = 0; j < scene->m_cameras.size(); j++)
+            {
+                if(scene->m_cameras[j].cur_section == &section)
+                {
+                    scene->m_cameras[j].m_autoScrool.enabled = true;
+                    scene->m_cameras[j].m_autoScrool.resetAutoscroll();
+                }
+            }
+            break;
+        }
+
+        case Op::OP_MESSAGE:
+            showMessage(static_cast<size_t>(op.value));
+            break;
+
+        case Op::OP_MOVE_LAYER:
+            scene->m_layers.installLayerMotion(m_opNames[op.namesBegin], op.speedX, op.speedY);
+            break;
         }
     }
 }
 
-void LVL_EventEngine::triggerEvent(std::string event)
+void LVL_EventEngine::showMessage(size_t message)
 {
-    if(event.empty())
-        return;
-
-    EventsTable::iterator e = events.find(event);
-    if(e != events.end())
-        workingEvents.push_back(e->second);
+    EventQueueEntry<LevelScene > msgBox;
+    msgBox.makeCaller([this, message]()->void
+    {
+        if(message < m_messages.size())
+            m_scene->m_messages.showMsg(m_messages[message]);
+    }, 0.0);
+    m_scene->m_systemEvents.events.push_back(msgBox);
 }
@@ -20,40 +20,133 @@
 #define LVL_EVENTENGINE_H
 
 #include <PGE_File_Formats/lvl_filedata.h>
-#include <common_features/event_queue.h>
-#include <Utils/vptrlist.h>
+#include "lvl_name_table.h"
 #include <string>
 #include <vector>
-#include <unordered_map>
-
-class LVL_EventAction
-{
-public:
-    LVL_EventAction();
-    LVL_EventAction(const LVL_EventAction &ea) = default;
-    virtual ~LVL_EventAction();
-
-    std::string m_eventName;
-    EventQueue<LVL_EventAction > m_action;
-    double m_timeDelayLeft = 0.0;
-};
+#include <cstdint>
 
 class LevelScene;
+/**
+ * @brief Runs level events
+ *
+ * Events are compiled at load into a program indexed by identifier of the event name.
+ * Triggered event creates small cursors which are pointing into the program.
+ */
 class LVL_EventEngine
 {
     friend class LevelScene;
     LevelScene *m_scene = nullptr;
 public:
+    typedef LVL_NameTable::Id EventId;
+
     LVL_EventEngine();
     virtual ~LVL_EventEngine();
+    /**
+     * @brief Compile SMBX64 event and append it to the program of its name
+     * @param evt Event data
+     */
     void addSMBX64Event(LevelSMBX64Event &evt);
     void processTimers(double tickTime);
-    void triggerEvent(std::string event);
-    typedef VPtrList<LVL_EventAction >  EventActList;
-    typedef VPtrList<EventActList >     WorkingEvents;
-    WorkingEvents   workingEvents;
-    typedef std::unordered_map<std::string, EventActList > EventsTable;
-    EventsTable events;
+    /**
+     * @brief Trigger event by name
+     * @param event Name of event
+     */
+    void triggerEvent(const std::string &event);
+    /**
+     * @brief Trigger event by identifier
+     * @param event Identifier of event name
+     */
+    void triggerEvent(EventId event);
+    /**
+     * @brief Get identifier of event to trigger it without name lookups
+     * @param event Name of event
+     * @return identifier of event, or LVL_NameTable::invalid when event is unknown
+     */
+    EventId eventId(const std::string &event) const;
+    /**
+     * @brief Remove all compiled events and running cursors
+     */
+    void clear();
+
+private:
+    //! Single action of the event
+    struct Op
+    {
+        enum Type
+        {
+            OP_HIDE_LAYERS = 0,
+            OP_SHOW_LAYERS,
+            OP_TOGGLE_LAYERS,
+            OP_RESTORE_DESTROYED_BLOCKS,
+            OP_PLAY_SOUND,
+            OP_RESET_BACKGROUND,
+            OP_SET_BACKGROUND,
+            OP_RESET_MUSIC,
+            OP_SET_MUSIC,
+            OP_RESET_BORDERS,
+            OP_SET_BORDERS,
+            OP_AUTOSCROLL,
+            OP_MESSAGE,
+            OP_MOVE_LAYER
+        };
+        Type    type = OP_PLAY_SOUND;
+        bool    smoke = false;
+        //! Sound, background or music ID, or index of message
+        long    value = 0;
+        //! Index of section
+        size_t  section = 0;
+        //! Range of layer names in m_opNames
+        uint32_t namesBegin = 0;
+        uint32_t namesEnd = 0;
+        //! Section borders
+        long    box[4] = {0, 0, 0, 0};
+        //! Speed of autoscroll or layer motion
+        double  speedX = 0.0;
+        double  speedY = 0.0;
+    };
+
+    //! Step of event which runs independently from other steps of same event
+    struct Step
+    {
+        //! Run range of operations, or trigger another event after delay
+        bool    isTrigger = false;
+        //! Range of operations in m_ops
+        uint32_t opsBegin = 0;
+        uint32_t opsEnd = 0;
+        //! Event to trigger
+        EventId trigger = LVL_NameTable::invalid;
+        //! Delay before trigger in milliseconds
+        double  delay = 0.0;
+    };
+
+    //! Running step of triggered event
+    struct Cursor
+    {
+        EventId  event;
+        uint32_t step;
+        //! Steps which were triggered together share same serial number
+        uint32_t serial;
+        bool     done;
+        double   delayLeft;
+    };
+
+    void runOps(const Step &step);
+    void showMessage(size_t message);
+
+    //! Steps of every event, indexed by event identifier
+    std::vector<std::vector<Step> > m_program;
+    std::vector<Op>                 m_ops;
+    //! Layer names referred by operations
+    std::vector<LVL_NameTable::Id>  m_opNames;
+    std::vector<std::string>        m_messages;
+
+    std::vector<Cursor> m_working;
+    //! Serial number of the latest trigger
+    uint32_t m_triggerSerial = 0;
+    //! Number of processTimers() call, used to detect completion of same event twice during one step
+    uint64_t m_stepNumber = 0;
+    //! Step number where event has completed a step, indexed by event identifier
+    std::vector<uint64_t> m_completedAt;
 };
 
 #endif // LVL_EVENTENGINE_H
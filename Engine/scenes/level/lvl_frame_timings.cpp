@@ -0,0 +1,88 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lvl_frame_timings.h"
+
+#include <Utils/files.h>
+#include <common_features/logger.h>
+
+#include <algorithm>
+
+LVL_FrameTimings::LVL_FrameTimings() :
+    m_file(nullptr)
+{}
+
+LVL_FrameTimings::~LVL_FrameTimings()
+{
+    close();
+}
+
+bool LVL_FrameTimings::open(const std::string &path)
+{
+    close();
+    m_file = Files::utf8_fopen(path.c_str(), "wb");
+    if(!m_file)
+    {
+        pLogWarning("Can't create frame timings file %s", path.c_str());
+        return false;
+    }
+    std::fprintf(m_file, "step,update_us,collide_us,render_us,checksum\n");
+    m_updateTimes.clear();
+    m_renderTimes.clear();
+    return true;
+}
+
+static double percentile(std::vector<double> &times, double p)
+{
+    if(times.empty())
+        return 0.0;
+    size_t n = static_cast<size_t>(p * static_cast<double>(times.size() - 1));
+    std::nth_element(times.begin(), times.begin() + static_cast<std::ptrdiff_t>(n), times.end());
+    return times[n];
+}
+
+void LVL_FrameTimings::close()
+{
+    if(!m_file)
+        return;
+
+    std::fclose(m_file);
+    m_file = nullptr;
+
+    pLogInfo("Frame timings of %u steps, update: p50=%.1f us, p99=%.1f us, max=%.1f us; "
+             "render: p50=%.1f us, p99=%.1f us",
+             static_cast<unsigned>(m_updateTimes.size()),
+             percentile(m_updateTimes, 0.50),
+             percentile(m_updateTimes, 0.99),
+             percentile(m_updateTimes, 1.0),
+             percentile(m_renderTimes, 0.50),
+             percentile(m_renderTimes, 0.99));
+}
+
+void LVL_FrameTimings::add(unsigned long step, int64_t updateNs, int64_t collideNs, int64_t renderNs, uint32_t checksum)
+{
+    if(!m_file)
+        return;
+
+    double updateUs  = static_cast<double>(updateNs) / 1000.0;
+    double collideUs = static_cast<double>(collideNs) / 1000.0;
+    double renderUs  = static_cast<double>(renderNs) / 1000.0;
+    std::fprintf(m_file, "%lu,%.1f,%.1f,%.1f,%08x\n", step, updateUs, collideUs, renderUs, checksum);
+    m_updateTimes.push_back(updateUs);
+    m_renderTimes.push_back(renderUs);
+}
@@ -0,0 +1,73 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LVL_FRAME_TIMINGS_H
+#define LVL_FRAME_TIMINGS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Writer of timings of every loop step of the level into CSV file
+ *
+ * Every line contains number of step, time of update, collisions and rendering
+ * in microseconds and checksum of the level state after the step. Checksums
+ * of two runs by same input track are equal when replay is exact.
+ */
+class LVL_FrameTimings
+{
+public:
+    LVL_FrameTimings();
+    ~LVL_FrameTimings();
+
+    /*!
+     * \brief Create the file and write header into it
+     * \param path Path to the CSV file
+     * \return true on success
+     */
+    bool open(const std::string &path);
+    /*!
+     * \brief Close the file and print summary of timings into log
+     */
+    void close();
+
+    inline bool isOpen() const
+    {
+        return m_file != nullptr;
+    }
+
+    /*!
+     * \brief Write timings of the step
+     * \param step Number of loop step
+     * \param updateNs Time of the world update, nanoseconds
+     * \param collideNs Time of collisions resolving, part of the update, nanoseconds
+     * \param renderNs Time of rendering, nanoseconds
+     * \param checksum Checksum of the level state after the step
+     */
+    void add(unsigned long step, int64_t updateNs, int64_t collideNs, int64_t renderNs, uint32_t checksum);
+
+private:
+    FILE *m_file;
+    //! Update times of all steps for the summary, microseconds
+    std::vector<double> m_updateTimes;
+    std::vector<double> m_renderTimes;
+};
+
+#endif // LVL_FRAME_TIMINGS_H
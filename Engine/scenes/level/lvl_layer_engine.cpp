@@ -23,19 +23,7 @@
 LVL_LayerEngine::LVL_LayerEngine(LevelScene *_parent) :
     m_scene(_parent),
     m_layers()
-{
-    // Automatically initialize special layers
-    {
-        Layer &db = m_layers[DESTROYED_LAYER_NAME];
-        db.m_layerType = Layer::T_DESTROYED_BLOCKS;
-        db.m_visible = false;
-    }
-    {
-        Layer &db = m_layers[SPAWNED_LAYER_NAME];
-        db.m_layerType = Layer::T_SPAWNED_NPCs;
-        db.m_visible = true;
-    }
-}
+{}
 
 void LVL_LayerEngine::spawnSmokeAt(double x, double y)
 {
@@ -45,28 +33,168 @@ void LVL_LayerEngine::spawnSmokeAt(double x, double y)
     m_scene->launchEffect(smoke, true);
 }
 
+LVL_LayerEngine::LayerId LVL_LayerEngine::layerId(const std::string &layer)
+{
+    LayerId id = m_scene->m_names.intern(layer);
+    getLayer(id);
+    return id;
+}
+
+LVL_LayerEngine::LayerId LVL_LayerEngine::findLayer(const std::string &layer) const
+{
+    return m_scene->m_names.find(layer);
+}
+
 LVL_LayerEngine::Layer &LVL_LayerEngine::getLayer(const std::string &lyr)
 {
-    LayersTable::iterator li = m_layers.find(lyr);
-    if(li == m_layers.end())
+    return getLayer(m_scene->m_names.intern(lyr));
+}
+
+LVL_LayerEngine::Layer &LVL_LayerEngine::getLayer(LayerId lyr)
+{
+    if(lyr >= m_layers.size())
+        m_layers.resize(m_scene->m_names.size());
+
+    std::unique_ptr<Layer> &l = m_layers[lyr];
+    if(!l)
+    {
+        l.reset(new Layer);
+        // Automatically initialize special layers
+        const std::string &name = m_scene->m_names.name(lyr);
+        if(name.compare(DESTROYED_LAYER_NAME) == 0)
+        {
+            l->m_layerType = Layer::T_DESTROYED_BLOCKS;
+            l->m_visible = false;
+        }
+        else if(name.compare(SPAWNED_LAYER_NAME) == 0)
+        {
+            l->m_layerType = Layer::T_SPAWNED_NPCs;
+            l->m_visible = true;
+        }
+    }
+    return *l;
+}
+
+void LVL_LayerEngine::setLayerVisible(LVL_LayerEngine::Layer &lyr, bool visible)
+{
+    if(lyr.m_layerType != Layer::T_REGULAR)
+        return;
+    lyr.m_visible = visible;
+    // Static members are checking this flag instead of being toggled one by one
+    lyr.m_rtree.setVisible(visible);
+}
+
+bool LVL_LayerEngine::canBeStatic(const Layer &lyr, const PGE_Phys_Object *item)
+{
+    // NPCs are always toggled one by one because of their own reactions on showing and hiding
+    return (lyr.m_layerType == Layer::T_REGULAR) &&
+           (item->m_bodytype == PGE_Phys_Object::Body_STATIC) &&
+           (item->type != PGE_Phys_Object::LVLNPC);
+}
+
+void LVL_LayerEngine::takeMember(Layer::Members &list, PGE_Phys_Object *item)
+{
+    //Swap with the last member to don't shift the whole list
+    size_t slot = item->m_layerMember.m_slot;
+    PGE_Phys_Object *last = list.back();
+    list[slot] = last;
+    last->m_layerMember.m_slot = slot;
+    list.pop_back();
+}
+
+void LVL_LayerEngine::detachStaticMember(Layer &lyr, PGE_Phys_Object *item)
+{
+    PGE_Phys_Object::LayerMember &member = item->m_layerMember;
+    takeMember(lyr.m_staticMembers, item);
+    // Keep effective visibility
+    item->m_is_visible = lyr.m_visible;
+    member.m_static = false;
+    member.m_slot = lyr.m_members.size();
+    lyr.m_members.push_back(item);
+}
+
+void LVL_LayerEngine::detachStaticMembers(Layer &lyr)
+{
+    for(PGE_Phys_Object *body : lyr.m_staticMembers)
+    {
+        body->m_is_visible = lyr.m_visible;
+        body->m_layerMember.m_static = false;
+        body->m_layerMember.m_slot = lyr.m_members.size();
+        lyr.m_members.push_back(body);
+    }
+    lyr.m_staticMembers.clear();
+    lyr.m_rtree.setVisible(true);
+}
+
+void LVL_LayerEngine::attachStaticMembers(Layer &lyr)
+{
+    if(lyr.m_layerType != Layer::T_REGULAR)
+        return;
+    // Called when all members got visibility of the layer, so own flags are no longer needed
+    size_t kept = 0;
+    for(size_t i = 0; i < lyr.m_members.size(); i++)
+    {
+        PGE_Phys_Object *body = lyr.m_members[i];
+        PGE_Phys_Object::LayerMember &member = body->m_layerMember;
+        if(canBeStatic(lyr, body))
+        {
+            body->m_is_visible = true;
+            member.m_static = true;
+            member.m_slot = lyr.m_staticMembers.size();
+            lyr.m_staticMembers.push_back(body);
+            continue;
+        }
+        member.m_slot = kept;
+        lyr.m_members[kept++] = body;
+    }
+    lyr.m_members.resize(kept);
+}
+
+void LVL_LayerEngine::setMemberVisible(PGE_Phys_Object *item, bool visible)
+{
+    PGE_Phys_Object::LayerMember &member = item->m_layerMember;
+    if((member.m_id == LVL_NameTable::invalid) || (member.m_id >= m_layers.size()) || !m_layers[member.m_id])
+    {
+        item->m_is_visible = visible;
+        return;
+    }
+
+    Layer &lyr = *m_layers[member.m_id];
+    if(member.m_static)
+    {
+        if(visible == lyr.m_visible)
+            return; // Already has this visibility by the layer's flag
+        if(visible)
+            detachStaticMembers(lyr); // Sub-tree of hidden layer must be shown to show one of its members
+        else
+            detachStaticMember(lyr, item);
+    }
+    else if(visible && (item->m_parent == &lyr.m_rtree) && !lyr.m_rtree.m_is_visible)
+        detachStaticMembers(lyr);
+
+    item->m_is_visible = visible;
+}
+
+void LVL_LayerEngine::spawnSmokeAtVisible(const Layer::Members &members)
+{
+    for(PGE_Phys_Object *body : members)
     {
-        Layer &lr = m_layers[lyr];
-        lr.m_layerType = Layer::T_REGULAR;
-        lr.m_visible = true;
-        return lr;
+        if(body->m_is_visible)
+            spawnSmokeAt(body->posCenterX(), body->posCenterY());
     }
-    return li->second;
 }
 
+void LVL_LayerEngine::hide(const std::string &layer, bool smoke)
+{
+    hide(m_scene->m_names.intern(layer), smoke);
+}
 
-void LVL_LayerEngine::hide(std::string layer, bool smoke)
+void LVL_LayerEngine::hide(LayerId layer, bool smoke)
 {
     Layer &lyr = getLayer(layer);
-    for(Layer::Members::iterator it = lyr.m_members.begin();
-        it != lyr.m_members.end();
-        it++)
+    for(size_t i = 0; i < lyr.m_members.size(); i++)
     {
-        PGE_Phys_Object *body = *it;
+        PGE_Phys_Object *body = lyr.m_members[i];
         if(!body->isVisible())
             continue;
         body->hide();
@@ -74,61 +202,43 @@ void LVL_LayerEngine::hide(std::string layer, bool smoke)
             spawnSmokeAt(body->posCenterX(), body->posCenterY());
     }
 
-    if(lyr.m_layerType == Layer::T_REGULAR)
-        lyr.m_visible = false;
+    if(smoke && lyr.m_visible)
+        spawnSmokeAtVisible(lyr.m_staticMembers);
+    attachStaticMembers(lyr);
+    setLayerVisible(lyr, false);
 }
 
-void LVL_LayerEngine::show(std::string layer, bool smoke)
+void LVL_LayerEngine::show(const std::string &layer, bool smoke)
+{
+    show(m_scene->m_names.intern(layer), smoke);
+}
+
+void LVL_LayerEngine::show(LayerId layer, bool smoke)
 {
     Layer &lyr = getLayer(layer);
-    /*
-    if(lyr.m_layerType == Layer::T_DESTROYED_BLOCKS)
+    // Showing of a member may detach static members and append them to the list
+    for(size_t i = 0; i < lyr.m_members.size(); i++)
     {
-        //Restore all destroyed and modified blocks into their initial states
-        for(Layer::Members::iterator it = lyr.m_members.begin();
-            it != lyr.m_members.end();
-            it++)
-        {
-            LVL_Block *blk = dynamic_cast<LVL_Block *>(*it);
-            if(!blk)
-                continue;
-            //lyr.m_members.remove(intptr_t(blk));
-            bool wasInvisible = !blk->isVisible() || blk->m_destroyed;
-            blk->setVisible(true);
-            blk->init(true);//Force re-initialize block from initial data
-            if(smoke && wasInvisible)
-            {
-                PGE_Phys_Object::Momentum momentum = blk->m_momentum_relative;
-                Layer &lyrn = getLayer(blk->data.layer);//Get block's original layer
-                momentum.x -= lyrn.m_rtree.m_offsetX;
-                momentum.y -= lyrn.m_rtree.m_offsetY;
-                spawnSmokeAt(momentum.centerX(), momentum.centerY());
-            }
-        }
-
-        //Clear layer from objects
-        lyr.m_members.clear();
+        PGE_Phys_Object *body = lyr.m_members[i];
+        if(body->isVisible())
+            continue;
+        body->show();
+        if(smoke)
+            spawnSmokeAt(body->posCenterX(), body->posCenterY());
     }
-    else
-    {*/
-        for(Layer::Members::iterator it = lyr.m_members.begin();
-            it != lyr.m_members.end();
-            it++)
-        {
-            PGE_Phys_Object *body = *it;
-            if(body->isVisible())
-                continue;
-            body->show();
-            if(smoke)
-                spawnSmokeAt(body->posCenterX(), body->posCenterY());
-        }
-    //}
 
-    if(lyr.m_layerType == Layer::T_REGULAR)
-        lyr.m_visible = true;
+    if(smoke && !lyr.m_visible)
+        spawnSmokeAtVisible(lyr.m_staticMembers);
+    attachStaticMembers(lyr);
+    setLayerVisible(lyr, true);
 }
 
-void LVL_LayerEngine::toggle(std::string layer, bool smoke)
+void LVL_LayerEngine::toggle(const std::string &layer, bool smoke)
+{
+    toggle(m_scene->m_names.intern(layer), smoke);
+}
+
+void LVL_LayerEngine::toggle(LayerId layer, bool smoke)
 {
     Layer &lyr = getLayer(layer);
     bool viz = !lyr.m_visible;
@@ -143,20 +253,44 @@ void LVL_LayerEngine::toggle(std::string layer, bool smoke)
         return;
     }
 
-    for(Layer::Members::iterator it = lyr.m_members.begin(); it != lyr.m_members.end(); it++)
+    // Showing of a member may detach static members and append them to the list
+    for(size_t i = 0; i < lyr.m_members.size(); i++)
     {
-        PGE_Phys_Object *body = *it;
+        PGE_Phys_Object *body = lyr.m_members[i];
         body->setVisible(viz);
         if(smoke)
             spawnSmokeAt(body->posCenterX(), body->posCenterY());
     }
 
-    if(lyr.m_layerType == Layer::T_REGULAR)
-        lyr.m_visible = viz;
+    if(smoke)
+    {
+        for(PGE_Phys_Object *body : lyr.m_staticMembers)
+            spawnSmokeAt(body->posCenterX(), body->posCenterY());
+    }
+    attachStaticMembers(lyr);
+    setLayerVisible(lyr, viz);
+}
+
+bool LVL_LayerEngine::isVisible(LayerId layer) const
+{
+    if((layer >= m_layers.size()) || !m_layers[layer])
+        return true;
+    return m_layers[layer]->m_visible;
+}
+
+void LVL_LayerEngine::registerItem(const std::string &layer, PGE_Phys_Object *item, bool keepAbsPos)
+{
+    registerItem(m_scene->m_names.intern(layer), item, keepAbsPos);
 }
 
-void LVL_LayerEngine::registerItem(std::string layer, PGE_Phys_Object *item, bool keepAbsPos)
+void LVL_LayerEngine::registerItem(LayerId layer, PGE_Phys_Object *item, bool keepAbsPos)
 {
+    PGE_Phys_Object::LayerMember &member = item->m_layerMember;
+    //Item was registered in another layer
+    if((member.m_id != LVL_NameTable::invalid) && (member.m_id != layer))
+        removeRegItem(item, keepAbsPos);
+
+    bool isRegistered = (member.m_id == layer);
     //Register item in the layer
     Layer &lyr = getLayer(layer);
     //if( (item->type == PGE_Phys_Object::LVLBGO)||
@@ -177,21 +311,39 @@ void LVL_LayerEngine::registerItem(std::string layer, PGE_Phys_Object *item, boo
         }
     }
 
-    lyr.m_members.insert(item);
-    if(lyr.m_layerType == Layer::T_REGULAR)
+    if(!isRegistered)
+    {
+        // While static members are detached, new ones are toggled one by one too
+        member.m_static = canBeStatic(lyr, item) && (lyr.m_visible || !lyr.m_rtree.m_is_visible);
+        Layer::Members &list = member.m_static ? lyr.m_staticMembers : lyr.m_members;
+        member.m_id = layer;
+        member.m_slot = list.size();
+        list.push_back(item);
+    }
+
+    if(member.m_static)
+        item->m_is_visible = true;
+    else if(lyr.m_layerType == Layer::T_REGULAR)
         item->setVisible(lyr.m_visible);
 }
 
-void LVL_LayerEngine::removeRegItem(std::string layer, PGE_Phys_Object *item, bool keepAbsPos)
+void LVL_LayerEngine::removeRegItem(PGE_Phys_Object *item, bool keepAbsPos)
 {
+    PGE_Phys_Object::LayerMember &member = item->m_layerMember;
+    if((member.m_id == LVL_NameTable::invalid) || (member.m_id >= m_layers.size()) || !m_layers[member.m_id])
+        return;
+
     //Remove item from the layer
-    Layer &lyr = m_layers[layer];
+    Layer &lyr = *m_layers[member.m_id];
     //if( (item->type == PGE_Phys_Object::LVLBGO)||
     //    (item->type == PGE_Phys_Object::LVLBlock)||
     //    (item->type == PGE_Phys_Object::LVLWarp)||
     //    (item->type == PGE_Phys_Object::LVLPhysEnv) )
     if(item->m_bodytype == PGE_Phys_Object::Body_STATIC)
     {
+        // Keep effective visibility of the item out of the layer
+        if(member.m_static && !lyr.m_visible)
+            item->m_is_visible = false;
         setItemMovable(lyr, item, false, keepAbsPos);
         if(item->type == PGE_Phys_Object::LVLBlock)
         {
@@ -203,12 +355,17 @@ void LVL_LayerEngine::removeRegItem(std::string layer, PGE_Phys_Object *item, bo
             }
         }
     }
-    lyr.m_members.erase(item);
+
+    takeMember(member.m_static ? lyr.m_staticMembers : lyr.m_members, item);
+
+    member.m_id = LVL_NameTable::invalid;
+    member.m_slot = 0;
+    member.m_static = false;
 }
 
-void LVL_LayerEngine::moveToAnotherLayerItem(std::string oldLayer, std::string newLayer, PGE_Phys_Object *item, bool keepAbsPos)
+void LVL_LayerEngine::moveToAnotherLayerItem(LayerId newLayer, PGE_Phys_Object *item, bool keepAbsPos)
 {
-    removeRegItem(oldLayer, item, keepAbsPos);
+    removeRegItem(item, keepAbsPos);
     registerItem(newLayer, item, keepAbsPos);
 }
 
@@ -291,30 +448,36 @@ void LVL_LayerEngine::setItemMovable(LVL_LayerEngine::Layer &lyr, PGE_Phys_Objec
     }
 }
 
-void LVL_LayerEngine::installLayerMotion(std::string layer, double speedX, double speedY)
+void LVL_LayerEngine::installLayerMotion(const std::string &layer, double speedX, double speedY)
 {
-    MovingLayersTable::iterator mv = m_movingLayers.find(layer);
-    if(mv != m_movingLayers.end())
-    {
-        MovingLayer &l = mv->second;
-        l.m_speedX = speedX;
-        l.m_speedY = speedY;
-    }
-    else
+    LayerId id = findLayer(layer);
+    if(id != LVL_NameTable::invalid)
+        installLayerMotion(id, speedX, speedY);
+}
+
+void LVL_LayerEngine::installLayerMotion(LayerId layer, double speedX, double speedY)
+{
+    for(MovingLayer &l : m_movingLayers)
     {
-        if((speedX == 0.0) && (speedY == 0.0))
-            return;//Don't store zero-speed layers!
-        LayersTable::iterator li = m_layers.find(layer);
-        if(li == m_layers.end())
+        if(l.m_layer == layer)
+        {
+            l.m_speedX = speedX;
+            l.m_speedY = speedY;
             return;
-        Layer &lyr = li->second;
-        MovingLayer l;
-        l.m_speedX = speedX;
-        l.m_speedY = speedY;
-        l.m_members = &lyr.m_members;
-        l.m_subtree = &lyr.m_rtree;
-        m_movingLayers.insert({layer, l});
+        }
     }
+
+    if((speedX == 0.0) && (speedY == 0.0))
+        return;//Don't store zero-speed layers!
+    if((layer >= m_layers.size()) || !m_layers[layer])
+        return;
+    Layer &lyr = *m_layers[layer];
+    MovingLayer l;
+    l.m_layer = layer;
+    l.m_speedX = speedX;
+    l.m_speedY = speedY;
+    l.m_subtree = &lyr.m_rtree;
+    m_movingLayers.push_back(l);
 }
 
 void LVL_LayerEngine::processMoving(double tickTime)
@@ -322,12 +485,10 @@ void LVL_LayerEngine::processMoving(double tickTime)
     if(m_movingLayers.empty())
         return;
 
-    std::vector<std::string> remove_list;
-    for(MovingLayersTable::iterator layerIt = m_movingLayers.begin();
-        layerIt != m_movingLayers.end();
-        layerIt++)
+    size_t kept = 0;
+    for(size_t i = 0; i < m_movingLayers.size(); i++)
     {
-        MovingLayer &l = layerIt->second;
+        MovingLayer &l = m_movingLayers[i];
         l.m_subtree->m_momentum.velX    = l.m_speedX;
         l.m_subtree->m_momentum.velXsrc = l.m_speedX;
         l.m_subtree->m_momentum.velY    = l.m_speedY;
@@ -340,53 +501,28 @@ void LVL_LayerEngine::processMoving(double tickTime)
             l.m_subtree->m_offsetYold = l.m_subtree->m_momentum_relative.y - l.m_subtree->m_momentum.oldy;
             l.m_subtree->m_treemap.updatePos();
         }
-//        for(Layer::Members::iterator it = l.m_members->begin(); it != l.m_members->end(); it++)
-//        {
-//            PGE_Phys_Object *obj = it->second;
-//            //Don't iterate playable characters
-//            if(obj->type == PGE_Phys_Object::LVLPlayer)
-//                continue;
-
-//            //obj->setSpeed(l.m_speedX, l.m_speedY);
-
-//            ////Don't iterate activated NPC's!
-//            //if(obj->type == PGE_Phys_Object::LVLNPC)
-//            //{
-//            //    LVL_Npc *npc = dynamic_cast<LVL_Npc *>(obj);
-//            //    SDL_assert_release(npc);
-//            //    if(npc)
-//            //    {
-//            //        if(npc->isActivated /* &&
-//            //           !npc->isGenerator &&
-//            //           !npc->is_scenery*/)
-//            //            continue;
-//            //    }
-//            //    else
-//            //        continue;
-//            //}
-//            ////obj->iterateStep(tickTime, true);
-//            //if((l.m_speedX == 0.0) && (l.m_speedY == 0.0))
-//            //{
-//            //    if(obj->m_bodytype == PGE_physBody::Body_STATIC)
-//            //    {
-//            //        //obj->m_momentum.y = obj->m_momentum.y < 0 ? floor(obj->m_momentum.y) : ceil(obj->m_momentum.y);
-//            //        obj->m_momentum.saveOld();
-//            //    }
-//            //}
-//            //obj->_syncPosition();
-//        }
+
+        //Remove zero-speed layers
         if((l.m_speedX == 0.0) && (l.m_speedY == 0.0))
-            remove_list.push_back(layerIt->first);
+            continue;
+        if(kept != i)
+            m_movingLayers[kept] = l;
+        kept++;
     }
-    //Remove zero-speed layers
-    for(size_t i = 0; i < remove_list.size(); i++)
-        m_movingLayers.erase(remove_list[i]);
+    m_movingLayers.resize(kept);
 }
 
-bool LVL_LayerEngine::isEmpty(std::string layer)
+bool LVL_LayerEngine::isEmpty(const std::string &layer) const
 {
-    LayersTable::iterator i = m_layers.find(layer);
-    return (i == m_layers.end()) || ((i->second.m_members.size() - i->second.m_destroyedObjects) == 0);
+    return isEmpty(findLayer(layer));
+}
+
+bool LVL_LayerEngine::isEmpty(LayerId layer) const
+{
+    if((layer >= m_layers.size()) || !m_layers[layer])
+        return true;
+    const Layer &lyr = *m_layers[layer];
+    return ((lyr.m_members.size() + lyr.m_staticMembers.size() - lyr.m_destroyedObjects) == 0);
 }
 
 void LVL_LayerEngine::clear()
@@ -394,4 +530,3 @@ void LVL_LayerEngine::clear()
     m_movingLayers.clear();
     m_layers.clear();
 }
-
@@ -20,10 +20,11 @@
 #define LVL_LAYER_H
 
 #include <string> // on Emscripten: Must be here, or "type does not provide a call operator" error will appear
-#include <unordered_set>
-#include <unordered_map>
+#include <vector>
+#include <memory>
 #include "lvl_base_object.h"
 #include "lvl_subtree.h"
+#include "lvl_name_table.h"
 
 #define DESTROYED_LAYER_NAME    "Destroyed Blocks"
 #define SPAWNED_LAYER_NAME      "Spawned NPCs"
@@ -37,11 +38,24 @@ public:
     LVL_LayerEngine(LevelScene *_parent=NULL);
     void spawnSmokeAt(double x, double y);
 
+    //! Handle of layer, same as identifier of its name in the name table of the scene
+    typedef LVL_NameTable::Id LayerId;
+
     struct Layer
     {
         bool m_visible = true;
-        typedef std::unordered_set<PGE_Phys_Object* > Members;
+        typedef std::vector<PGE_Phys_Object* > Members;
+        //! Members which are shown and hidden one by one
         Members     m_members;
+        /**
+         * Static members of regular layer which are registered in the sub-tree.
+         * Their visibility is controlled by visibility flag of the sub-tree
+         * which is checked together with own visibility flag of every member.
+         * Own flag of these members is always set, member which is shown or hidden
+         * alone is moved into list of members toggled one by one until the layer
+         * itself is shown or hidden next time.
+         */
+        Members     m_staticMembers;
         //! Count of destroyed objects are
         size_t      m_destroyedObjects = 0;
         //! Sub-tree of statical objects
@@ -55,14 +69,49 @@ public:
         Type m_layerType = T_REGULAR;
     };
 
+    /**
+     * @brief Get handle of layer by name, layer will be created if not exists
+     * @param layer Name of layer
+     * @return handle of layer
+     */
+    LayerId layerId(const std::string &layer);
+    /**
+     * @brief Get handle of existing layer name without creating of new layers
+     * @param layer Name of layer
+     * @return handle of layer or LVL_NameTable::invalid if layer name is unknown
+     */
+    LayerId findLayer(const std::string &layer) const;
+
     Layer &getLayer(const std::string &lyr);
+    /**
+     * @brief Get layer by handle, layer will be created if not exists
+     * @param lyr Valid handle of layer
+     * @return layer
+     */
+    Layer &getLayer(LayerId lyr);
 
-    void hide(std::string layer, bool smoke=true);
-    void show(std::string layer, bool smoke=true);
-    void toggle(std::string layer, bool smoke=true);
-    void registerItem(std::string layer, PGE_Phys_Object* item, bool keepAbsPos = true);
-    void removeRegItem(std::string layer, PGE_Phys_Object* item, bool keepAbsPos = true);
-    void moveToAnotherLayerItem(std::string oldLayer, std::string newLayer, PGE_Phys_Object* item, bool keepAbsPos = true);
+    void hide(const std::string &layer, bool smoke=true);
+    void show(const std::string &layer, bool smoke=true);
+    void toggle(const std::string &layer, bool smoke=true);
+    void hide(LayerId layer, bool smoke=true);
+    void show(LayerId layer, bool smoke=true);
+    void toggle(LayerId layer, bool smoke=true);
+    bool isVisible(LayerId layer) const;
+    /**
+     * @brief Show or hide single member of layer, called by the member itself
+     * @param item Registered member
+     * @param visible New visibility of the member
+     */
+    void setMemberVisible(PGE_Phys_Object *item, bool visible);
+    void registerItem(const std::string &layer, PGE_Phys_Object* item, bool keepAbsPos = true);
+    void registerItem(LayerId layer, PGE_Phys_Object* item, bool keepAbsPos = true);
+    /**
+     * @brief Remove item from the layer where it was registered
+     * @param item Item to remove
+     * @param keepAbsPos keep absolute position of the object
+     */
+    void removeRegItem(PGE_Phys_Object* item, bool keepAbsPos = true);
+    void moveToAnotherLayerItem(LayerId newLayer, PGE_Phys_Object* item, bool keepAbsPos = true);
 
     /**
      * @brief Register item to layer's subtree as movable object and unregister from the scene's tree
@@ -73,23 +122,41 @@ public:
      */
     void setItemMovable(Layer& lyr, PGE_Phys_Object *item, bool enabled, bool keepAbsPos = true);
 
-    bool isEmpty(std::string layer);
+    bool isEmpty(const std::string &layer) const;
+    bool isEmpty(LayerId layer) const;
     void clear();
 
     struct MovingLayer
     {
+        LayerId m_layer;
         double m_speedX;
         double m_speedY;
-        Layer::Members  *m_members;
         LVL_SubTree     *m_subtree;
     };
 
-    void installLayerMotion(std::string layer, double speedX, double speedY);
-    typedef std::unordered_map<std::string, Layer> LayersTable;
+    void installLayerMotion(const std::string &layer, double speedX, double speedY);
+    void installLayerMotion(LayerId layer, double speedX, double speedY);
+    //! Layers indexed by handle, null for names which are not layers
+    typedef std::vector<std::unique_ptr<Layer> > LayersTable;
     LayersTable         m_layers;
-    typedef std::unordered_map<std::string, MovingLayer> MovingLayersTable;
+    typedef std::vector<MovingLayer> MovingLayersTable;
     MovingLayersTable   m_movingLayers;
     void processMoving(double tickTime);
+
+private:
+    void setLayerVisible(Layer &lyr, bool visible);
+    //! Member can be shown and hidden by visibility flag of the layer's sub-tree
+    static bool canBeStatic(const Layer &lyr, const PGE_Phys_Object *item);
+    //! Remove item from list of members by the slot stored in the item
+    static void takeMember(Layer::Members &list, PGE_Phys_Object *item);
+    //! Move static member into list of members toggled one by one
+    static void detachStaticMember(Layer &lyr, PGE_Phys_Object *item);
+    //! Move all static members into list of members toggled one by one and show the sub-tree
+    static void detachStaticMembers(Layer &lyr);
+    //! Move members which can be static back into the list of static members
+    static void attachStaticMembers(Layer &lyr);
+    //! Spawn smoke effect at every member which is visible by own flag
+    void spawnSmokeAtVisible(const Layer::Members &members);
 };
 
 #endif // LVL_LAYER_H
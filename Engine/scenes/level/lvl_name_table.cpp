@@ -0,0 +1,50 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "lvl_name_table.h"
+
+LVL_NameTable::Id LVL_NameTable::intern(const std::string &name)
+{
+    std::unordered_map<std::string, Id>::iterator it = m_ids.find(name);
+    if(it != m_ids.end())
+        return it->second;
+
+    Id id = static_cast<Id>(m_names.size());
+    m_names.push_back(name);
+    m_ids.insert({name, id});
+    return id;
+}
+
+LVL_NameTable::Id LVL_NameTable::find(const std::string &name) const
+{
+    std::unordered_map<std::string, Id>::const_iterator it = m_ids.find(name);
+    return (it != m_ids.end()) ? it->second : invalid;
+}
+
+const std::string &LVL_NameTable::name(Id id) const
+{
+    static const std::string empty;
+    return (id < m_names.size()) ? m_names[id] : empty;
+}
+
+void LVL_NameTable::clear()
+{
+    m_ids.clear();
+    m_names.clear();
+}
@@ -0,0 +1,74 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LVL_NAME_TABLE_H
+#define LVL_NAME_TABLE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+/**
+ * @brief Interns names of level layers and events into small integer identifiers
+ *
+ * Names are resolved once while level is loading, running code compares and indexes identifiers only.
+ * Identifiers are never removed until the table is cleared.
+ */
+class LVL_NameTable
+{
+public:
+    typedef uint32_t Id;
+    //! Identifier of a name which is not in the table
+    static const Id invalid = 0xFFFFFFFF;
+
+    /**
+     * @brief Get identifier of the name, add it into the table when it's new
+     * @param name Name of layer or event
+     * @return identifier of the name
+     */
+    Id intern(const std::string &name);
+    /**
+     * @brief Get identifier of the name without adding of it
+     * @param name Name of layer or event
+     * @return identifier of the name or invalid when name is unknown
+     */
+    Id find(const std::string &name) const;
+    /**
+     * @brief Get name by identifier
+     * @param id Identifier of the name
+     * @return name, or empty string for unknown identifier
+     */
+    const std::string &name(Id id) const;
+    /**
+     * @brief Count of interned names, identifiers are less than this value
+     * @return count of names
+     */
+    size_t size() const
+    {
+        return m_names.size();
+    }
+    void clear();
+
+private:
+    std::unordered_map<std::string, Id> m_ids;
+    std::vector<std::string> m_names;
+};
+
+#endif // LVL_NAME_TABLE_H
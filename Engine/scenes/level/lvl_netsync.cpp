@@ -0,0 +1,476 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lvl_netsync.h"
+#include "../scene_level.h"
+
+#include <common_features/logger.h>
+#include <Utils/files.h>
+#include <SDL2/SDL_timer.h>
+
+#include <algorithm>
+#include <iterator>
+
+LVL_NetSync::Setup LVL_NetSync::setup;
+
+LVL_NetSync::LVL_NetSync(LevelScene *scene) :
+    m_scene(scene)
+{}
+
+LVL_NetSync::~LVL_NetSync()
+{
+    if(m_log)
+        std::fclose(m_log);
+}
+
+bool LVL_NetSync::start()
+{
+    m_role = setup.role;
+    if(!setup.logFile.empty() && !m_log)
+    {
+        m_log = Files::utf8_fopen(setup.logFile.c_str(), "wb");
+        if(m_log)
+            std::fprintf(m_log, "side,sequence,time,entities,unresolved,checksum\n");
+        else
+            pLogWarning("NetSync: Can't create log file %s", setup.logFile.c_str());
+    }
+    switch(m_role)
+    {
+    case ROLE_SERVER:
+        if(!m_socket.open(setup.port))
+            return false;
+        pLogDebug("NetSync: Server is listening UDP port %u", static_cast<unsigned>(setup.port));
+        return true;
+    case ROLE_CLIENT:
+        if(!NetSync_UdpSocket::resolve(setup.host, setup.port, m_serverAddress))
+            return false;
+        if(!m_socket.open())
+            return false;
+        rebuildIndex();
+        pLogDebug("NetSync: Client is connecting to %s", m_serverAddress.toString().c_str());
+        return true;
+    default:
+        return false;
+    }
+}
+
+void LVL_NetSync::update(double ticks)
+{
+    m_time += ticks;
+    if(m_role == ROLE_SERVER)
+        updateServer();
+    else if(m_role == ROLE_CLIENT)
+        updateClient();
+}
+
+void LVL_NetSync::updateServer()
+{
+    NetSync_Address from;
+    std::string data;
+    while(m_socket.receive(from, data))
+    {
+        uint32_t acked;
+        if(!NetSync_Codec::decodeAck(data, acked))
+            continue;
+        Peer *peer = nullptr;
+        for(Peer &p : m_peers)
+        {
+            if(p.address == from)
+            {
+                peer = &p;
+                break;
+            }
+        }
+        if(!peer)
+        {
+            pLogDebug("NetSync: New client %s", from.toString().c_str());
+            m_peers.push_back(Peer());
+            peer = &m_peers.back();
+            peer->address = from;
+        }
+        // Acks may come out of order, baseline must be the newest one
+        if((acked == 0) || (static_cast<int32_t>(acked - peer->acked) > 0))
+            peer->acked = acked;
+        peer->lastSeen = m_time;
+    }
+
+    for(size_t i = 0; i < m_peers.size();)
+    {
+        if(m_time - m_peers[i].lastSeen > peerTimeout)
+        {
+            pLogDebug("NetSync: Client %s timed out", m_peers[i].address.toString().c_str());
+            m_peers.erase(m_peers.begin() + static_cast<std::ptrdiff_t>(i));
+            continue;
+        }
+        i++;
+    }
+
+    if(m_peers.empty() || (m_time - m_lastSnapshotTime < snapshotInterval))
+        return;
+    m_lastSnapshotTime = m_time;
+
+    NetSync_Snapshot snapshot;
+    capture(snapshot);
+    m_server.push(snapshot);
+    writeLog("server", snapshot);
+
+    for(Peer &peer : m_peers)
+    {
+        data.clear();
+        if(!m_server.encodeFor(peer.acked, data))
+            continue;
+        m_lastFrameSize = data.size();
+        if(!m_socket.send(peer.address, data))
+            pLogWarning("NetSync: Failed to send frame of %u bytes to %s",
+                        static_cast<unsigned>(data.size()), peer.address.toString().c_str());
+    }
+}
+
+void LVL_NetSync::updateClient()
+{
+    uint32_t now = SDL_GetTicks();
+    NetSync_Address from;
+    std::string data, ackData;
+    uint32_t ack = 0;
+    bool received = false;
+
+    while(m_socket.receive(from, data))
+    {
+        if(!(from == m_serverAddress))
+            continue;
+        if(m_client.receive(data, now, ack))
+        {
+            m_lastFrameSize = data.size();
+            received = true;
+        }
+    }
+
+    if(received || (m_time - m_lastHelloTime >= helloInterval))
+    {
+        // Acknowledge of the latest snapshot, also tells the server that client is alive
+        NetSync_Codec::encodeAck(received ? ack : m_client.latestSequence(), ackData);
+        m_socket.send(m_serverAddress, ackData);
+        m_lastHelloTime = m_time;
+    }
+
+    if(m_client.interpolate(now, m_shown))
+        apply(m_shown);
+
+    if(received)
+        writeLog("client", *m_client.latest());
+}
+
+void LVL_NetSync::capture(NetSync_Snapshot &out)
+{
+    const int ps = NetSync_Entity::positionScale;
+    const int vs = NetSync_Entity::velocityScale;
+    out.time = static_cast<uint32_t>(m_time);
+    out.entities.clear();
+
+    auto fillBody = [ps, vs](NetSync_Entity &e, PGE_Phys_Object *obj)
+    {
+        e.field[NetSync_Entity::F_X]    = NetSync_Entity::quantize(obj->m_momentum.x, ps);
+        e.field[NetSync_Entity::F_Y]    = NetSync_Entity::quantize(obj->m_momentum.y, ps);
+        e.field[NetSync_Entity::F_W]    = NetSync_Entity::quantize(obj->m_momentum.w, ps);
+        e.field[NetSync_Entity::F_H]    = NetSync_Entity::quantize(obj->m_momentum.h, ps);
+        e.field[NetSync_Entity::F_VELX] = NetSync_Entity::quantize(obj->speedX(), vs);
+        e.field[NetSync_Entity::F_VELY] = NetSync_Entity::quantize(obj->speedY(), vs);
+    };
+
+    for(LVL_Player *player : m_scene->m_itemsPlayers)
+    {
+        NetSync_Entity e;
+        e.key = NetSync_Entity::makeKey(NetSync_Entity::KIND_PLAYER, static_cast<uint32_t>(player->playerID));
+        fillBody(e, player);
+        e.field[NetSync_Entity::F_TYPE]      = static_cast<int32_t>(player->characterID);
+        e.field[NetSync_Entity::F_DIRECTION] = player->m_direction;
+        e.field[NetSync_Entity::F_STATE]     = static_cast<int32_t>(player->stateID);
+        e.field[NetSync_Entity::F_FLAGS]     = (player->isVisible() ? NetSync_Entity::FLAG_VISIBLE : 0) |
+                                               (player->isAlive ? 0 : NetSync_Entity::FLAG_KILLED);
+        out.entities.push_back(e);
+    }
+
+    size_t npcsBegin = out.entities.size();
+    for(LVL_Npc *npc : m_scene->m_npcActive)
+    {
+        NetSync_Entity e;
+        e.key = NetSync_Entity::makeKey(NetSync_Entity::KIND_NPC, npc->data.meta.array_id);
+        fillBody(e, npc);
+        e.field[NetSync_Entity::F_TYPE]      = static_cast<int32_t>(npc->_npc_id);
+        e.field[NetSync_Entity::F_DIRECTION] = npc->direction();
+        e.field[NetSync_Entity::F_STATE]     = npc->getHealth();
+        e.field[NetSync_Entity::F_FLAGS]     = NetSync_Entity::FLAG_ACTIVE |
+                                               (npc->isVisible() ? NetSync_Entity::FLAG_VISIBLE : 0) |
+                                               (npc->isKilled() ? NetSync_Entity::FLAG_KILLED : 0);
+        out.entities.push_back(e);
+    }
+
+    // Killed NPCs are deleted before the snapshot, send them as killed for some time,
+    // otherwise the client will only see that NPC is gone and will deactivate it
+    std::unordered_map<uint32_t, NetSync_Entity> captured;
+    for(size_t i = npcsBegin; i < out.entities.size(); i++)
+        captured[out.entities[i].id()] = out.entities[i];
+    std::unordered_map<uint32_t, bool> existing;
+    for(auto &c : m_capturedNpcs)
+    {
+        if(captured.find(c.first) != captured.end())
+            continue;
+        if(existing.empty())
+        {
+            for(LVL_Npc *npc : m_scene->m_itemsNpc)
+                existing[npc->data.meta.array_id] = npc->isKilled();
+        }
+        auto it = existing.find(c.first);
+        if((it != existing.end()) && !it->second)
+            continue; // Deactivated, but still alive
+        Tombstone &t = m_npcTombstones[c.first];
+        t.entity = c.second;
+        t.entity.field[NetSync_Entity::F_FLAGS] |= NetSync_Entity::FLAG_KILLED;
+        t.time = m_time;
+    }
+    for(auto it = m_npcTombstones.begin(); it != m_npcTombstones.end();)
+    {
+        if((m_time - it->second.time > tombstoneLifetime) || (captured.find(it->first) != captured.end()))
+        {
+            it = m_npcTombstones.erase(it);
+            continue;
+        }
+        out.entities.push_back(it->second.entity);
+        ++it;
+    }
+    m_capturedNpcs.swap(captured);
+
+    // Most of blocks are never changed, only ones which are differ from the level file are sent
+    for(LVL_Block *block : m_scene->m_itemsBlocks)
+    {
+        bool changed = block->m_destroyed ||
+                       (block->data.id != block->dataInitial.id) ||
+                       (block->m_isHidden != block->dataInitial.invisible) ||
+                       !block->isVisible() ||
+                       (block->m_momentum.x != static_cast<double>(block->dataInitial.x)) ||
+                       (block->m_momentum.y != static_cast<double>(block->dataInitial.y));
+        if(!changed)
+            continue;
+        NetSync_Entity e;
+        e.key = NetSync_Entity::makeKey(NetSync_Entity::KIND_BLOCK, block->data.meta.array_id);
+        fillBody(e, block);
+        e.field[NetSync_Entity::F_TYPE]  = static_cast<int32_t>(block->data.id);
+        e.field[NetSync_Entity::F_FLAGS] = (block->isVisible() ? NetSync_Entity::FLAG_VISIBLE : 0) |
+                                           (block->m_isHidden ? NetSync_Entity::FLAG_HIDDEN : 0) |
+                                           (block->m_destroyed ? NetSync_Entity::FLAG_DESTROYED : 0);
+        out.entities.push_back(e);
+    }
+
+    out.sort();
+}
+
+void LVL_NetSync::apply(const NetSync_Snapshot &state)
+{
+    // NPCs could be spawned after the start, blocks transformed into NPCs are deleted,
+    // don't keep pointers to them
+    if(m_indexRevision != m_scene->m_itemsRevision)
+        rebuildIndex();
+
+    std::vector<uint32_t> applied;
+    applied.reserve(state.entities.size());
+    size_t unresolved = 0;
+    for(const NetSync_Entity &e : state.entities)
+    {
+        switch(e.kind())
+        {
+        case NetSync_Entity::KIND_PLAYER:
+            for(LVL_Player *player : m_scene->m_itemsPlayers)
+            {
+                if(static_cast<uint32_t>(player->playerID) == e.id())
+                {
+                    applyPlayer(player, e);
+                    break;
+                }
+            }
+            break;
+        case NetSync_Entity::KIND_NPC:
+        {
+            // NPCs spawned by the server are not spawned here, both sides should spawn them by same events.
+            // Until it happened, the NPC is skipped, the index is rebuilt only when the scene has changed
+            auto it = m_npcById.find(e.id());
+            if(it != m_npcById.end())
+            {
+                applyNpc(it->second, e);
+                applied.push_back(e.key);
+            }
+            else
+                unresolved++;
+            break;
+        }
+        case NetSync_Entity::KIND_BLOCK:
+        {
+            auto it = m_blockById.find(e.id());
+            if(it != m_blockById.end())
+            {
+                applyBlock(it->second, e);
+                applied.push_back(e.key);
+            }
+            else
+                unresolved++;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    // Objects which are gone from the snapshot: NPC was deactivated, block got back to its initial state
+    std::vector<uint32_t> removed;
+    std::set_difference(m_appliedKeys.begin(), m_appliedKeys.end(),
+                        applied.begin(), applied.end(),
+                        std::back_inserter(removed));
+    for(uint32_t key : removed)
+    {
+        NetSync_Entity e;
+        e.key = key;
+        if(e.kind() == NetSync_Entity::KIND_NPC)
+        {
+            auto it = m_npcById.find(e.id());
+            if(it != m_npcById.end())
+                removeNpc(it->second);
+        }
+        else if(e.kind() == NetSync_Entity::KIND_BLOCK)
+        {
+            auto it = m_blockById.find(e.id());
+            if(it != m_blockById.end())
+                restoreBlock(it->second);
+        }
+    }
+    m_appliedKeys.swap(applied);
+    m_unresolved = unresolved;
+}
+
+void LVL_NetSync::applyPlayer(LVL_Player *player, const NetSync_Entity &e)
+{
+    const int ps = NetSync_Entity::positionScale;
+    const int vs = NetSync_Entity::velocityScale;
+    if(!player->isAlive)
+        return;
+
+    unsigned long character = static_cast<unsigned long>(e.field[NetSync_Entity::F_TYPE]);
+    unsigned long state = static_cast<unsigned long>(e.field[NetSync_Entity::F_STATE]);
+    if((player->characterID != character) || (player->stateID != state))
+        player->setCharacterSafe(character, state);
+
+    player->setPos(NetSync_Entity::dequantize(e.field[NetSync_Entity::F_X], ps),
+                   NetSync_Entity::dequantize(e.field[NetSync_Entity::F_Y], ps));
+    player->setSpeed(NetSync_Entity::dequantize(e.field[NetSync_Entity::F_VELX], vs),
+                     NetSync_Entity::dequantize(e.field[NetSync_Entity::F_VELY], vs));
+    player->m_direction = e.field[NetSync_Entity::F_DIRECTION];
+}
+
+void LVL_NetSync::applyNpc(LVL_Npc *npc, const NetSync_Entity &e)
+{
+    const int ps = NetSync_Entity::positionScale;
+    const int vs = NetSync_Entity::velocityScale;
+    if(npc->isKilled())
+        return;
+
+    if(e.field[NetSync_Entity::F_FLAGS] & NetSync_Entity::FLAG_KILLED)
+    {
+        npc->kill(LVL_Npc::DAMAGE_NOREASON);
+        return;
+    }
+
+    if(!npc->isActivated)
+    {
+        npc->Activate();
+        m_scene->m_npcActive.insert(npc);
+    }
+
+    npc->setPos(NetSync_Entity::dequantize(e.field[NetSync_Entity::F_X], ps),
+                NetSync_Entity::dequantize(e.field[NetSync_Entity::F_Y], ps));
+    npc->setSpeed(NetSync_Entity::dequantize(e.field[NetSync_Entity::F_VELX], vs),
+                  NetSync_Entity::dequantize(e.field[NetSync_Entity::F_VELY], vs));
+    if(npc->direction() != e.field[NetSync_Entity::F_DIRECTION])
+        npc->setDirection(e.field[NetSync_Entity::F_DIRECTION]);
+    npc->setHealth(e.field[NetSync_Entity::F_STATE]);
+}
+
+void LVL_NetSync::applyBlock(LVL_Block *block, const NetSync_Entity &e)
+{
+    const int ps = NetSync_Entity::positionScale;
+    int32_t flags = e.field[NetSync_Entity::F_FLAGS];
+
+    unsigned long id = static_cast<unsigned long>(e.field[NetSync_Entity::F_TYPE]);
+    if(block->data.id != id)
+        block->transformTo_x(id);
+
+    if((flags & NetSync_Entity::FLAG_DESTROYED) && !block->m_destroyed)
+        block->destroy(true);
+
+    bool hidden = (flags & NetSync_Entity::FLAG_HIDDEN) != 0;
+    if(block->m_isHidden != hidden)
+        block->lua_setInvisible(hidden);
+
+    bool visible = (flags & NetSync_Entity::FLAG_VISIBLE) != 0;
+    if(block->isVisible() != visible)
+        block->setVisible(visible);
+
+    double x = NetSync_Entity::dequantize(e.field[NetSync_Entity::F_X], ps);
+    double y = NetSync_Entity::dequantize(e.field[NetSync_Entity::F_Y], ps);
+    if((block->m_momentum.x != x) || (block->m_momentum.y != y))
+        block->setPos(x, y);
+}
+
+void LVL_NetSync::removeNpc(LVL_Npc *npc)
+{
+    if(npc->isKilled() || !npc->isActivated)
+        return;
+    npc->deActivate();
+    npc->wasDeactivated = false;
+    m_scene->m_npcActive.erase(npc);
+}
+
+void LVL_NetSync::restoreBlock(LVL_Block *block)
+{
+    // Same as LevelScene::restoreDestroyedBlocks() for a single block
+    block->setVisible(true);
+    block->init(true);
+    m_scene->m_blocksDestroyed.erase(block);
+}
+
+void LVL_NetSync::rebuildIndex()
+{
+    m_npcById.clear();
+    for(LVL_Npc *npc : m_scene->m_itemsNpc)
+        m_npcById[npc->data.meta.array_id] = npc;
+    m_blockById.clear();
+    for(LVL_Block *block : m_scene->m_itemsBlocks)
+        m_blockById[block->data.meta.array_id] = block;
+    m_indexRevision = m_scene->m_itemsRevision;
+}
+
+void LVL_NetSync::writeLog(const char *side, const NetSync_Snapshot &snapshot)
+{
+    if(!m_log)
+        return;
+    std::fprintf(m_log, "%s,%u,%u,%u,%u,%08x\n", side,
+                 static_cast<unsigned>(snapshot.sequence),
+                 static_cast<unsigned>(snapshot.time),
+                 static_cast<unsigned>(snapshot.entities.size()),
+                 static_cast<unsigned>(m_unresolved),
+                 static_cast<unsigned>(snapshot.checksum()));
+    // Keep the log complete when engine gets killed
+    std::fflush(m_log);
+}
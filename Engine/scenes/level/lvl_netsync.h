@@ -0,0 +1,158 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LVL_NETSYNC_H
+#define LVL_NETSYNC_H
+
+#include <networking/netsync_snapshot.h>
+#include <networking/netsync_udp.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+class LevelScene;
+class LVL_Npc;
+class LVL_Block;
+class LVL_Player;
+
+/*!
+ * \brief Replication of the level state between engine instances
+ *
+ * Server takes snapshots of players, active NPCs and changed blocks and sends
+ * every client the difference with the snapshot it has acknowledged. Client runs
+ * the same level and puts received objects into the state of the server,
+ * positions of moving objects are interpolated between snapshots.
+ * Objects are matched by array IDs, so both sides must load the same level file.
+ */
+class LVL_NetSync
+{
+public:
+    enum Role
+    {
+        ROLE_NONE = 0,
+        ROLE_SERVER,
+        ROLE_CLIENT
+    };
+
+    struct Setup
+    {
+        Role        role = ROLE_NONE;
+        //! Server address for the client
+        std::string host = "127.0.0.1";
+        uint16_t    port = 24445;
+        //! CSV file to write every sent or received snapshot into, to compare both sides
+        std::string logFile;
+    };
+    //! Configured from the command line
+    static Setup setup;
+
+    //! Time between snapshots, milliseconds
+    static const uint32_t snapshotInterval = 50;
+    //! Client is forgotten when nothing came from it for this time, milliseconds
+    static const uint32_t peerTimeout = 5000;
+    //! Time between hello messages of the client while it has nothing to acknowledge, milliseconds
+    static const uint32_t helloInterval = 500;
+    //! Killed NPC is sent with the kill flag for this time, so clients with late acks will see it, milliseconds
+    static const uint32_t tombstoneLifetime = 1000;
+
+    explicit LVL_NetSync(LevelScene *scene);
+    ~LVL_NetSync();
+    LVL_NetSync(const LVL_NetSync &) = delete;
+    LVL_NetSync &operator=(const LVL_NetSync &) = delete;
+
+    /*!
+     * \brief Open the socket by the setup
+     * \return true on success
+     */
+    bool start();
+    /*!
+     * \brief Exchange data, must be called once per frame after the world step
+     * \param ticks Time of the step, milliseconds
+     */
+    void update(double ticks);
+
+    inline Role role() const
+    {
+        return m_role;
+    }
+    //! Size of recently sent or received frame, bytes
+    inline size_t lastFrameSize() const
+    {
+        return m_lastFrameSize;
+    }
+
+private:
+    void updateServer();
+    void updateClient();
+    void capture(NetSync_Snapshot &out);
+    void apply(const NetSync_Snapshot &state);
+    void applyPlayer(LVL_Player *player, const NetSync_Entity &e);
+    void applyNpc(LVL_Npc *npc, const NetSync_Entity &e);
+    void applyBlock(LVL_Block *block, const NetSync_Entity &e);
+    void removeNpc(LVL_Npc *npc);
+    void restoreBlock(LVL_Block *block);
+    void rebuildIndex();
+    void writeLog(const char *side, const NetSync_Snapshot &snapshot);
+
+    LevelScene *m_scene;
+    Role        m_role = ROLE_NONE;
+    NetSync_UdpSocket m_socket;
+    //! Time since start, milliseconds
+    double      m_time = 0.0;
+    double      m_lastSnapshotTime = 0.0;
+    size_t      m_lastFrameSize = 0;
+    FILE       *m_log = nullptr;
+
+    /********************Server*********************/
+    struct Peer
+    {
+        NetSync_Address address;
+        //! Latest snapshot acknowledged by the client
+        uint32_t acked = 0;
+        double   lastSeen = 0.0;
+    };
+    std::vector<Peer> m_peers;
+    NetSync_ReplicationServer m_server;
+    //! NPCs of the previous snapshot, by array ID
+    std::unordered_map<uint32_t, NetSync_Entity> m_capturedNpcs;
+    struct Tombstone
+    {
+        NetSync_Entity entity;
+        double   time = 0.0;
+    };
+    //! Recently killed NPCs, by array ID
+    std::unordered_map<uint32_t, Tombstone> m_npcTombstones;
+
+    /********************Client*********************/
+    NetSync_Address m_serverAddress;
+    NetSync_ReplicationClient m_client;
+    double      m_lastHelloTime = -1.0e9;
+    NetSync_Snapshot m_shown;
+    std::unordered_map<uint32_t, LVL_Npc *>   m_npcById;
+    std::unordered_map<uint32_t, LVL_Block *> m_blockById;
+    //! LevelScene::m_itemsRevision at the moment of rebuildIndex()
+    uint32_t    m_indexRevision = 0;
+    //! Keys of NPCs and blocks applied from the previous snapshot, sorted
+    std::vector<uint32_t> m_appliedKeys;
+    //! Count of NPCs and blocks of the latest applied state which are not in this level
+    size_t      m_unresolved = 0;
+};
+
+#endif // LVL_NETSYNC_H
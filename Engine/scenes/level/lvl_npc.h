@@ -113,12 +113,27 @@ public:
     unsigned long transformedFromNpcID = 0;
 
     void update(double tickTime);
+    /*!
+     * \brief First part of update(): timers, movement and section bounds
+     * \param tickTime Time step in milliseconds
+     * \return true if detectors and script loop are must be processed at this step
+     */
+    bool updateState(double tickTime);
+    /*!
+     * \brief Second part of update(): process all detectors
+     */
+    void updateDetectors();
+    /*!
+     * \brief Last part of update(): call script loop
+     * \param tickTime Time step in milliseconds
+     */
+    void updateScript(double tickTime);
     void render(double camX, double camY);
     void setDefaults();
     void Activate();
     void deActivate();
 
-    virtual void iterateStep(double ticks, bool force = false);
+    virtual bool iterateMotion(double ticks, bool force = false);
     void processContacts();
     void preCollision();
     void postCollision();
@@ -168,6 +183,10 @@ public:
 
     bool reSpawnable = false;
     bool isActivated = false;
+    //! Slot in the list of activated NPCs, maintained by LVL_NpcActiveList
+    size_t m_activeSlot = static_cast<size_t>(-1);
+    //! Slot in the list of activated NPCs sorted by Y, maintained by LVL_NpcActiveList
+    size_t m_activeSortedSlot = static_cast<size_t>(-1);
     bool deActivatable = false;
     bool wasDeactivated = false;
     bool offSectionDeactivate = false;
@@ -0,0 +1,111 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lvl_npc_active_list.h"
+#include "lvl_npc.h"
+
+#include <algorithm>
+
+static bool compareNpcPosY(const LVL_Npc *i, const LVL_Npc *j)
+{
+    return (i->m_momentum.y > j->m_momentum.y);
+}
+
+bool LVL_NpcActiveList::insert(LVL_Npc *npc)
+{
+    if(npc->m_activeSlot != noSlot)
+        return false;
+
+    npc->m_activeSlot = m_items.size();
+    m_items.push_back(npc);
+    npc->m_activeSortedSlot = m_sorted.size();
+    m_sorted.push_back(npc);
+    return true;
+}
+
+bool LVL_NpcActiveList::erase(LVL_Npc *npc)
+{
+    if(npc->m_activeSlot == noSlot)
+        return false;
+
+    size_t slot = npc->m_activeSlot;
+    LVL_Npc *last = m_items.back();
+    m_items[slot] = last;
+    last->m_activeSlot = slot;
+    m_items.pop_back();
+    npc->m_activeSlot = noSlot;
+
+    // Keep a hole, it will be removed on the next sort
+    m_sorted[npc->m_activeSortedSlot] = nullptr;
+    npc->m_activeSortedSlot = noSlot;
+    m_sortedHoles++;
+    return true;
+}
+
+bool LVL_NpcActiveList::contains(const LVL_Npc *npc) const
+{
+    return npc->m_activeSlot != noSlot;
+}
+
+void LVL_NpcActiveList::clear()
+{
+    for(LVL_Npc *npc : m_items)
+    {
+        npc->m_activeSlot = noSlot;
+        npc->m_activeSortedSlot = noSlot;
+    }
+    m_items.clear();
+    m_sorted.clear();
+    m_sortedHoles = 0;
+}
+
+const std::vector<LVL_Npc *> &LVL_NpcActiveList::sortedByY()
+{
+    if(m_sortedHoles > 0)
+    {
+        m_sorted.erase(std::remove(m_sorted.begin(), m_sorted.end(), nullptr), m_sorted.end());
+        m_sortedHoles = 0;
+    }
+
+    // Order of recent frame is almost right, so insertion sort is close to linear.
+    // Fall back to the regular sort when too many NPCs are changed their places.
+    size_t shifts = 0;
+    const size_t maxShifts = m_sorted.size() * 8;
+    for(size_t i = 1; i < m_sorted.size(); i++)
+    {
+        LVL_Npc *npc = m_sorted[i];
+        size_t j = i;
+        while((j > 0) && compareNpcPosY(npc, m_sorted[j - 1]))
+        {
+            m_sorted[j] = m_sorted[j - 1];
+            j--;
+        }
+        m_sorted[j] = npc;
+        shifts += (i - j);
+        if(shifts > maxShifts)
+        {
+            std::stable_sort(m_sorted.begin(), m_sorted.end(), compareNpcPosY);
+            break;
+        }
+    }
+
+    for(size_t i = 0; i < m_sorted.size(); i++)
+        m_sorted[i]->m_activeSortedSlot = i;
+
+    return m_sorted;
+}
@@ -0,0 +1,104 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LVL_NPC_ACTIVE_LIST_H
+#define LVL_NPC_ACTIVE_LIST_H
+
+#include <vector>
+#include <cstddef>
+
+class LVL_Npc;
+
+/*!
+ * \brief List of activated NPCs
+ *
+ * NPCs are stored in a dense array, every NPC keeps own slot in the list,
+ * so insertion, removal and membership check are constant time. Removal moves
+ * the last NPC into the freed slot: iteration order depends on the sequence
+ * of insertions and removals only and is the same on every run.
+ *
+ * Items can be inserted while list is iterated by index, but only the current
+ * item is allowed to be removed (the next one takes its index).
+ *
+ * Additionally list keeps NPCs sorted by Y position for the collision pass.
+ * The order is updated incrementally, as NPCs are barely move between frames.
+ */
+class LVL_NpcActiveList
+{
+public:
+    typedef std::vector<LVL_Npc *>::const_iterator const_iterator;
+
+    static const size_t noSlot = static_cast<size_t>(-1);
+
+    /*!
+     * \brief Add NPC into the list
+     * \param npc NPC to add
+     * \return true if NPC was added, false if it is already in the list
+     */
+    bool insert(LVL_Npc *npc);
+    /*!
+     * \brief Remove NPC from the list
+     * \param npc NPC to remove
+     * \return true if NPC was removed, false if it is not in the list
+     */
+    bool erase(LVL_Npc *npc);
+    /*!
+     * \brief Is NPC in the list
+     * \param npc NPC to check
+     * \return true if NPC is in the list
+     */
+    bool contains(const LVL_Npc *npc) const;
+    void clear();
+
+    size_t size() const
+    {
+        return m_items.size();
+    }
+    bool empty() const
+    {
+        return m_items.empty();
+    }
+    LVL_Npc *operator[](size_t index) const
+    {
+        return m_items[index];
+    }
+    const_iterator begin() const
+    {
+        return m_items.begin();
+    }
+    const_iterator end() const
+    {
+        return m_items.end();
+    }
+
+    /*!
+     * \brief NPCs sorted from the bottom to the top, same as collision pass does for all bodies
+     * \return Sorted list, valid until the next change of the list
+     */
+    const std::vector<LVL_Npc *> &sortedByY();
+
+private:
+    //! Activated NPCs
+    std::vector<LVL_Npc *> m_items;
+    //! NPCs sorted by Y since recent call of sortedByY(), removed NPCs are null
+    std::vector<LVL_Npc *> m_sorted;
+    //! Count of null entries in the m_sorted
+    size_t m_sortedHoles = 0;
+};
+
+#endif // LVL_NPC_ACTIVE_LIST_H
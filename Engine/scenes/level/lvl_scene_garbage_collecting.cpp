@@ -35,9 +35,10 @@ void LevelScene::collectGarbageNPCs()
             continue;
         }
         m_npcActive.erase(corpse);
-        m_layers.removeRegItem(corpse->data.layer, corpse);
+        m_layers.removeRegItem(corpse);
         corpse->unregisterFromTree();
         m_itemsNpc.erase(corpse);
+        m_itemsRevision++;
         m_luaEngine.destoryLuaNpc(corpse);
     }
     m_npcDead.insert(m_npcDead.end(), stillVizible.begin(), stillVizible.end());
@@ -97,9 +98,10 @@ void LevelScene::collectGarbageBlocks()
             stillVizible.push_back(corpse);//Avoid camera crash (which uses a cached render list)
             continue;
         }
-        m_layers.removeRegItem(corpse->data.layer, corpse);
+        m_layers.removeRegItem(corpse);
         corpse->unregisterFromTree();
         m_itemsBlocks.erase(corpse);
+        m_itemsRevision++;
         delete corpse;
     }
     m_blocksToDelete.insert(m_blocksToDelete.end(), stillVizible.begin(), stillVizible.end());
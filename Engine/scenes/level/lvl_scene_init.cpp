@@ -26,6 +26,7 @@
 
 #include <Utils/files.h>
 #include <functional>
+#include <set>
 #include <algorithm>
 
 bool LevelScene::setEntrance(unsigned long entr)
@@ -449,12 +450,28 @@ bool LevelScene::init_items()
         m_playerStates.push_back(luaPlState);
     }
 
+    //Decode sprites of used blocks, BGO and NPCs on worker threads and pack them into texture atlas
+    {
+        std::set<unsigned long> blocks, bgos, npcs;
+        for(const LevelBlock &b : m_data.blocks)
+            blocks.insert(b.id);
+        for(const LevelBGO &b : m_data.bgo)
+            bgos.insert(b.id);
+        for(const LevelNPC &n : m_data.npc)
+            npcs.insert(n.id);
+        ConfigManager::buildLevelAtlas(blocks, bgos, npcs, [this]()->void
+        {
+            loaderStep();
+        });
+    }
+
     //Init data
     //blocks
     for(size_t i = 0; i < m_data.blocks.size(); i++)
     {
         if(!m_isLevelContinues)
             return false;//!< quit from game if window was closed
+        loaderStep();
         placeBlock(m_data.blocks[i]);
     }
 
@@ -466,6 +483,7 @@ bool LevelScene::init_items()
     {
         if(!m_isLevelContinues)
             return false;//!< quit from game if window was closed
+        loaderStep();
         placeBGO(m_data.bgo[i]);
     }
 
@@ -474,6 +492,7 @@ bool LevelScene::init_items()
     {
         if(!m_isLevelContinues)
             return false;//!< quit from game if window was closed
+        loaderStep();
         placeNPC(m_data.npc[i]);
     }
 
@@ -566,6 +585,17 @@ place_door_again:
     for(size_t i = 0; i < m_data.events.size(); i++)
         m_events.addSMBX64Event(m_data.events[i]);
 
+    if(LVL_NetSync::setup.role != LVL_NetSync::ROLE_NONE)
+    {
+        D_pLogDebugNA("Start network synchronization");
+        m_netSync.reset(new LVL_NetSync(this));
+        if(!m_netSync->start())
+        {
+            pLogWarning("Failed to start network synchronization, level will run alone");
+            m_netSync.reset();
+        }
+    }
+
     m_isInit = true;
     return true;
 }
@@ -591,12 +621,15 @@ bool LevelScene::init()
     stopLoaderAnimation();
     SDL_GL_MakeCurrent(PGE_Window::window, PGE_Window::glcontext);
     #else
-    //Load everything without loading animation, in the main thread
-    //(because in the threaded loading some issues are appearence)
+    //Load everything in the main thread (because in the threaded loading some issues are appearence),
+    //but images are decoded by worker threads while loading animation is alive
+    setLoaderAnimation(62);
     init_thread(this);
+    stopLoaderAnimation();
     #endif
 
-    if(m_isInitFailed)
+    //Don't complain when window was closed while loading
+    if(m_isInitFailed && !m_doExit)
         PGE_MsgBox::error(_errorString);
 
     return !m_isInitFailed;
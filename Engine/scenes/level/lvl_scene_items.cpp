@@ -70,6 +70,7 @@ void LevelScene::placeBlock(LevelBlock &blockData)
     block->data = blockData;
     block->init();
     m_itemsBlocks.insert(block);
+    m_itemsRevision++;
 }
 
 LVL_Block *LevelScene::spawnBlock(const LevelBlock &blockData)
@@ -93,6 +94,7 @@ LVL_Block *LevelScene::spawnBlock(const LevelBlock &blockData)
     block->data.meta.array_id = ++m_data.blocks_array_id;
     block->init();
     m_itemsBlocks.insert(block);
+    m_itemsRevision++;
     return block;
 }
 
@@ -158,6 +160,7 @@ void LevelScene::placeNPC(LevelNPC& npcData)
     npc->data  = npcData;
     npc->init();
     m_itemsNpc.insert(npc);
+    m_itemsRevision++;
 }
 
 LVL_Npc *LevelScene::spawnNPC(const LevelNPC &npcData,
@@ -236,6 +239,7 @@ LVL_Npc *LevelScene::spawnNPC(const LevelNPC &npcData,
     npc->Activate();
     m_npcActive.insert(npc);
     m_itemsNpc.insert(npc);
+    m_itemsRevision++;
     return npc;
 }
 
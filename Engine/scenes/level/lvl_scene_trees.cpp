@@ -20,6 +20,12 @@
 #include <functional>
 #include "lvl_subtree.h"
 
+static inline void syncGeometry(PGE_Phys_Object *self)
+{
+    if((self->m_treemap.m_geometrySlot != LVL_StaticGeometry::noSlot) || LVL_BroadPhase::isFixedBody(self))
+        self->m_scene->m_staticGeometry.update(self);
+}
+
 void PGE_Phys_Object::TreeMapMember::addToScene(bool keepAbsPos)
 {
     if(!m_is_registered)
@@ -49,6 +55,7 @@ void PGE_Phys_Object::TreeMapMember::addToScene(bool keepAbsPos)
         }
     }
     m_is_registered = true;
+    syncGeometry(m_self);
 }
 
 void PGE_Phys_Object::TreeMapMember::updatePos()
@@ -80,6 +87,7 @@ void PGE_Phys_Object::TreeMapMember::updatePos()
         else
             m_self->m_scene->updateElement(m_self);
     }
+    syncGeometry(m_self);
 }
 
 void PGE_Phys_Object::TreeMapMember::updatePosAndSize()
@@ -120,6 +128,7 @@ void PGE_Phys_Object::TreeMapMember::updatePosAndSize()
         else
             m_self->m_scene->updateElement(m_self);
     }
+    syncGeometry(m_self);
 }
 
 void PGE_Phys_Object::TreeMapMember::updateSize()
@@ -146,6 +155,7 @@ void PGE_Phys_Object::TreeMapMember::updateSize()
         else
             m_self->m_scene->updateElement(m_self);
     }
+    syncGeometry(m_self);
 }
 
 void PGE_Phys_Object::TreeMapMember::delFromScene()
@@ -159,6 +169,8 @@ void PGE_Phys_Object::TreeMapMember::delFromScene()
             m_self->m_scene->unregisterElement(m_self);
     }
     m_is_registered = false;
+    if(m_geometrySlot != LVL_StaticGeometry::noSlot)
+        m_self->m_scene->m_staticGeometry.remove(m_self);
 }
 
 void LevelScene::registerElement(LevelScene::PhysObjPtr item)
@@ -0,0 +1,128 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lvl_static_geometry.h"
+#include "lvl_broad_phase.h"
+
+#include <cmath>
+#include <limits>
+
+/*!
+ * \brief Float which is not greater than the value
+ */
+static inline float floatBelow(double value)
+{
+    float f = static_cast<float>(value);
+    if(static_cast<double>(f) > value)
+        f = std::nextafter(f, -std::numeric_limits<float>::infinity());
+    return f;
+}
+
+/*!
+ * \brief Float which is not less than the value
+ */
+static inline float floatAbove(double value)
+{
+    float f = static_cast<float>(value);
+    if(static_cast<double>(f) < value)
+        f = std::nextafter(f, std::numeric_limits<float>::infinity());
+    return f;
+}
+
+static inline uint8_t blockedMask(const PGE_Phys_Object *body)
+{
+    return static_cast<uint8_t>((body->m_blocked[1] & 0x0F) | ((body->m_blocked[2] & 0x0F) << 4));
+}
+
+void LVL_StaticGeometry::update(PGE_Phys_Object *body)
+{
+    uint32_t &slot = body->m_treemap.m_geometrySlot;
+    if(slot == noSlot)
+    {
+        // Sub-trees of layers are never candidates, their members are
+        if(!LVL_BroadPhase::isFixedBody(body) || (body->type == PGE_Phys_Object::LVLSubTree))
+            return;
+        if(m_free.empty())
+        {
+            slot = static_cast<uint32_t>(m_left.size());
+            m_left.push_back(0.0f);
+            m_top.push_back(0.0f);
+            m_right.push_back(0.0f);
+            m_bottom.push_back(0.0f);
+            m_blocked.push_back(0);
+            m_tree.push_back(nullptr);
+        }
+        else
+        {
+            slot = m_free.back();
+            m_free.pop_back();
+        }
+    }
+
+    const LVL_SubTree *st = dynamic_cast<const LVL_SubTree *>(body->m_parent);
+    if(st)
+    {
+        // Members of layers are registered by position relative to the layer
+        const PGE_Phys_Object::TreeMapMember &t = body->m_treemap;
+        m_left[slot]    = floatBelow(t.m_posX_registered);
+        m_top[slot]     = floatBelow(t.m_posY_registered);
+        m_right[slot]   = floatAbove(t.m_posX_registered + t.m_width_registered);
+        m_bottom[slot]  = floatAbove(t.m_posY_registered + t.m_height_registered);
+    }
+    else
+    {
+        const PGE_physBody::Momentum &m = body->m_momentum;
+        m_left[slot]    = floatBelow(m.x);
+        m_top[slot]     = floatBelow(m.y);
+        m_right[slot]   = floatAbove(m.x + m.w);
+        m_bottom[slot]  = floatAbove(m.y + m.h);
+    }
+    m_blocked[slot] = blockedMask(body);
+    m_tree[slot]    = st;
+}
+
+void LVL_StaticGeometry::remove(PGE_Phys_Object *body)
+{
+    uint32_t slot = body->m_treemap.m_geometrySlot;
+    if(slot != noSlot)
+        setEmpty(slot);
+}
+
+void LVL_StaticGeometry::updateBlocked(PGE_Phys_Object *body)
+{
+    uint32_t slot = body->m_treemap.m_geometrySlot;
+    if(slot != noSlot)
+        m_blocked[slot] = blockedMask(body);
+}
+
+void LVL_StaticGeometry::release(uint32_t slot)
+{
+    setEmpty(slot);
+    m_free.push_back(slot);
+}
+
+void LVL_StaticGeometry::setEmpty(uint32_t slot)
+{
+    // Inverted box never intersects anything
+    m_left[slot]    = std::numeric_limits<float>::infinity();
+    m_top[slot]     = std::numeric_limits<float>::infinity();
+    m_right[slot]   = -std::numeric_limits<float>::infinity();
+    m_bottom[slot]  = -std::numeric_limits<float>::infinity();
+    m_blocked[slot] = 0;
+    m_tree[slot]    = nullptr;
+}
@@ -0,0 +1,110 @@
+/*
+ * Platformer Game Engine by Wohlstand, a free platform for game making
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LVL_STATIC_GEOMETRY_H
+#define LVL_STATIC_GEOMETRY_H
+
+#include "lvl_subtree.h"
+#include <vector>
+#include <cstdint>
+
+/*!
+ * \brief Compact store of geometry of fixed bodies (terrain, BGOs, warps)
+ *
+ * Every fixed body gets a slot on its first registration in the tree and keeps
+ * it until it gets destroyed. Slot is updated by the tree operations of the body,
+ * so the store is always in sync with the tree. Edges are kept as floats rounded
+ * outward in coordinates of the tree where body is registered: scan of the store
+ * never misses a body, but may pass one which is then checked by its actual position.
+ * Bodies which are not registered in the tree are never passing the scan.
+ */
+class LVL_StaticGeometry
+{
+public:
+    static const uint32_t noSlot = 0xFFFFFFFF;
+
+    /*!
+     * \brief Store actual geometry of the body, slot is allocated for fixed body which has no it
+     * \param body Physical body registered in the tree
+     */
+    void update(PGE_Phys_Object *body);
+    /*!
+     * \brief Body was removed from the tree, it will not pass the scan until next update
+     * \param body Physical body
+     */
+    void remove(PGE_Phys_Object *body);
+    /*!
+     * \brief Update blocked sides of the body which has a slot
+     * \param body Physical body
+     */
+    void updateBlocked(PGE_Phys_Object *body);
+    /*!
+     * \brief Body gets destroyed, slot will be given to another body
+     * \param slot Slot of the body
+     */
+    void release(uint32_t slot);
+
+    /*!
+     * \brief Is body in the slot may intersect with the given area
+     * \param slot Slot of the body
+     * \return false if body is surely not intersects the area
+     */
+    inline bool intersects(uint32_t slot, double left, double top, double right, double bottom) const
+    {
+        double ox = 0.0, oy = 0.0;
+        const LVL_SubTree *st = m_tree[slot];
+        if(st)
+        {
+            ox = st->m_offsetX;
+            oy = st->m_offsetY;
+        }
+        // Without branches, same as the tree query does
+        return (right > m_left[slot] - ox) & (m_right[slot] - ox > left) &
+               (bottom > m_top[slot] - oy) & (m_bottom[slot] - oy > top);
+    }
+
+    /*!
+     * \brief Blocked sides of the body in the slot
+     * \param slot Slot of the body
+     * \return Sides blocked for players in low 4 bits and sides blocked for NPCs in high 4 bits
+     */
+    inline uint8_t blocked(uint32_t slot) const
+    {
+        return m_blocked[slot];
+    }
+
+    //! Count of slots including free ones
+    inline size_t size() const
+    {
+        return m_left.size();
+    }
+
+private:
+    void setEmpty(uint32_t slot);
+
+    std::vector<float>   m_left;
+    std::vector<float>   m_top;
+    std::vector<float>   m_right;
+    std::vector<float>   m_bottom;
+    std::vector<uint8_t> m_blocked;
+    //! Sub-tree of layer where body is registered, null for the scene's tree
+    std::vector<const LVL_SubTree *> m_tree;
+    std::vector<uint32_t> m_free;
+};
+
+#endif // LVL_STATIC_GEOMETRY_H
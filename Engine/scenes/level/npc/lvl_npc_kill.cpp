@@ -269,6 +269,6 @@ void LVL_Npc::unregister()
     m_is_visible = false;
     unregisterFromTree();
     m_scene->m_npcDead.push_back(this);
-    m_scene->m_layers.removeRegItem(data.layer, this);
+    m_scene->m_layers.removeRegItem(this);
     transformedFromBlockData.reset();
 }
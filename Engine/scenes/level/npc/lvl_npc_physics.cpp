@@ -23,10 +23,11 @@
 #include "../lvl_bgo.h"
 #include "../../scene_level.h"
 
-void LVL_Npc::iterateStep(double ticks, bool force)
+bool LVL_Npc::iterateMotion(double ticks, bool force)
 {
     if(!m_isGenerator && !is_static)
-        PGE_Phys_Object::iterateStep(ticks, force);
+        return PGE_Phys_Object::iterateMotion(ticks, force);
+    return false;
 }
 
 void LVL_Npc::processContacts()
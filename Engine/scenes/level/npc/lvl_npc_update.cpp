@@ -22,16 +22,25 @@
 
 void LVL_Npc::update(double tickTime)
 {
-    if(killed) return;
+    if(!updateState(tickTime))
+        return;
+
+    updateDetectors();
+    updateScript(tickTime);
+}
+
+bool LVL_Npc::updateState(double tickTime)
+{
+    if(killed) return false;
 
     if(wasDeactivated)
-        return;
+        return false;
 
     if(m_isGenerator)
     {
         activationTimeout -= tickTime;
         updateGenerator(tickTime);
-        return;
+        return false;
     }
 
     event_queue.processEvents(tickTime);
@@ -40,7 +49,7 @@ void LVL_Npc::update(double tickTime)
     if(warpSpawing)
     {
         setSpeed(0.0, 0.0);
-        return;
+        return false;
     }
 
     PGE_Phys_Object::update(tickTime);
@@ -107,9 +116,17 @@ void LVL_Npc::update(double tickTime)
     else if((setup->setup.kill_on_pit_fall) && (posY() > sBox.bottom() + m_momentum.h))
         kill(DAMAGE_PITFALL);
 
+    return true;
+}
+
+void LVL_Npc::updateDetectors()
+{
     for(auto i = detectors.begin(); i != detectors.end(); i++)
         (*i)->processDetector();
+}
 
+void LVL_Npc::updateScript(double tickTime)
+{
     try
     {
         lua_onLoop(tickTime);
@@ -46,6 +46,18 @@ BasicDetector::~BasicDetector()
 void BasicDetector::processDetector()
 {}
 
+bool BasicDetector::searchZone(PGE_RectF &zone)
+{
+    (void)(zone);
+    return false;
+}
+
+void BasicDetector::processFound(const std::vector<PGE_Phys_Object *> &bodies)
+{
+    (void)(bodies);
+    processDetector();
+}
+
 bool BasicDetector::detected()
 { return _detected; }
 
@@ -19,8 +19,12 @@
 #ifndef BASICDETECTOR_H
 #define BASICDETECTOR_H
 
+#include <common_features/rectf.h>
+#include <vector>
+
 class LVL_Npc;
 class LevelScene;
+class PGE_Phys_Object;
 class BasicDetector
 {
     friend class LVL_Npc;
@@ -30,6 +34,18 @@ public:
     BasicDetector(const BasicDetector &dtc);
     virtual ~BasicDetector();
     virtual void processDetector();
+    /*!
+     * \brief Area of the level where objects are needed to process this detector
+     * \param zone [out] Search area
+     * \return true if detector needs objects from the area, otherwise processDetector() should be used
+     */
+    virtual bool searchZone(PGE_RectF &zone);
+    /*!
+     * \brief Process detector with objects found in the search area.
+     *        Must not modify anything except of detector itself
+     * \param bodies Objects intersecting with the search area
+     */
+    virtual void processFound(const std::vector<PGE_Phys_Object *> &bodies);
     virtual bool detected();
 protected:
     bool _detected;
@@ -31,8 +31,21 @@ InAreaDetector::~InAreaDetector()
 
 void InAreaDetector::processDetector()
 {
-    _contacts = 0;
-    _detected = false;
+    updateTrapZone();
+    std::vector<PGE_Phys_Object *> bodies;
+    _scene->queryItems(_trapZone, &bodies);
+    processFound(bodies);
+}
+
+bool InAreaDetector::searchZone(PGE_RectF &zone)
+{
+    updateTrapZone();
+    zone = _trapZone;
+    return true;
+}
+
+void InAreaDetector::updateTrapZone()
+{
     _trapZone = _srcTrapZone;
 
     _trapZone.setPos(
@@ -45,6 +58,12 @@ void InAreaDetector::processDetector()
         double x_pos = _trapZone.left() + (_parentNPC->posCenterX() - _trapZone.center().x()) * 2.0;
         _trapZone.setPos(x_pos, _trapZone.y());
     }
+}
+
+void InAreaDetector::processFound(const std::vector<PGE_Phys_Object *> &bodies)
+{
+    _contacts = 0;
+    _detected = false;
 
     detectedPLR.clear();
     detectedBLK.clear();
@@ -55,10 +74,7 @@ void InAreaDetector::processDetector()
     detectedNPCs.clear();
     detectedPlayers.clear();
 
-    std::vector<PGE_Phys_Object *> bodies;
-    _scene->queryItems(_trapZone, &bodies);
-
-    for(PGE_RenderList::iterator it = bodies.begin(); it != bodies.end(); it++)
+    for(auto it = bodies.begin(); it != bodies.end(); it++)
     {
         PGE_Phys_Object *visibleBody = *it;
         if(visibleBody == _parentNPC) continue;
@@ -31,6 +31,8 @@ public:
     InAreaDetector(const InAreaDetector &dtc);
     ~InAreaDetector();
     void processDetector();
+    bool searchZone(PGE_RectF &zone);
+    void processFound(const std::vector<PGE_Phys_Object *> &bodies);
     bool detected();
     bool detected(long type, long ID);
     int contacts();   //! number of detected items
@@ -42,6 +44,7 @@ public:
     luabind::object getPlayers(lua_State *L);
 
 private:
+    void updateTrapZone();
     std::unordered_map<long, long> detectedPLR;
     std::unordered_map<long, long> detectedBLK;
     std::unordered_map<long, long> detectedBGO;
@@ -20,6 +20,7 @@
 
 #include <common_features/app_path.h>
 #include <common_features/graphics_funcs.h>
+#include <common_features/profiler.h>
 #include <settings/debugger.h>
 
 #include <graphics/gl_renderer.h>
@@ -37,6 +38,7 @@
 #include <settings/global_settings.h>
 
 #include <algorithm>
+#include <cstring>
 
 #include <common_features/logger.h>
 
@@ -101,8 +103,8 @@ LevelScene::LevelScene()
     m_fader.setFull();
     /*********Fader*************/
     /*********Controller********/
-    m_player1Controller = g_AppSettings.openController(1);
-    m_player2Controller = g_AppSettings.openController(2);
+    m_player1Controller = g_AppSettings.openLevelController(1);
+    m_player2Controller = g_AppSettings.openLevelController(2);
     /*********Controller********/
     /*********Pause menu*************/
     initPauseMenu1();
@@ -121,6 +123,7 @@ LevelScene::LevelScene()
 
 void LevelScene::processPhysics(double ticks)
 {
+    PGE_PROFILE_ZONE("LevelScene::processPhysics");
     //Iterate layer movement
     m_layers.processMoving(uTickf);
 
@@ -132,10 +135,109 @@ void LevelScene::processPhysics(double ticks)
     }
 
     //Iterate activated NPCs
-    for(LVL_NpcActiveSet::iterator i = m_npcActive.begin(); i != m_npcActive.end(); ++i)
+    if(g_AppSettings.parallelNpcStep)
     {
-        LVL_Npc *n = *i;
+        processNpcPhysicsParallel(ticks);
+        return;
+    }
+
+    for(LVL_Npc *n : m_npcActive)
         n->iterateStep(ticks);
+}
+
+WorkerPool &LevelScene::npcWorkers()
+{
+    if(!m_npcWorkers)
+        m_npcWorkers.reset(new WorkerPool());
+    return *m_npcWorkers;
+}
+
+void LevelScene::processNpcPhysicsParallel(double ticks)
+{
+    std::vector<LVL_Npc *> &npcs = m_npcStep;
+    std::vector<char> &moved = m_npcStepFlags;
+    npcs.assign(m_npcActive.begin(), m_npcActive.end());
+    moved.assign(npcs.size(), 0);
+
+    // Motion of every NPC depends on its own state only
+    npcWorkers().parallelFor(npcs.size(), 64, [&npcs, &moved, ticks](size_t begin, size_t end)->void
+    {
+        PGE_PROFILE_ZONE("LVL_Npc::iterateMotion");
+        for(size_t i = begin; i < end; i++)
+            moved[i] = npcs[i]->iterateMotion(ticks) ? 1 : 0;
+    });
+
+    // Tree is not thread-safe, commit new positions in the same order as serial step does
+    for(size_t i = 0; i < npcs.size(); i++)
+    {
+        if(moved[i])
+            npcs[i]->m_treemap.updatePos();
+    }
+}
+
+void LevelScene::updateNpcsParallel(double tickTime)
+{
+    PGE_PROFILE_ZONE("LevelScene::updateNpcsParallel");
+    std::vector<LVL_Npc *> &npcs = m_npcStep;
+    std::vector<char> &updated = m_npcStepFlags;
+    npcs.assign(m_npcActive.begin(), m_npcActive.end());
+    updated.assign(npcs.size(), 0);
+
+    // Timers, events and movement are able to spawn and kill things, keep them serial.
+    // NPC killed here (by a pit fall) still gets own script loop, like the serial step does
+    for(size_t i = 0; i < npcs.size(); i++)
+    {
+        if(npcs[i]->updateState(tickTime))
+            updated[i] = npcs[i]->isKilled() ? 2 : 1;
+    }
+
+    // Collect search areas of detectors and query the tree for them
+    m_npcStepDetectors.clear();
+    m_npcStepZones.clear();
+    for(size_t i = 0; i < npcs.size(); i++)
+    {
+        if(!updated[i])
+            continue;
+        for(BasicDetector *d : npcs[i]->detectors)
+        {
+            NpcStepDetector dtc;
+            PGE_RectF zone;
+            dtc.detector = d;
+            dtc.hasZone = d->searchZone(zone);
+            if(dtc.hasZone)
+            {
+                dtc.zone = m_npcStepZones.size();
+                m_npcStepZones.push_back(zone);
+            }
+            m_npcStepDetectors.push_back(dtc);
+        }
+    }
+    m_npcStepPhase.buildZones(this, m_npcStepZones);
+
+    // Every detector writes its own results only
+    npcWorkers().parallelFor(m_npcStepDetectors.size(), 16, [this](size_t begin, size_t end)->void
+    {
+        PGE_PROFILE_ZONE("LVL_Npc::detectors");
+        std::vector<PGE_Phys_Object *> found;
+        for(size_t i = begin; i < end; i++)
+        {
+            NpcStepDetector &dtc = m_npcStepDetectors[i];
+            if(dtc.hasZone)
+            {
+                found.clear();
+                m_npcStepPhase.query(dtc.zone, m_npcStepZones[dtc.zone], found);
+                dtc.detector->processFound(found);
+            }
+            else
+                dtc.detector->processDetector();
+        }
+    });
+
+    // Scripts are able to touch anything, call them in order
+    for(size_t i = 0; i < npcs.size(); i++)
+    {
+        if((updated[i] == 2) || ((updated[i] == 1) && !npcs[i]->isKilled()))
+            npcs[i]->updateScript(tickTime);
     }
 }
 
@@ -146,7 +248,9 @@ static bool comparePosY(PGE_Phys_Object *i, PGE_Phys_Object *j)
 
 void LevelScene::processAllCollisions()
 {
-    std::vector<PGE_Phys_Object *> toCheck;
+    PGE_PROFILE_ZONE("LevelScene::processAllCollisions");
+    std::vector<PGE_Phys_Object *> &toCheck = m_collisionBodies;
+    toCheck.clear();
 
     //Reset events first
     for(LVL_PlayersArray::iterator it = m_itemsPlayers.begin(); it != m_itemsPlayers.end(); it++)
@@ -156,21 +260,23 @@ void LevelScene::processAllCollisions()
         toCheck.push_back(plr);
     }
 
+    std::stable_sort(toCheck.begin(), toCheck.end(), comparePosY);
+    size_t playersCount = toCheck.size();
+
     //Process collision check and resolving for activated NPC's
-    for(LVL_NpcActiveSet::iterator i = m_npcActive.begin(); i != m_npcActive.end(); ++i)
+    for(LVL_Npc *n : m_npcActive.sortedByY())
     {
-        LVL_Npc *n = *i;
         n->resetEvents();
         toCheck.push_back(n);
     }
 
-    std::stable_sort(toCheck.begin(), toCheck.end(), comparePosY);
+    // NPCs are already sorted, merge them with players
+    std::inplace_merge(toCheck.begin(), toCheck.begin() + static_cast<std::ptrdiff_t>(playersCount), toCheck.end(), comparePosY);
 
-    for(std::vector<PGE_Phys_Object *>::iterator it = toCheck.begin(); it != toCheck.end(); it++)
-    {
-        PGE_Phys_Object *obj = *it;
-        obj->updateCollisions();
-    }
+    m_broadPhase.build(this, toCheck);
+
+    for(size_t i = 0; i < toCheck.size(); i++)
+        m_broadPhase.collide(i);
 }
 
 
@@ -212,7 +318,7 @@ LevelScene::~LevelScene()
         LVL_Block *tmp = *i;
         if(tmp)
         {
-            m_layers.removeRegItem(tmp->data.layer, tmp);
+            m_layers.removeRegItem(tmp);
             tmp->unregisterFromTree();
             delete tmp;
         }
@@ -225,7 +331,7 @@ LevelScene::~LevelScene()
         LVL_Bgo *tmp = *i;
         if(tmp)
         {
-            m_layers.removeRegItem(tmp->data.layer, tmp);
+            m_layers.removeRegItem(tmp);
             tmp->unregisterFromTree();
             delete tmp;
         }
@@ -251,7 +357,7 @@ LevelScene::~LevelScene()
         LVL_Warp *tmp = *i;
         if(tmp)
         {
-            m_layers.removeRegItem(tmp->data.layer, tmp);
+            m_layers.removeRegItem(tmp);
             tmp->unregisterFromTree();
             delete tmp;
         }
@@ -264,7 +370,7 @@ LevelScene::~LevelScene()
         LVL_PhysEnv *tmp = *i;
         if(tmp)
         {
-            m_layers.removeRegItem(tmp->data.layer, tmp);
+            m_layers.removeRegItem(tmp);
             tmp->unregisterFromTree();
             delete tmp;
         }
@@ -308,6 +414,7 @@ void LevelScene::tickAnimations(double ticks)
 
 void LevelScene::update()
 {
+    PGE_PROFILE_ZONE("LevelScene::update");
     if(m_luaEngine.shouldShutdown())
     {
         m_fader.setFade(10, 1.0, 1.0);
@@ -404,14 +511,19 @@ void LevelScene::update()
         }
 
         //Process activated NPCs
-        //for(size_t i = 0; i < m_npcActive.size(); i++)
-        for(LVL_NpcActiveSet::iterator i = m_npcActive.begin(); i != m_npcActive.end();)
+        bool npcsUpdated = g_AppSettings.parallelNpcStep;
+        if(npcsUpdated)
+            updateNpcsParallel(uTickf);
+
+        // Removal puts the last NPC into the current slot, so index is incremented only when NPC is kept
+        for(size_t i = 0; i < m_npcActive.size();)
         {
-            LVL_Npc *n = *i;
-            n->update(uTickf);
+            LVL_Npc *n = m_npcActive[i];
+            if(!npcsUpdated)
+                n->update(uTickf);
             if(n->isKilled())
             {
-                i = m_npcActive.erase(i);
+                m_npcActive.erase(n);
                 continue;
             }
             else if(n->activationTimeout <= 0)
@@ -423,7 +535,7 @@ void LevelScene::update()
                     if(!isVizibleOnScreen(n->m_momentum) || !n->isVisible() || !n->is_activity)
                     {
                         n->wasDeactivated = false;
-                        i = m_npcActive.erase(i);
+                        m_npcActive.erase(n);
                         continue;
                     }
                 }
@@ -431,10 +543,21 @@ void LevelScene::update()
             ++i;
         }
 
+        //Call scripts of NPC classes which are processing all their NPCs at once
+        m_luaEngine.processNpcLoopBatches(uTickf);
+
         if(!m_isTimeStopped) //if activated Time stop bonus or time disabled by special event
         {
             //Process and resolve collisions
-            processAllCollisions();
+            if(m_frameTimings.isOpen())
+            {
+                ElapsedTimer collideTime;
+                collideTime.start();
+                processAllCollisions();
+                m_collideTime = collideTime.nanoelapsed();
+            }
+            else
+                processAllCollisions();
         }
 
         /***************Collect garbage****************/
@@ -449,6 +572,9 @@ void LevelScene::update()
 
         /**********************************************/
 
+        if(m_netSync)
+            m_netSync->update(uTickf);
+
         //update cameras
         for(PGE_LevelCamera &cam : m_cameras)
         {
@@ -493,6 +619,7 @@ void LevelScene::update()
 
 void LevelScene::processEvents()
 {
+    PGE_PROFILE_ZONE("LevelScene::processEvents");
     Scene::processEvents();
     m_player1Controller->update();
     m_player2Controller->update();
@@ -500,6 +627,7 @@ void LevelScene::processEvents()
 
 void LevelScene::render()
 {
+    PGE_PROFILE_ZONE("LevelScene::render");
     GlRenderer::clearScreen();
     size_t c = 0;
 
@@ -839,6 +967,7 @@ LuaEngine *LevelScene::getLuaEngine()
 void levelSceneLoopStep(void *scene)
 {
     LevelScene* s = reinterpret_cast<LevelScene*>(scene);
+    PGE_PROFILE_ZONE("levelSceneLoopStep");
     s->times.start_common = SDL_GetTicks();
     s->debug_TimeCounted += s->uTickf;
 
@@ -858,14 +987,35 @@ void levelSceneLoopStep(void *scene)
     s->times.start_physics = SDL_GetTicks();
 
     /**********************Update physics and game progess***********************/
+    ElapsedTimer stepTime;
+    s->m_collideTime = 0;
+    stepTime.start();
+
     if(!s->m_debug_oneStepMode || s->m_debug_oneStepMode_doStep)
     {
         s->update();
         s->m_debug_oneStepMode_doStep = false;
     }
 
+    int64_t updateTime = stepTime.nanoelapsed();
+
     /****************************************************************************/
     s->times.stop_physics = SDL_GetTicks();
+    s->m_loopSteps++;
+
+    if(s->m_isLevelContinues && (g_AppSettings.frameLimit > 0) && (s->m_loopSteps >= g_AppSettings.frameLimit))
+    {
+        pLogDebug("Frame limit %lu is reached, closing the level", g_AppSettings.frameLimit);
+        s->setExiting(0, LvlExit::EXIT_Closed);
+    }
+
+    //Nothing to draw and no need to wait, next step goes right away
+    if(PGE_Window::headless)
+    {
+        if(s->m_frameTimings.isOpen())
+            s->m_frameTimings.add(s->m_loopSteps, updateTime, s->m_collideTime, 0, s->stateChecksum());
+        return;
+    }
 
     if(PGE_Window::showDebugInfo)
         s->m_debug_phys_delay  = static_cast<int>(s->times.stop_physics - s->times.start_physics);
@@ -874,13 +1024,19 @@ void levelSceneLoopStep(void *scene)
     s->times.start_render = 0;
 
     /**********************Process rendering of stuff****************************/
+    int64_t renderTime = 0;
     if((PGE_Window::vsync) || (s->times.doUpdate_render <= 0.0))
     {
         s->times.start_render = SDL_GetTicks();
+        stepTime.restart();
         /**********************Render everything***********************/
         s->render();
-        GlRenderer::flush();
-        GlRenderer::repaint();
+        {
+            PGE_PROFILE_ZONE("GlRenderer::repaint");
+            GlRenderer::flush();
+            GlRenderer::repaint();
+        }
+        renderTime = stepTime.nanoelapsed();
         s->times.stop_render = SDL_GetTicks();
         s->times.doUpdate_render = s->m_frameSkip ? s->uTickf + (s->times.stop_render - s->times.start_render) : 0;
 
@@ -890,6 +1046,9 @@ void levelSceneLoopStep(void *scene)
 
     s->times.doUpdate_render -= s->uTickf;
 
+    if(s->m_frameTimings.isOpen())
+        s->m_frameTimings.add(s->m_loopSteps, updateTime, s->m_collideTime, renderTime, s->stateChecksum());
+
     if(s->times.stop_render < s->times.start_render)
     {
         s->times.stop_render = 0;
@@ -940,11 +1099,25 @@ int LevelScene::exec()
 
     debug_TimeCounted = 0;
     debug_TimeReal.restart();
+
+    if(!g_AppSettings.frameTimingsFile.empty())
+        m_frameTimings.open(g_AppSettings.frameTimingsFile);
     /*****************************************************/
 
     #ifndef __EMSCRIPTEN__
     while(m_isRunning)
         levelSceneLoopStep(this);
+
+    if(PGE_Window::headless)
+    {
+        double gameTime = static_cast<double>(m_loopSteps) * uTickf;
+        int realTime = debug_TimeReal.elapsed();
+        pLogInfo("Headless run: %lu steps, %.0f ms of game time passed in %d ms (x%.2f)",
+                 m_loopSteps, gameTime, realTime,
+                 realTime > 0 ? gameTime / realTime : 0.0);
+    }
+
+    m_frameTimings.close();
     #else
     emscripten_set_main_loop_arg(levelSceneLoopStep, this, (int)PGE_Window::frameRate, 1);
     #endif
@@ -954,6 +1127,41 @@ int LevelScene::exec()
 
 
 
+uint32_t LevelScene::stateChecksum()
+{
+    //FNV-1a over exact bits of values, any difference of the simulation changes it
+    uint32_t hash = 2166136261u;
+    auto mix = [&hash](double value)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for(int i = 0; i < 8; i++)
+        {
+            hash ^= static_cast<uint32_t>((bits >> (i * 8)) & 0xFF);
+            hash *= 16777619u;
+        }
+    };
+
+    for(LVL_Player *plr : m_itemsPlayers)
+    {
+        mix(plr->m_momentum.x);
+        mix(plr->m_momentum.y);
+        mix(plr->speedX());
+        mix(plr->speedY());
+    }
+
+    for(LVL_Npc *npc : m_npcActive)
+    {
+        mix(static_cast<double>(npc->data.meta.array_id));
+        mix(npc->m_momentum.x);
+        mix(npc->m_momentum.y);
+        mix(npc->speedX());
+        mix(npc->speedY());
+    }
+
+    return hash;
+}
+
 std::string LevelScene::getLastError()
 {
     return m_errorMsg;
@@ -1022,7 +1230,7 @@ LevelScene::LVL_NpcsArray &LevelScene::getNpcs()
     return m_itemsNpc;
 }
 
-LevelScene::LVL_NpcActiveSet &LevelScene::getActiveNpcs()
+LVL_NpcActiveList &LevelScene::getActiveNpcs()
 {
     return m_npcActive;
 }
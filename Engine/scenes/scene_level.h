@@ -27,8 +27,11 @@
 #include <common_features/episode_state.h>
 #include <common_features/event_queue.h>
 #include <common_features/point.h>
+#include <common_features/worker_pool.h>
 #include <common_features/RTree/RTree.h>
 #include "level/lvl_quad_tree.h"
+#include "level/lvl_broad_phase.h"
+#include "level/lvl_static_geometry.h"
 
 #include <gui/pge_menubox.h>
 
@@ -38,6 +41,7 @@
 #include "level/lvl_block.h"
 #include "level/lvl_bgo.h"
 #include "level/lvl_npc.h"
+#include "level/lvl_npc_active_list.h"
 
 #include "level/lvl_physenv.h"
 
@@ -45,9 +49,12 @@
 #include "level/lvl_section.h"
 #include "level/lvl_backgrnd.h"
 
+#include "level/lvl_name_table.h"
 #include "level/lvl_layer_engine.h"
 #include "level/lvl_event_engine.h"
 #include "level/lvl_player_switch.h"
+#include "level/lvl_netsync.h"
+#include "level/lvl_frame_timings.h"
 
 #include "level/lvl_z_constants.h"
 
@@ -65,6 +72,7 @@
 #include <deque>
 #include <unordered_map>
 #include <unordered_set>
+#include <memory>
 
 #include <SDL2/SDL_opengl.h>
 #include <SDL2/SDL_timer.h>
@@ -125,6 +133,10 @@ class LevelScene : public Scene
         void onMouseReleased(SDL_MouseButtonEvent &mvevent);
 
         LuaEngine *getLuaEngine();
+        LuaLevelEngine *getLuaLevelEngine()
+        {
+            return &m_luaEngine;
+        }
 
         void update();
         void processEvents();
@@ -233,9 +245,8 @@ class LevelScene : public Scene
         /*************************Character switchers*************************/
 
         /**********************NPC Management*********************/
-        typedef std::unordered_set<LVL_Npc * > LVL_NpcActiveSet;
         //! List of activated NPCs
-        LVL_NpcActiveSet m_npcActive;
+        LVL_NpcActiveList m_npcActive;
         //! List of dead NPCs
         std::vector<LVL_Npc * > m_npcDead;
         /**********************NPC Management*end*****************/
@@ -347,6 +358,10 @@ class LevelScene : public Scene
         typedef std::unordered_set<LVL_Warp * >    LVL_WarpsArray;
         typedef std::unordered_set<LVL_PhysEnv * > LVL_PhysEnvsArray;
 
+        //! Geometry of fixed bodies, must outlive all objects of the scene
+        LVL_StaticGeometry  m_staticGeometry;
+        //! Interned names of layers and events
+        LVL_NameTable       m_names;
         LVL_LayerEngine     m_layers;
         LVL_EventEngine     m_events;
 
@@ -356,6 +371,8 @@ class LevelScene : public Scene
         LVL_NpcsArray       m_itemsNpc;
         LVL_WarpsArray      m_itemsWarps;
         LVL_PhysEnvsArray   m_itemsPhysEnvs;
+        //! Incremented on every insertion and removal of blocks and NPCs
+        uint32_t            m_itemsRevision = 0;
 
     private:
         /*****************Pause Menu*******************/
@@ -397,6 +414,17 @@ class LevelScene : public Scene
 
         ElapsedTimer debug_TimeReal;
         int          debug_TimeCounted  = 0;
+        //! Count of loop steps since start of the level
+        unsigned long m_loopSteps       = 0;
+        //! Timings of loop steps, written when requested from a command line
+        LVL_FrameTimings m_frameTimings;
+        //! Time of collisions resolving of the recent step, nanoseconds
+        int64_t      m_collideTime      = 0;
+        /**
+         * @brief Checksum of positions and speeds of players and active NPCs
+         * @return checksum which is same for same level states
+         */
+        uint32_t stateChecksum();
         bool m_debug_slowTimeMode       = false;
         bool m_debug_oneStepMode        = false;
         bool m_debug_oneStepMode_doStep = false;
@@ -408,6 +436,41 @@ class LevelScene : public Scene
 
         typedef PGE_Phys_Object *PhysObjPtr;
     private:
+        //! Dynamic bodies to check collisions, kept between frames
+        std::vector<PGE_Phys_Object *> m_collisionBodies;
+        //! Broad phase of collision check
+        LVL_BroadPhase              m_broadPhase;
+
+        /*
+         * Parallel step of NPCs (enabled by the "parallel-npc-step" setting).
+         * Work of worker threads is limited by the own state of NPCs and by
+         * read-only queries, everything else is committed in order of m_npcStep.
+         */
+        struct NpcStepDetector
+        {
+            BasicDetector *detector = nullptr;
+            //! Index of search area in m_npcStepZones
+            size_t         zone = 0;
+            bool           hasZone = false;
+        };
+        //! Active NPCs of the current step
+        std::vector<LVL_Npc *>       m_npcStep;
+        //! Per-NPC results of the current phase of the step
+        std::vector<char>            m_npcStepFlags;
+        //! Detectors of all updated NPCs
+        std::vector<NpcStepDetector> m_npcStepDetectors;
+        //! Search areas of detectors
+        std::vector<PGE_RectF>       m_npcStepZones;
+        //! Snapshot of the tree for search areas of detectors
+        LVL_BroadPhase               m_npcStepPhase;
+        std::unique_ptr<WorkerPool>  m_npcWorkers;
+        WorkerPool &npcWorkers();
+        void processNpcPhysicsParallel(double ticks);
+        void updateNpcsParallel(double tickTime);
+
+        //! Replication of the level state with other engine instances, exists when enabled
+        std::unique_ptr<LVL_NetSync> m_netSync;
+
         typedef RTree<PhysObjPtr, double, 2, double > IndexTree;
         typedef LvlQuadTree IndexTree4;
 
@@ -425,7 +488,7 @@ class LevelScene : public Scene
 
         LVL_PlayersArray &getPlayers();
         LVL_NpcsArray &getNpcs();
-        LVL_NpcActiveSet &getActiveNpcs();
+        LVL_NpcActiveList &getActiveNpcs();
 
         LVL_BlocksArray &getBlocks();
         LVL_BgosArray   &getBGOs();
@@ -2,6 +2,9 @@
 #include "luaclass_level_lvl_player.h"
 
 #include <script/lua_global.h>
+#include <script/lua_level_engine.h>
+#include <scenes/scene_level.h>
+#include <luabind/detail/pcall.hpp>
 
 Binding_Level_ClassWrapper_LVL_NPC::Binding_Level_ClassWrapper_LVL_NPC(LevelScene *_parent) : LVL_Npc(_parent)
 {
@@ -103,12 +106,57 @@ function MyNPC:onLoop(frameDelay)
     ticker(frameDelay)
 end
 
+return MyNPC
+*/
+
+/***
+Optional event callback calling once per frame for all active NPCs of the class.
+When defined, onLoop is not called for NPCs of this class.
+Table is reused between frames, don't keep it.
+@function onLoopAll
+@tparam table npcs Array of NPC-AI controllers updated in this frame
+@tparam double frameDelay Frame delay in milliseconds. Use it for various timing processors.
+
+@usage
+class 'MyNPC'
+
+function MyNPC.onLoopAll(npcs, frameDelay)
+    for i = 1, #npcs do
+        local npc = npcs[i]
+        npc.timer = npc.timer + frameDelay
+    end
+end
+
 return MyNPC
 */
 void Binding_Level_ClassWrapper_LVL_NPC::lua_onLoop(double tickTime)
 {
-    if(!LuaGlobal::getEngine(mself.ref(*this).state())->shouldShutdown())
+    LuaLevelEngine *engine = m_scene->getLuaLevelEngine();
+    if(engine->shouldShutdown())
+        return;
+
+    // Class of this NPC handles all its NPCs by onLoopAll
+    if(engine->queueNpcLoop(this))
+        return;
+
+    callOnLoop(tickTime);
+}
+
+void Binding_Level_ClassWrapper_LVL_NPC::callOnLoop(double tickTime)
+{
+    const luabind::object &onLoop = m_scene->getLuaLevelEngine()->npcOnLoopFunction();
+    if(!onLoop.is_valid())
+    {
         call<void>("onLoop", tickTime);
+        return;
+    }
+
+    lua_State *L = onLoop.interpreter();
+    onLoop.push(L);
+    mself.ref(*this).get(L);
+    lua_pushnumber(L, tickTime);
+    if(luabind::detail::pcall(L, 2, 0))
+        throw luabind::error(L);
 }
 
 void Binding_Level_ClassWrapper_LVL_NPC::lua_onInit()
@@ -18,6 +18,11 @@ class Binding_Level_ClassWrapper_LVL_NPC : public LVL_Npc, public luabind::wrap_
         virtual void lua_onKill(KillEvent *killEvent);
         virtual void lua_onHarm(HarmEvent *harmEvent);
         virtual void lua_onTransform(unsigned long id);
+        /*!
+         * \brief Call onLoop of this NPC only, even if its class has onLoopAll handler
+         * \param tickTime Frame delay in milliseconds
+         */
+        void callOnLoop(double tickTime);
 
         static void def_lua_onActivated(LVL_Npc *base)
         {
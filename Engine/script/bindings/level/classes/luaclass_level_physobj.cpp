@@ -242,7 +242,10 @@ luabind::scope Binding_Level_Class_PhysObj::bindToLua()
             .property("paused_physics", &PGE_Phys_Object::isPaused, &PGE_Phys_Object::setPaused)
 
             /***
-            Object is visible and will be drawn on player's camera
+            Object is visible and will be drawn on player's camera.
+            Object of hidden layer is not visible. Setting of this property shows or hides the object
+            alone, even inside of hidden layer, until its layer will be shown or hidden again:
+            after that object has visibility of the layer.
             @tfield bool visible
             */
             .property("visible", &PGE_Phys_Object::isVisible, &PGE_Phys_Object::setVisible)
@@ -19,6 +19,39 @@ void Binding_Level_CommonFuncs::Lua_triggerEvent(lua_State *L, std::string event
     scene->m_events.triggerEvent( eventName );
 }
 
+uint32_t Binding_Level_CommonFuncs::Lua_getLayerID(lua_State *L, std::string layerName)
+{
+    LevelScene* scene = LuaGlobal::getLevelEngine(L)->getScene();
+    return scene->m_layers.layerId(layerName);
+}
+
+void Binding_Level_CommonFuncs::Lua_showLayer(lua_State *L, uint32_t layerID, bool smoke)
+{
+    LevelScene* scene = LuaGlobal::getLevelEngine(L)->getScene();
+    if(layerID < scene->m_names.size())
+        scene->m_layers.show(layerID, smoke);
+}
+
+void Binding_Level_CommonFuncs::Lua_hideLayer(lua_State *L, uint32_t layerID, bool smoke)
+{
+    LevelScene* scene = LuaGlobal::getLevelEngine(L)->getScene();
+    if(layerID < scene->m_names.size())
+        scene->m_layers.hide(layerID, smoke);
+}
+
+void Binding_Level_CommonFuncs::Lua_toggleLayer(lua_State *L, uint32_t layerID, bool smoke)
+{
+    LevelScene* scene = LuaGlobal::getLevelEngine(L)->getScene();
+    if(layerID < scene->m_names.size())
+        scene->m_layers.toggle(layerID, smoke);
+}
+
+bool Binding_Level_CommonFuncs::Lua_isLayerVisible(lua_State *L, uint32_t layerID)
+{
+    LevelScene* scene = LuaGlobal::getLevelEngine(L)->getScene();
+    return scene->m_layers.isVisible(layerID);
+}
+
 void Binding_Level_CommonFuncs::Lua_ShakeScreen(lua_State *L, double forceX, double forceY, double decX, double decY)
 {
     LevelScene* scene = LuaGlobal::getLevelEngine(L)->getScene();
@@ -85,6 +118,46 @@ luabind::scope Binding_Level_CommonFuncs::bindToLua()
             */
             def("triggerEvent", &Binding_Level_CommonFuncs::Lua_triggerEvent),
 
+            /***
+            Get handle of layer to use with layer functions. Resolve it once and keep it to avoid lookups of layer name
+            @function Level.getLayerID
+            @tparam string layerName Name of layer
+            @treturn int Handle of layer
+            */
+            def("getLayerID", &Binding_Level_CommonFuncs::Lua_getLayerID),
+
+            /***
+            Show all members of layer
+            @function Level.showLayer
+            @tparam int layerID Handle of layer, returned by @{Level.getLayerID}
+            @tparam bool smoke Spawn smoke effect at every shown member
+            */
+            def("showLayer", &Binding_Level_CommonFuncs::Lua_showLayer),
+
+            /***
+            Hide all members of layer
+            @function Level.hideLayer
+            @tparam int layerID Handle of layer, returned by @{Level.getLayerID}
+            @tparam bool smoke Spawn smoke effect at every hidden member
+            */
+            def("hideLayer", &Binding_Level_CommonFuncs::Lua_hideLayer),
+
+            /***
+            Toggle visibility of layer
+            @function Level.toggleLayer
+            @tparam int layerID Handle of layer, returned by @{Level.getLayerID}
+            @tparam bool smoke Spawn smoke effect at every member
+            */
+            def("toggleLayer", &Binding_Level_CommonFuncs::Lua_toggleLayer),
+
+            /***
+            Get visibility state of layer
+            @function Level.isLayerVisible
+            @tparam int layerID Handle of layer, returned by @{Level.getLayerID}
+            @treturn bool true if layer is visible
+            */
+            def("isLayerVisible", &Binding_Level_CommonFuncs::Lua_isLayerVisible),
+
             /***
             Set screen shaking effect (or turn it off by giving of zero force)
             @function Level.shakeScreen
@@ -12,6 +12,11 @@ public:
     static void Lua_ToggleSwitch(lua_State *L, int switchID);
     static bool Lua_getSwitchState(lua_State *L, uint32_t switchID);
     static void Lua_triggerEvent(lua_State *L, std::string eventName);
+    static uint32_t Lua_getLayerID(lua_State *L, std::string layerName);
+    static void Lua_showLayer(lua_State *L, uint32_t layerID, bool smoke);
+    static void Lua_hideLayer(lua_State *L, uint32_t layerID, bool smoke);
+    static void Lua_toggleLayer(lua_State *L, uint32_t layerID, bool smoke);
+    static bool Lua_isLayerVisible(lua_State *L, uint32_t layerID);
     static void Lua_ShakeScreen(lua_State *L, double forceX, double forceY, double decX, double decY);
     static void Lua_ShakeScreenX(lua_State *L, double forceX, double decX);
     static void Lua_ShakeScreenY(lua_State *L, double forceY, double decY);
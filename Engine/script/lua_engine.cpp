@@ -23,6 +23,7 @@
 #include <Utils/files.h>
 #include <Utils/sdl_file.h>
 #include <common_features/logger.h>
+#include <common_features/profiler.h>
 #include <common_features/fmt_format_ne.h>
 
 #include <sstream>
@@ -269,6 +270,7 @@ void LuaEngine::forceShutdown()
         return;
     }
 
+    onShutdown();
     LuaGlobal::remove(L);
     lua_close(L);
     L = nullptr;
@@ -341,6 +343,7 @@ void LuaEngine::setCoreFile(const std::string &coreFile)
 
 void LuaEngine::dispatchEvent(LuaEvent &toDispatchEvent)
 {
+    PGE_PROFILE_ZONE("LuaEngine::dispatchEvent");
     if(m_lateShutdown)
         return;
 
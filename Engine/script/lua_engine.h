@@ -93,6 +93,8 @@ public:
 
 protected:
     virtual void onBindAll() {}
+    //! Called before closing of lua state, release here all kept lua objects
+    virtual void onShutdown() {}
     void loadMultiRet(SdlFile *file, const std::string &name = "unknown");
 
     lua_State* getNativeState() {return L; }
@@ -23,6 +23,7 @@
 #include "bindings/core/lua_global_constants.h"
 
 #include <luabind/adopt_policy.hpp>
+#include <luabind/wrapper_base.hpp>
 
 LuaLevelEngine::LuaLevelEngine(LevelScene *scene) : LuaEngine(scene)
 {}
@@ -115,7 +116,120 @@ void LuaLevelEngine::loadNPCClass(unsigned long id, const std::string &path)
     if(luabind::type(_G["npc_class_table"][id]) != LUA_TNIL)
         return;
 
-    _G["npc_class_table"][id] = loadClassAPI(path);
+    luabind::object npcClass = loadClassAPI(path);
+    _G["npc_class_table"][id] = npcClass;
+
+    // Class opted-in to process all its NPCs by one call per frame
+    if(luabind::type(npcClass) != LUA_TNIL)
+    {
+        luabind::object onLoopAll = npcClass["onLoopAll"];
+        if(luabind::type(onLoopAll) == LUA_TFUNCTION)
+        {
+            NpcLoopBatch &batch = m_npcLoopBatches[id];
+            batch.func = onLoopAll;
+            batch.table = luabind::newtable(getNativeState());
+            batch.tableSize = 0;
+        }
+    }
+}
+
+bool LuaLevelEngine::queueNpcLoop(Binding_Level_ClassWrapper_LVL_NPC *npc)
+{
+    if(m_npcLoopBatches.empty())
+        return false;
+
+    NpcLoopBatches::iterator b = m_npcLoopBatches.find(npc->getID());
+    if(b == m_npcLoopBatches.end())
+        return false;
+
+    b->second.npcs.push_back(npc);
+    m_hasQueuedNpcLoops = true;
+    return true;
+}
+
+void LuaLevelEngine::processNpcLoopBatches(double tickTime)
+{
+    if(!m_hasQueuedNpcLoops)
+        return;
+    m_hasQueuedNpcLoops = false;
+
+    lua_State *L = getNativeState();
+    for(NpcLoopBatches::iterator b = m_npcLoopBatches.begin(); b != m_npcLoopBatches.end(); b++)
+    {
+        NpcLoopBatch &batch = b->second;
+        if(batch.npcs.empty())
+            continue;
+
+        if(shouldShutdown())
+        {
+            batch.npcs.clear();
+            continue;
+        }
+
+        // Fill the table with controllers, same objects which are receiving onLoop calls
+        batch.table.push(L);
+        int table = lua_gettop(L);
+        int count = 0;
+        for(Binding_Level_ClassWrapper_LVL_NPC *npc : batch.npcs)
+        {
+            // NPC could be killed or transformed after it was queued, also by onLoopAll of another class
+            if(npc->isKilled())
+                continue;
+            if(npc->getID() != b->first)
+            {
+                m_npcLoopSingles.push_back(npc);
+                continue;
+            }
+            luabind::detail::wrap_access::ref(*npc).get(L);
+            lua_getfield(L, -1, "controller");
+            lua_remove(L, -2);
+            if(lua_isnil(L, -1))
+            {
+                lua_pop(L, 1);
+                continue;
+            }
+            lua_rawseti(L, table, ++count);
+        }
+        // Cut entries which are left from the previous frame
+        for(int i = count + 1; i <= batch.tableSize; i++)
+        {
+            lua_pushnil(L);
+            lua_rawseti(L, table, i);
+        }
+        batch.tableSize = count;
+        lua_pop(L, 1);
+        batch.npcs.clear();
+
+        if(count == 0)
+            continue;
+
+        try
+        {
+            batch.func(batch.table, tickTime);
+        }
+        catch(luabind::error &e)
+        {
+            postLateShutdownError(e);
+        }
+    }
+
+    // Transformed NPCs are receiving onLoop of their new class
+    for(Binding_Level_ClassWrapper_LVL_NPC *npc : m_npcLoopSingles)
+    {
+        if(shouldShutdown())
+            break;
+        if(npc->isKilled())
+            continue;
+        try
+        {
+            npc->callOnLoop(tickTime);
+        }
+        catch(luabind::error &e)
+        {
+            postLateShutdownError(e);
+        }
+    }
+    m_npcLoopSingles.clear();
 }
 
 void LuaLevelEngine::loadPlayerClass(unsigned long id, const std::string &path)
@@ -190,5 +304,22 @@ void LuaLevelEngine::onBindAll()
 
         _G["bases"]["npc"] = loadClassAPI(m_npcBaseClassPath);
         _G["bases"]["player"] = loadClassAPI(m_playerBaseClassPath);
+
+        // Keep onLoop of NPC class to don't look it up by name on every call
+        luabind::object npcClass = _G["bases"]["npc"];
+        if(luabind::type(npcClass) != LUA_TNIL)
+        {
+            luabind::object onLoop = npcClass["onLoop"];
+            if(luabind::type(onLoop) == LUA_TFUNCTION)
+                m_npcOnLoop = onLoop;
+        }
     }
 }
+
+void LuaLevelEngine::onShutdown()
+{
+    m_npcLoopBatches.clear();
+    m_npcLoopSingles.clear();
+    m_hasQueuedNpcLoops = false;
+    m_npcOnLoop = luabind::object();
+}
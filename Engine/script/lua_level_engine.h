@@ -2,10 +2,12 @@
 #define LUALEVELENGINE_H
 
 #include "lua_engine.h"
+#include <vector>
 
 class LevelScene;
 class LVL_Player;
 class LVL_Npc;
+class Binding_Level_ClassWrapper_LVL_NPC;
 
 class LuaLevelEngine : public LuaEngine
 {
@@ -25,6 +27,26 @@ class LuaLevelEngine : public LuaEngine
 
         LevelScene *getScene();
 
+        /*!
+         * \brief Get cached onLoop function of Lua NPC base class
+         * \return function object, or invalid object if class has no such function
+         */
+        const luabind::object &npcOnLoopFunction() const
+        {
+            return m_npcOnLoop;
+        }
+        /*!
+         * \brief Put NPC into the batch of its class when class has onLoopAll handler
+         * \param npc Lua NPC updated in current frame
+         * \return true if NPC will be processed by onLoopAll, false if onLoop must be called for it
+         */
+        bool queueNpcLoop(Binding_Level_ClassWrapper_LVL_NPC *npc);
+        /*!
+         * \brief Call onLoopAll of every NPC class once for all NPCs queued in current frame
+         * \param tickTime Frame delay in milliseconds
+         */
+        void processNpcLoopBatches(double tickTime);
+
         std::string getNpcBaseClassPath() const;
         void setNpcBaseClassPath(const std::string &npcBaseClassPath);
 
@@ -36,6 +58,25 @@ class LuaLevelEngine : public LuaEngine
         std::string m_playerBaseClassPath;
 
         void onBindAll();
+        void onShutdown();
+
+        //! NPCs of one class which are processed by single onLoopAll call
+        struct NpcLoopBatch
+        {
+            //! onLoopAll function of the class
+            luabind::object func;
+            //! Table of NPC controllers, reused every frame
+            luabind::object table;
+            //! Count of entries filled in the table by last call
+            int tableSize = 0;
+            std::vector<Binding_Level_ClassWrapper_LVL_NPC *> npcs;
+        };
+        typedef std::unordered_map<unsigned long, NpcLoopBatch> NpcLoopBatches;
+        NpcLoopBatches  m_npcLoopBatches;
+        //! Queued NPCs which were transformed into another class, they are processed one by one
+        std::vector<Binding_Level_ClassWrapper_LVL_NPC *> m_npcLoopSingles;
+        bool            m_hasQueuedNpcLoops = false;
+        luabind::object m_npcOnLoop;
 };
 
 #endif // LUALEVELENGINE_H
@@ -21,14 +21,20 @@
 #include <graphics/window.h>
 #include <controls/controller_joystick.h>
 #include <controls/controller_keyboard.h>
+#include <controls/controller_replay.h>
+#include <controls/controller_recording.h>
+#include <Utils/maths.h>
 #include <common_features/logger.h>
 #include <common_features/number_limiter.h>
 #include <IniProcessor/ini_processing.h>
 #include <common_features/fmt_format_ne.h>
 
+#include <cstdlib>
+
 GlobalSettings g_AppSettings;
 
-GlobalSettings::GlobalSettings()
+GlobalSettings::GlobalSettings() :
+    frameLimit(0)
 {
     resetDefaults();
 }
@@ -87,6 +93,7 @@ void GlobalSettings::load()
         setup.read("show-debug-info", showDebugInfo, showDebugInfo);
         setup.read("full-screen", fullScreen, fullScreen);
         setup.read("frame-skip", frameSkip, frameSkip);
+        setup.read("parallel-npc-step", parallelNpcStep, parallelNpcStep);
         setup.read("vsync", vsync, vsync);
         setup.read("player1-controller", player1_controller, player1_controller);
         setup.read("player2-controller", player2_controller, player2_controller);
@@ -144,6 +151,7 @@ void GlobalSettings::save()
         setup.setValue("phys-step-time", timeOfFrame);
         setup.setValue("show-debug-info", showDebugInfo);
         setup.setValue("frame-skip", frameSkip);
+        setup.setValue("parallel-npc-step", parallelNpcStep);
         setup.setValue("full-screen", fullScreen);
         setup.setValue("vsync", vsync);
         setup.setValue("player1-controller", player1_controller);
@@ -179,6 +187,7 @@ void GlobalSettings::resetDefaults()
     vsync = true;
     showDebugInfo = false;
     frameSkip = true;
+    parallelNpcStep = false;
     fullScreen = false;
     volume_sound = 128;
     volume_music = 64;
@@ -349,3 +358,46 @@ Controller *GlobalSettings::openController(int player)
     return targetController;
 }
 
+Controller *GlobalSettings::openLevelController(int player)
+{
+    if(!inputReplayFile.empty())
+    {
+        if(!m_replayTrack)
+        {
+            m_replayTrack.reset(new InputTrack);
+            if(!m_replayTrack->load(inputReplayFile))
+                pLogWarning("Failed to load input track, players will stay without controls");
+        }
+
+        //Every level starts with same random numbers as at recording
+        if((player == 1) && m_replayTrack->hasSeed)
+            seedRandom(m_replayTrack->seed);
+
+        return new ReplayController(m_replayTrack, player - 1);
+    }
+
+    if(!inputRecordFile.empty())
+    {
+        std::shared_ptr<InputTrack> track = m_recordTrack.lock();
+        if((player == 1) || !track)
+        {
+            //New level, new recording
+            track.reset(new InputTrack);
+            track->reset(2);
+            track->seed = Maths::urand64();
+            track->hasSeed = true;
+            seedRandom(track->seed);
+            m_recordTrack = track;
+        }
+        return new RecordingController(openController(player), track, player - 1, inputRecordFile);
+    }
+
+    return openController(player);
+}
+
+void GlobalSettings::seedRandom(uint64_t seed)
+{
+    Maths::seedRandom(seed);
+    //Scripts are using random numbers of C library
+    std::srand(static_cast<unsigned int>(seed));
+}
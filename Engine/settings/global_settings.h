@@ -22,11 +22,14 @@
 #include <controls/controller_key_map.h>
 #include <vector>
 #include <string>
+#include <memory>
+#include <cstdint>
 
 #include <SDL2/SDL_joystick.h>
 
 class IniProcessing;
 class Controller;
+class InputTrack;
 
 /*!
  * \brief Global engine application settings class
@@ -71,6 +74,16 @@ class GlobalSettings
         bool debugMode;
         //! Enable interprocessing mode (Engine will try to find running editor and will ask it for opened file data to play it)
         bool interprocessing;
+        //! File of recorded input track which drives players instead of physical controllers
+        std::string inputReplayFile;
+        //! Close the level after this count of loop steps, 0 is unlimited
+        unsigned long frameLimit;
+        //! File where controls of players in the level will be recorded
+        std::string inputRecordFile;
+        //! File where timings of every loop step of the level will be written
+        std::string frameTimingsFile;
+        //! File where profiler zones captured since start will be written on exit
+        std::string profileTraceFile;
         /*Via command line only. End*/
 
         //! Enable full-screen mode
@@ -94,6 +107,9 @@ class GlobalSettings
         //! Enable skipping of frames if real time delay is longer than predefined
         bool frameSkip;
 
+        //! Process NPC physics and detectors of the level on worker threads (script callbacks are still serial)
+        bool parallelNpcStep;
+
         //! Current volume of SFX-es (0...128)
         int volume_sound;
         //! Current volume of music (0...128)
@@ -182,10 +198,30 @@ class GlobalSettings
          */
         Controller *openController(int player);
 
+        /*!
+         * \brief Constructs controller class for specific player of the level scene.
+         *        Takes controls from the recorded input track, or records controls when asked from a command line.
+         * \param player Number of player
+         * \return Pointer to constructed controller class (When you fininshed your works with it, delete it youself!)
+         */
+        Controller *openLevelController(int player);
+
         /*!
          * \brief Load all joystick control keys maps from engine configuration file
          */
         void loadJoystickSettings();
+
+    private:
+        //! Input track loaded from the inputReplayFile, shared by controllers of all players
+        std::shared_ptr<InputTrack> m_replayTrack;
+        //! Input track of the current recording, shared by controllers of all players
+        std::weak_ptr<InputTrack>   m_recordTrack;
+
+        /*!
+         * \brief Restart all random numbers generators from the seed
+         * \param seed Seed of random numbers
+         */
+        void seedRandom(uint64_t seed);
 };
 
 //! Engine application settings container
@@ -25,6 +25,7 @@
 #include <FileMapper/file_mapper.h>
 #include <DirManager/dirman.h>
 #include <Utils/files.h>
+#include <Utils/bitmask.h>
 #include <Utf8Main/utf8main.h>
 #include <tclap/CmdLine.h>
 #include "version.h"
@@ -92,40 +93,12 @@ static void mergeBitBltToRGBA(FIBITMAP *image, const std::string &pathToMask, FI
     unsigned int mask_w = FreeImage_GetWidth(mask);
     unsigned int mask_h = FreeImage_GetHeight(mask);
 
-    RGBQUAD Fpix;
-    RGBQUAD Bpix;
-    RGBQUAD Npix = {0x0, 0x0, 0x0, 0xFF};
+    unsigned int w = (img_w < mask_w) ? img_w : mask_w;
 
     for(unsigned int y = 0; (y < img_h) && (y < mask_h); y++)
-    {
-        for(unsigned int x = 0; (x < img_w) && (x < mask_w); x++)
-        {
-
-            FreeImage_GetPixelColor(image, x, y, &Fpix);
-            FreeImage_GetPixelColor(mask, x, y, &Bpix);
-
-            Npix.rgbRed     = ((0x7F & Bpix.rgbRed) | Fpix.rgbRed);
-            Npix.rgbGreen   = ((0x7F & Bpix.rgbGreen) | Fpix.rgbGreen);
-            Npix.rgbBlue    = ((0x7F & Bpix.rgbBlue) | Fpix.rgbBlue);
-            int newAlpha = 255 -
-                           ((int(Bpix.rgbRed) +
-                             int(Bpix.rgbGreen) +
-                             int(Bpix.rgbBlue)) / 3);
-            if((Bpix.rgbRed > 240u) //is almost White
-               && (Bpix.rgbGreen > 240u)
-               && (Bpix.rgbBlue > 240u))
-                newAlpha = 0;
-
-            newAlpha = newAlpha + ((int(Fpix.rgbRed) +
-                                    int(Fpix.rgbGreen) +
-                                    int(Fpix.rgbBlue)) / 3);
-            if(newAlpha > 255)
-                newAlpha = 255;
-            Npix.rgbReserved = newAlpha;
-
-            FreeImage_SetPixelColor(image, x, y, &Npix);
-        }
-    }
+        BitMask::mergeWithMask(FreeImage_GetScanLine(image, static_cast<int>(y)),
+                               FreeImage_GetScanLine(mask, static_cast<int>(y)),
+                               w);
 
     if(!extMask)
         FreeImage_Unload(mask);
@@ -148,23 +121,10 @@ static void getMaskFromRGBA(FIBITMAP*&image, FIBITMAP *&mask)
                                FreeImage_GetGreenMask(image),
                                FreeImage_GetBlueMask(image));
 
-    RGBQUAD Fpix;
-    RGBQUAD Npix = {0x0, 0x0, 0x0, 0xFF};
-
     for(unsigned int y = 0; (y < img_h); y++)
-    {
-        for(unsigned int x = 0; (x < img_w); x++)
-        {
-            FreeImage_GetPixelColor(image, x, y, &Fpix);
-
-            uint8_t grey = (255 - Fpix.rgbReserved);
-            Npix.rgbRed  = grey;
-            Npix.rgbGreen = grey;
-            Npix.rgbBlue = grey;
-            Npix.rgbReserved = 0xFF;
-            FreeImage_SetPixelColor(mask,  x, y, &Npix);
-        }
-    }
+        BitMask::maskFromAlpha(FreeImage_GetScanLine(image, static_cast<int>(y)),
+                               FreeImage_GetScanLine(mask, static_cast<int>(y)),
+                               img_w);
 }
 
 struct GIFs2PNG_Setup
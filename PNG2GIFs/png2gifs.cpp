@@ -24,6 +24,7 @@
 #include <FileMapper/file_mapper.h>
 #include <DirManager/dirman.h>
 #include <Utils/files.h>
+#include <Utils/bitmask.h>
 #include <Utf8Main/utf8main.h>
 #include <tclap/CmdLine.h>
 #include "version.h"
@@ -71,14 +72,6 @@ static FIBITMAP *loadImage(const std::string &file, bool convertTo32bit = true)
     return img;
 }
 
-static inline uint8_t subtractAlpha(const uint8_t channel, const uint8_t alpha)
-{
-    int16_t ch = static_cast<int16_t>(channel) - static_cast<int16_t>(alpha);
-    if(ch < 0)
-        ch = 0;
-    return static_cast<uint8_t>(ch);
-}
-
 static void splitRGBAtoBitBlt(FIBITMAP*&image, FIBITMAP *&mask)
 {
     unsigned int img_w   = FreeImage_GetWidth(image);
@@ -91,30 +84,10 @@ static void splitRGBAtoBitBlt(FIBITMAP*&image, FIBITMAP *&mask)
                                FreeImage_GetGreenMask(image),
                                FreeImage_GetBlueMask(image));
 
-    RGBQUAD Fpix;
-    RGBQUAD Npix = {0x0, 0x0, 0x0, 0xFF};
-
     for(unsigned int y = 0; (y < img_h); y++)
-    {
-        for(unsigned int x = 0; (x < img_w); x++)
-        {
-            FreeImage_GetPixelColor(image, x, y, &Fpix);
-
-            uint8_t grey = (255 - Fpix.rgbReserved);
-            Npix.rgbRed  = grey;
-            Npix.rgbGreen = grey;
-            Npix.rgbBlue = grey;
-            Npix.rgbReserved = 255;
-
-            Fpix.rgbRed  = subtractAlpha(Fpix.rgbRed, grey);
-            Fpix.rgbGreen = subtractAlpha(Fpix.rgbGreen, grey);
-            Fpix.rgbBlue = subtractAlpha(Fpix.rgbBlue, grey);
-            Fpix.rgbReserved = 255;
-
-            FreeImage_SetPixelColor(image, x, y, &Fpix);
-            FreeImage_SetPixelColor(mask,  x, y, &Npix);
-        }
-    }
+        BitMask::splitToFrontAndMask(FreeImage_GetScanLine(image, static_cast<int>(y)),
+                                     FreeImage_GetScanLine(mask, static_cast<int>(y)),
+                                     img_w);
 }
 
 struct LazyFixTool_Setup
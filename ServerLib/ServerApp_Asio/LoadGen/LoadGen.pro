@@ -0,0 +1,58 @@
+#-------------------------------------------------
+#
+# Load generator for the ServerAsio
+#
+#-------------------------------------------------
+
+QT       += core concurrent
+QT       -= gui
+
+TARGET = LoadGen
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG += c++11
+
+include(../../../_common/dest_dir.pri)
+include(../../../_common/build_props.pri)
+
+INCLUDEPATH += $$PWD/../../../_Libs/asio
+INCLUDEPATH += $$PWD/../ServerAsio
+
+DEFINES += ASIO_STANDALONE
+DEFINES += ASIO_SEPARATE_COMPILATION
+DEFINES += BOOST_ASIO_HEADER_ONLY
+
+win32:{
+    DEFINES += ASIO_HAS_THREADS
+    DEFINES += _WIN32_WINNT=0x0501
+    DEFINES += ASIO_WINDOWS
+    LIBS += -lWs2_32 -lMswsock
+}
+unix:{
+    DEFINES += ASIO_HAS_PTHREADS
+}
+
+SOURCES += main.cpp \
+    loadclient.cpp \
+    ../../../_Libs/asio/asio/impl/src.cpp \
+    ../ServerAsio/ConnectionLib/Shared/pgenet_global.cpp \
+    ../ServerAsio/ConnectionLib/Shared/pgenet_packetmanager.cpp \
+    ../ServerAsio/ConnectionLib/Shared/packetV2/pgenet_packetcodec.cpp \
+    ../ServerAsio/ConnectionLib/Shared/packetV2/packets/ClientToServer/packetuserauth.cpp \
+    ../ServerAsio/ConnectionLib/Shared/packetV2/packets/Both/packetmessage.cpp \
+    ../ServerAsio/ConnectionLib/Shared/packetV2/packets/Both/packetcursor.cpp \
+    ../ServerAsio/ConnectionLib/Shared/util/threadedlogger.cpp \
+    ../ServerAsio/ConnectionLib/Shared/user/pgenet_user.cpp
+
+HEADERS += loadclient.h \
+    ../ServerAsio/ConnectionLib/Shared/pgenet_global.h \
+    ../ServerAsio/ConnectionLib/Shared/pgenet_packetmanager.h \
+    ../ServerAsio/ConnectionLib/Shared/packetV2/pgenet_packetcodec.h \
+    ../ServerAsio/ConnectionLib/Shared/packetV2/packets/packet.h \
+    ../ServerAsio/ConnectionLib/Shared/packetV2/packets/ClientToServer/packetuserauth.h \
+    ../ServerAsio/ConnectionLib/Shared/packetV2/packets/Both/packetmessage.h \
+    ../ServerAsio/ConnectionLib/Shared/packetV2/packets/Both/packetcursor.h \
+    ../ServerAsio/ConnectionLib/Shared/util/threadedlogger.h \
+    ../ServerAsio/ConnectionLib/Shared/user/pgenet_user.h
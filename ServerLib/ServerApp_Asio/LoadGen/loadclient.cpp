@@ -0,0 +1,191 @@
+#include "loadclient.h"
+
+#include <ConnectionLib/Shared/packetV2/pgenet_packetcodec.h>
+#include <ConnectionLib/Shared/packetV2/packets/ClientToServer/packetuserauth.h>
+#include <ConnectionLib/Shared/packetV2/packets/Both/packetcursor.h>
+
+#include <cstring>
+
+LoadClient::LoadClient(asio::io_service &service, PGENET_DefPacketRegister *packetRegister, const LoadOptions &options, int index) :
+    m_strand(service),
+    m_socket(service),
+    m_timer(service),
+    m_packetRegister(packetRegister),
+    m_options(options),
+    m_username(QString("loadgen%1").arg(index)),
+    m_interval(std::chrono::nanoseconds(1000000000LL / std::max(options.rate, 1)))
+{
+    // Spread first cursors of clients over the interval to don't send all of them at once
+    m_nextCursor = Clock::time_point() + (m_interval * index) / std::max(options.clients, 1);
+}
+
+void LoadClient::start(const tcp::endpoint &endpoint, Clock::time_point sendFrom, Clock::time_point sendUntil)
+{
+    auto self(shared_from_this());
+    m_nextCursor = sendFrom + m_nextCursor.time_since_epoch();
+    m_sendUntil = sendUntil;
+
+    m_socket.async_connect(endpoint, m_strand.wrap([this, self](std::error_code ec)
+    {
+        if(ec){
+            fail(ec);
+            return;
+        }
+        m_connected = true;
+        m_socket.set_option(tcp::no_delay(true), ec);
+        sendAuth();
+        readLength();
+        scheduleCursor();
+    }));
+}
+
+void LoadClient::stop()
+{
+    auto self(shared_from_this());
+    m_strand.dispatch([this, self]()
+    {
+        m_stopped = true;
+        std::error_code ec;
+        m_timer.cancel(ec);
+        m_socket.close(ec);
+    });
+}
+
+void LoadClient::sendAuth()
+{
+    PacketUserAuth auth;
+    auth.setSessionID(0);
+    auth.setUsername(m_username);
+    auth.setNetworkVersionNumber(static_cast<int>(PGENET_Global::NetworkVersion));
+
+    // User is not known by the server yet, so header has no username
+    std::string data;
+    if(PGENET_PacketCodec::encodePacket(&auth, QString(), m_options.format, data))
+        send(std::move(data));
+}
+
+void LoadClient::scheduleCursor()
+{
+    if(m_stopped || (m_nextCursor >= m_sendUntil))
+        return;
+
+    auto self(shared_from_this());
+    m_timer.expires_at(m_nextCursor);
+    m_timer.async_wait(m_strand.wrap([this, self](std::error_code ec)
+    {
+        if(ec || m_stopped)
+            return;
+        // Cursors are sent by the fixed schedule even if client is late,
+        // so the slow server doesn't hide its latency by slowing down the clients.
+        Clock::time_point now = Clock::now();
+        while((m_nextCursor <= now) && (m_nextCursor < m_sendUntil)){
+            sendCursor();
+            m_nextCursor += m_interval;
+        }
+        scheduleCursor();
+    }));
+}
+
+void LoadClient::sendCursor()
+{
+    int sequence = m_nextSequence++;
+    PacketCursor cursor(sequence, 0);
+    cursor.setSessionID(0);
+
+    std::string data;
+    if(!PGENET_PacketCodec::encodePacket(&cursor, m_username, m_options.format, data))
+        return;
+
+    m_pending[sequence] = Clock::now();
+    m_sent++;
+    send(std::move(data));
+}
+
+void LoadClient::send(std::string data)
+{
+    m_bytesSent += data.size();
+    m_writeQueue.push_back(std::move(data));
+    if(m_writeQueue.size() == 1)
+        writeNext();
+}
+
+void LoadClient::writeNext()
+{
+    auto self(shared_from_this());
+    asio::async_write(m_socket, asio::buffer(m_writeQueue.front()), m_strand.wrap([this, self](std::error_code ec, std::size_t /*length*/)
+    {
+        if(ec){
+            fail(ec);
+            return;
+        }
+        m_writeQueue.pop_front();
+        if(!m_writeQueue.empty())
+            writeNext();
+    }));
+}
+
+void LoadClient::readLength()
+{
+    auto self(shared_from_this());
+    asio::async_read(m_socket, asio::buffer(m_lengthBuf, sizeof(m_lengthBuf)), m_strand.wrap([this, self](std::error_code ec, std::size_t /*length*/)
+    {
+        if(ec){
+            fail(ec);
+            return;
+        }
+        int size = 0;
+        memcpy(&size, m_lengthBuf, sizeof(int));
+        if(size < 0){
+            fail(asio::error::make_error_code(asio::error::invalid_argument));
+            return;
+        }
+        readPacket(size);
+    }));
+}
+
+void LoadClient::readPacket(int size)
+{
+    auto self(shared_from_this());
+    m_readBuf.resize(static_cast<size_t>(size));
+    asio::async_read(m_socket, asio::buffer(&m_readBuf[0], m_readBuf.size()), m_strand.wrap([this, self](std::error_code ec, std::size_t /*length*/)
+    {
+        if(ec){
+            fail(ec);
+            return;
+        }
+        m_bytesReceived += sizeof(int) + m_readBuf.size();
+        handlePacket();
+        readLength();
+    }));
+}
+
+void LoadClient::handlePacket()
+{
+    QString username;
+    PacketWireFormat format;
+    std::unique_ptr<Packet> packet(PGENET_PacketCodec::decodePacket(m_packetRegister, m_readBuf, username, format));
+    if(!packet || (packet->getPacketID() != static_cast<int>(PacketID::PGENET_PacketCursor)))
+        return;
+
+    PacketCursor* cursor = static_cast<PacketCursor*>(packet.get());
+    auto it = m_pending.find(cursor->x());
+    if(it == m_pending.end())
+        return;
+
+    auto rtt = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - it->second);
+    m_latencies.push_back(static_cast<unsigned int>(rtt.count()));
+    m_pending.erase(it);
+    m_received++;
+}
+
+void LoadClient::fail(const std::error_code &ec)
+{
+    // Errors of the closed socket are expected
+    if(m_stopped || (ec == asio::error::operation_aborted))
+        return;
+    m_failed = true;
+    m_stopped = true;
+    std::error_code ignored;
+    m_timer.cancel(ignored);
+    m_socket.close(ignored);
+}
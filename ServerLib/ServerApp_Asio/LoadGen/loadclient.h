@@ -0,0 +1,112 @@
+#ifndef LOADCLIENT_H
+#define LOADCLIENT_H
+
+#include <asio.hpp>
+#include <asio/steady_timer.hpp>
+
+#include <QString>
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <ConnectionLib/Shared/pgenet_packetmanager.h>
+
+using asio::ip::tcp;
+
+///
+/// \brief Settings of the load test
+///
+struct LoadOptions
+{
+    /// Count of simulated clients
+    int clients = 100;
+    /// Cursor packets per second sent by every client
+    int rate = 20;
+    /// Time between connecting and first cursor, server must register the user meanwhile
+    std::chrono::milliseconds warmup = std::chrono::milliseconds(1000);
+    /// Time of sending cursors
+    std::chrono::milliseconds duration = std::chrono::milliseconds(10000);
+    /// Wire format of the packets
+    PacketWireFormat format = PacketWireFormat::PGENET_WireBinary;
+};
+
+///
+/// \brief Simulated client: authorizes and sends cursor packets at given rate.
+///
+/// Server sends every cursor back, the round-trip time is measured by the x field
+/// which carries the sequence number of the cursor. All handlers of the client are
+/// running through its own strand, so io_service can be run by several threads.
+///
+class LoadClient : public std::enable_shared_from_this<LoadClient>
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    LoadClient(asio::io_service& service, PGENET_DefPacketRegister* packetRegister, const LoadOptions& options, int index);
+
+    ///
+    /// \brief start Connect and begin the test.
+    /// \param endpoint Address of the server.
+    /// \param sendFrom Time of the first cursor.
+    /// \param sendUntil Time when client stops sending cursors.
+    ///
+    void start(const tcp::endpoint& endpoint, Clock::time_point sendFrom, Clock::time_point sendUntil);
+    void stop();
+
+    // Results, read them only after io_service has been stopped
+    bool connected() const { return m_connected; }
+    bool failed() const { return m_failed; }
+    unsigned long long sent() const { return m_sent; }
+    unsigned long long received() const { return m_received; }
+    unsigned long long bytesSent() const { return m_bytesSent; }
+    unsigned long long bytesReceived() const { return m_bytesReceived; }
+    /// Cursors without answer
+    size_t pending() const { return m_pending.size(); }
+    /// Round-trip times in microseconds
+    const std::vector<unsigned int>& latencies() const { return m_latencies; }
+
+private:
+    void sendAuth();
+    void scheduleCursor();
+    void sendCursor();
+    void send(std::string data);
+    void writeNext();
+    void readLength();
+    void readPacket(int size);
+    void handlePacket();
+    void fail(const std::error_code& ec);
+
+    asio::io_service::strand m_strand;
+    tcp::socket m_socket;
+    asio::steady_timer m_timer;
+
+    PGENET_DefPacketRegister* m_packetRegister;
+    const LoadOptions& m_options;
+    QString m_username;
+
+    Clock::time_point m_sendUntil;
+    Clock::time_point m_nextCursor;
+    std::chrono::nanoseconds m_interval;
+
+    std::deque<std::string> m_writeQueue;
+    char m_lengthBuf[sizeof(int)];
+    std::string m_readBuf;
+
+    int m_nextSequence = 0;
+    std::unordered_map<int, Clock::time_point> m_pending;
+
+    bool m_connected = false;
+    bool m_failed = false;
+    bool m_stopped = false;
+    unsigned long long m_sent = 0;
+    unsigned long long m_received = 0;
+    unsigned long long m_bytesSent = 0;
+    unsigned long long m_bytesReceived = 0;
+    std::vector<unsigned int> m_latencies;
+};
+
+#endif // LOADCLIENT_H
@@ -0,0 +1,130 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <ConnectionLib/Shared/util/threadedlogger.h>
+
+#include "loadclient.h"
+
+// Nearest-rank percentile of sorted values
+static double percentileMs(const std::vector<unsigned int>& sorted, double p)
+{
+    if(sorted.empty())
+        return 0.0;
+    size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+    rank = std::min(std::max(rank, size_t(1)), sorted.size());
+    return sorted[rank - 1] / 1000.0;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("LoadGen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Opens many simulated clients to the PGE Asio server and measures round-trip time of cursor packets.");
+    parser.addHelpOption();
+    QCommandLineOption hostOption("host", "Server address.", "host", "127.0.0.1");
+    QCommandLineOption portOption("port", "Server port.", "port", QString::number(PGENET_Global::Port));
+    QCommandLineOption clientsOption("clients", "Count of simulated clients.", "count", "100");
+    QCommandLineOption rateOption("rate", "Cursor packets per second sent by every client.", "rate", "20");
+    QCommandLineOption durationOption("duration", "Seconds of sending cursors.", "seconds", "10");
+    QCommandLineOption warmupOption("warmup", "Milliseconds between connecting and first cursor.", "ms", "1000");
+    QCommandLineOption threadsOption("threads", "Count of network threads, 0 is count of CPU cores.", "count", "0");
+    QCommandLineOption formatOption("format", "Wire format: binary or json.", "format", "binary");
+    parser.addOptions({hostOption, portOption, clientsOption, rateOption, durationOption, warmupOption, threadsOption, formatOption});
+    parser.process(a);
+
+    LoadOptions options;
+    options.clients = std::max(parser.value(clientsOption).toInt(), 1);
+    options.rate = std::max(parser.value(rateOption).toInt(), 1);
+    options.duration = std::chrono::milliseconds(static_cast<long long>(parser.value(durationOption).toDouble() * 1000.0));
+    options.warmup = std::chrono::milliseconds(parser.value(warmupOption).toInt());
+    options.format = (parser.value(formatOption) == "json") ? PacketWireFormat::PGENET_WireJSON : PacketWireFormat::PGENET_WireBinary;
+
+    int threads = parser.value(threadsOption).toInt();
+    if(threads <= 0)
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+    if(threads <= 0)
+        threads = 1;
+
+    // Codec reports broken packets through the logger
+    ThreadedLogger::initStatic();
+    QObject::connect(gThreadedLogger.data(), &ThreadedLogger::newIncomingMsg, [](ThreadedLogger::LoggerLevel level, QString msg){
+        std::cerr << "[" << ThreadedLogger::LoggerLevelToString(level).toStdString() << "] " << msg.toStdString() << std::endl;
+    });
+
+    PGENET_PacketManager packetManager;
+    asio::io_service service;
+    std::unique_ptr<asio::io_service::work> work(new asio::io_service::work(service));
+
+    tcp::endpoint endpoint;
+    try {
+        tcp::resolver resolver(service);
+        endpoint = *resolver.resolve(tcp::resolver::query(parser.value(hostOption).toStdString(), parser.value(portOption).toStdString()));
+    } catch(std::exception& e) {
+        std::cerr << "Failed to resolve the server address: " << e.what() << std::endl;
+        return 1;
+    }
+
+    LoadClient::Clock::time_point sendFrom = LoadClient::Clock::now() + options.warmup;
+    LoadClient::Clock::time_point sendUntil = sendFrom + options.duration;
+
+    std::vector<std::shared_ptr<LoadClient> > clients;
+    for(int i = 0; i < options.clients; i++){
+        clients.push_back(std::make_shared<LoadClient>(service, packetManager.getPacketRegister(), options, i));
+        clients.back()->start(endpoint, sendFrom, sendUntil);
+    }
+
+    std::vector<std::thread> ioThreads;
+    for(int i = 0; i < threads; i++)
+        ioThreads.push_back(std::thread([&service](){ service.run(); }));
+
+    std::cout << "Running " << options.clients << " clients at " << options.rate << " cursors/s each..." << std::endl;
+
+    // Give the last answers a time to come
+    std::this_thread::sleep_until(sendUntil + std::chrono::seconds(1));
+    for(std::shared_ptr<LoadClient>& client : clients)
+        client->stop();
+    work.reset();
+    for(std::thread& ioThread : ioThreads)
+        ioThread.join();
+
+    int connected = 0, failed = 0;
+    unsigned long long sent = 0, received = 0, lost = 0, bytesSent = 0, bytesReceived = 0;
+    std::vector<unsigned int> latencies;
+    for(std::shared_ptr<LoadClient>& client : clients){
+        connected += client->connected() ? 1 : 0;
+        failed += client->failed() ? 1 : 0;
+        sent += client->sent();
+        received += client->received();
+        lost += client->pending();
+        bytesSent += client->bytesSent();
+        bytesReceived += client->bytesReceived();
+        latencies.insert(latencies.end(), client->latencies().begin(), client->latencies().end());
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    double seconds = std::chrono::duration<double>(options.duration).count();
+    if(seconds <= 0.0)
+        seconds = 1.0;
+
+    printf("Clients:    %d connected, %d failed\n", connected, failed);
+    printf("Cursors:    %llu sent, %llu answered, %llu lost\n", sent, received, lost);
+    printf("Throughput: %.1f sent/s, %.1f answered/s\n", sent / seconds, received / seconds);
+    printf("Traffic:    %.1f KiB/s out, %.1f KiB/s in\n", bytesSent / seconds / 1024.0, bytesReceived / seconds / 1024.0);
+    printf("Round-trip: p50 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+           percentileMs(latencies, 0.50), percentileMs(latencies, 0.99), percentileMs(latencies, 1.0));
+    fflush(stdout);
+
+    clients.clear();
+    ThreadedLogger::destoryStatic();
+    return (failed > 0 || connected == 0) ? 1 : 0;
+}
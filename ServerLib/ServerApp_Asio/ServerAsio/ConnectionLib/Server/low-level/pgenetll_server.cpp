@@ -4,7 +4,8 @@
 
 PGENETLL_Server::PGENETLL_Server(asio::io_service& io_service, short port) :
     m_pgenetll_acceptor(io_service, tcp::endpoint(tcp::v4(), port)),
-    m_pgenetll_nextsocket(io_service)
+    m_pgenetll_nextsocket(io_service),
+    m_nextRawPacketQueue(0)
 {}
 
 
@@ -17,8 +18,10 @@ void PGENETLL_Server::startAccepting()
             if (!ec)
             {
                 std::shared_ptr<PGENETLL_Session> newSession = std::make_shared<PGENETLL_Session>(std::move(m_pgenetll_nextsocket));
+                // Only one accept is pending at time, so this handler is never executed concurrently
+                newSession->setRawPacketToPush(m_rawPacketToPush[m_nextRawPacketQueue]);
+                m_nextRawPacketQueue = (m_nextRawPacketQueue + 1) % m_rawPacketToPush.size();
                 newSession->start();
-                newSession->setRawPacketToPush(m_rawPacketToPush);
                 std::cout << "Incoming connection!" << std::endl;
 
                 if(m_incomingConnectionHandler)
@@ -33,9 +36,10 @@ void PGENETLL_Server::startAccepting()
 }
 
 
-void PGENETLL_Server::setRawPacketToPush(const std::shared_ptr<ThreadedQueue_RawData> &packetToPush)
+void PGENETLL_Server::setRawPacketToPush(const std::vector<std::shared_ptr<ThreadedQueue_RawData> > &packetToPush)
 {
     m_rawPacketToPush = packetToPush;
+    m_nextRawPacketQueue = 0;
 }
 void PGENETLL_Server::setIncomingConnectionHandler(const std::function<void (std::shared_ptr<PGENETLL_Session>)> &value)
 {
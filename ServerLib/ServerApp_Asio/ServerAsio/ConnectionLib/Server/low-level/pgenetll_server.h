@@ -3,8 +3,9 @@
 
 #include <asio.hpp>
 #include <functional>
+#include <vector>
 
-#include <ConnectionLib/Shared/util/ThreadedQueue.h>
+#include <ConnectionLib/Shared/util/MPSCQueue.h>
 #include "pgenetll_session.h"
 
 using asio::ip::tcp;
@@ -17,12 +18,14 @@ public:
     void startAccepting();
 
 
-    void setRawPacketToPush(const std::shared_ptr<ThreadedQueue_RawData> &packetToPush);
+    // Connections are spread over the queues, all packets of one connection go to the same queue.
+    void setRawPacketToPush(const std::vector<std::shared_ptr<ThreadedQueue_RawData> > &packetToPush);
     void setIncomingConnectionHandler(const std::function<void (std::shared_ptr<PGENETLL_Session>)> &value);
 
 private:
     // Will be forwarded to the session:
-    std::shared_ptr<ThreadedQueue_RawData> m_rawPacketToPush;
+    std::vector<std::shared_ptr<ThreadedQueue_RawData> > m_rawPacketToPush;
+    size_t m_nextRawPacketQueue;
 
     std::function<void(std::shared_ptr<PGENETLL_Session>)> m_incomingConnectionHandler;
 
@@ -4,7 +4,9 @@
 
 
 PGENETLL_Session::PGENETLL_Session(tcp::socket socket) :
-    m_socket(std::move(socket))
+    m_wireFormat(PacketWireFormat::PGENET_WireJSON),
+    m_socket(std::move(socket)),
+    m_strand(m_socket.get_io_service())
 {
 
 }
@@ -19,12 +21,54 @@ void PGENETLL_Session::setRawPacketToPush(const std::shared_ptr<ThreadedQueue_Ra
     m_rawPacketToPush = packetToPush;
 }
 
+PacketWireFormat PGENETLL_Session::wireFormat() const
+{
+    return m_wireFormat.load();
+}
+
+void PGENETLL_Session::setWireFormat(PacketWireFormat format)
+{
+    m_wireFormat.store(format);
+}
+
+void PGENETLL_Session::send(std::string data)
+{
+    auto self(shared_from_this());
+
+    // The socket and the queue are used on the strand only
+    m_strand.post([this, self, data]()
+    {
+        m_writeQueue.push_back(data);
+        if(m_writeQueue.size() == 1)
+            writeNext();
+    });
+}
+
+void PGENETLL_Session::writeNext()
+{
+    auto self(shared_from_this());
+
+    asio::async_write(m_socket, asio::buffer(m_writeQueue.front()),
+                      m_strand.wrap([this, self](std::error_code ec, std::size_t /*length*/)
+    {
+        if (ec){
+            std::cout << "Error happened: " << ec.message() << std::endl;
+            m_writeQueue.clear();
+            return;
+        }
+        m_writeQueue.pop_front();
+        if(!m_writeQueue.empty())
+            writeNext();
+    }));
+}
+
 void PGENETLL_Session::listen()
 {
     auto self(shared_from_this());
 
-    m_socket.async_read_some(asio::buffer(m_dataBuf, max_length),
-                             [this, self](std::error_code ec, std::size_t length)
+    // The length prefix may come in several parts, so wait for all of it
+    asio::async_read(m_socket, asio::buffer(m_dataBuf, max_length),
+                     m_strand.wrap([this, self](std::error_code ec, std::size_t /*length*/)
     {
         if (ec == asio::error::connection_reset || ec == asio::error::eof){
             std::cout << "Connection closed!" << std::endl;
@@ -35,19 +79,48 @@ void PGENETLL_Session::listen()
             int size = 0;
             memcpy((void*)&size, (void*)&m_dataBuf, 4);
 
-            std::cout << "[Receive Size] size: " << size << std::endl;
+            if((size <= 0) || (size > max_packet_size))
+            {
+                std::cout << "Invalid packet length " << size << ", closing connection!" << std::endl;
+                close();
+                return;
+            }
+
+            readBody(size);
+        }else{
+            std::cout << "Error happened: " << ec.message() << std::endl;
+        }
+    }));
+}
 
-            std::string buf(size, '\0');
-            asio::read(m_socket, asio::buffer(&buf[0], size));
+void PGENETLL_Session::readBody(int size)
+{
+    auto self(shared_from_this());
 
-            m_rawPacketToPush->push(make_pair(self, buf));
+    m_bodyBuf.assign(static_cast<size_t>(size), '\0');
+    asio::async_read(m_socket, asio::buffer(&m_bodyBuf[0], m_bodyBuf.size()),
+                     m_strand.wrap([this, self](std::error_code ec, std::size_t /*length*/)
+    {
+        if (ec == asio::error::connection_reset || ec == asio::error::eof){
+            std::cout << "Connection closed!" << std::endl;
+            return;
+        }
+        if (!ec)
+        {
+            m_rawPacketToPush->push(make_pair(self, m_bodyBuf));
 
             // Listen more
             listen();
         }else{
             std::cout << "Error happened: " << ec.message() << std::endl;
         }
-
-    });
+    }));
 }
 
+void PGENETLL_Session::close()
+{
+    // Called on the strand
+    std::error_code ec;
+    m_socket.shutdown(tcp::socket::shutdown_both, ec);
+    m_socket.close(ec);
+}
@@ -2,12 +2,16 @@
 #define PGENETLL_SESSION_H
 
 #include <asio.hpp>
-#include <ConnectionLib/Shared/util/ThreadedQueue.h>
+#include <atomic>
+#include <deque>
+#include <string>
+#include <ConnectionLib/Shared/util/MPSCQueue.h>
+#include <ConnectionLib/Shared/pgenet_global.h>
 
 class PGENETLL_Session;
 
 using asio::ip::tcp;
-using ThreadedQueue_RawData = ThreadedQueue<std::pair<std::shared_ptr<PGENETLL_Session>, std::string> >;
+using ThreadedQueue_RawData = MPSCQueue<std::pair<std::shared_ptr<PGENETLL_Session>, std::string> >;
 
 class PGENETLL_Session
   : public std::enable_shared_from_this<PGENETLL_Session>
@@ -18,14 +22,37 @@ public:
     void start();
     void setRawPacketToPush(const std::shared_ptr<ThreadedQueue_RawData> &packetToPush);
 
+    PacketWireFormat wireFormat() const;
+    void setWireFormat(PacketWireFormat format);
+
+    ///
+    /// \brief send Send encoded packet (with length prefix) to the client. Can be called from any thread.
+    /// \param data The data to send.
+    ///
+    void send(std::string data);
+
 private:
+    //Format negotiated by the auth packet, JSON until the client is authorized
+    std::atomic<PacketWireFormat> m_wireFormat;
+
     std::shared_ptr<ThreadedQueue_RawData> m_rawPacketToPush;
 
     void listen();
+    void readBody(int size);
+    void close();
+
+    //Outgoing data, the front one is being written. Used on the strand only
+    std::deque<std::string> m_writeQueue;
+    void writeNext();
 
     tcp::socket m_socket;
+    //Handlers of this connection never run concurrently
+    asio::io_service::strand m_strand;
     enum { max_length = 4 };
+    //Packets longer than this are treated as broken stream
+    enum { max_packet_size = 1024 * 1024 };
     char m_dataBuf[max_length];
+    std::string m_bodyBuf;
 };
 
 #endif // PGENETLL_SESSION_H
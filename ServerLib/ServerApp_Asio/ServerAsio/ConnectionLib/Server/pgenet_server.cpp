@@ -3,19 +3,21 @@
 #include "../Shared/pgenet_global.h"
 #include <iostream>
 
-PGENET_Server::PGENET_Server(QObject *parent) :
+PGENET_Server::PGENET_Server(QObject *parent, int ioThreads, int decoderThreads) :
     QObject(parent),
 
     m_currentState(PGENET_ServerState::Closed),
 
-    m_pckDecoder(getPacketRegister(), &m_userManager),
+    m_ioThreadsCount(ioThreads),
+
+    m_pckDecoder(getPacketRegister(), &m_userManager, decoderThreads),
 
     m_globalSession(this),
 
     m_service(new asio::io_service()),
     m_llserver(*m_service, PGENET_Global::Port)
 {
-    m_llserver.setRawPacketToPush(m_pckDecoder.incomingPacketsQueue());
+    m_llserver.setRawPacketToPush(m_pckDecoder.incomingPacketsQueues());
     m_fullPackets = m_pckDecoder.fullPacketsQueue();
     m_fullPacketsUnindentified = m_pckDecoder.fullPacketsUnindentified();
 
@@ -28,7 +30,8 @@ PGENET_Server::~PGENET_Server()
     if(m_currentState == PGENET_ServerState::Running){
         _bgWorker_quit();
         m_service->stop();
-        _ioServiceState.waitForFinished();
+        for(std::thread& ioThread : _ioServiceThreads)
+            ioThread.join();
         _bgWorkerState_FullPackets.waitForFinished();
         _bgWorkerState_FullPacketsUnindentified.waitForFinished();
     }
@@ -41,7 +44,16 @@ void PGENET_Server::start()
         return;
     }
     m_llserver.startAccepting();
-    _ioServiceState = QtConcurrent::run([this](){ _ioService_run(); });
+
+    int ioThreads = m_ioThreadsCount;
+    if(ioThreads <= 0)
+        ioThreads = static_cast<int>(std::thread::hardware_concurrency());
+    if(ioThreads <= 0)
+        ioThreads = 1;
+    // Handlers of one connection are never running concurrently: every session has only one pending read.
+    for(int i = 0; i < ioThreads; i++)
+        _ioServiceThreads.push_back(std::thread([this](){ _ioService_run(); }));
+
     _bgWorkerState_FullPackets = QtConcurrent::run([this](){ _bgWorker_WaitForIncomingFullPackets(); });
     _bgWorkerState_FullPacketsUnindentified = QtConcurrent::run([this](){ _bgWorker_WaitForIncomingFullPacketsUnindentified(); });
     m_currentState = PGENET_ServerState::Running;
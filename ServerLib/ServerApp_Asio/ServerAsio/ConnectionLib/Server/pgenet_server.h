@@ -4,6 +4,8 @@
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <thread>
+#include <vector>
 
 #include <asio.hpp>
 #include <asio/io_service.hpp>
@@ -34,7 +36,11 @@ class PGENET_Server : public QObject, public PGENET_PacketManager
     Q_OBJECT
     Q_DISABLE_COPY(PGENET_Server)
 public:
-    PGENET_Server(QObject* parent = 0);
+    ///
+    /// \param ioThreads Count of threads running the io_service. When 0, count of CPU cores is used.
+    /// \param decoderThreads Count of packet decoding threads. When 0, count of CPU cores is used.
+    ///
+    PGENET_Server(QObject* parent = 0, int ioThreads = 0, int decoderThreads = 0);
     virtual ~PGENET_Server();
 
     void start();
@@ -62,7 +68,8 @@ private:
     // ///////////// ASYC IO_SERVICE RUNNER ///////////////
 
     void _ioService_run();
-    QFuture<void> _ioServiceState;
+    int m_ioThreadsCount;
+    std::vector<std::thread> _ioServiceThreads;
 
     // ///////////// ASYC TOOLS ///////////////////////////
 
@@ -85,7 +92,7 @@ private:
 
     // Packet Decoder:
     RawPacketDecoder m_pckDecoder;
-    std::shared_ptr<ThreadedQueue<Packet*> > m_fullPackets;
+    std::shared_ptr<MPSCQueue<Packet*> > m_fullPackets;
     std::shared_ptr<ThreadedQueue_UnindentifedPackets> m_fullPacketsUnindentified;
 
     // Sessions:
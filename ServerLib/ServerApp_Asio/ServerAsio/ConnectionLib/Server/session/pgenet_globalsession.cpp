@@ -4,6 +4,7 @@
 #include <iostream>
 
 #include <ConnectionLib/Shared/util/threadedlogger.h>
+#include <ConnectionLib/Shared/packetV2/pgenet_packetcodec.h>
 
 PGENET_GlobalSession::PGENET_GlobalSession(PGENET_Server *server) :
     PGENET_Session(PGENET_Session::SESSIONTYPE_PacketAndUnindentifiedPacket),
@@ -21,10 +22,30 @@ void PGENET_GlobalSession::managePacketAuth(std::shared_ptr<PGENETLL_Session> se
     m_server->getUserManager()->registerUser(auth->username(), session);
 }
 
+void PGENET_GlobalSession::managePacketCursor(PacketCursor *cursor)
+{
+    if(!cursor)
+        return;
+
+    PGENET_User* user = cursor->getUser();
+    if(!user || !user->getSession())
+        return;
+
+    // There are no rooms yet, so the cursor is sent back to its owner as acknowledge.
+    std::shared_ptr<PGENETLL_Session> session = user->getSession();
+    std::string data;
+    if(PGENET_PacketCodec::encodePacket(cursor, user->getUsername(), session->wireFormat(), data))
+        session->send(std::move(data));
+}
+
 
 void PGENET_GlobalSession::manageNextPacket(std::shared_ptr<Packet> nextPacket)
 {
-
+    switch (static_cast<PacketID>(nextPacket->getPacketID())) {
+    case PacketID::PGENET_PacketCursor: managePacketCursor(dynamic_cast<PacketCursor*>(nextPacket.get())); break;
+    default:
+        break;
+    }
 }
 
 void PGENET_GlobalSession::manageNextPacketUnindentified(std::shared_ptr<PGENETLL_Session> lowLevelClient, std::shared_ptr<Packet> nextPacket)
@@ -6,6 +6,7 @@
 #include <memory>
 
 #include <ConnectionLib/Shared/packetV2/packets/ClientToServer/packetuserauth.h>
+#include <ConnectionLib/Shared/packetV2/packets/Both/packetcursor.h>
 
 class PGENET_Server;
 
@@ -20,6 +21,7 @@ private:
     PGENET_Server* m_server;
 
     void managePacketAuth(std::shared_ptr<PGENETLL_Session> session, PacketUserAuth* auth);
+    void managePacketCursor(PacketCursor* cursor);
 
     // PGENET_Session interface
 protected:
@@ -4,7 +4,7 @@
 #include <QObject>
 
 #include <ConnectionLib/Shared/packetV2/packets/packet.h>
-#include <ConnectionLib/Shared/util/ThreadedQueue.h>
+#include <ConnectionLib/Shared/util/MPSCQueue.h>
 #include <memory>
 #include <thread>
 
@@ -32,11 +32,11 @@ private:
     SessionLoopType m_type;
 
     // Async Stuff
-    ThreadedQueue<Packet*> m_nextPacketQueue;
+    MPSCQueue<Packet*> m_nextPacketQueue;
     std::thread m_packetLoopThread;
     void runPacketLoop();
 
-    ThreadedQueue<std::pair<std::shared_ptr<PGENETLL_Session>, Packet*> > m_nextPacketUnindentifiedQueue;
+    MPSCQueue<std::pair<std::shared_ptr<PGENETLL_Session>, Packet*> > m_nextPacketUnindentifiedQueue;
     std::thread m_packetUnindentifiedLoopThread;
     void runPacketUnindentifiedLoop();
 };
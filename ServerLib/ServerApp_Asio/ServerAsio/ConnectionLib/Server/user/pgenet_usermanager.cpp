@@ -9,7 +9,7 @@ PGENET_ServerUser *PGENET_UserManager::getUserByName(const QString &name)
 
     for(unsigned int i = 0; i < m_regUsers.size(); i++){
         std::unique_ptr<PGENET_ServerUser>& nextUser = m_regUsers[i];
-        if(name.compare(nextUser->getUsername(), Qt::CaseInsensitive))
+        if(name.compare(nextUser->getUsername(), Qt::CaseInsensitive) == 0)
             return nextUser.get();
     }
 
@@ -18,6 +18,8 @@ PGENET_ServerUser *PGENET_UserManager::getUserByName(const QString &name)
 
 void PGENET_UserManager::registerUser(const QString &name, std::shared_ptr<PGENETLL_Session> sessionObj)
 {
+    QMutexLocker locker(&mutex);
+
     std::unique_ptr<PGENET_ServerUser> newUser(new PGENET_ServerUser(name));
     newUser->setSession(sessionObj);
     m_regUsers.push_back(std::move(newUser));
@@ -30,5 +32,6 @@ std::function<void (std::shared_ptr<PGENETLL_Session>)> PGENET_UserManager::getN
 
 void PGENET_UserManager::newIncomingConnection(std::shared_ptr<PGENETLL_Session> newUnindentifiedSession)
 {
+    QMutexLocker locker(&mutex);
     m_unindentifiedUsers.push_back(newUnindentifiedSession);
 }
@@ -1,128 +1,76 @@
 #include "rawpacketdecoder.h"
 
-#include <QDataStream>
-#include <iostream>
-#include <QJsonDocument>
-
 #include <ConnectionLib/Shared/util/threadedlogger.h>
+#include <ConnectionLib/Shared/packetV2/pgenet_packetcodec.h>
 
-RawPacketDecoder::RawPacketDecoder(PGENET_DefPacketRegister *packetRegister, PGENET_UserManager *userManager) :
-    m_incomingPackets(new ThreadedQueue_RawData()),
-    m_fullPackets(new ThreadedQueue<Packet* >()),
+RawPacketDecoder::RawPacketDecoder(PGENET_DefPacketRegister *packetRegister, PGENET_UserManager *userManager, int workerCount) :
+    m_fullPackets(new MPSCQueue<Packet* >()),
     m_fullPacketsUnindentified(new ThreadedQueue_UnindentifedPackets()),
     m_packetRegister(packetRegister),
     m_userManager(userManager)
 {
-    _asyncWorkerThread = std::thread([this](){_asyncWorkerProc();});
+    if(workerCount <= 0)
+        workerCount = static_cast<int>(std::thread::hardware_concurrency());
+    if(workerCount <= 0)
+        workerCount = 1;
+
+    for(int i = 0; i < workerCount; i++){
+        std::shared_ptr<ThreadedQueue_RawData> incomingPackets(new ThreadedQueue_RawData());
+        m_incomingPackets.push_back(incomingPackets);
+        _asyncWorkerThreads.push_back(std::thread([this, incomingPackets](){_asyncWorkerProc(incomingPackets);}));
+    }
 }
 
 RawPacketDecoder::~RawPacketDecoder()
 {
-    m_incomingPackets->doExit();
-    _asyncWorkerThread.join();
+    for(std::shared_ptr<ThreadedQueue_RawData>& incomingPackets : m_incomingPackets)
+        incomingPackets->doExit();
+    for(std::thread& worker : _asyncWorkerThreads)
+        worker.join();
 }
 
-std::shared_ptr<ThreadedQueue_RawData> RawPacketDecoder::incomingPacketsQueue() const
+const std::vector<std::shared_ptr<ThreadedQueue_RawData> >& RawPacketDecoder::incomingPacketsQueues() const
 {
     return m_incomingPackets;
 }
 
-std::shared_ptr<ThreadedQueue<Packet* > > RawPacketDecoder::fullPacketsQueue() const
+std::shared_ptr<MPSCQueue<Packet* > > RawPacketDecoder::fullPacketsQueue() const
 {
     return m_fullPackets;
 }
 
-void RawPacketDecoder::_asyncWorkerProc()
+int RawPacketDecoder::workerCount() const
 {
+    return static_cast<int>(_asyncWorkerThreads.size());
+}
+
+void RawPacketDecoder::_asyncWorkerProc(std::shared_ptr<ThreadedQueue_RawData> incomingPackets)
+{
+    std::vector<std::pair<std::shared_ptr<PGENETLL_Session>, std::string> > nextPacketParts;
     while(true){
-        std::pair<std::shared_ptr<PGENETLL_Session>, std::string> nextPacketPart = m_incomingPackets->pop();
-        if(m_incomingPackets->shouldExit())
+        nextPacketParts.clear();
+        if(incomingPackets->popMany(nextPacketParts, DecodeBatchSize) == 0)
             return;
 
-        // Load the json content
-        QJsonParseError possibleError;
-
-        QJsonDocument data = QJsonDocument::fromJson(QByteArray(nextPacketPart.second.c_str(), nextPacketPart.second.size()), &possibleError);
-        if(possibleError.error != QJsonParseError::NoError){
-            gThreadedLogger->logWarning("Failed to parse JSON packet: " + possibleError.errorString());
-            continue;
-        }
-
-        QJsonValue headerValue = data.object().value("header");
-        if(headerValue.type() != QJsonValue::Object){
-            gThreadedLogger->logWarning("JSON Error: header doesn't exist or has wrong type! The header value is type-id: " + (int)headerValue.type());
-            continue;
-        }
-        QJsonObject headerObject = headerValue.toObject();
-
-        QJsonValue packetValue = data.object().value("packet");
-        if(packetValue .type() != QJsonValue::Object){
-            gThreadedLogger->logWarning("JSON Error: packet doesn't exist or has wrong type! The header value is type-id: " + (int)packetValue.type());
-            continue;
-        }
-        QJsonObject packetObject = packetValue.toObject();
+        for(std::pair<std::shared_ptr<PGENETLL_Session>, std::string>& nextPacketPart : nextPacketParts){
+            QString username;
+            PacketWireFormat format;
+            Packet* newPacket = PGENET_PacketCodec::decodePacket(m_packetRegister, nextPacketPart.second, username, format);
+            if(newPacket == nullptr)
+                continue;
 
-        // QDataStream packetStream(QByteArray(nextPacketPart.second.c_str(), nextPacketPart.second.size()));
+            // The client speaks the format of its auth packet, answers must be sent in it too
+            if(newPacket->getPacketID() == static_cast<int>(PacketID::PGENET_PacketUserAuth))
+                nextPacketPart.first->setWireFormat(format);
 
-        int packetID;
-        QString username;
-        int sessionID;
+            newPacket->setUser(m_userManager->getUserByName(username));
 
-        if(!headerObject.contains("packetID")){
-            gThreadedLogger->logWarning("JSON Error: header does not have key \"packetID\"");
-            continue;
+            if(username.isEmpty()){
+                m_fullPacketsUnindentified->push(make_pair(nextPacketPart.first, newPacket));
+            }else{
+                m_fullPackets->push(newPacket);
+            }
         }
-        if(!headerObject.value("packetID").isDouble()){
-            gThreadedLogger->logWarning("JSON Error: header does not have key \"packetID\" with value double. Instead the type is: " + (int)headerObject.value("packetID").type());
-            continue;
-        }
-
-
-        if(!headerObject.contains("username")){
-            gThreadedLogger->logWarning("JSON Error: header does not have key \"username\"");
-            continue;
-        }
-        if(!headerObject.value("username").isString()){
-            gThreadedLogger->logWarning("JSON Error: header does not have key \"username\" with value string. Instead the type is: " + (int)headerObject.value("username").type());
-            continue;
-        }
-
-
-        if(!headerObject.contains("sessionID")){
-            gThreadedLogger->logWarning("JSON Error: header does not have key \"sessionID\"");
-            continue;
-        }
-        if(!headerObject.value("sessionID").isDouble()){
-            gThreadedLogger->logWarning("JSON Error: header does not have key \"sessionID\" with value double. Instead the type is: " + (int)headerObject.value("sessionID").type());
-            continue;
-        }
-
-        packetID = (int)headerObject.value("packetID").toDouble();
-        username = headerObject.value("username").toString();
-        sessionID = (int)headerObject.value("sessionID").toDouble();
-
-        std::cout << "Incoming Packet (with valid header): " << std::endl;
-        std::cout << "packetID: " << packetID << std::endl;
-        std::cout << "username: " << username.toStdString().c_str() << std::endl;
-        std::cout << "sessionID: " << sessionID << std::endl;
-        std::cout << std::endl;
-
-
-        Packet* newPacket = m_packetRegister->createPacketById(static_cast<PacketID>(packetID));
-        if(newPacket == nullptr){
-            std::cout << "Invalid Packet!" << std::endl;
-            continue;
-        }
-        newPacket->setUser(m_userManager->getUserByName(username));
-        newPacket->setSessionID(sessionID);
-        newPacket->decode(packetObject);
-
-        if(username.isEmpty()){
-            m_fullPacketsUnindentified->push(make_pair(nextPacketPart.first, newPacket));
-        }else{
-            m_fullPackets->push(newPacket);
-        }
-
     }
 }
 std::shared_ptr<ThreadedQueue_UnindentifedPackets> RawPacketDecoder::fullPacketsUnindentified() const
@@ -6,7 +6,7 @@
 #include <atomic>
 #include <condition_variable>
 
-#include <ConnectionLib/Shared/util/ThreadedQueue.h>
+#include <ConnectionLib/Shared/util/MPSCQueue.h>
 #include <ConnectionLib/Shared/packetV2/packets/packet.h>
 #include <ConnectionLib/Shared/pgenet_packetmanager.h>
 #include <ConnectionLib/Server/user/pgenet_usermanager.h>
@@ -14,35 +14,53 @@
 #include <ConnectionLib/Server/low-level/pgenetll_session.h>
 
 #include <utility>
+#include <vector>
+#include <thread>
 
 #include <asio.hpp>
 
 
 
-using ThreadedQueue_UnindentifedPackets = ThreadedQueue<std::pair<std::shared_ptr<PGENETLL_Session>, Packet*> >;
+using ThreadedQueue_UnindentifedPackets = MPSCQueue<std::pair<std::shared_ptr<PGENETLL_Session>, Packet*> >;
 
+///
+/// \brief Decodes raw packets by a pool of worker threads.
+///
+/// Every connection is bound to one of workers when it's accepted, so packets
+/// of the same connection are decoded in the order they were received.
+/// Queues are bounded: when decoders are falling behind, the io threads are
+/// waiting for the free space instead of the memory growing without a limit.
+///
 class RawPacketDecoder
 {
 public:
-    RawPacketDecoder(PGENET_DefPacketRegister* packetRegister, PGENET_UserManager* userManager);
+    ///
+    /// \param workerCount Count of decoding threads. When 0, count of CPU cores is used.
+    ///
+    RawPacketDecoder(PGENET_DefPacketRegister* packetRegister, PGENET_UserManager* userManager, int workerCount = 0);
     ~RawPacketDecoder();
 
 
-    std::shared_ptr<ThreadedQueue_RawData> incomingPacketsQueue() const;
-    std::shared_ptr<ThreadedQueue<Packet* > > fullPacketsQueue() const;
+    const std::vector<std::shared_ptr<ThreadedQueue_RawData> >& incomingPacketsQueues() const;
+    std::shared_ptr<MPSCQueue<Packet* > > fullPacketsQueue() const;
     std::shared_ptr<ThreadedQueue_UnindentifedPackets> fullPacketsUnindentified() const;
 
+    int workerCount() const;
+
 private:
     // ASYNC STUFF
 
-    std::thread _asyncWorkerThread;
-    void _asyncWorkerProc();
+    /// Maximal count of raw packets taken from the queue at once
+    static const size_t DecodeBatchSize = 64;
+
+    std::vector<std::thread> _asyncWorkerThreads;
+    void _asyncWorkerProc(std::shared_ptr<ThreadedQueue_RawData> incomingPackets);
 
-    // Input:
-    std::shared_ptr<ThreadedQueue_RawData> m_incomingPackets;
+    // Input, one queue per worker:
+    std::vector<std::shared_ptr<ThreadedQueue_RawData> > m_incomingPackets;
 
     // Output:
-    std::shared_ptr<ThreadedQueue<Packet* > > m_fullPackets;
+    std::shared_ptr<MPSCQueue<Packet* > > m_fullPackets;
     std::shared_ptr<ThreadedQueue_UnindentifedPackets> m_fullPacketsUnindentified;
 
     PGENET_DefPacketRegister* m_packetRegister;
@@ -0,0 +1,7 @@
+#include "packetcursor.h"
+
+PacketCursor::PacketCursor(int x, int y, QObject *parent) : Packet(parent), m_x(x), m_y(y)
+{}
+
+PacketCursor::PacketCursor(QObject *parent) : Packet(parent), m_x(0), m_y(0)
+{}
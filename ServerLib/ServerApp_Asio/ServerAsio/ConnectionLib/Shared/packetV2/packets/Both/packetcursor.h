@@ -0,0 +1,46 @@
+#ifndef PACKETCURSOR_H
+#define PACKETCURSOR_H
+
+#include "../packet.h"
+
+class PacketCursor : public Packet
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(PacketCursor)
+
+    Q_PROPERTY(int x READ x WRITE setX)
+    Q_PROPERTY(int y READ y WRITE setY)
+public:
+    PacketCursor(int x, int y, QObject* parent = 0);
+    Q_INVOKABLE PacketCursor(QObject *parent = 0);
+
+    // Packet interface
+public:
+
+    int x() const
+    {
+        return m_x;
+    }
+
+    int y() const
+    {
+        return m_y;
+    }
+
+public slots:
+    void setX(int x)
+    {
+        m_x = x;
+    }
+
+    void setY(int y)
+    {
+        m_y = y;
+    }
+
+private:
+    int m_x;
+    int m_y;
+};
+
+#endif // PACKETCURSOR_H
@@ -6,8 +6,13 @@
 
 #include <QObject>
 #include <QJsonDocument>
+#include <QMetaProperty>
+#include <QtEndian>
+
+#include <string>
 
 #include "../../util/threadedlogger.h"
+#include "../../util/varint.h"
 
 class Packet : public QObject
 {
@@ -54,6 +59,147 @@ public:
     }
 
 
+    ///
+    /// \brief encode Write properties into compact binary form.
+    ///        Properties are written in the declaration order without names, both sides must use the same packet classes.
+    /// \param data Output buffer, data is appended to it.
+    /// \return True, if all properties have supported types.
+    ///
+    bool encode(std::string& data)
+    {
+        const QMetaObject* obj = metaObject();
+
+        for(int i = 0; i < obj->propertyCount(); ++i){
+            QMetaProperty nextProperty = obj->property(i);
+            if(qstrcmp(nextProperty.name(), "objectName") == 0) continue;
+            QVariant value = nextProperty.read(this);
+            switch(nextProperty.userType()){
+            case QMetaType::Bool:
+                data.push_back(value.toBool() ? 1 : 0);
+                break;
+            case QMetaType::Int:
+            case QMetaType::Long:
+            case QMetaType::LongLong:
+                VarInt::writeSigned(data, value.toLongLong());
+                break;
+            case QMetaType::UInt:
+            case QMetaType::ULong:
+            case QMetaType::ULongLong:
+                VarInt::write(data, value.toULongLong());
+                break;
+            case QMetaType::Double:
+            {
+                double d = value.toDouble();
+                quint64 raw;
+                memcpy(&raw, &d, sizeof(raw));
+                raw = qToLittleEndian(raw);
+                data.append(reinterpret_cast<const char*>(&raw), sizeof(raw));
+                break;
+            }
+            case QMetaType::QString:
+            {
+                QByteArray utf8 = value.toString().toUtf8();
+                VarInt::writeBytes(data, utf8.constData(), static_cast<size_t>(utf8.size()));
+                break;
+            }
+            case QMetaType::QByteArray:
+            {
+                QByteArray bytes = value.toByteArray();
+                VarInt::writeBytes(data, bytes.constData(), static_cast<size_t>(bytes.size()));
+                break;
+            }
+            default:
+                gThreadedLogger->logError(QString(nextProperty.name()) + " property for class " + obj->className() + " has type which can't be sent in binary packet!");
+                return false;
+            }
+        }
+        return true;
+    }
+
+    ///
+    /// \brief decode Read properties written by encode(std::string&).
+    /// \param it Position in the input buffer, moved to the end of packet data.
+    /// \param end End of the input buffer.
+    /// \return True, if all properties were read.
+    ///
+    bool decode(const char*& it, const char* end)
+    {
+        const QMetaObject* obj = metaObject();
+
+        for(int i = 0; i < obj->propertyCount(); ++i){
+            QMetaProperty nextProperty = obj->property(i);
+            if(qstrcmp(nextProperty.name(), "objectName") == 0) continue;
+            QVariant value;
+            bool ok = true;
+            switch(nextProperty.userType()){
+            case QMetaType::Bool:
+                ok = (it < end);
+                if(ok)
+                    value = QVariant(*it++ != 0);
+                break;
+            case QMetaType::Int:
+            case QMetaType::Long:
+            case QMetaType::LongLong:
+            {
+                int64_t v = 0;
+                ok = VarInt::readSigned(it, end, v);
+                value = QVariant(static_cast<qlonglong>(v));
+                break;
+            }
+            case QMetaType::UInt:
+            case QMetaType::ULong:
+            case QMetaType::ULongLong:
+            {
+                uint64_t v = 0;
+                ok = VarInt::read(it, end, v);
+                value = QVariant(static_cast<qulonglong>(v));
+                break;
+            }
+            case QMetaType::Double:
+            {
+                quint64 raw;
+                ok = (static_cast<size_t>(end - it) >= sizeof(raw));
+                if(!ok)
+                    break;
+                memcpy(&raw, it, sizeof(raw));
+                it += sizeof(raw);
+                raw = qFromLittleEndian(raw);
+                double d;
+                memcpy(&d, &raw, sizeof(d));
+                value = QVariant(d);
+                break;
+            }
+            case QMetaType::QString:
+            case QMetaType::QByteArray:
+            {
+                const char* bytes = nullptr;
+                size_t size = 0;
+                ok = VarInt::readBytes(it, end, bytes, size);
+                if(!ok)
+                    break;
+                if(nextProperty.userType() == QMetaType::QString)
+                    value = QVariant(QString::fromUtf8(bytes, static_cast<int>(size)));
+                else
+                    value = QVariant(QByteArray(bytes, static_cast<int>(size)));
+                break;
+            }
+            default:
+                gThreadedLogger->logError(QString(nextProperty.name()) + " property for class " + obj->className() + " has type which can't be read from binary packet!");
+                return false;
+            }
+            if(!ok){
+                gThreadedLogger->logError(QString(nextProperty.name()) + " property for class " + obj->className() + " is truncated in binary packet!");
+                return false;
+            }
+            if(!nextProperty.write(this, value)){
+                gThreadedLogger->logError(QString("Failed to write ") + QString(nextProperty.name()) + " property for class " + obj->className() + "! Wrong type?");
+                return false;
+            }
+        }
+        return true;
+    }
+
+
     PGENET_User *getUser() const
     {
         return user;
@@ -0,0 +1,146 @@
+#include "pgenet_packetcodec.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cstring>
+#include <memory>
+
+const char PGENET_PacketCodec::BinaryMarker;
+
+PacketWireFormat PGENET_PacketCodec::detectFormat(const std::string &raw)
+{
+    if(!raw.empty() && raw[0] == BinaryMarker)
+        return PacketWireFormat::PGENET_WireBinary;
+    return PacketWireFormat::PGENET_WireJSON;
+}
+
+bool PGENET_PacketCodec::encodePacket(Packet *packet, const QString &username, PacketWireFormat format, std::string &out)
+{
+    size_t prefixPos = out.size();
+    out.append(sizeof(int), '\0');
+
+    if(format == PacketWireFormat::PGENET_WireBinary){
+        out.push_back(BinaryMarker);
+        VarInt::write(out, static_cast<uint64_t>(packet->getPacketID()));
+        VarInt::writeSigned(out, packet->getSessionID());
+        QByteArray utf8 = username.toUtf8();
+        VarInt::writeBytes(out, utf8.constData(), static_cast<size_t>(utf8.size()));
+        if(!packet->encode(out)){
+            out.resize(prefixPos);
+            return false;
+        }
+    }else{
+        QJsonObject headerObject;
+        headerObject["packetID"] = packet->getPacketID();
+        headerObject["username"] = username;
+        headerObject["sessionID"] = packet->getSessionID();
+
+        QJsonObject packetObject;
+        packet->encode(packetObject);
+
+        QJsonObject root;
+        root["header"] = headerObject;
+        root["packet"] = packetObject;
+        QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Compact);
+        out.append(json.constData(), static_cast<size_t>(json.size()));
+    }
+
+    // Same as the session reads it
+    int size = static_cast<int>(out.size() - prefixPos - sizeof(int));
+    memcpy(&out[prefixPos], &size, sizeof(int));
+    return true;
+}
+
+Packet *PGENET_PacketCodec::decodePacket(PGENET_DefPacketRegister *packetRegister, const std::string &raw, QString &username, PacketWireFormat &format)
+{
+    format = detectFormat(raw);
+    if(format == PacketWireFormat::PGENET_WireBinary)
+        return decodeBinary(packetRegister, raw, username);
+    return decodeJSON(packetRegister, raw, username);
+}
+
+Packet *PGENET_PacketCodec::decodeJSON(PGENET_DefPacketRegister *packetRegister, const std::string &raw, QString &username)
+{
+    // Load the json content
+    QJsonParseError possibleError;
+
+    QJsonDocument data = QJsonDocument::fromJson(QByteArray(raw.c_str(), static_cast<int>(raw.size())), &possibleError);
+    if(possibleError.error != QJsonParseError::NoError){
+        gThreadedLogger->logWarning("Failed to parse JSON packet: " + possibleError.errorString());
+        return nullptr;
+    }
+
+    QJsonValue headerValue = data.object().value("header");
+    if(headerValue.type() != QJsonValue::Object){
+        gThreadedLogger->logWarning("JSON Error: header doesn't exist or has wrong type! The header value is type-id: " + QString::number((int)headerValue.type()));
+        return nullptr;
+    }
+    QJsonObject headerObject = headerValue.toObject();
+
+    QJsonValue packetValue = data.object().value("packet");
+    if(packetValue.type() != QJsonValue::Object){
+        gThreadedLogger->logWarning("JSON Error: packet doesn't exist or has wrong type! The header value is type-id: " + QString::number((int)packetValue.type()));
+        return nullptr;
+    }
+    QJsonObject packetObject = packetValue.toObject();
+
+    if(!headerObject.value("packetID").isDouble()){
+        gThreadedLogger->logWarning("JSON Error: header does not have key \"packetID\" with value double. Instead the type is: " + QString::number((int)headerObject.value("packetID").type()));
+        return nullptr;
+    }
+    if(!headerObject.value("username").isString()){
+        gThreadedLogger->logWarning("JSON Error: header does not have key \"username\" with value string. Instead the type is: " + QString::number((int)headerObject.value("username").type()));
+        return nullptr;
+    }
+    if(!headerObject.value("sessionID").isDouble()){
+        gThreadedLogger->logWarning("JSON Error: header does not have key \"sessionID\" with value double. Instead the type is: " + QString::number((int)headerObject.value("sessionID").type()));
+        return nullptr;
+    }
+
+    int packetID = (int)headerObject.value("packetID").toDouble();
+    username = headerObject.value("username").toString();
+    int sessionID = (int)headerObject.value("sessionID").toDouble();
+
+    std::unique_ptr<Packet> newPacket(packetRegister->createPacketById(static_cast<PacketID>(packetID)));
+    if(!newPacket){
+        gThreadedLogger->logWarning("Invalid Packet ID: " + QString::number(packetID));
+        return nullptr;
+    }
+    newPacket->setSessionID(sessionID);
+    if(!newPacket->decode(packetObject))
+        return nullptr;
+
+    return newPacket.release();
+}
+
+Packet *PGENET_PacketCodec::decodeBinary(PGENET_DefPacketRegister *packetRegister, const std::string &raw, QString &username)
+{
+    const char* it = raw.data() + 1; // Skip marker
+    const char* end = raw.data() + raw.size();
+
+    uint64_t packetID;
+    int64_t sessionID;
+    const char* name;
+    size_t nameSize;
+    if(!VarInt::read(it, end, packetID) ||
+       !VarInt::readSigned(it, end, sessionID) ||
+       !VarInt::readBytes(it, end, name, nameSize)){
+        gThreadedLogger->logWarning("Binary Error: packet header is truncated!");
+        return nullptr;
+    }
+    username = QString::fromUtf8(name, static_cast<int>(nameSize));
+
+    std::unique_ptr<Packet> newPacket(packetRegister->createPacketById(static_cast<PacketID>(packetID)));
+    if(!newPacket){
+        gThreadedLogger->logWarning("Invalid Packet ID: " + QString::number(packetID));
+        return nullptr;
+    }
+    newPacket->setSessionID(static_cast<int>(sessionID));
+    if(!newPacket->decode(it, end))
+        return nullptr;
+
+    if(it != end)
+        gThreadedLogger->logWarning("Binary Error: " + QString::number(end - it) + " unknown bytes at end of packet " + QString::number(packetID));
+
+    return newPacket.release();
+}
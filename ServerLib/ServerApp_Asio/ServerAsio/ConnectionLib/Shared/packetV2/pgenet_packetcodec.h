@@ -0,0 +1,59 @@
+#ifndef PGENET_PACKETCODEC_H
+#define PGENET_PACKETCODEC_H
+
+#include <string>
+#include <QString>
+
+#include "packets/packet.h"
+#include "../pgenet_global.h"
+#include "../pgenet_packetmanager.h"
+
+///
+/// \brief Converts packets from and to the wire formats.
+///
+/// Binary packet data (the part after the length prefix) looks as followed:
+///   byte        BinaryMarker
+///   varint      PGE-Packet ID
+///   varint      Session ID (zigzag-encoded)
+///   varint+utf8 Username
+///   ...         Properties of the packet in declaration order, see Packet::encode(std::string&)
+///
+/// JSON packets are always starting with '{', so the format is detected by the first byte.
+///
+class PGENET_PacketCodec
+{
+public:
+    static const char BinaryMarker = static_cast<char>(0xB1);
+
+    ///
+    /// \brief detectFormat Detect format of the packet data.
+    /// \param raw Packet data without length prefix.
+    ///
+    static PacketWireFormat detectFormat(const std::string& raw);
+
+    ///
+    /// \brief encodePacket Encode the packet with length prefix.
+    /// \param packet The packet to encode.
+    /// \param username Name of the user to put into header.
+    /// \param format Wire format.
+    /// \param out Output buffer, data is appended to it.
+    /// \return True, if packet was encoded.
+    ///
+    static bool encodePacket(Packet* packet, const QString& username, PacketWireFormat format, std::string& out);
+
+    ///
+    /// \brief decodePacket Decode packet data of any format.
+    /// \param packetRegister Register to create the packet.
+    /// \param raw Packet data without length prefix.
+    /// \param username [out] Name of the user from the header.
+    /// \param format [out] Detected wire format.
+    /// \return New packet, or nullptr if data is invalid.
+    ///
+    static Packet* decodePacket(PGENET_DefPacketRegister* packetRegister, const std::string& raw, QString& username, PacketWireFormat& format);
+
+private:
+    static Packet* decodeJSON(PGENET_DefPacketRegister* packetRegister, const std::string& raw, QString& username);
+    static Packet* decodeBinary(PGENET_DefPacketRegister* packetRegister, const std::string& raw, QString& username);
+};
+
+#endif // PGENET_PACKETCODEC_H
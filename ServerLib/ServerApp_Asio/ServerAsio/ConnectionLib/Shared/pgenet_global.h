@@ -15,7 +15,16 @@ public:
 enum class PacketID : int {
     PGENET_UNDEFINED,
     PGENET_PacketUserAuth,
-    PGENET_PacketMessage
+    PGENET_PacketMessage,
+    PGENET_PacketCursor
+};
+
+///
+/// \brief Encoding of packets on the wire. Client selects it by the encoding of its auth packet
+///
+enum class PacketWireFormat : int {
+    PGENET_WireJSON,
+    PGENET_WireBinary
 };
 
 #endif // PGENET_GLOBAL_H
@@ -3,6 +3,7 @@
 #include "packetV2/packets/ClientToServer/packetuserauth.h"
 
 #include "packetV2/packets/Both/packetmessage.h"
+#include "packetV2/packets/Both/packetcursor.h"
 
 PGENET_PacketManager::PGENET_PacketManager()
 {
@@ -19,6 +20,7 @@ void PGENET_PacketManager::registerAllPackets()
 {
     m_packetRegister.registerPacket<PacketUserAuth>(PacketID::PGENET_PacketUserAuth);
     m_packetRegister.registerPacket<PacketMessage>(PacketID::PGENET_PacketMessage);
+    m_packetRegister.registerPacket<PacketCursor>(PacketID::PGENET_PacketCursor);
 }
 
 
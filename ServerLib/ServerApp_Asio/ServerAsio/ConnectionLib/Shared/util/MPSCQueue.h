@@ -0,0 +1,251 @@
+#ifndef MPSCQueue__hhhh
+#define MPSCQueue__hhhh
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstddef>
+#include <cstdint>
+
+///
+/// \brief Bounded lock-free queue for many producers and a single consumer.
+///
+/// Items are kept in a ring of cells, each cell has a sequence number which tells
+/// whether it's free for the producer or ready for the consumer, so push and pop
+/// are taking no locks. The mutex is used only to sleep: the consumer sleeps when
+/// the queue is empty, producers are sleeping when it's full (back-pressure).
+/// Sleepers are woken only when someone is actually waiting.
+///
+template <class T>
+class MPSCQueue {
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    static const int SpinCount = 64;
+
+    std::unique_ptr<Cell[]> mBuffer;
+    size_t mMask;
+
+    // Producers and consumer positions are kept on different cache lines
+    char mPad0[64];
+    std::atomic<size_t> mEnqueuePos;
+    char mPad1[64 - sizeof(std::atomic<size_t>)];
+    // Touched by the consumer only
+    size_t mDequeuePos;
+    char mPad2[64 - sizeof(size_t)];
+
+    std::mutex mWaitMutex;
+    std::condition_variable mNotEmpty;
+    std::condition_variable mNotFull;
+    std::atomic_bool mConsumerWaiting;
+    std::atomic_int  mProducersWaiting;
+    std::atomic_bool mDoExit;
+
+    static size_t roundCapacity(size_t capacity)
+    {
+        size_t size = 2;
+        while(size < capacity)
+            size <<= 1;
+        return size;
+    }
+
+    void wakeConsumer()
+    {
+        // Pairs with the fence in waitNotEmpty(): either consumer sees the item, or we see it waiting
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(mConsumerWaiting.load(std::memory_order_relaxed)){
+            std::unique_lock<std::mutex> lck(mWaitMutex);
+            mNotEmpty.notify_one();
+        }
+    }
+
+    void wakeProducers()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(mProducersWaiting.load(std::memory_order_relaxed) > 0){
+            std::unique_lock<std::mutex> lck(mWaitMutex);
+            mNotFull.notify_all();
+        }
+    }
+
+    bool isReadable()
+    {
+        Cell& cell = mBuffer[mDequeuePos & mMask];
+        return cell.sequence.load(std::memory_order_acquire) == mDequeuePos + 1;
+    }
+
+    bool isWritable()
+    {
+        size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+        Cell& cell = mBuffer[pos & mMask];
+        return static_cast<intptr_t>(cell.sequence.load(std::memory_order_acquire)) - static_cast<intptr_t>(pos) >= 0;
+    }
+
+    ///
+    /// \return false if exit was requested
+    ///
+    bool waitNotEmpty()
+    {
+        for(int i = 0; i < SpinCount; i++){
+            if(isReadable())
+                return !mDoExit.load();
+            std::this_thread::yield();
+        }
+
+        std::unique_lock<std::mutex> lck(mWaitMutex);
+        mConsumerWaiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while(!isReadable() && !mDoExit.load())
+            mNotEmpty.wait(lck);
+        mConsumerWaiting.store(false, std::memory_order_relaxed);
+        return !mDoExit.load();
+    }
+
+    template<class U>
+    bool tryPushImpl(U&& value)
+    {
+        size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for(;;){
+            cell = &mBuffer[pos & mMask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if(diff == 0){
+                if(mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }else if(diff < 0){
+                return false; // Full
+            }else{
+                pos = mEnqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::forward<U>(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        wakeConsumer();
+        return true;
+    }
+
+    template<class U>
+    void pushImpl(U&& value)
+    {
+        for(int i = 0; ; i++){
+            if(tryPushImpl(std::forward<U>(value)))
+                return;
+            if(mDoExit.load())
+                return; // Consumer is gone, nobody will free the space
+            if(i < SpinCount){
+                std::this_thread::yield();
+                continue;
+            }
+            std::unique_lock<std::mutex> lck(mWaitMutex);
+            mProducersWaiting.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            while(!isWritable() && !mDoExit.load())
+                mNotFull.wait(lck);
+            mProducersWaiting.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    ///
+    /// \param capacity Maximal count of queued items, rounded up to the power of two.
+    ///
+    explicit MPSCQueue(size_t capacity = 4096) :
+        mBuffer(new Cell[roundCapacity(capacity)]),
+        mMask(roundCapacity(capacity) - 1),
+        mEnqueuePos(0),
+        mDequeuePos(0),
+        mConsumerWaiting(false),
+        mProducersWaiting(0),
+        mDoExit(false)
+    {
+        for(size_t i = 0; i <= mMask; i++)
+            mBuffer[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    inline void doExit(){
+        mDoExit.store(true);
+        std::unique_lock<std::mutex> lck(mWaitMutex);
+        mNotEmpty.notify_all();
+        mNotFull.notify_all();
+    }
+
+    inline bool shouldExit(){
+        return mDoExit.load();
+    }
+
+    ///
+    /// \brief Add item, waits while the queue is full. Any thread.
+    ///
+    inline void push(const T& value) {
+        pushImpl(value);
+    }
+
+    inline void push(T&& value) {
+        pushImpl(std::move(value));
+    }
+
+    ///
+    /// \brief Add item if there is a free space. Any thread.
+    /// \return false if the queue is full.
+    ///
+    inline bool tryPush(const T& value) {
+        return tryPushImpl(value);
+    }
+
+    ///
+    /// \brief Take item if available. Consumer thread only.
+    ///
+    inline bool tryPop(T& value) {
+        Cell& cell = mBuffer[mDequeuePos & mMask];
+        if(cell.sequence.load(std::memory_order_acquire) != mDequeuePos + 1)
+            return false;
+        value = std::move(cell.data);
+        cell.data = T(); // Don't hold resources of taken items
+        cell.sequence.store(mDequeuePos + mMask + 1, std::memory_order_release);
+        mDequeuePos++;
+        wakeProducers();
+        return true;
+    }
+
+    ///
+    /// \brief Wait for the next item. Consumer thread only.
+    /// \return Next item, or default value when exit was requested.
+    ///
+    inline T pop() {
+        T value;
+        if(!waitNotEmpty())
+            return T();
+        tryPop(value);
+        return value;
+    }
+
+    ///
+    /// \brief Wait for items and take all available ones. Consumer thread only.
+    /// \param out Items are appended to it.
+    /// \param max Maximal count of items to take.
+    /// \return Count of taken items, 0 when exit was requested.
+    ///
+    inline size_t popMany(std::vector<T>& out, size_t max) {
+        if(!waitNotEmpty())
+            return 0;
+        size_t count = 0;
+        T value;
+        while((count < max) && tryPop(value)){
+            out.push_back(std::move(value));
+            count++;
+        }
+        return count;
+    }
+};
+
+#endif
@@ -4,11 +4,13 @@ QScopedPointer<ThreadedLogger> gThreadedLogger;
 
 void ThreadedLogger::queuedMsgWorker()
 {
+    std::vector<QPair<LoggerLevel, QString>> nextMsgs;
     for(;;){
-        QPair<LoggerLevel, QString> nextMsg = queuedMsg.pop();
-        if(queuedMsg.shouldExit())
+        nextMsgs.clear();
+        if(queuedMsg.popMany(nextMsgs, 128) == 0)
             return;
-        emit newIncomingMsg(nextMsg.first, nextMsg.second);
+        for(const QPair<LoggerLevel, QString>& nextMsg : nextMsgs)
+            emit newIncomingMsg(nextMsg.first, nextMsg.second);
     }
 }
 
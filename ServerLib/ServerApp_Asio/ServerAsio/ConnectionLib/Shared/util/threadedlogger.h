@@ -2,7 +2,7 @@
 #define THREADEDLOGGER_H
 
 #include <QObject>
-#include "ThreadedQueue.h"
+#include "MPSCQueue.h"
 
 #include <QtConcurrent>
 #include <iostream>
@@ -41,7 +41,7 @@ public:
     }
 
 private:
-    ThreadedQueue<QPair<LoggerLevel, QString>> queuedMsg;
+    MPSCQueue<QPair<LoggerLevel, QString>> queuedMsg;
     QFuture<void> queuedMsgWorkerState;
     void queuedMsgWorker();
     void quitQueuedMsgWorker();
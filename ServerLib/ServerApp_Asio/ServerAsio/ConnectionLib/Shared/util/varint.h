@@ -0,0 +1,80 @@
+#ifndef VARINT_H
+#define VARINT_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+///
+/// \brief Helpers for variable-length integers (7 bits per byte, little-endian groups)
+///
+namespace VarInt
+{
+
+inline void write(std::string& out, uint64_t value)
+{
+    while(value >= 0x80){
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+inline bool read(const char*& it, const char* end, uint64_t& value)
+{
+    value = 0;
+    for(int shift = 0; (it < end) && (shift < 64); shift += 7){
+        uint8_t byte = static_cast<uint8_t>(*it++);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if(!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+///
+/// \brief Signed values are zigzag-encoded, so small negative numbers are short too
+///
+inline void writeSigned(std::string& out, int64_t value)
+{
+    write(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+inline bool readSigned(const char*& it, const char* end, int64_t& value)
+{
+    uint64_t raw;
+    if(!read(it, end, raw))
+        return false;
+    value = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+    return true;
+}
+
+///
+/// \brief Write length-prefixed bytes
+///
+inline void writeBytes(std::string& out, const char* data, size_t size)
+{
+    write(out, size);
+    out.append(data, size);
+}
+
+///
+/// \brief Read length-prefixed bytes
+/// \param data Pointer to the bytes inside of the input buffer
+///
+inline bool readBytes(const char*& it, const char* end, const char*& data, size_t& size)
+{
+    uint64_t len;
+    if(!read(it, end, len))
+        return false;
+    if(len > static_cast<uint64_t>(end - it))
+        return false;
+    data = it;
+    size = static_cast<size_t>(len);
+    it += size;
+    return true;
+}
+
+}
+
+#endif // VARINT_H
@@ -40,10 +40,12 @@ SOURCES += main.cpp\
     ../../../_Libs/asio/asio/impl/src.cpp \
     ConnectionLib/Shared/pgenet_global.cpp \
     ConnectionLib/Shared/pgenet_packetmanager.cpp \
+    ConnectionLib/Shared/packetV2/pgenet_packetcodec.cpp \
     ConnectionLib/Server/session/pgenet_session.cpp \
     ConnectionLib/Server/session/pgenet_globalsession.cpp \
     ConnectionLib/Shared/packetV2/packets/ClientToServer/packetuserauth.cpp \
     ConnectionLib/Shared/packetV2/packets/Both/packetmessage.cpp \
+    ConnectionLib/Shared/packetV2/packets/Both/packetcursor.cpp \
     ConnectionLib/Server/util/rawpacketdecoder.cpp \
     ConnectionLib/Server/user/pgenet_usermanager.cpp \
     ConnectionLib/Shared/util/threadedlogger.cpp \
@@ -404,14 +406,17 @@ HEADERS  += mainwindow.h \
     ../../../_Libs/asio/asio/yield.hpp \
     ../../../_Libs/asio/asio.hpp \
     ConnectionLib/Shared/pgenet_global.h \
-    ConnectionLib/Shared/util/ThreadedQueue.h \
+    ConnectionLib/Shared/util/MPSCQueue.h \
     ConnectionLib/Shared/pgenet_packetmanager.h \
     ConnectionLib/Shared/packetV2/packets/packet.h \
     ConnectionLib/Shared/packetV2/pgepacketregister.h \
+    ConnectionLib/Shared/packetV2/pgenet_packetcodec.h \
+    ConnectionLib/Shared/util/varint.h \
     ConnectionLib/Server/session/pgenet_session.h \
     ConnectionLib/Server/session/pgenet_globalsession.h \
     ConnectionLib/Shared/packetV2/packets/ClientToServer/packetuserauth.h \
     ConnectionLib/Shared/packetV2/packets/Both/packetmessage.h \
+    ConnectionLib/Shared/packetV2/packets/Both/packetcursor.h \
     ConnectionLib/Server/util/rawpacketdecoder.h \
     ConnectionLib/Server/user/pgenet_user.h \
     ConnectionLib/Server/user/pgenet_usermanager.h \
@@ -0,0 +1,22 @@
+CONFIG -= qt
+CONFIG += c++11
+
+INCLUDEPATH += $$PWD/../../_common/
+
+TARGET = BitMask_Benchmark
+CONFIG += console
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+DESTDIR = $$PWD/bin
+
+linux-g++||win32: {
+LIBS += -static-libgcc -static-libstdc++ -static -lpthread
+}
+
+HEADERS += $$PWD/../../_common/Utils/bitmask.h
+
+SOURCES += \
+    main.cpp \
+    $$PWD/../../_common/Utils/bitmask.cpp
@@ -0,0 +1,300 @@
+#include <stdint.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <random>
+
+#include <Utils/bitmask.h>
+
+class ElapsedTimer
+{
+public:
+    typedef std::chrono::nanoseconds TimeT;
+    ElapsedTimer() {}
+    void start()
+    {
+        recent = std::chrono::high_resolution_clock::now();
+    }
+    void restart()
+    {
+        recent = std::chrono::high_resolution_clock::now();
+    }
+    int64_t elapsed()
+    {
+        using std::chrono::nanoseconds;
+        using std::chrono::duration_cast;
+        return duration_cast<nanoseconds>(std::chrono::high_resolution_clock::now() - recent).count();
+    }
+    std::chrono::high_resolution_clock::time_point recent;
+};
+
+#define BENCHMARK(taskName, expression)\
+{\
+    ElapsedTimer clock;\
+    clock.start();\
+    {expression}\
+    int64_t done = clock.elapsed();\
+    printf("=== [%lli] nanoseconds == %s \n", static_cast<long long>(done), (taskName));\
+    fflush(stdout);\
+}
+
+/*
+ * Original per-pixel loops, the kernels must give exactly same results
+ */
+static void refMergeWithMask(uint8_t *FPixP, const uint8_t *SPixP, size_t pixels)
+{
+    for(size_t i = 0; i < pixels; i++)
+    {
+        uint8_t b = ((SPixP[0] & 0x7F) | FPixP[0]);
+        uint8_t g = ((SPixP[1] & 0x7F) | FPixP[1]);
+        uint8_t r = ((SPixP[2] & 0x7F) | FPixP[2]);
+        unsigned short newAlpha = 255 - ((static_cast<unsigned short>(SPixP[2]) +
+                                          static_cast<unsigned short>(SPixP[1]) +
+                                          static_cast<unsigned short>(SPixP[0])) / 3);
+        if((SPixP[2] > 240u) && (SPixP[1] > 240u) && (SPixP[0] > 240u))
+            newAlpha = 0;
+        newAlpha += ((static_cast<unsigned short>(FPixP[2]) +
+                      static_cast<unsigned short>(FPixP[1]) +
+                      static_cast<unsigned short>(FPixP[0])) / 3);
+        if(newAlpha > 255)
+            newAlpha = 255;
+        FPixP[0] = b;
+        FPixP[1] = g;
+        FPixP[2] = r;
+        FPixP[3] = static_cast<uint8_t>(newAlpha);
+        FPixP += 4;
+        SPixP += 4;
+    }
+}
+
+/*
+ * Original loop of the Editor's QImage path (GraphicsHelps::mergeToRGBA_BitWise),
+ * which ANDs the mask with qRgb(128, 128, 128) instead of 0x7F
+ */
+static void refMergeWithMaskQImage(uint8_t *FPixP, const uint8_t *SPixP, size_t pixels)
+{
+    const int Dpix = 128;
+    for(size_t i = 0; i < pixels; i++)
+    {
+        int red   = FPixP[2] | (Dpix & SPixP[2]);
+        int green = FPixP[1] | (Dpix & SPixP[1]);
+        int blue  = FPixP[0] | (Dpix & SPixP[0]);
+        int newAlpha = 255 - ((SPixP[2] + SPixP[1] + SPixP[0]) / 3);
+        if((SPixP[2] > 240) && (SPixP[1] > 240) && (SPixP[0] > 240))
+            newAlpha = 0;
+        newAlpha = newAlpha + ((FPixP[2] + FPixP[1] + FPixP[0]) / 3);
+        if(newAlpha > 255)
+            newAlpha = 255;
+        FPixP[0] = static_cast<uint8_t>(blue);
+        FPixP[1] = static_cast<uint8_t>(green);
+        FPixP[2] = static_cast<uint8_t>(red);
+        FPixP[3] = static_cast<uint8_t>(newAlpha);
+        FPixP += 4;
+        SPixP += 4;
+    }
+}
+
+static void refMaskFromAlpha(const uint8_t *image, uint8_t *mask, size_t pixels)
+{
+    for(size_t i = 0; i < pixels; i++, image += 4, mask += 4)
+    {
+        uint8_t grey = (255 - image[3]);
+        mask[0] = grey;
+        mask[1] = grey;
+        mask[2] = grey;
+        mask[3] = 0xFF;
+    }
+}
+
+static inline uint8_t subtractAlpha(const uint8_t channel, const uint8_t alpha)
+{
+    int16_t ch = static_cast<int16_t>(channel) - static_cast<int16_t>(alpha);
+    if(ch < 0)
+        ch = 0;
+    return static_cast<uint8_t>(ch);
+}
+
+static void refSplitToFrontAndMask(uint8_t *image, uint8_t *mask, size_t pixels)
+{
+    for(size_t i = 0; i < pixels; i++, image += 4, mask += 4)
+    {
+        uint8_t grey = (255 - image[3]);
+        mask[0] = grey;
+        mask[1] = grey;
+        mask[2] = grey;
+        mask[3] = 255;
+        image[0] = subtractAlpha(image[0], grey);
+        image[1] = subtractAlpha(image[1], grey);
+        image[2] = subtractAlpha(image[2], grey);
+        image[3] = 255;
+    }
+}
+
+static void fillRandom(std::vector<uint8_t> &data, std::mt19937 &rng)
+{
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> mode(0, 3);
+    for(size_t i = 0; i < data.size(); i += 4)
+    {
+        switch(mode(rng))
+        {
+        case 0: // Black
+            data[i] = data[i + 1] = data[i + 2] = 0;
+            break;
+        case 1: // Around of the "almost white" threshold
+            data[i] = static_cast<uint8_t>(236 + byte(rng) % 20);
+            data[i + 1] = static_cast<uint8_t>(236 + byte(rng) % 20);
+            data[i + 2] = static_cast<uint8_t>(236 + byte(rng) % 20);
+            break;
+        default:
+            data[i] = static_cast<uint8_t>(byte(rng));
+            data[i + 1] = static_cast<uint8_t>(byte(rng));
+            data[i + 2] = static_cast<uint8_t>(byte(rng));
+            break;
+        }
+        data[i + 3] = static_cast<uint8_t>(byte(rng));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t pixels = 1024 * 1024 + 7; // Odd size to also test tails
+    int rounds = 50;
+    if(argc > 1)
+        pixels = static_cast<size_t>(atoi(argv[1]));
+    if(argc > 2)
+        rounds = atoi(argv[2]);
+
+    printf("== Preparing %u pixels... ==\n", static_cast<unsigned>(pixels));
+    fflush(stdout);
+
+    std::mt19937 rng(12345);
+    std::vector<uint8_t> front(pixels * 4), mask(pixels * 4);
+    fillRandom(front, rng);
+    fillRandom(mask, rng);
+
+    std::vector<uint8_t> refMerge = front;
+    refMergeWithMask(refMerge.data(), mask.data(), pixels);
+    std::vector<uint8_t> refMergeQImage = front;
+    refMergeWithMaskQImage(refMergeQImage.data(), mask.data(), pixels);
+    std::vector<uint8_t> refMask(pixels * 4);
+    refMaskFromAlpha(front.data(), refMask.data(), pixels);
+    std::vector<uint8_t> refSplit = front, refSplitMask(pixels * 4);
+    refSplitToFrontAndMask(refSplit.data(), refSplitMask.data(), pixels);
+
+    std::vector<uint8_t> work(pixels * 4), out(pixels * 4);
+    int failed = 0;
+
+    const BitMask::Kernel kernels[] = {BitMask::KERNEL_SCALAR, BitMask::KERNEL_SSE2, BitMask::KERNEL_AVX2};
+    for(BitMask::Kernel k : kernels)
+    {
+        BitMask::Kernel got = BitMask::setKernel(k);
+        if(got != k)
+        {
+            printf("== %s kernel is not supported, skipping ==\n", BitMask::kernelName(k));
+            continue;
+        }
+
+        printf("== Testing %s kernel ==\n", BitMask::kernelName(k));
+
+        // Check every length up to 64 to cover all tails
+        for(size_t len = 0; len <= 64 && len <= pixels; len++)
+        {
+            work = front;
+            BitMask::mergeWithMask(work.data(), mask.data(), len);
+            if(memcmp(work.data(), refMerge.data(), len * 4) != 0 ||
+               memcmp(work.data() + len * 4, front.data() + len * 4, (pixels - len) * 4) != 0)
+            {
+                printf("!!! mergeWithMask mismatch with %u pixels\n", static_cast<unsigned>(len));
+                failed++;
+                break;
+            }
+        }
+
+        work = front;
+        BitMask::mergeWithMask(work.data(), mask.data(), pixels);
+        if(work != refMerge)
+        {
+            printf("!!! mergeWithMask mismatch\n");
+            failed++;
+        }
+
+        // Every length up to 64 again with the bits of the Editor's QImage path
+        for(size_t len = 0; len <= 64 && len <= pixels; len++)
+        {
+            work = front;
+            BitMask::mergeWithMask(work.data(), mask.data(), len, 0x80);
+            if(memcmp(work.data(), refMergeQImage.data(), len * 4) != 0 ||
+               memcmp(work.data() + len * 4, front.data() + len * 4, (pixels - len) * 4) != 0)
+            {
+                printf("!!! mergeWithMask (0x80) mismatch with %u pixels\n", static_cast<unsigned>(len));
+                failed++;
+                break;
+            }
+        }
+
+        work = front;
+        BitMask::mergeWithMask(work.data(), mask.data(), pixels, 0x80);
+        if(work != refMergeQImage)
+        {
+            printf("!!! mergeWithMask (0x80) mismatch\n");
+            failed++;
+        }
+
+        BitMask::maskFromAlpha(front.data(), out.data(), pixels);
+        if(out != refMask)
+        {
+            printf("!!! maskFromAlpha mismatch\n");
+            failed++;
+        }
+
+        work = front;
+        BitMask::splitToFrontAndMask(work.data(), out.data(), pixels);
+        if(work != refSplit || out != refSplitMask)
+        {
+            printf("!!! splitToFrontAndMask mismatch\n");
+            failed++;
+        }
+
+        BENCHMARK("mergeWithMask",
+            for(int i = 0; i < rounds; i++)
+            {
+                memcpy(work.data(), front.data(), work.size());
+                BitMask::mergeWithMask(work.data(), mask.data(), pixels);
+            }
+        );
+
+        BENCHMARK("maskFromAlpha",
+            for(int i = 0; i < rounds; i++)
+                BitMask::maskFromAlpha(front.data(), out.data(), pixels);
+        );
+
+        BENCHMARK("splitToFrontAndMask",
+            for(int i = 0; i < rounds; i++)
+            {
+                memcpy(work.data(), front.data(), work.size());
+                BitMask::splitToFrontAndMask(work.data(), out.data(), pixels);
+            }
+        );
+    }
+
+    printf("== Original per-pixel loop ==\n");
+    BENCHMARK("mergeWithMask",
+        for(int i = 0; i < rounds; i++)
+        {
+            memcpy(work.data(), front.data(), work.size());
+            refMergeWithMask(work.data(), mask.data(), pixels);
+        }
+    );
+
+    if(failed)
+    {
+        printf("== FAILED: %d mismatches ==\n", failed);
+        return 1;
+    }
+
+    printf("== All kernels are giving identical results ==\n");
+    return 0;
+}
@@ -0,0 +1,21 @@
+CONFIG -= qt
+CONFIG += c++11
+
+INCLUDEPATH += $$PWD/../../Engine/common_features/gif-h/
+
+TARGET = GifPalette_Test
+CONFIG += console
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+DESTDIR = $$PWD/bin
+
+linux-g++||win32: {
+LIBS += -static-libgcc -static-libstdc++ -static -lpthread
+}
+
+HEADERS += $$PWD/../../Engine/common_features/gif-h/gif.h
+
+SOURCES += \
+    main.cpp
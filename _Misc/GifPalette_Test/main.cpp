@@ -0,0 +1,132 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include <gif.h>
+
+/*
+ * Writes sequences of frames and checks that every pixel shown after each frame
+ * (the quantized frame kept by the writer for delta-coding) stays close to the source.
+ * Every frame has less than 256 colors, so a right palette always represents them well.
+ */
+
+static const uint32_t W = 256;
+static const uint32_t H = 256;
+
+static void fillRect(std::vector<uint8_t> &img, uint32_t x, uint32_t y, uint32_t w, uint32_t h,
+                     uint8_t r, uint8_t g, uint8_t b)
+{
+    for(uint32_t yy = y; yy < y + h && yy < H; yy++)
+    {
+        for(uint32_t xx = x; xx < x + w && xx < W; xx++)
+        {
+            uint8_t *p = img.data() + (yy * W + xx) * 4;
+            p[0] = r;
+            p[1] = g;
+            p[2] = b;
+            p[3] = 255;
+        }
+    }
+}
+
+static void fillGreys(std::vector<uint8_t> &img)
+{
+    fillRect(img, 0,     0,     W / 2, H / 2, 32, 32, 32);
+    fillRect(img, W / 2, 0,     W / 2, H / 2, 96, 96, 96);
+    fillRect(img, 0,     H / 2, W / 2, H / 2, 160, 160, 160);
+    fillRect(img, W / 2, H / 2, W / 2, H / 2, 224, 224, 224);
+}
+
+static void fillStripes(std::vector<uint8_t> &img)
+{
+    for(uint32_t x = 0; x < W; x += 8)
+        fillRect(img, x, 0, 8, H, static_cast<uint8_t>(x), static_cast<uint8_t>(255 - x), 64);
+}
+
+static int g_failed = 0;
+
+static void writeAndCheck(GifWriter &writer, const std::vector<uint8_t> &img, const char *what, int frame)
+{
+    GifWriteFrame(&writer, img.data(), W, H, 2);
+
+    int maxErr = 0;
+    for(size_t i = 0; i < W * H * 4; i += 4)
+    {
+        int err = abs(writer.oldImage[i] - img[i]) +
+                  abs(writer.oldImage[i + 1] - img[i + 1]) +
+                  abs(writer.oldImage[i + 2] - img[i + 2]);
+        if(err > maxErr)
+            maxErr = err;
+    }
+
+    if(maxErr > kGifPaletteReuseMaxError)
+    {
+        printf("!!! %s, frame %d: color error is %d\n", what, frame, maxErr);
+        g_failed++;
+    }
+}
+
+int main()
+{
+    std::vector<uint8_t> img(W * H * 4);
+    FILE *f = tmpfile();
+    if(!f)
+    {
+        printf("!!! Can't create temporary file\n");
+        return 1;
+    }
+
+    GifWriter writer;
+    GifBegin(&writer, f, W, H, 2);
+
+    printf("== Green square over four greys ==\n");
+    fflush(stdout);
+    fillGreys(img);
+    writeAndCheck(writer, img, "Four greys", 0);
+    fillRect(img, 100, 100, 8, 8, 0, 255, 0);
+    for(int i = 1; i <= 31; i++)
+        writeAndCheck(writer, img, "Green square", i);
+
+    printf("== Small changes after a frame with a palette of changed pixels only ==\n");
+    fflush(stdout);
+    fillStripes(img);
+    writeAndCheck(writer, img, "Stripes", 0);
+    fillRect(img, 10, 10, 4, 4, 255, 0, 0);
+    writeAndCheck(writer, img, "Red square", 1);
+    fillRect(img, 20, 20, 4, 4, 0, 0, 255);
+    writeAndCheck(writer, img, "Blue square", 2);
+    for(int i = 3; i <= 31; i++)
+    {
+        fillRect(img, static_cast<uint32_t>(i * 4), 200, 4, 4, 255, 255, 255);
+        writeAndCheck(writer, img, "White squares", i);
+    }
+
+    printf("== Small changes with colors of the frame ==\n");
+    fflush(stdout);
+    fillGreys(img);
+    writeAndCheck(writer, img, "Four greys", 0);
+    for(int i = 1; i <= 31; i++)
+    {
+        fillRect(img, static_cast<uint32_t>(i * 4), 10, 4, 4, 224, 224, 224);
+        writeAndCheck(writer, img, "Grey squares", i);
+    }
+
+    if(!writer.lastPalValid)
+    {
+        printf("!!! Palette of the whole frame was not kept for barely changed frames\n");
+        g_failed++;
+    }
+
+    GifEnd(&writer);
+
+    if(g_failed)
+    {
+        printf("== FAILED: %d frames are out of palette ==\n", g_failed);
+        return 1;
+    }
+
+    printf("== All frames are matching their palettes ==\n");
+    return 0;
+}
@@ -0,0 +1,17 @@
+CONFIG -= qt
+CONFIG += c++11
+
+TARGET = StaticGeometry_Benchmark
+CONFIG += console
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+DESTDIR = $$PWD/bin
+
+linux-g++||win32: {
+LIBS += -static-libgcc -static-libstdc++ -static -lpthread
+}
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,309 @@
+#include <stdint.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+/*
+ * Model of the broad phase of the level on a big level of fixed blocks.
+ *
+ * Blocks are allocated one by one as LevelScene::placeBlock() does, with the size
+ * and the position of momentum of engine objects, and the static geometry store
+ * is filled the same way as LVL_StaticGeometry does. Every body of the frame
+ * picks candidates of its cluster by the previous way (actual position of every
+ * candidate object) and by the current one (scan of the store, then actual
+ * position of passed candidates only); both must give same candidates.
+ */
+
+// sizeof(PGE_Phys_Object) with fields of LVL_Block except of its two LevelBlock copies,
+// and offset of PGE_Phys_Object::m_momentum, both on x86_64 with GCC
+static const size_t c_blockObjectSize = 1216;
+static const size_t c_momentumOffset = 296;
+
+static const double c_blockSize = 32.0;
+static const double c_clusterMargin = 32.0; // LVL_BroadPhase::clusterMargin
+
+class ElapsedTimer
+{
+public:
+    typedef std::chrono::nanoseconds TimeT;
+    ElapsedTimer() {}
+    void start()
+    {
+        recent = std::chrono::high_resolution_clock::now();
+    }
+    int64_t elapsed()
+    {
+        using std::chrono::nanoseconds;
+        using std::chrono::duration_cast;
+        return duration_cast<nanoseconds>(std::chrono::high_resolution_clock::now() - recent).count();
+    }
+    std::chrono::high_resolution_clock::time_point recent;
+};
+
+struct Momentum
+{
+    double x, y, w, h;
+};
+
+struct Rect
+{
+    double left, top, right, bottom;
+};
+
+static inline const Momentum &momentum(const uint8_t *obj)
+{
+    return *reinterpret_cast<const Momentum *>(obj + c_momentumOffset);
+}
+
+static inline bool zoneIntersects(const Rect &zone, const Momentum &m)
+{
+    return !((zone.right <= m.x) || (m.x + m.w <= zone.left) ||
+             (zone.bottom <= m.y) || (m.y + m.h <= zone.top));
+}
+
+static inline float floatBelow(double value)
+{
+    float f = static_cast<float>(value);
+    if(static_cast<double>(f) > value)
+        f = std::nextafter(f, -std::numeric_limits<float>::infinity());
+    return f;
+}
+
+static inline float floatAbove(double value)
+{
+    float f = static_cast<float>(value);
+    if(static_cast<double>(f) < value)
+        f = std::nextafter(f, std::numeric_limits<float>::infinity());
+    return f;
+}
+
+struct Store
+{
+    std::vector<float>   left, top, right, bottom;
+    std::vector<uint8_t> blocked;
+    std::vector<const void *> tree;
+
+    size_t bytes() const
+    {
+        return left.capacity() * sizeof(float) * 4 + blocked.capacity() + tree.capacity() * sizeof(void *);
+    }
+
+    inline bool intersects(uint32_t slot, double l, double t, double r, double b) const
+    {
+        double ox = 0.0, oy = 0.0; // Blocks are not members of layers
+        return (r > left[slot] - ox) & (right[slot] - ox > l) &
+               (b > top[slot] - oy) & (bottom[slot] - oy > t);
+    }
+};
+
+struct Cluster
+{
+    Rect zone;
+    std::vector<uint8_t *> candidates;
+    std::vector<uint32_t>  slots;
+};
+
+static void queryObjects(const Cluster &c, const Rect &zone, std::vector<uint8_t *> &out)
+{
+    for(uint8_t *obj : c.candidates)
+    {
+        if(zoneIntersects(zone, momentum(obj)))
+            out.push_back(obj);
+    }
+}
+
+// Same as LVL_BroadPhase::query()
+static void queryStore(const Store &store, const Cluster &c, const Rect &zone, std::vector<uint8_t *> &out)
+{
+    const size_t scanBlock = 64;
+    unsigned char hit[scanBlock];
+    const size_t end = c.candidates.size();
+    for(size_t begin = 0; begin < end; begin += scanBlock)
+    {
+        size_t count = std::min(scanBlock, end - begin);
+        for(size_t i = 0; i < count; i++)
+            hit[i] = static_cast<unsigned char>(store.intersects(c.slots[begin + i], zone.left, zone.top, zone.right, zone.bottom));
+        for(size_t i = 0; i < count; i++)
+        {
+            if(!hit[i])
+                continue;
+            uint8_t *obj = c.candidates[begin + i];
+            if(!zoneIntersects(zone, momentum(obj)))
+                continue;
+            out.push_back(obj);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int columns = 2000, rows = 25;  // 50000 blocks
+    int bodies = 300;
+    int groupSize = 1;
+    int frames = 200;
+    if(argc > 1)
+        columns = atoi(argv[1]);
+    if(argc > 2)
+        bodies = atoi(argv[2]);
+    if(argc > 3)
+        groupSize = std::max(1, atoi(argv[3]));
+    if(argc > 4)
+        frames = atoi(argv[4]);
+
+    const size_t blocksCount = static_cast<size_t>(columns) * static_cast<size_t>(rows);
+    printf("== %u blocks, %d bodies in groups of %d, %d frames ==\n",
+           static_cast<unsigned>(blocksCount), bodies, groupSize, frames);
+    fflush(stdout);
+
+    std::vector<uint8_t *> blocks(blocksCount);
+    Store store;
+    for(int y = 0; y < rows; y++)
+    {
+        for(int x = 0; x < columns; x++)
+        {
+            uint8_t *obj = new uint8_t[c_blockObjectSize];
+            memset(obj, 0, c_blockObjectSize);
+            Momentum &m = *reinterpret_cast<Momentum *>(obj + c_momentumOffset);
+            m.x = x * c_blockSize;
+            m.y = y * c_blockSize;
+            m.w = c_blockSize;
+            m.h = c_blockSize;
+            blocks[static_cast<size_t>(y) * static_cast<size_t>(columns) + static_cast<size_t>(x)] = obj;
+            store.left.push_back(floatBelow(m.x));
+            store.top.push_back(floatBelow(m.y));
+            store.right.push_back(floatAbove(m.x + m.w));
+            store.bottom.push_back(floatAbove(m.y + m.h));
+            store.blocked.push_back(0x11);
+            store.tree.push_back(nullptr);
+        }
+    }
+
+    // Bodies are walking and falling over the level in groups of groupSize, bodies of every group
+    // are close to each other and share one cluster, like crowds of NPCs on the screen
+    std::mt19937 rng(12345);
+    const double groupArea = (groupSize > 1) ? 480.0 : 0.0;
+    std::uniform_real_distribution<double> posX(0.0, columns * c_blockSize - 64.0 - groupArea);
+    std::uniform_real_distribution<double> posY(0.0, rows * c_blockSize - 64.0 - std::min(groupArea, rows * c_blockSize / 2.0));
+    std::uniform_real_distribution<double> inGroup(0.0, 1.0);
+    std::vector<Rect> zones(static_cast<size_t>(bodies));
+    std::vector<size_t> bodyCluster(zones.size());
+    std::vector<Cluster> clusters;
+    size_t totalCandidates = 0;
+    for(size_t i = 0; i < zones.size(); i += static_cast<size_t>(groupSize))
+    {
+        double gx = posX(rng), gy = posY(rng);
+        Cluster c;
+        c.zone = {1e9, 1e9, -1e9, -1e9};
+        for(size_t j = i; j < std::min(zones.size(), i + static_cast<size_t>(groupSize)); j++)
+        {
+            double x = gx + inGroup(rng) * groupArea;
+            double y = gy + inGroup(rng) * std::min(groupArea, rows * c_blockSize / 2.0);
+            zones[j] = {x, y, x + 40.0, y + 40.0};
+            c.zone.left = std::min(c.zone.left, x - c_clusterMargin);
+            c.zone.top = std::min(c.zone.top, y - c_clusterMargin);
+            c.zone.right = std::max(c.zone.right, x + 40.0 + c_clusterMargin);
+            c.zone.bottom = std::max(c.zone.bottom, y + 40.0 + c_clusterMargin);
+            bodyCluster[j] = clusters.size();
+        }
+        int x1 = std::max(0, static_cast<int>(std::floor(c.zone.left / c_blockSize)));
+        int x2 = std::min(columns - 1, static_cast<int>(std::floor(c.zone.right / c_blockSize)));
+        int y1 = std::max(0, static_cast<int>(std::floor(c.zone.top / c_blockSize)));
+        int y2 = std::min(rows - 1, static_cast<int>(std::floor(c.zone.bottom / c_blockSize)));
+        std::vector<uint32_t> found;
+        for(int yy = y1; yy <= y2; yy++)
+            for(int xx = x1; xx <= x2; xx++)
+                found.push_back(static_cast<uint32_t>(yy * columns + xx));
+        // Tree gives candidates in order of its nodes, not of the memory
+        std::shuffle(found.begin(), found.end(), rng);
+        for(uint32_t slot : found)
+        {
+            c.candidates.push_back(blocks[slot]);
+            c.slots.push_back(slot);
+        }
+        clusters.push_back(c);
+    }
+    for(size_t i = 0; i < zones.size(); i++)
+        totalCandidates += clusters[bodyCluster[i]].candidates.size();
+
+    // Rest of the frame (rendering, other objects) evicts blocks from caches
+    std::vector<uint8_t> evict(64 * 1024 * 1024);
+    auto evictCaches = [&evict]()
+    {
+        for(size_t i = 0; i < evict.size(); i += 64)
+            evict[i]++;
+    };
+
+    std::vector<uint8_t *> outObjects, outStore;
+    size_t found = 0;
+    int failed = 0;
+    for(size_t i = 0; i < zones.size(); i++)
+    {
+        outObjects.clear();
+        outStore.clear();
+        queryObjects(clusters[bodyCluster[i]], zones[i], outObjects);
+        queryStore(store, clusters[bodyCluster[i]], zones[i], outStore);
+        if(outObjects != outStore)
+            failed++;
+        found += outObjects.size();
+    }
+
+    int64_t time[2][2] = {{0, 0}, {0, 0}}; // [objects, store][hot, cold]
+    for(int cold = 0; cold < 2; cold++)
+    {
+        for(int f = 0; f < frames; f++)
+        {
+            for(int way = 0; way < 2; way++)
+            {
+                if(cold)
+                    evictCaches();
+                ElapsedTimer clock;
+                clock.start();
+                for(size_t i = 0; i < zones.size(); i++)
+                {
+                    outObjects.clear();
+                    if(way == 0)
+                        queryObjects(clusters[bodyCluster[i]], zones[i], outObjects);
+                    else
+                        queryStore(store, clusters[bodyCluster[i]], zones[i], outObjects);
+                }
+                time[way][cold] += clock.elapsed();
+            }
+        }
+    }
+
+    size_t objectsBytes = blocksCount * c_blockObjectSize;
+    size_t storeBytes = store.bytes();
+    printf("== Memory ==\n");
+    printf("Block objects: %u bytes each, %.1f MB (without LevelBlock copies and allocator overhead)\n",
+           static_cast<unsigned>(c_blockObjectSize), objectsBytes / 1048576.0);
+    printf("Static geometry store: %.1f bytes per block, %.2f MB (+%.1f%%)\n",
+           static_cast<double>(storeBytes) / static_cast<double>(blocksCount), storeBytes / 1048576.0,
+           100.0 * static_cast<double>(storeBytes) / static_cast<double>(objectsBytes));
+    printf("Candidate slots of the broad phase: %u bytes per candidate, %u candidates per frame\n",
+           static_cast<unsigned>(sizeof(uint32_t)), static_cast<unsigned>(totalCandidates));
+
+    printf("== Broad phase per frame, %u clusters, %u candidates, %u found ==\n",
+           static_cast<unsigned>(clusters.size()), static_cast<unsigned>(totalCandidates), static_cast<unsigned>(found));
+    printf("Objects, hot caches:  %8.1f us\n", time[0][0] / 1000.0 / frames);
+    printf("Store, hot caches:    %8.1f us\n", time[1][0] / 1000.0 / frames);
+    printf("Objects, cold caches: %8.1f us\n", time[0][1] / 1000.0 / frames);
+    printf("Store, cold caches:   %8.1f us\n", time[1][1] / 1000.0 / frames);
+
+    for(uint8_t *obj : blocks)
+        delete[] obj;
+
+    if(failed)
+    {
+        printf("== FAILED: %d bodies got different candidates ==\n", failed);
+        return 1;
+    }
+
+    printf("== Both ways are giving same candidates ==\n");
+    return 0;
+}
@@ -0,0 +1,85 @@
+#!/bin/bash
+#
+# Runs two headless engines on one level, server and client connected over 127.0.0.1,
+# then checks that every snapshot received by the client has the same checksum
+# as the snapshot sent by the server under the same sequence number.
+#
+# Usage: netsync_loopback_test.sh <pge_engine> <config pack dir> <level file> [port]
+#
+# CLIENT_FRAMES is count of loop steps of the client, the server runs until the client finishes.
+# MIN_SNAPSHOTS is the smallest count of matched snapshots to pass.
+
+if [[ $# -lt 3 ]]; then
+    echo "Usage: $0 <pge_engine> <config pack dir> <level file> [port]"
+    exit 2
+fi
+
+ENGINE="$1"
+CONFIG="$2"
+LEVEL="$3"
+PORT="${4:-24445}"
+CLIENT_FRAMES="${CLIENT_FRAMES:-10000}"
+MIN_SNAPSHOTS="${MIN_SNAPSHOTS:-20}"
+
+WORKDIR=$(mktemp -d)
+trap 'rm -rf "$WORKDIR"' EXIT
+
+"$ENGINE" --headless --config="$CONFIG" \
+    --netsync-server=$PORT --netsync-log="$WORKDIR/server.csv" "$LEVEL" > "$WORKDIR/server.out" 2>&1 &
+SERVER_PID=$!
+
+# Let the server open its socket
+sleep 1
+
+"$ENGINE" --headless --config="$CONFIG" --frames=$CLIENT_FRAMES \
+    --netsync-client=127.0.0.1:$PORT --netsync-log="$WORKDIR/client.csv" "$LEVEL" > "$WORKDIR/client.out" 2>&1
+CLIENT_CODE=$?
+
+if ! kill -0 $SERVER_PID 2> /dev/null; then
+    wait $SERVER_PID
+    echo "Server has quit before the client with exit code $?"
+    cat "$WORKDIR/server.out"
+    exit 1
+fi
+# Snapshot log is flushed on every line, so the server can be just killed
+kill $SERVER_PID
+wait $SERVER_PID 2> /dev/null
+
+if [[ $CLIENT_CODE -ne 0 ]]; then
+    echo "Client has failed with exit code $CLIENT_CODE"
+    cat "$WORKDIR/client.out"
+    exit 1
+fi
+
+if [[ ! -f "$WORKDIR/server.csv" || ! -f "$WORKDIR/client.csv" ]]; then
+    echo "Snapshot logs are missing, was the engine built with --netsync-log support?"
+    exit 1
+fi
+
+# side,sequence,time,entities,unresolved,checksum
+awk -F, -v minMatched=$MIN_SNAPSHOTS '
+    FNR == 1 { next }
+    $1 == "server" { sent[$2] = $6; next }
+    $1 == "client" {
+        received++
+        if(!($2 in sent)) { unknown++; next }
+        if(sent[$2] != $6)
+        {
+            printf("Snapshot %s differs: server %s, client %s\n", $2, sent[$2], $6)
+            mismatched++
+            next
+        }
+        matched++
+        if($5 > maxUnresolved)
+            maxUnresolved = $5
+    }
+    END {
+        printf("Snapshots: %d sent, %d received, %d matched, %d mismatched, %d unknown; up to %d objects unresolved by client\n",
+               length(sent), received, matched, mismatched, unknown, maxUnresolved)
+        if(mismatched > 0 || unknown > 0 || matched < minMatched)
+        {
+            print "FAILED: states of the server and the client are not converging"
+            exit 1
+        }
+        print "Server and client states are converging"
+    }' "$WORKDIR/server.csv" "$WORKDIR/client.csv"
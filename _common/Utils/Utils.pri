@@ -6,6 +6,7 @@ HEADERS += \
     $$PWD/files.h \
     $$PWD/strings.h \
     $$PWD/elapsed_timer.h \
+    $$PWD/bitmask.h \
     $$PWD/vptrlist.h \
 
 SOURCES += \
@@ -13,3 +14,4 @@ SOURCES += \
     $$PWD/files.cpp \
     $$PWD/strings.cpp \
     $$PWD/elapsed_timer.cpp \
+    $$PWD/bitmask.cpp \
@@ -0,0 +1,372 @@
+/*
+ * Vectorized kernels to merge bitwise transparency masks with front images
+ *
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "bitmask.h"
+
+/*
+ * SSE2 is a part of the base instruction set of x86_64, and of 32-bit x86 builds
+ * which are targeting SSE2. AVX2 is compiled per function and enabled at run time.
+ */
+#if defined(__x86_64__) || defined(_M_X64) || defined(_M_AMD64) || \
+    (defined(__i386__) && defined(__SSE2__)) || \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#   define BITMASK_USE_SSE2
+#   include <emmintrin.h>
+#   if defined(__clang__) || \
+       (defined(__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9))))
+#       define BITMASK_USE_AVX2
+#       define BITMASK_TARGET_AVX2 __attribute__((target("avx2")))
+#       include <immintrin.h>
+#   elif defined(_MSC_VER) && (_MSC_VER >= 1700)
+#       define BITMASK_USE_AVX2
+#       define BITMASK_TARGET_AVX2
+#       include <immintrin.h>
+#       include <intrin.h>
+#   endif
+#endif
+
+/*
+ * Reference implementations, every vectorized kernel must give same results
+ */
+
+static void mergeWithMaskScalar(uint8_t *front, const uint8_t *mask, size_t pixels, uint8_t maskBits)
+{
+    for(; pixels > 0; pixels--, front += 4, mask += 4)
+    {
+        unsigned int newAlpha = 255 - ((unsigned(mask[0]) + unsigned(mask[1]) + unsigned(mask[2])) / 3);
+
+        if((mask[0] > 240u) //is almost White
+           && (mask[1] > 240u)
+           && (mask[2] > 240u))
+            newAlpha = 0;
+
+        newAlpha += (unsigned(front[0]) + unsigned(front[1]) + unsigned(front[2])) / 3;
+
+        if(newAlpha > 255)
+            newAlpha = 255;
+
+        front[0] = (mask[0] & maskBits) | front[0];
+        front[1] = (mask[1] & maskBits) | front[1];
+        front[2] = (mask[2] & maskBits) | front[2];
+        front[3] = static_cast<uint8_t>(newAlpha);
+    }
+}
+
+static void maskFromAlphaScalar(const uint8_t *image, uint8_t *mask, size_t pixels)
+{
+    for(; pixels > 0; pixels--, image += 4, mask += 4)
+    {
+        uint8_t grey = 255 - image[3];
+        mask[0] = grey;
+        mask[1] = grey;
+        mask[2] = grey;
+        mask[3] = 0xFF;
+    }
+}
+
+static inline uint8_t subtractAlpha(uint8_t channel, uint8_t alpha)
+{
+    return (channel > alpha) ? static_cast<uint8_t>(channel - alpha) : 0;
+}
+
+static void splitToFrontAndMaskScalar(uint8_t *image, uint8_t *mask, size_t pixels)
+{
+    for(; pixels > 0; pixels--, image += 4, mask += 4)
+    {
+        uint8_t grey = 255 - image[3];
+        mask[0] = grey;
+        mask[1] = grey;
+        mask[2] = grey;
+        mask[3] = 0xFF;
+        image[0] = subtractAlpha(image[0], grey);
+        image[1] = subtractAlpha(image[1], grey);
+        image[2] = subtractAlpha(image[2], grey);
+        image[3] = 0xFF;
+    }
+}
+
+
+#ifdef BITMASK_USE_SSE2
+/*
+ * Every pixel is processed in own 32-bit lane. Sums of three channels are not
+ * exceeding 765, so they are divided by 3 exactly with multiplication by 0xAAAB
+ * and shift by 17 bits. The high 16-bit half of every lane stays zero, so
+ * 16-bit multiplication and min operations are safe to use here.
+ */
+static void mergeWithMaskSSE2(uint8_t *front, const uint8_t *mask, size_t pixels, uint8_t maskBits)
+{
+    const __m128i byteMask = _mm_set1_epi32(0xFF);
+    const __m128i colorMask = _mm_set1_epi32(0x00FFFFFF);
+    const __m128i bits = _mm_and_si128(_mm_set1_epi8(static_cast<char>(maskBits)), colorMask);
+    const __m128i div3 = _mm_set1_epi32(0xAAAB);
+    const __m128i white = _mm_set1_epi8(static_cast<char>(240));
+    const __m128i zero = _mm_setzero_si128();
+
+    for(; pixels >= 4; pixels -= 4, front += 16, mask += 16)
+    {
+        __m128i f = _mm_loadu_si128(reinterpret_cast<const __m128i *>(front));
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mask));
+
+        __m128i sumS = _mm_add_epi32(_mm_and_si128(s, byteMask),
+                       _mm_add_epi32(_mm_and_si128(_mm_srli_epi32(s, 8), byteMask),
+                                     _mm_and_si128(_mm_srli_epi32(s, 16), byteMask)));
+        __m128i sumF = _mm_add_epi32(_mm_and_si128(f, byteMask),
+                       _mm_add_epi32(_mm_and_si128(_mm_srli_epi32(f, 8), byteMask),
+                                     _mm_and_si128(_mm_srli_epi32(f, 16), byteMask)));
+        __m128i avgS = _mm_srli_epi32(_mm_mulhi_epu16(sumS, div3), 1);
+        __m128i avgF = _mm_srli_epi32(_mm_mulhi_epu16(sumF, div3), 1);
+
+        // Lanes where every colour channel of mask is greater than 240
+        __m128i notWhite = _mm_and_si128(_mm_cmpeq_epi8(_mm_subs_epu8(s, white), zero), colorMask);
+        __m128i isWhite = _mm_cmpeq_epi32(notWhite, zero);
+
+        __m128i alpha = _mm_andnot_si128(isWhite, _mm_sub_epi32(byteMask, avgS));
+        alpha = _mm_min_epi16(_mm_add_epi32(alpha, avgF), byteMask);
+
+        __m128i color = _mm_and_si128(_mm_or_si128(_mm_and_si128(s, bits), f), colorMask);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(front),
+                         _mm_or_si128(color, _mm_slli_epi32(alpha, 24)));
+    }
+
+    mergeWithMaskScalar(front, mask, pixels, maskBits);
+}
+
+static void maskFromAlphaSSE2(const uint8_t *image, uint8_t *mask, size_t pixels)
+{
+    const __m128i ones = _mm_set1_epi32(-1);
+
+    for(; pixels >= 4; pixels -= 4, image += 16, mask += 16)
+    {
+        __m128i a = _mm_srli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(image)), 24);
+        // (255 - alpha) in every colour channel, and 0xFF in alpha
+        __m128i grey = _mm_or_si128(a, _mm_or_si128(_mm_slli_epi32(a, 8), _mm_slli_epi32(a, 16)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(mask), _mm_xor_si128(grey, ones));
+    }
+
+    maskFromAlphaScalar(image, mask, pixels);
+}
+
+static void splitToFrontAndMaskSSE2(uint8_t *image, uint8_t *mask, size_t pixels)
+{
+    const __m128i colorMask = _mm_set1_epi32(0x00FFFFFF);
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+    for(; pixels >= 4; pixels -= 4, image += 16, mask += 16)
+    {
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i *>(image));
+        __m128i a = _mm_srli_epi32(px, 24);
+        __m128i grey = _mm_xor_si128(_mm_or_si128(a, _mm_or_si128(_mm_slli_epi32(a, 8), _mm_slli_epi32(a, 16))), colorMask);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(mask), _mm_or_si128(grey, alphaMask));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(image), _mm_or_si128(_mm_subs_epu8(px, grey), alphaMask));
+    }
+
+    splitToFrontAndMaskScalar(image, mask, pixels);
+}
+#endif // BITMASK_USE_SSE2
+
+
+#ifdef BITMASK_USE_AVX2
+// Same as SSE2 kernels, but with 8 pixels per step
+BITMASK_TARGET_AVX2
+static void mergeWithMaskAVX2(uint8_t *front, const uint8_t *mask, size_t pixels, uint8_t maskBits)
+{
+    const __m256i byteMask = _mm256_set1_epi32(0xFF);
+    const __m256i colorMask = _mm256_set1_epi32(0x00FFFFFF);
+    const __m256i bits = _mm256_and_si256(_mm256_set1_epi8(static_cast<char>(maskBits)), colorMask);
+    const __m256i div3 = _mm256_set1_epi32(0xAAAB);
+    const __m256i white = _mm256_set1_epi8(static_cast<char>(240));
+    const __m256i zero = _mm256_setzero_si256();
+
+    for(; pixels >= 8; pixels -= 8, front += 32, mask += 32)
+    {
+        __m256i f = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(front));
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(mask));
+
+        __m256i sumS = _mm256_add_epi32(_mm256_and_si256(s, byteMask),
+                       _mm256_add_epi32(_mm256_and_si256(_mm256_srli_epi32(s, 8), byteMask),
+                                        _mm256_and_si256(_mm256_srli_epi32(s, 16), byteMask)));
+        __m256i sumF = _mm256_add_epi32(_mm256_and_si256(f, byteMask),
+                       _mm256_add_epi32(_mm256_and_si256(_mm256_srli_epi32(f, 8), byteMask),
+                                        _mm256_and_si256(_mm256_srli_epi32(f, 16), byteMask)));
+        __m256i avgS = _mm256_srli_epi32(_mm256_mulhi_epu16(sumS, div3), 1);
+        __m256i avgF = _mm256_srli_epi32(_mm256_mulhi_epu16(sumF, div3), 1);
+
+        __m256i notWhite = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_subs_epu8(s, white), zero), colorMask);
+        __m256i isWhite = _mm256_cmpeq_epi32(notWhite, zero);
+
+        __m256i alpha = _mm256_andnot_si256(isWhite, _mm256_sub_epi32(byteMask, avgS));
+        alpha = _mm256_min_epi16(_mm256_add_epi32(alpha, avgF), byteMask);
+
+        __m256i color = _mm256_and_si256(_mm256_or_si256(_mm256_and_si256(s, bits), f), colorMask);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(front),
+                            _mm256_or_si256(color, _mm256_slli_epi32(alpha, 24)));
+    }
+
+    mergeWithMaskSSE2(front, mask, pixels, maskBits);
+}
+
+BITMASK_TARGET_AVX2
+static void maskFromAlphaAVX2(const uint8_t *image, uint8_t *mask, size_t pixels)
+{
+    const __m256i ones = _mm256_set1_epi32(-1);
+
+    for(; pixels >= 8; pixels -= 8, image += 32, mask += 32)
+    {
+        __m256i a = _mm256_srli_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(image)), 24);
+        __m256i grey = _mm256_or_si256(a, _mm256_or_si256(_mm256_slli_epi32(a, 8), _mm256_slli_epi32(a, 16)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(mask), _mm256_xor_si256(grey, ones));
+    }
+
+    maskFromAlphaSSE2(image, mask, pixels);
+}
+
+BITMASK_TARGET_AVX2
+static void splitToFrontAndMaskAVX2(uint8_t *image, uint8_t *mask, size_t pixels)
+{
+    const __m256i colorMask = _mm256_set1_epi32(0x00FFFFFF);
+    const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+
+    for(; pixels >= 8; pixels -= 8, image += 32, mask += 32)
+    {
+        __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(image));
+        __m256i a = _mm256_srli_epi32(px, 24);
+        __m256i grey = _mm256_xor_si256(_mm256_or_si256(a, _mm256_or_si256(_mm256_slli_epi32(a, 8), _mm256_slli_epi32(a, 16))), colorMask);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(mask), _mm256_or_si256(grey, alphaMask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(image), _mm256_or_si256(_mm256_subs_epu8(px, grey), alphaMask));
+    }
+
+    splitToFrontAndMaskSSE2(image, mask, pixels);
+}
+
+static bool cpuHasAVX2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if(info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    // Operating system must save AVX registers on context switch
+    if(((info[2] & (1 << 27)) == 0) || ((info[2] & (1 << 28)) == 0))
+        return false;
+    if((_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif // BITMASK_USE_AVX2
+
+
+struct BitMaskImpl
+{
+    BitMask::Kernel kernel;
+    void (*mergeWithMask)(uint8_t *, const uint8_t *, size_t, uint8_t);
+    void (*maskFromAlpha)(const uint8_t *, uint8_t *, size_t);
+    void (*splitToFrontAndMask)(uint8_t *, uint8_t *, size_t);
+};
+
+static const BitMaskImpl g_implScalar =
+{
+    BitMask::KERNEL_SCALAR, mergeWithMaskScalar, maskFromAlphaScalar, splitToFrontAndMaskScalar
+};
+
+#ifdef BITMASK_USE_SSE2
+static const BitMaskImpl g_implSSE2 =
+{
+    BitMask::KERNEL_SSE2, mergeWithMaskSSE2, maskFromAlphaSSE2, splitToFrontAndMaskSSE2
+};
+#endif
+
+#ifdef BITMASK_USE_AVX2
+static const BitMaskImpl g_implAVX2 =
+{
+    BitMask::KERNEL_AVX2, mergeWithMaskAVX2, maskFromAlphaAVX2, splitToFrontAndMaskAVX2
+};
+#endif
+
+static const BitMaskImpl *bestImpl(BitMask::Kernel wanted)
+{
+#ifdef BITMASK_USE_AVX2
+    static const bool hasAVX2 = cpuHasAVX2();
+    if(hasAVX2 && ((wanted == BitMask::KERNEL_AUTO) || (wanted == BitMask::KERNEL_AVX2)))
+        return &g_implAVX2;
+#endif
+#ifdef BITMASK_USE_SSE2
+    if(wanted != BitMask::KERNEL_SCALAR)
+        return &g_implSSE2;
+#endif
+    (void)wanted;
+    return &g_implScalar;
+}
+
+static const BitMaskImpl *&currentImpl()
+{
+    static const BitMaskImpl *impl = bestImpl(BitMask::KERNEL_AUTO);
+    return impl;
+}
+
+void BitMask::mergeWithMask(uint8_t *front, const uint8_t *mask, size_t pixels, uint8_t maskBits)
+{
+    currentImpl()->mergeWithMask(front, mask, pixels, maskBits);
+}
+
+void BitMask::maskFromAlpha(const uint8_t *image, uint8_t *mask, size_t pixels)
+{
+    currentImpl()->maskFromAlpha(image, mask, pixels);
+}
+
+void BitMask::splitToFrontAndMask(uint8_t *image, uint8_t *mask, size_t pixels)
+{
+    currentImpl()->splitToFrontAndMask(image, mask, pixels);
+}
+
+BitMask::Kernel BitMask::setKernel(BitMask::Kernel kernel)
+{
+    currentImpl() = bestImpl(kernel);
+    return currentImpl()->kernel;
+}
+
+BitMask::Kernel BitMask::kernel()
+{
+    return currentImpl()->kernel;
+}
+
+const char *BitMask::kernelName(BitMask::Kernel kernel)
+{
+    switch(kernel)
+    {
+    case KERNEL_AUTO:
+        return "auto";
+    case KERNEL_SCALAR:
+        return "scalar";
+    case KERNEL_SSE2:
+        return "SSE2";
+    case KERNEL_AVX2:
+        return "AVX2";
+    }
+    return "unknown";
+}
@@ -0,0 +1,101 @@
+/*
+ * Vectorized kernels to merge bitwise transparency masks with front images
+ *
+ * Copyright (c) 2017 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef BITMASK_H
+#define BITMASK_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * \brief Pixel kernels of the bitwise transparency masks (GIF front + mask pairs)
+ *
+ * All functions are working with arrays of 32-bit pixels where the alpha channel is
+ * the fourth byte of every pixel and the colour channels are the first three bytes in
+ * any order (FreeImage's 32-bit bitmaps and QImage::Format_ARGB32 on little-endian
+ * machines are matching this). Input and output arrays must not overlap, excepting
+ * the in-place arguments. The best implementation (AVX2, SSE2 or plain C++) is chosen
+ * at run time once per process; all of them are giving bit-exact same results.
+ */
+namespace BitMask
+{
+    enum Kernel
+    {
+        //! Choose the best kernel supported by the CPU
+        KERNEL_AUTO = 0,
+        //! Plain C++ implementation
+        KERNEL_SCALAR,
+        //! SSE2 implementation, 4 pixels per step
+        KERNEL_SSE2,
+        //! AVX2 implementation, 8 pixels per step
+        KERNEL_AVX2
+    };
+
+    /*!
+     * \brief Merge the bitwise mask into the front image and compute its alpha channel
+     * \param front [in,out] Front image pixels
+     * \param mask [in] Mask pixels
+     * \param pixels Count of pixels to process
+     * \param maskBits Bits of mask colour channels which are merged into the front, 0x7F for
+     *        the engine and tools, 0x80 for the Editor's QImage path (AND with qRgb(128,128,128))
+     */
+    void mergeWithMask(uint8_t *front, const uint8_t *mask, size_t pixels, uint8_t maskBits = 0x7F);
+
+    /*!
+     * \brief Generate the bitwise mask from the alpha channel of RGBA image
+     * \param image [in] Source image pixels
+     * \param mask [out] Destination mask pixels
+     * \param pixels Count of pixels to process
+     */
+    void maskFromAlpha(const uint8_t *image, uint8_t *mask, size_t pixels);
+
+    /*!
+     * \brief Split RGBA image into the bitwise front and the mask
+     * \param image [in,out] Source image pixels, will be turned into front image
+     * \param mask [out] Destination mask pixels
+     * \param pixels Count of pixels to process
+     */
+    void splitToFrontAndMask(uint8_t *image, uint8_t *mask, size_t pixels);
+
+    /*!
+     * \brief Force the kernel implementation (used by benchmarks and for debugging)
+     * \param kernel Kernel type. Unsupported by CPU kernels are falling back into the best supported
+     * \return Kernel which will be actually used
+     */
+    Kernel setKernel(Kernel kernel);
+
+    /*!
+     * \brief Get the kernel which is currently in use
+     * \return Kernel type
+     */
+    Kernel kernel();
+
+    /*!
+     * \brief Human-readable name of kernel
+     * \param kernel Kernel type
+     * \return Name of kernel
+     */
+    const char *kernelName(Kernel kernel);
+}
+
+#endif // BITMASK_H
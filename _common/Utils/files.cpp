@@ -137,6 +137,26 @@ bool Files::fileExists(const std::string &path)
     #endif
 }
 
+int64_t Files::fileModifiedTime(const std::string &path)
+{
+    #ifdef _WIN32
+    std::wstring wpath = Str2WStr(path);
+    WIN32_FILE_ATTRIBUTE_DATA attr;
+    if(GetFileAttributesExW(wpath.c_str(), GetFileExInfoStandard, &attr) == FALSE)
+        return -1;
+    ULARGE_INTEGER t;
+    t.LowPart = attr.ftLastWriteTime.dwLowDateTime;
+    t.HighPart = attr.ftLastWriteTime.dwHighDateTime;
+    //Convert from 100-nanosecond intervals since 1601 into seconds since 1970
+    return static_cast<int64_t>(t.QuadPart / 10000000ULL) - 11644473600LL;
+    #else
+    struct stat st;
+    if(stat(path.c_str(), &st) != 0)
+        return -1;
+    return static_cast<int64_t>(st.st_mtime);
+    #endif
+}
+
 bool Files::deleteFile(const std::string &path)
 {
     #ifdef _WIN32
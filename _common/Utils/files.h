@@ -26,11 +26,14 @@
 #define FILES_H
 
 #include <string>
+#include <cstdint>
 
 namespace Files
 {
     FILE *utf8_fopen(const char *filePath, const char *modes);
     bool fileExists(const std::string &path);
+    //Returns time of last modification of the file in seconds since epoch, or -1 on error
+    int64_t fileModifiedTime(const std::string &path);
     bool deleteFile(const std::string &path);
     bool copyFile(const std::string &to, const std::string &from, bool override = false);
     bool moveFile(const std::string &to, const std::string &from, bool override = false);
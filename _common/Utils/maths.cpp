@@ -26,15 +26,31 @@
 #include <assert.h>
 
 #include <chrono>
-#include <random>
+#include <mutex>
+
+//! State of the SplitMix64 generator, seeded with a timed value
+static uint64_t   g_randomState = static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+static std::mutex g_randomMutex;
 
 static double osRandom()
 {
-    auto t = std::chrono::high_resolution_clock::now().time_since_epoch().count();
-    std::default_random_engine e;//Seed engine with timed value.
-    e.seed(static_cast<std::default_random_engine::result_type>(t));
-    std::uniform_real_distribution<double> distribution(0.0, 1.0);
-    return distribution(e);
+    uint64_t z;
+    {
+        std::lock_guard<std::mutex> lock(g_randomMutex);
+        g_randomState += 0x9E3779B97F4A7C15ull;
+        z = g_randomState;
+    }
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z = z ^ (z >> 31);
+    //53 bits of mantissa, from 0.0 to 1.0 exclusive
+    return static_cast<double>(z >> 11) / 9007199254740992.0;
+}
+
+void Maths::seedRandom(uint64_t seed)
+{
+    std::lock_guard<std::mutex> lock(g_randomMutex);
+    g_randomState = seed;
 }
 
 int8_t Maths::rand()
@@ -40,6 +40,8 @@ namespace Maths
     uint64_t urand64();
     float    frand();
     double   drand();
+    //! Restart random numbers from the seed, same seed gives same numbers
+    void     seedRandom(uint64_t seed);
 
     long    roundTo(long src, long grid);
     double  roundTo(double src, double grid);